@@ -1,5 +1,6 @@
 #include "included/animatronic.hpp"
 #include "included/state.hpp"
+#include "included/graph.hpp"
 
 // Small, branch prediction hints (PSPSDK uses GCC)
 #if defined(__GNUC__)
@@ -31,7 +32,17 @@ namespace animatronic {
 
     bool unloaded = false;
 
-    int waitBeforeForceReset = 450; // int, not float
+    Table table;
+    scheduler::Wheel ai;
+
+    // Office clock for the stuck-state watchdog; unlike the AI clock it keeps
+    // running through Foxy's attack
+    static constexpr int kForceResetDelay = 450;
+    static scheduler::Wheel housekeeping;
+    static void forceReset(scheduler::Timer* timer);
+    static scheduler::Timer forceResetTimer = {forceReset, kForceResetDelay, 0};
+    static void onOpportunity(scheduler::Timer* timer);
+    static bool timersArmed = false;
 
     // ------------------------------
     // Internal reload worker state
@@ -43,6 +54,7 @@ namespace animatronic {
     // Forward decls
     static void ensureReloadWorker();
     static inline void queueReloadOnce();
+    static void armTimers();
 
     // ------------------------------
     // Fast RNG (drop-in replacement for rand()%N)
@@ -50,11 +62,13 @@ namespace animatronic {
 #if ANIMATRONIC_USE_STD_RAND
     static inline int fastRandN(int n) { return rand() % n; }
 #else
+    static uint32_t rngState = 0xA3C59AC3u; // non-zero seed; in snapshots
     static inline uint32_t xorshift32() {
-        static uint32_t s = 0xA3C59AC3u; // non-zero seed
+        uint32_t s = rngState;
         s ^= s << 13;
         s ^= s >> 17;
         s ^= s << 5;
+        rngState = s;
         return s;
     }
     static inline int fastRandN(int n) {
@@ -63,34 +77,35 @@ namespace animatronic {
     }
 #endif
 
+    // ==============================
+    // Per-character wiring; how they move is graph::characters (romfs/ai/map.txt)
+    // ==============================
+    static int* const kSpritePosition[kCount] = {
+        &sprite::UI::office::freddyPosition,
+        &sprite::UI::office::bonniePosition,
+        &sprite::UI::office::chicaPosition,
+        &sprite::UI::office::foxyPosition,
+    };
+
+    // Foxy's run: once he reaches the door the AI pauses, run.wav plays and the
+    // left door has a second to be shut
+    static int  warningTimer = 0;
+    static bool foxyAttackStarted = false;
+    static bool knockPlayed = false;
+
     // ==============================
     // Reset & utilities
     // ==============================
+    static void clearTable() {
+        for (int id = 0; id < kCount; ++id) {
+            table.level[id] = 0;
+            table.atDoor[id] = false;
+            table.position[id] = 0;
+        }
+    }
+
     void reset() {
-        freddy::levelOnes = 0;
-        freddy::levelTenths = 0;
-        freddy::totalLevel = 0;
-        freddy::atDoor = false;
-
-        bonnie::levelOnes = 0;
-        bonnie::levelTenths = 0;
-        bonnie::totalLevel = 0;
-        bonnie::atDoor = false;
-
-        chika::levelOnes = 0;
-        chika::levelTenths = 0;
-        chika::totalLevel = 0;
-        chika::atDoor = false;
-
-        foxy::levelOnes = 0;
-        foxy::levelTenths = 0;
-        foxy::totalLevel = 0;
-        foxy::atDoor = false;
-
-        freddy::position = 0;
-        bonnie::position = 0;
-        chika::position = 0;
-        foxy::position = 0;
+        clearTable();
 
         isMoving = false;
         reloaded = true;
@@ -102,8 +117,10 @@ namespace animatronic {
         unloaded = false;
         locked = false;
 
-        waitBeforeForceReset = 450;
+        armTimers();
+        housekeeping.schedule(forceResetTimer, kForceResetDelay);
         sprite::n_jumpscare::whichJumpscare = 0;
+        sprite::n_jumpscare::discard(0);
 
         // CRITICAL: Reset reload worker state to prevent state persistence between nights
         // This fixes the issue where Night 4→5 transitions inherit worker thread problems
@@ -143,75 +160,78 @@ namespace animatronic {
         }
         
         // Reset animatronic positions and levels (but don't call full reset to avoid double-reset)
-        freddy::levelOnes = 0;
-        freddy::levelTenths = 0;
-        freddy::totalLevel = 0;
-        freddy::atDoor = false;
-        freddy::position = 0;
-
-        bonnie::levelOnes = 0;
-        bonnie::levelTenths = 0;
-        bonnie::totalLevel = 0;
-        bonnie::atDoor = false;
-        bonnie::position = 0;
-
-        chika::levelOnes = 0;
-        chika::levelTenths = 0;
-        chika::totalLevel = 0;
-        chika::atDoor = false;
-        chika::position = 0;
-
-        foxy::levelOnes = 0;
-        foxy::levelTenths = 0;
-        foxy::totalLevel = 0;
-        foxy::atDoor = false;
-        foxy::position = 0;
+        clearTable();
 
         leftClosed = false;
         rightClosed = false;
         unloaded = false;
         locked = false;
-        waitBeforeForceReset = 450;
+        armTimers();
+        housekeeping.schedule(forceResetTimer, kForceResetDelay);
         sprite::n_jumpscare::whichJumpscare = 0;
+        sprite::n_jumpscare::discard(0);
         
         // Ensure worker thread state is completely cleared
         ensureReloadWorker();
     }
 
-    void forceAnimatronicAiReset() {
-        if (waitBeforeForceReset <= 0 && !jumpscaring) {
-
-            if (reloaded && isMoving) {
-                isMoving = false;
-            }
-            if (isMoving && reloaded && freddy::delay > 0 && bonnie::delay > 0 && chika::delay > 0 && foxy::delay > 0) {
-                isMoving = false;
-            }
+    static void setFoxyPaused(bool paused) {
+        // CRITICAL: Set pause state atomically using semaphore synchronization
+        if (FoxyStateSemaphore >= 0) {
+            sceKernelWaitSema(FoxyStateSemaphore, 1, nullptr);
+            state::isFoxyAttackPaused = paused;
+            sceKernelSignalSema(FoxyStateSemaphore, 1);
+        } else {
+            state::isFoxyAttackPaused = paused; // Fallback if semaphore unavailable
+        }
+    }
 
-            if (freddy::position > 6) freddy::position = 6;
-            if (bonnie::position > 6 && bonnie::position != 7) bonnie::position = 6;
-            if (chika::position > 6 && chika::position != 7 && chika::position != 8 && chika::position != 9) chika::position = 6;
-            if (foxy::position > 4) foxy::position = 4;
+    static void resetFoxyAttack() {
+        warningTimer = 0;
+        foxyAttackStarted = false;
+        knockPlayed = false;
+        setFoxyPaused(false);
+    }
 
-            if (foxy::position == 0) foxy::position = 0;
+    static void forceReset(scheduler::Timer* timer) {
+        if (jumpscaring) {
+            // Try again every frame until the jumpscare is over
+            housekeeping.schedule(*timer, 0);
+            return;
+        }
 
-            if (bonnie::inOtherRoom && bonnie::position != 7) bonnie::inOtherRoom = false;
-            if (chika::inOtherRoom && chika::position != 7 && chika::position != 8 && chika::position != 9) chika::inOtherRoom = false;
+        bool opportunityDue = false;
+        for (int id = 0; id < kCount; ++id) {
+            if (ai.remaining(table.opportunity[id]) <= 0) opportunityDue = true;
+        }
+        if (reloaded && isMoving) {
+            isMoving = false;
+        }
+        if (isMoving && reloaded && !opportunityDue) {
+            isMoving = false;
+        }
 
-            if (freddy::atDoor && freddy::position < 6) freddy::atDoor = false;
-            if (bonnie::atDoor && bonnie::position < 6) bonnie::atDoor = false;
-            if (chika::atDoor && chika::position < 6) chika::atDoor = false;
-            if (foxy::atDoor && foxy::position < 4) {
-                foxy::atDoor = false;
-                foxy::resetAttackState();
+        // Pull anyone stuck past their door back to it, and drop flags their position contradicts
+        for (int id = 0; id < kCount; ++id) {
+            const graph::Character& character = graph::characters[id];
+            if (table.position[id] > character.door && !(graph::node(id, table.position[id]).flags & graph::kSide)) {
+                table.position[id] = character.door;
+            }
+            if (table.inOtherRoom[id] && !(graph::node(id, table.position[id]).flags & graph::kSide)) {
+                table.inOtherRoom[id] = false;
+            }
+            if (table.atDoor[id] && table.position[id] < character.door) {
+                table.atDoor[id] = false;
+                if (character.flags & graph::kRuns) resetFoxyAttack();
             }
-
-            waitBeforeForceReset = 450;
-        } else {
-            waitBeforeForceReset -= 1;
         }
     }
 
+    void forceAnimatronicAiReset() {
+        armTimers();
+        housekeeping.advance();
+    }
+
     // ==============================
     // Persistent reload worker
     // ==============================
@@ -242,11 +262,10 @@ namespace animatronic {
             // Replaces the old system that unloaded all cameras and caused black screens
             sprite::UI::office::updateChangedCams();
 
-            // CRITICAL: Don't play audio from background thread to prevent race conditions
-            // Audio should only be played from the main thread
-            // if (usingCams) {
-            //     sfx::office::playMove();
-            // }
+            // Sound events are queued for the mixer, so this thread can post them itself
+            if (usingCams) {
+                sfx::office::playMove();
+            }
 
             reloaded = true;
             isMoving = false;
@@ -282,31 +301,25 @@ namespace animatronic {
     }
 
     void setReload() {
-        // CRITICAL: Fix deadlock issue - allow queuing reloads even during active reloads
-        // The semaphore system handles batching multiple requests automatically
-        // Only prevent queuing during jumpscares to maintain stability
-        
-        // Use atomic semaphore operations to prevent race conditions
+        // Only a jumpscare holds reloads back. No polling here: a token taken
+        // while sPendingReloads is set is a reload the worker never wakes for,
+        // and every later request folds into the lost one
         if (LIKELY(!jumpscaring)) {
-            ensureReloadWorker();
-            // Try to acquire semaphore non-blocking to prevent races
-            if (ReloadSemaphore >= 0 && sceKernelPollSema(ReloadSemaphore, 1) >= 0) {
-                // We got the semaphore, now queue the reload and signal back
-                queueReloadOnce();
-            } else {
-                // Semaphore busy or unavailable, queue anyway as system handles batching
-                queueReloadOnce();
-            }
+            queueReloadOnce();
         }
     }
 
     // ==============================
     // Game flow
     // ==============================
+    static void foxyAttackFrame();
+
     void runAiLoop() {
+        armTimers();
+
         // Handle Foxy attack every frame (not just every AI turn)
         if (save::whichNight > 1) {
-            foxy::handleAttackFrame();
+            foxyAttackFrame();
         }
         
         // Pause AI movements during Foxy attack
@@ -319,534 +332,250 @@ namespace animatronic {
         } else {
             foxyPaused = state::isFoxyAttackPaused; // Fallback
         }
-        if (!foxyPaused) {
-            freddy::wait();
-            if (save::whichNight == 2) {
-                freddy::incrementDifficulty();
-            }
 
-            bonnie::wait();
-            chika::wait();
-            if (save::whichNight > 1) {
-                foxy::wait();
-            }
-            
-            // CRITICAL: Play move sound from main thread only to prevent race conditions
-            if (usingCams && isMoving) {
-                sfx::office::playMove();
-            }
+        // Foxy sits out night 1; his timer keeps its count until he is active
+        if (save::whichNight > 1) {
+            ai.resume(table.opportunity[kFoxy]);
+        } else {
+            ai.suspend(table.opportunity[kFoxy]);
         }
-    }
-
-    void unloadMain() {
-        // locked = true; // kept commented as in original
-
-        state::isOffice = false;
-
-        // Clean up office audio (comprehensive cleanup matching powerout.cpp)
-        sfx::office::unloadSfx();
-        ambience::office::unloadAmbience();
-        ambience::office::unloadFanSound();
-        call::unloadPhoneCalls();
-
-        // Clean up office sprites and UI (comprehensive cleanup matching powerout.cpp)
-        sprite::UI::office::unloadCamUi();
-        sprite::UI::office::unloadPowerInfo();
-        sprite::UI::office::unloadTimeInfo();
-        sprite::office::unloadDoors();
-        sprite::office::unloadButtons();
-        sprite::UI::office::unloadCams();
-        sprite::UI::office::unloadCamFlip();
-
-        // Clean up office background sprites (comprehensive cleanup matching powerout.cpp)
-        officeImage::unloadOffice1Sprites();
-        officeImage::unloadOffice2Sprites();
-
-        // CRITICAL: Clean up pre-cached assets to prevent camera system conflicts
-        // This matches the comprehensive cleanup in powerout.cpp and dead.cpp
-        text::preload::unloadCameraAssets();
-        text::preload::unloadJumpscareAssets();
-        sfx::preload::unloadCriticalAudio();
 
-        sfx::jumpscare::loadJumpscareSound();
-
-        initJumpscare();
-    }
-
-    void initJumpscare() {
-        // Load sprites immediately (benefits from pre-caching system)
-        // This ensures sprites are ready before state transition
-        sprite::n_jumpscare::loadJumpscare();
-        
-        // Only set state after loading is complete
-        state::isJumpscare = true;
+        if (!foxyPaused) {
+            ai.advance();
+        }
     }
 
     // ==============================
-    // Freddy
+    // Movement
     // ==============================
-    namespace freddy {
-        int   levelOnes = 0;
-        int   levelTenths = 0;
-        float totalLevel = 0;
-        int   randomNumber = 0;
-
-        float position = 0;
-        int   delay = 650; // int, not float
-
-        bool  atDoor = false;
-
-        inline void reloadPosition() {
-            sprite::UI::office::freddyPosition = position;
-            setReload();
-        }
-
-        inline void triggerJumpscare() {
-            jumpscaring = true;
-            sprite::n_jumpscare::whichJumpscare = 1;
-            unloadMain();
-        }
-
-        inline void blockAttack() {
-            atDoor = false;
-            position = 6;
-            reloadPosition();
-        }
+    // At its door or one step from it: its jumpscare set is worth decoding
+    static inline bool nearDoor(int id) {
+        const int door = graph::characters[id].door;
+        const int position = table.position[id];
+        const graph::Node& node = graph::node(id, position);
+        return position == door || (node.next == door && !(node.flags & graph::kSide));
+    }
 
-        inline void moveForward() {
-            position += 1;
-            sfx::office::playLaugh();
-            reloadPosition();
-        }
+    static inline void reloadPosition(int id) {
+        *kSpritePosition[id] = table.position[id];
+        setReload();
 
-        inline bool shouldMoveOrAttack() {
-            return (randomNumber < totalLevel || position == 6);
-        }
-
-        inline void handleAtDoor() {
-            atDoor = true;
-            if (!jumpscaring && !rightClosed && usingCams) {
-                triggerJumpscare();
-            } else if (!jumpscaring && rightClosed) {
-                blockAttack();
-            }
-        }
-
-        inline void decideNextMove() {
-            if (position >= 6) {
-                handleAtDoor();
-            } else if (!usingCams && !::animatronic::isMoving) {
-                moveForward();
-            }
-        }
+        if (nearDoor(id)) sprite::n_jumpscare::warm(id + 1);
+        else sprite::n_jumpscare::discard(id + 1);
+    }
 
-        inline void evaluateMovement() {
-            if (shouldMoveOrAttack() && !atDoor) {
-                decideNextMove();
-            }
-        }
+    static void triggerJumpscare(int id) {
+        jumpscaring = true;
+        sprite::n_jumpscare::whichJumpscare = id + 1;
+        state::request(state::kJumpscare);
+    }
 
-        void generateRandom() {
-            randomNumber = fastRandN(20);
-            evaluateMovement();
-        }
+    static void blockAttack(int id) {
+        table.atDoor[id] = false;
+        table.position[id] = graph::characters[id].blockedTo;
+        if (graph::characters[id].flags & graph::kRuns) resetFoxyAttack();
+        reloadPosition(id);
+    }
 
-        void wait() {
-            if (delay > 0) {
-                --delay;
-            } else {
-                generateRandom();
-                delay = 650;
+    static void reachDoor(int id) {
+        const graph::Character& character = graph::characters[id];
+        if (character.flags & graph::kRuns) {
+            if (!table.atDoor[id]) {
+                table.atDoor[id] = true;
+                // Start the warning timer when Foxy reaches the door
+                warningTimer = 0;
+                foxyAttackStarted = false;
+                knockPlayed = false;
+                setFoxyPaused(true); // Pause cameras and AI during attack
             }
+            return;
         }
 
-        void incrementDifficulty() {
-            if (save::whichNight == 3) {
-                totalLevel = static_cast<float>(fastRandN(3)); // Night 3 variability kept
-            }
+        table.atDoor[id] = true;
+        const bool closed = character.side == graph::kLeftDoor ? leftClosed : rightClosed;
+        if (!jumpscaring && !closed && (usingCams || !(character.flags & graph::kNeedsCams))) {
+            triggerJumpscare(id);
+        } else if (!jumpscaring && closed) {
+            blockAttack(id);
         }
     }
 
-    // ==============================
-    // Bonnie
-    // ==============================
-    namespace bonnie {
-        int   levelOnes = 0;
-        int   levelTenths = 0;
-        float totalLevel = 0;
-        int   randomNumber = 0;
-
-        bool  inOtherRoom = false;
-        float position = 0;
-        int   delay = 389; // int
-
-        bool  atDoor = false;
-
-        inline void reloadPosition() {
-            sprite::UI::office::bonniePosition = position;
-            setReload();
+    // One movement opportunity, the same routine for every character
+    static void onOpportunity(scheduler::Timer* timer) {
+        const int id = static_cast<int>(timer - table.opportunity);
+        const graph::Character& character = graph::characters[id];
+        if (character.flags & graph::kForgetsRoom) {
+            table.inOtherRoom[id] = false;
         }
 
-        inline void triggerJumpscare() {
-            jumpscaring = true;
-            sprite::n_jumpscare::whichJumpscare = 2;
-            unloadMain();
-        }
-
-        inline void blockAttack() {
-            atDoor = false;
-            position = 1;
-            reloadPosition();
-        }
-
-        inline void moveForward() {
-            position += 1;
-            reloadPosition();
-        }
-
-        inline bool shouldMoveOrAttack() {
-            return (randomNumber < totalLevel || position == 6);
-        }
+        const int roll = fastRandN(20);
+        const int position = table.position[id];
+        const int level = table.level[id];
+        const graph::Node& node = graph::node(id, position);
+        table.roll[id] = static_cast<unsigned char>(roll);
 
-        void moveToRoom(int targetRoom) {
-            position = static_cast<float>(targetRoom);
-            inOtherRoom = true;
-            ::animatronic::isMoving = true;
-            reloadPosition();
+        bool moves;
+        if (character.flags & graph::kRuns) {
+            moves = roll <= level || ((node.flags & graph::kPushed) && !isMoving);
+        } else {
+            moves = roll < level || (node.flags & graph::kPushed);
         }
+        if (!moves || table.atDoor[id]) return;
 
-        inline void handleAtDoor() {
-            atDoor = true;
-            if (!jumpscaring && !leftClosed) {
-                triggerJumpscare();
-            } else if (!jumpscaring && leftClosed) {
-                blockAttack();
+        if (node.flags & graph::kReturn) {
+            if (table.inOtherRoom[id]) {
+                table.position[id] = node.next;
+                table.inOtherRoom[id] = false;
+                reloadPosition(id);
             }
-        }
-
-        inline void resetToStart() {
-            if (inOtherRoom) {
-                position = 2;
-                inOtherRoom = false;
-                reloadPosition();
+        } else if (roll == node.detourRoll) {
+            table.position[id] = node.detourTo;
+            table.inOtherRoom[id] = true;
+            isMoving = true;
+            reloadPosition(id);
+        } else if (node.flags & graph::kDoor) {
+            reachDoor(id);
+        } else if (!isMoving && (!usingCams || (node.flags & graph::kWatched))) {
+            table.position[id] = node.next;
+            if (character.flags & graph::kLaughs) {
+                sfx::office::playLaugh();
             }
+            reloadPosition(id);
         }
+    }
 
-        inline void evaluateOpportunity() {
-            if (randomNumber == 2 && (position == 2 || position == 3)) {
-                moveToRoom(7);
-            } else if (position >= 6 && position != 7) {
-                handleAtDoor();
-            } else if (!::animatronic::isMoving) {
-                moveForward();
+    static void foxyAttackFrame() {
+        // Only handle attack logic if Foxy is at the door
+        if (table.atDoor[kFoxy] && !jumpscaring) {
+            // Play run.wav immediately when Foxy reaches the door
+            if (!foxyAttackStarted) {
+                sfx::office::playRun();
+                foxyAttackStarted = true;
             }
-        }
-
-        void processMovementDecision() {
-            if (shouldMoveOrAttack() && !atDoor) {
-                if (position == 7) {
-                    resetToStart();
+            
+            // Increment warning timer every frame
+            warningTimer++;
+            
+            // Wait 1 second (60 frames at 60 FPS) before attacking
+            if (warningTimer >= 60) {
+                if (!leftClosed) {
+                    // User didn't block - trigger jumpscare
+                    // CRITICAL: Clear pause state atomically before jumpscare
+                    setFoxyPaused(false);
+                    triggerJumpscare(kFoxy);
                 } else {
-                    evaluateOpportunity();
+                    // User blocked - play knock.wav after run.wav
+                    if (!knockPlayed) {
+                        sfx::office::playKnock();
+                        knockPlayed = true;
+                    }
+                    // Wait a bit for knock sound to play, then reset
+                    if (warningTimer >= 90) { // Give knock sound time to play
+                        blockAttack(kFoxy);
+                    }
                 }
             }
         }
-
-        void generateRandom() {
-            randomNumber = fastRandN(20);
-            processMovementDecision();
-        }
-
-        void wait() {
-            if (delay > 0) {
-                --delay;
-            } else {
-                generateRandom();
-                delay = 389;
-            }
-        }
-
-        void incrementDifficulty() { totalLevel += 1; }
     }
 
+    void incrementDifficulty(int id) { table.level[id] += 1; }
+
     // ==============================
-    // Chika
+    // Snapshot
     // ==============================
-    namespace chika {
-        int   levelOnes = 0;
-        int   levelTenths = 0;
-        float totalLevel = 0;
-        int   randomNumber = 0;
-
-        bool  inOtherRoom = false;
-        float position = 0;
-        int   delay = 432; // int
-
-        bool  atDoor = false;
-
-        inline void reloadPosition() {
-            sprite::UI::office::chicaPosition = position;
-            setReload();
-        }
-
-        inline void triggerJumpscare() {
-            jumpscaring = true;
-            sprite::n_jumpscare::whichJumpscare = 3;
-            unloadMain();
-        }
-
-        inline void blockAttack() {
-            atDoor = false;
-            position = 1;
-            reloadPosition();
-        }
-
-        inline void moveForward() {
-            position += 1;
-            reloadPosition();
-        }
-
-        inline bool shouldMoveOrAttack() {
-            return (randomNumber < totalLevel || position == 6);
-        }
-
-        void moveToRoom(int targetRoom) {
-            position = static_cast<float>(targetRoom);
-            inOtherRoom = true;
-            ::animatronic::isMoving = true;
-            reloadPosition();
-        }
-
-        inline void handleAtDoor() {
-            atDoor = true;
-
-            if (!jumpscaring && !rightClosed) {
-                triggerJumpscare();
-            } else if (!jumpscaring && rightClosed) {
-                blockAttack();
-            }
-        }
-
-        inline void resetToStart() {
-            if (inOtherRoom) {
-                position = 1;
-                inOtherRoom = false;
-                reloadPosition();
-            }
-        }
+    // Timers go as ticks left, so they come back on a fresh wheel in the
+    // same phase and, on a shared tick, still fire in Id order
+    static void saveTimer(snapshot::Writer& out, scheduler::Wheel& wheel, scheduler::Timer& timer) {
+        out.s16(wheel.remaining(timer));
+        out.flag(timer.suspended);
+    }
 
-        inline void evaluateOpportunity() {
-            if (randomNumber == 3 && position == 1) {
-                moveToRoom(7);
-            } else if (randomNumber == 6 && position == 2) {
-                moveToRoom(9);
-            } else if (position >= 6 && position != 7 && position != 8 && position != 9) {
-                handleAtDoor();
-            } else if (!::animatronic::isMoving) {
-                moveForward();
-            }
+    static void restoreTimer(snapshot::Reader& in, scheduler::Wheel& wheel, scheduler::Timer& timer) {
+        const int remaining = in.s16();
+        const bool suspended = in.flag();
+        if (remaining < 0) {
+            wheel.cancel(timer);
+            return;
         }
+        wheel.schedule(timer, remaining);
+        if (suspended) wheel.suspend(timer);
+    }
 
-        void processMovementDecision() {
-            if (shouldMoveOrAttack() && !atDoor) {
-                if (position == 8 || position == 9) {
-                    resetToStart();
-                } else {
-                    evaluateOpportunity();
-                }
-            }
-        }
+    void saveSnapshot(snapshot::Writer& out) {
+        for (int id = 0; id < kCount; ++id) {
+            out.u8(table.position[id]);
+            out.u8(table.level[id]);
+            out.u8(table.roll[id]);
+            out.flag(table.atDoor[id]);
+            out.flag(table.inOtherRoom[id]);
+            saveTimer(out, ai, table.opportunity[id]);
+        }
+        saveTimer(out, housekeeping, forceResetTimer);
+
+        out.flag(isMoving);
+        out.flag(usingCams);
+        out.flag(leftClosed);
+        out.flag(rightClosed);
+
+        out.s16(warningTimer);
+        out.flag(foxyAttackStarted);
+        out.flag(knockPlayed);
+        out.flag(state::isFoxyAttackPaused);
+#if ANIMATRONIC_USE_STD_RAND
+        out.u32(0); // rand() keeps its own state
+#else
+        out.u32(rngState);
+#endif
+    }
 
-        void generateRandom() {
-            randomNumber = fastRandN(20);
-            processMovementDecision();
-        }
+    void restoreSnapshot(snapshot::Reader& in) {
+        armTimers();
+        for (int id = 0; id < kCount; ++id) {
+            table.position[id] = static_cast<signed char>(in.u8());
+            table.level[id] = static_cast<signed char>(in.u8());
+            table.roll[id] = static_cast<unsigned char>(in.u8());
+            table.atDoor[id] = in.flag();
+            table.inOtherRoom[id] = in.flag();
+            restoreTimer(in, ai, table.opportunity[id]);
+        }
+        restoreTimer(in, housekeeping, forceResetTimer);
+
+        isMoving = in.flag();
+        usingCams = in.flag();
+        leftClosed = in.flag();
+        rightClosed = in.flag();
+        reloaded = true;
+        jumpscaring = false;
 
-        void wait() {
-            if (delay > 0) {
-                --delay;
-            } else {
-                inOtherRoom = false;
-                generateRandom();
-                delay = 432;
-            }
-        }
+        warningTimer = in.s16();
+        foxyAttackStarted = in.flag();
+        knockPlayed = in.flag();
+        setFoxyPaused(in.flag());
+        const uint32_t rng = in.u32();
+#if !ANIMATRONIC_USE_STD_RAND
+        if (rng) rngState = rng;
+#else
+        (void)rng;
+#endif
 
-        void incrementDifficulty() { totalLevel += 1; }
+        for (int id = 0; id < kCount; ++id) reloadPosition(id);
     }
-    
+
     // ==============================
-    // Foxy
+    // AI clock
     // ==============================
-    namespace foxy {
-        int   levelOnes = 0;
-        int   levelTenths = 0;
-        float totalLevel = 0;
-        static int randomNumber = 0; // internal
-
-        float position = 0;
-        int   delay = 460; // int
-
-        bool  atDoor = false;
-        
-        // Foxy attack system
-        int   warningTimer = 0;
-        bool  foxyAttackStarted = false;
-        bool  knockPlayed = false;
-
-        inline void reloadPosition() {
-            sprite::UI::office::foxyPosition = position;
-            setReload();
-        }
-
-        inline void triggerJumpscare() {
-            jumpscaring = true;
-            sprite::n_jumpscare::whichJumpscare = 4;
-            unloadMain();
-        }
-
-        inline void resetToIdle() {
-            atDoor = false;
-            position = 0;
-            warningTimer = 0;
-            foxyAttackStarted = false;
-            knockPlayed = false;
-            
-            // CRITICAL: Clear pause state atomically
-            if (FoxyStateSemaphore >= 0) {
-                sceKernelWaitSema(FoxyStateSemaphore, 1, nullptr);
-                state::isFoxyAttackPaused = false;
-                sceKernelSignalSema(FoxyStateSemaphore, 1);
-            } else {
-                state::isFoxyAttackPaused = false; // Fallback
-            }
-            
-            reloadPosition();
-        }
-
-        inline void resetAttackState() {
-            warningTimer = 0;
-            foxyAttackStarted = false;
-            knockPlayed = false;
-            
-            // CRITICAL: Clear pause state atomically
-            if (FoxyStateSemaphore >= 0) {
-                sceKernelWaitSema(FoxyStateSemaphore, 1, nullptr);
-                state::isFoxyAttackPaused = false;
-                sceKernelSignalSema(FoxyStateSemaphore, 1);
-            } else {
-                state::isFoxyAttackPaused = false; // Fallback
-            }
-        }
-
-        inline void blockAttack() {
-            // knock.wav is now played in handleAtDoor() when user blocks
-            resetToIdle();
-        }
-
-        bool isMoving() { return ::animatronic::isMoving; }
-
-        bool shouldMoveOrAttack() {
-            return (randomNumber <= totalLevel || (position >= 3 && !isMoving() && !atDoor));
-        }
-
-        void handleAtDoor() {
-            if (!atDoor) {
-                atDoor = true;
-                // Start the warning timer when Foxy reaches the door
-                warningTimer = 0;
-                foxyAttackStarted = false;
-                knockPlayed = false;
-                
-                // CRITICAL: Set pause state atomically using semaphore synchronization
-                if (FoxyStateSemaphore >= 0) {
-                    sceKernelWaitSema(FoxyStateSemaphore, 1, nullptr);
-                    state::isFoxyAttackPaused = true; // Pause cameras and AI during attack
-                    sceKernelSignalSema(FoxyStateSemaphore, 1);
-                } else {
-                    state::isFoxyAttackPaused = true; // Fallback if semaphore unavailable
-                }
-            }
-        }
-
-        void handleAttackFrame() {
-            // Only handle attack logic if Foxy is at the door
-            if (atDoor && !jumpscaring) {
-                // Play run.wav immediately when Foxy reaches the door
-                if (!foxyAttackStarted) {
-                    sfx::office::playRun();
-                    foxyAttackStarted = true;
-                }
-                
-                // Increment warning timer every frame
-                warningTimer++;
-                
-                // Wait 1 second (60 frames at 60 FPS) before attacking
-                if (warningTimer >= 60) {
-                    if (!leftClosed) {
-                        // User didn't block - trigger jumpscare
-                        // CRITICAL: Clear pause state atomically before jumpscare
-                        if (FoxyStateSemaphore >= 0) {
-                            sceKernelWaitSema(FoxyStateSemaphore, 1, nullptr);
-                            state::isFoxyAttackPaused = false;
-                            sceKernelSignalSema(FoxyStateSemaphore, 1);
-                        } else {
-                            state::isFoxyAttackPaused = false; // Fallback
-                        }
-                        triggerJumpscare();
-                    } else {
-                        // User blocked - play knock.wav after run.wav
-                        if (!knockPlayed) {
-                            sfx::office::playKnock();
-                            knockPlayed = true;
-                        }
-                        // Wait a bit for knock sound to play, then reset
-                        if (warningTimer >= 90) { // Give knock sound time to play
-                            blockAttack();
-                        }
-                    }
-                }
-            }
-        }
-
-        void handleMovement() {
-            if (!isMoving() && ((position < 4 && !usingCams) || (position >= 3 && usingCams))) {
-                position += 1;
-                reloadPosition();
-            }
-        }
-
-        void attemptMoveOrAttack() {
-            if (position >= 4) {
-                handleAtDoor();
-            } else {
-                handleMovement();
-            }
-        }
-
-        void processRandomEvent() {
-            if (shouldMoveOrAttack()) {
-                attemptMoveOrAttack();
-            }
-        }
-
-        void generateRandomEvent() {
-            randomNumber = fastRandN(20);
-            processRandomEvent();
-        }
-
-        void wait() {
-            if (delay > 0) {
-                --delay;
-            } else {
-                generateRandomEvent();
-                delay = 460;
-            }
-        }
-
-        void incrementDifficulty() {
-            // No-op for now
-        }
+    // Armed once: like the old countdowns, opportunities keep their phase across nights
+    static void armTimers() {
+        if (timersArmed) return;
+        timersArmed = true;
+        for (int id = 0; id < kCount; ++id) {
+            scheduler::Timer& timer = table.opportunity[id];
+            timer.fire = onOpportunity;
+            timer.period = graph::characters[id].period;
+            timer.order = id;
+            ai.schedule(timer, timer.period);
+        }
+        housekeeping.schedule(forceResetTimer, kForceResetDelay);
     }
 
     // ==============================
@@ -865,10 +594,9 @@ namespace animatronic {
         switch (save::whichNight) {
             case 1: case 2: case 3: case 4: case 5: case 6: {
                 const int nightIndex = save::whichNight - 1;
-                freddy::totalLevel = static_cast<float>(levels[nightIndex][0]);
-                bonnie::totalLevel = static_cast<float>(levels[nightIndex][1]);
-                chika::totalLevel  = static_cast<float>(levels[nightIndex][2]);
-                foxy::totalLevel   = static_cast<float>(levels[nightIndex][3]);
+                for (int id = 0; id < kCount; ++id) {
+                    table.level[id] = static_cast<signed char>(levels[nightIndex][id]);
+                }
                 break;
             }
             case 7:
@@ -883,4 +611,4 @@ namespace animatronic {
         ensureReloadWorker();
     }
 
-} // namespace animatronic
\ No newline at end of file
+} // namespace animatronic
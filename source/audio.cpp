@@ -1,37 +1,31 @@
 #include "included/audio.hpp"
 #include "included/memory.hpp"
+#include "included/mixer.hpp"
+#include "included/stream.hpp"
 
-// Safety helper: pause before delete, then null the pointer
-// CRITICAL: Add thread safety to prevent race conditions during high activity
-static SceUID audioSemaphore = -1;
-
-static inline void initAudioSemaphore() {
-    if (audioSemaphore < 0) {
-        audioSemaphore = sceKernelCreateSema("audio_sema", 0, 1, 1, nullptr);
-    }
-}
-
+// Takes the sound off the mixer and nulls the handle; the memory goes once the
+// mix that may still be reading it is done (see mixer::collect)
 static inline void safeDelete(OSL_SOUND*& s) {
-    initAudioSemaphore();
-    
-    if (audioSemaphore >= 0) {
-        sceKernelWaitSema(audioSemaphore, 1, nullptr);
-    }
-    
     if (s) {
-        // CRITICAL: Check if sound is still valid before operations
-        // This prevents crashes when sound is accessed from multiple threads
-        int channel = oslGetSoundChannel(s);
-        if (channel != -1) {
-            oslPauseSound(s, 1); // pause this sound (not -1)
-            sceKernelDelayThread(1000); // Brief delay for pause to take effect (1ms)
-        }
-        oslDeleteSound(s);
+        mixer::release(s);
         s = nullptr;
     }
-    
-    if (audioSemaphore >= 0) {
-        sceKernelSignalSema(audioSemaphore, 1);
+}
+
+// Mixer priorities: when every voice is busy the lowest one is cut first
+static constexpr int kPriorityJumpscare = 100;
+static constexpr int kPriorityCall      = 90;
+static constexpr int kPriorityMusic     = 80;
+static constexpr int kPriorityAmbience  = 60;
+static constexpr int kPriorityThreat    = 50; // door, scare, run, knock
+static constexpr int kPriorityCue       = 40; // laugh
+static constexpr int kPriorityLoop      = 30; // buzz, walk
+static constexpr int kPriorityUi        = 20; // camera, switch, move
+
+namespace audio {
+    // Every sound is a stream now, so the stream list covers it all
+    size_t residentBytes() {
+        return stream::residentBytes();
     }
 }
 
@@ -41,15 +35,13 @@ namespace music {
 
         void loadMenuMusic() {
             safeDelete(menuMusic);
-            // Keep original format choice
-            menuMusic = oslLoadSoundFileWAV("romfs/music/menu/music.wav", OSL_FMT_NONE);
+            // Streamed: keeping the 2.7 MB of PCM resident for the whole menu isn't worth it
+            menuMusic = mixer::attach(stream::open("romfs/music/menu/music.wav"));
         }
         void playMenuMusic() {
             if (!menuMusic) return;
-            // Set loop first, then ensure it’s playing
-            oslSetSoundLoop(menuMusic, 1);
-            if (oslGetSoundChannel(menuMusic) == -1) {
-                oslPlaySound(menuMusic, 0);
+            if (!mixer::playing(menuMusic)) {
+                mixer::play(menuMusic, mixer::kMusic, kPriorityMusic, true);
             }
         }
         void unloadMenuMusic() {
@@ -63,13 +55,13 @@ namespace music {
 
         void loadEndingSong() {
             safeDelete(endingSong);
-            endingSong = oslLoadSoundFileWAV("romfs/music/ending/music.wav", OSL_FMT_STREAM);
+            endingSong = mixer::attach(stream::open("romfs/music/ending/music.wav"));
             stopped = false;
         }
         void playEndingSong() {
             if (!endingSong) return;
-            if (oslGetSoundChannel(endingSong) == -1) {
-                oslPlaySound(endingSong, 0);
+            if (!mixer::playing(endingSong)) {
+                mixer::play(endingSong, mixer::kMusic, kPriorityMusic);
             }
         }
         void stopEndingSong() {
@@ -90,13 +82,12 @@ namespace ambience {
 
         void loadAmbience() {
             safeDelete(ambience);
-            ambience = oslLoadSoundFileWAV("romfs/ambience/office/ambience_mix.wav", OSL_FMT_STREAM);
+            ambience = mixer::attach(stream::open("romfs/ambience/office/ambience_mix.wav"));
         }
         void playAmbience() {
             if (!ambience) return;
-            oslSetSoundLoop(ambience, 1);
-            if (oslGetSoundChannel(ambience) == -1) {
-                oslPlaySound(ambience, 0);
+            if (!mixer::playing(ambience)) {
+                mixer::play(ambience, mixer::kAmbience, kPriorityAmbience, true);
             }
         }
         void unloadAmbience() {
@@ -105,13 +96,12 @@ namespace ambience {
 
         void loadFanSound() {
             safeDelete(fan);
-            fan = oslLoadSoundFileWAV("romfs/ambience/office/fan.wav", OSL_FMT_STREAM);
+            fan = mixer::attach(stream::open("romfs/ambience/office/fan.wav"));
         }
         void playFanSound() {
             if (!fan) return;
-            oslSetSoundLoop(fan, 1);
-            if (oslGetSoundChannel(fan) == -1) {
-                oslPlaySound(fan, 2);
+            if (!mixer::playing(fan)) {
+                mixer::play(fan, mixer::kAmbience, kPriorityAmbience, true);
             }
         }
         void unloadFanSound() {
@@ -129,7 +119,7 @@ namespace call {
         if (nightIndex >= 0 && nightIndex < 5) {
             safeDelete(phoneCalls[nightIndex]);
             std::string filePath = "romfs/ambience/office/call/call" + toString(nightIndex + 1) + ".wav";
-            phoneCalls[nightIndex] = oslLoadSoundFileWAV(filePath.c_str(), OSL_FMT_STREAM);
+            phoneCalls[nightIndex] = mixer::attach(stream::open(filePath.c_str()));
             stopped = false;
         }
     }
@@ -137,8 +127,7 @@ namespace call {
     void playPhoneCalls() {
         int nightIndex = save::whichNight - 1;
         if (nightIndex >= 0 && nightIndex < 5 && phoneCalls[nightIndex]) {
-            oslPlaySound(phoneCalls[nightIndex], 1);
-            if (oslGetSoundChannel(phoneCalls[nightIndex]) == -1) {
+            if (!mixer::play(phoneCalls[nightIndex], mixer::kVoice, kPriorityCall)) {
                 unloadPhoneCalls(); // preserve original behavior
             }
         }
@@ -168,65 +157,95 @@ namespace sfx {
         OSL_SOUND* knock = nullptr;
         OSL_SOUND* camera[2] = {nullptr, nullptr};
 
+        static stream::Bank* bank = nullptr;
+
+        // Bank sounds are freed together with the bank, never one by one
+        static void release(OSL_SOUND*& s) {
+            if (!bank) {
+                safeDelete(s);
+                return;
+            }
+            mixer::forget(s);
+            s = nullptr;
+        }
+
         void loadSfx() {
             // Clear any previous handles first
-            safeDelete(buzz);
-            safeDelete(door);
-            safeDelete(scare);
-            safeDelete(switchCam);
-            safeDelete(laugh);
-            safeDelete(move);
-            safeDelete(walk);
-            // safeDelete(kitchen);
-            safeDelete(run);
-            safeDelete(knock);
-            safeDelete(camera[0]);
-            safeDelete(camera[1]);
-
-            // Keep your original format choices
-            buzz      = oslLoadSoundFileWAV("romfs/sfx/office/buzz.wav",    OSL_FMT_NONE);
-            door      = oslLoadSoundFileWAV("romfs/sfx/office/door.wav",    OSL_FMT_NONE);
-            scare     = oslLoadSoundFileWAV("romfs/sfx/office/scare.wav",   OSL_FMT_NONE);
-            switchCam = oslLoadSoundFileWAV("romfs/sfx/office/switch.wav",  OSL_FMT_NONE);
-            laugh     = oslLoadSoundFileWAV("romfs/sfx/office/laugh.wav",   OSL_FMT_STREAM);
-            move      = oslLoadSoundFileWAV("romfs/sfx/office/move.wav",    OSL_FMT_NONE);
-            walk      = oslLoadSoundFileWAV("romfs/sfx/office/walk.wav",    OSL_FMT_NONE);
-            // kitchen = oslLoadSoundFileWAV("romfs/sfx/office/kitchen.wav", OSL_FMT_STREAM);
-            run       = oslLoadSoundFileWAV("romfs/sfx/office/run.wav",     OSL_FMT_STREAM);
-            knock     = oslLoadSoundFileWAV("romfs/sfx/office/knock.wav",   OSL_FMT_STREAM);
-
-            camera[0] = oslLoadSoundFileWAV("romfs/sfx/office/openCam.wav", OSL_FMT_NONE);
-            camera[1] = oslLoadSoundFileWAV("romfs/sfx/office/closeCam.wav",OSL_FMT_NONE);
+            unloadSfx();
+
+            const unsigned int start = sceKernelGetSystemTimeLow();
+            const int allocations = stream::allocations;
+
+            // One read and one allocation for the whole set when the bank was built
+            bank = stream::loadBank("romfs/sfx/office/office.bank");
+            if (bank) {
+                buzz      = mixer::attach(stream::bankSound(bank, "buzz"));
+                door      = mixer::attach(stream::bankSound(bank, "door"));
+                scare     = mixer::attach(stream::bankSound(bank, "scare"));
+                switchCam = mixer::attach(stream::bankSound(bank, "switch"));
+                laugh     = mixer::attach(stream::bankSound(bank, "laugh"));
+                move      = mixer::attach(stream::bankSound(bank, "move"));
+                walk      = mixer::attach(stream::bankSound(bank, "walk"));
+                run       = mixer::attach(stream::bankSound(bank, "run"));
+                knock     = mixer::attach(stream::bankSound(bank, "knock"));
+                camera[0] = mixer::attach(stream::bankSound(bank, "openCam"));
+                camera[1] = mixer::attach(stream::bankSound(bank, "closeCam"));
+            } else {
+                // Resident, so the AI and camera threads can trigger them too
+                buzz      = mixer::attach(stream::load("romfs/sfx/office/buzz.wav"));
+                door      = mixer::attach(stream::load("romfs/sfx/office/door.wav"));
+                scare     = mixer::attach(stream::load("romfs/sfx/office/scare.wav"));
+                switchCam = mixer::attach(stream::load("romfs/sfx/office/switch.wav"));
+                laugh     = mixer::attach(stream::load("romfs/sfx/office/laugh.wav"));
+                move      = mixer::attach(stream::load("romfs/sfx/office/move.wav"));
+                walk      = mixer::attach(stream::load("romfs/sfx/office/walk.wav"));
+                // kitchen = oslLoadSoundFileWAV("romfs/sfx/office/kitchen.wav", OSL_FMT_STREAM);
+                run       = mixer::attach(stream::load("romfs/sfx/office/run.wav"));
+                knock     = mixer::attach(stream::load("romfs/sfx/office/knock.wav"));
+
+                camera[0] = mixer::attach(stream::load("romfs/sfx/office/openCam.wav"));
+                camera[1] = mixer::attach(stream::load("romfs/sfx/office/closeCam.wav"));
+            }
+            memory::reportAudioTiming(bank ? "office sfx bank" : "office sfx files",
+                                      sceKernelGetSystemTimeLow() - start, stream::allocations - allocations);
         }
 
         void stopSfx() {
-            if (buzz)      oslPauseSound(buzz, 1);
-            if (door)      oslPauseSound(door, 1);
-            if (scare)     oslPauseSound(scare, 1);
-            if (switchCam) oslPauseSound(switchCam, 1);
-            if (laugh)     oslPauseSound(laugh, 1);
-            if (move)      oslPauseSound(move, 1);
-            if (walk)      oslPauseSound(walk, 1);
-            // if (kitchen) oslPauseSound(kitchen, 1);
-            if (run)       oslPauseSound(run, 1);
-            if (knock)     oslPauseSound(knock, 1);
-            if (camera[0]) oslPauseSound(camera[0], 1);
-            if (camera[1]) oslPauseSound(camera[1], 1);
+            mixer::pause(buzz, true);
+            mixer::pause(door, true);
+            mixer::pause(scare, true);
+            mixer::pause(switchCam, true);
+            mixer::pause(laugh, true);
+            mixer::pause(move, true);
+            mixer::pause(walk, true);
+            // mixer::pause(kitchen, true);
+            mixer::pause(run, true);
+            mixer::pause(knock, true);
+            mixer::pause(camera[0], true);
+            mixer::pause(camera[1], true);
+        }
+
+        static void freeBankLater(void* b) {
+            stream::freeBank((stream::Bank*)b);
         }
 
         void unloadSfx() {
-            safeDelete(buzz);
-            safeDelete(door);
-            safeDelete(scare);
-            safeDelete(switchCam);
-            safeDelete(laugh);
-            safeDelete(move);
-            safeDelete(walk);
-            // safeDelete(kitchen);
-            safeDelete(run);
-            safeDelete(knock);
-            safeDelete(camera[0]);
-            safeDelete(camera[1]);
+            const unsigned int start = sceKernelGetSystemTimeLow();
+            release(buzz);
+            release(door);
+            release(scare);
+            release(switchCam);
+            release(laugh);
+            release(move);
+            release(walk);
+            // release(kitchen);
+            release(run);
+            release(knock);
+            release(camera[0]);
+            release(camera[1]);
+            mixer::defer(freeBankLater, bank);
+            bank = nullptr;
+            memory::reportAudioTiming("office sfx unload", sceKernelGetSystemTimeLow() - start, 0);
         }
 
         void playLightOn() {
@@ -234,68 +253,55 @@ namespace sfx {
 
         // CRITICAL: Add additional safety checks to prevent crashes
         // Check if sound object is still valid before operations
-        int ch = oslGetSoundChannel(buzz);
-        if (ch == -1) {
-            // Sound is not currently playing, safe to configure and play
-            oslSetSoundLoop(buzz, 1);
-            oslPlaySound(buzz, 3);
+        if (!mixer::playing(buzz)) {
+            mixer::play(buzz, mixer::kSfx, kPriorityLoop, true);
         } else {
             // Sound is already playing, just unpause if needed
-            oslPauseSound(buzz, 0); // unpause just this sound
+            mixer::pause(buzz, false);
         }
     }
     
  void playLightOff() {
         if (buzz) {
             // Pause just this buzz loop; do not stop/unload
-            oslPauseSound(buzz, 1);
+            mixer::pause(buzz, true);
         }
     }
 
         void playDoor()     { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (door && oslGetSoundChannel(door) == -1) oslPlaySound(door, 4); 
+            if (door && !mixer::playing(door)) mixer::play(door, mixer::kSfx, kPriorityThreat); 
         }
         void playCamOpen()  { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (camera[0] && oslGetSoundChannel(camera[0]) == -1) oslPlaySound(camera[0], 5); 
+            if (camera[0] && !mixer::playing(camera[0])) mixer::play(camera[0], mixer::kSfx, kPriorityUi); 
         }
         void playCamClose() { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (camera[1] && oslGetSoundChannel(camera[1]) == -1) oslPlaySound(camera[1], 5); 
+            if (camera[1] && !mixer::playing(camera[1])) mixer::play(camera[1], mixer::kSfx, kPriorityUi); 
         }
         void playSwitch()   { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (switchCam && oslGetSoundChannel(switchCam) == -1) oslPlaySound(switchCam, 5); 
+            if (switchCam && !mixer::playing(switchCam)) mixer::play(switchCam, mixer::kSfx, kPriorityUi); 
         }
         void playMove()     { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (move && oslGetSoundChannel(move) == -1) oslPlaySound(move, 5); 
+            if (move && !mixer::playing(move)) mixer::play(move, mixer::kSfx, kPriorityUi); 
         }
 
         void playLaugh()    { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (laugh && oslGetSoundChannel(laugh) == -1) oslPlaySound(laugh, 6); 
+            if (laugh && !mixer::playing(laugh)) mixer::play(laugh, mixer::kSfx, kPriorityCue); 
         }
         void playWalk()     { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (walk && oslGetSoundChannel(walk) == -1) oslPlaySound(walk, 7); 
+            if (walk && !mixer::playing(walk)) mixer::play(walk, mixer::kSfx, kPriorityLoop); 
         }
         void playKitchen()  {
             // if (kitchen) oslPlaySound(kitchen, 6);
         }
         void playScare()    { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (scare && oslGetSoundChannel(scare) == -1) oslPlaySound(scare, 7); 
+            if (scare && !mixer::playing(scare)) mixer::play(scare, mixer::kSfx, kPriorityThreat); 
         }
 
         void playRun()      { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (run && oslGetSoundChannel(run) == -1) oslPlaySound(run, 7); 
+            if (run && !mixer::playing(run)) mixer::play(run, mixer::kSfx, kPriorityThreat); 
         }
         void playKnock()    { 
-            // CRITICAL: Add thread safety to prevent race conditions
-            if (knock && oslGetSoundChannel(knock) == -1) oslPlaySound(knock, 7); 
+            if (knock && !mixer::playing(knock)) mixer::play(knock, mixer::kSfx, kPriorityThreat); 
         }
     }
 
@@ -305,7 +311,7 @@ namespace sfx {
 
         void loadSixAm() {
             safeDelete(chimes);
-            chimes = oslLoadSoundFileWAV("romfs/sfx/sixam/chimes.wav", OSL_FMT_STREAM);
+            chimes = mixer::attach(stream::open("romfs/sfx/sixam/chimes.wav"));
             // hooray = oslLoadSoundFileWAV("romfs/sfx/sixam/hooray.wav", OSL_FMT_STREAM);
         }
         void unloadSixAm() {
@@ -314,7 +320,7 @@ namespace sfx {
         }
 
         void playSixAm() {
-            if (chimes) oslPlaySound(chimes, 0);
+            if (chimes) mixer::play(chimes, mixer::kMusic, kPriorityMusic);
             // if (hooray) oslPlaySound(hooray, 0);
         }
     }
@@ -326,17 +332,15 @@ namespace sfx {
 
         void loadJumpscareSound() {
             safeDelete(jumpscare);
-            jumpscare = oslLoadSoundFileWAV("romfs/sfx/jumpscare/jumpscare.wav", OSL_FMT_STREAM);
+            jumpscare = mixer::attach(stream::open("romfs/sfx/jumpscare/jumpscare.wav"));
         }
         void playJumpscareSound() {
             // CRITICAL: Add thread safety to prevent race conditions during jumpscares
             if (!jumpscare) return;
             
             // Check if sound is already playing to prevent multiple simultaneous plays
-            if (oslGetSoundChannel(jumpscare) == -1) {
-                oslPlaySound(jumpscare, 0);
-                // Double-check after playing
-                if (oslGetSoundChannel(jumpscare) == -1) {
+            if (!mixer::playing(jumpscare)) {
+                if (!mixer::play(jumpscare, mixer::kSfx, kPriorityJumpscare)) {
                     unloadJumpscareSound();
                 }
             }
@@ -347,10 +351,10 @@ namespace sfx {
 
         void loadJumpscare2Sound() {
             safeDelete(jumpscare2);
-            jumpscare2 = oslLoadSoundFileWAV("romfs/sfx/jumpscare/jumpscare2.wav", OSL_FMT_STREAM);
+            jumpscare2 = mixer::attach(stream::open("romfs/sfx/jumpscare/jumpscare2.wav"));
         }
         void playJumpscare2Sound() {
-            if (jumpscare2) oslPlaySound(jumpscare2, 0);
+            if (jumpscare2) mixer::play(jumpscare2, mixer::kSfx, kPriorityJumpscare);
         }
         void unloadJumpscare2Sound() {
             safeDelete(jumpscare2);
@@ -358,17 +362,15 @@ namespace sfx {
 
         void loadDeadSound() {
             safeDelete(dead);
-            dead = oslLoadSoundFileWAV("romfs/sfx/jumpscare/dead.wav", OSL_FMT_STREAM);
+            dead = mixer::attach(stream::open("romfs/sfx/jumpscare/dead.wav"));
         }
         void playDeadSound() {
             // CRITICAL: Add thread safety to prevent race conditions during death sequence
             if (!dead) return;
             
             // Check if sound is already playing to prevent multiple simultaneous plays
-            if (oslGetSoundChannel(dead) == -1) {
-                oslPlaySound(dead, 0);
-                // Double-check after playing
-                if (oslGetSoundChannel(dead) == -1) {
+            if (!mixer::playing(dead)) {
+                if (!mixer::play(dead, mixer::kSfx, kPriorityJumpscare)) {
                     unloadDeadSound();
                 }
             }
@@ -394,102 +396,48 @@ namespace sfx {
                 return;
             }
             
-            // Pre-cache critical audio assets for zero-latency playback
+            // Everything here was loaded and attached to the mixer by its own
+            // load step; playing it starts a voice, nothing more. This only
+            // checks that the office effects, which the AI and camera threads
+            // trigger, are resident (load() or bank sounds) and so can start
+            // without touching the Memory Stick, and accounts the set.
+            struct Entry {
+                OSL_SOUND* sound;
+                size_t bytes;   // estimate, for the memory tracker
+                bool resident;  // must start without file I/O
+            };
+            const Entry entries[] = {
+                {sfx::office::move,            8288,   true},
+                {sfx::office::run,             12000,  true},
+                {sfx::office::knock,           5000,   true},
+                {sfx::office::door,            3000,   true},
+                {sfx::office::buzz,            8000,   true},
+                {sfx::office::laugh,           5000,   true},
+                {sfx::office::switchCam,       3000,   true},
+                {sfx::office::camera[0],       2000,   true},
+                {sfx::office::camera[1],       2000,   true},
+                {sfx::office::scare,           8000,   true},
+                {sfx::jumpscare::jumpscare,    15000,  false},
+                {sfx::jumpscare::dead,         10000,  false},
+                {ambience::office::ambience,   50000,  false},
+                {ambience::office::fan,        20000,  false},
+                {call::phoneCalls[0],          30000,  false},
+                {call::phoneCalls[1],          30000,  false},
+                {call::phoneCalls[2],          30000,  false},
+                {call::phoneCalls[3],          30000,  false},
+                {call::phoneCalls[4],          30000,  false},
+                {music::n_ending::endingSong,  100000, false},
+                {sfx::sixam::chimes,           15000,  false},
+            };
+
             size_t preCachedBytes = 0;
-            
-            // Pre-cache office sounds
-            if (sfx::office::move) {
-                oslGetSoundChannel(sfx::office::move); // Pre-warm audio system
-                preCachedBytes += 8288; // move.wav - AI movement
-            }
-            
-            if (sfx::office::run) {
-                oslGetSoundChannel(sfx::office::run); // Pre-warm audio system
-                preCachedBytes += 12000; // run.wav - Foxy attack
-            }
-            
-            if (sfx::office::knock) {
-                oslGetSoundChannel(sfx::office::knock); // Pre-warm audio system
-                preCachedBytes += 5000; // knock.wav - Door close
-            }
-            
-            if (sfx::office::door) {
-                oslGetSoundChannel(sfx::office::door); // Pre-warm audio system
-                preCachedBytes += 3000; // door.wav - Door open/close
-            }
-            
-            if (sfx::office::buzz) {
-                oslGetSoundChannel(sfx::office::buzz); // Pre-warm audio system
-                preCachedBytes += 8000; // buzz.wav - Power low
-            }
-            
-            // Pre-cache camera sounds (CRITICAL for camera functionality)
-            if (sfx::office::laugh) {
-                oslGetSoundChannel(sfx::office::laugh); // Pre-warm audio system
-                preCachedBytes += 5000; // laugh.wav - Animatronic laugh
-            }
-            
-            if (sfx::office::switchCam) {
-                oslGetSoundChannel(sfx::office::switchCam); // Pre-warm audio system
-                preCachedBytes += 3000; // switch.wav - Camera switch
-            }
-            
-            if (sfx::office::camera[0]) { // openCam
-                oslGetSoundChannel(sfx::office::camera[0]); // Pre-warm audio system
-                preCachedBytes += 2000; // openCam.wav - Camera open
-            }
-            
-            if (sfx::office::camera[1]) { // closeCam
-                oslGetSoundChannel(sfx::office::camera[1]); // Pre-warm audio system
-                preCachedBytes += 2000; // closeCam.wav - Camera close
-            }
-            
-            // Pre-cache office scare sound (replaces jumpscare2 for better memory usage)
-            if (sfx::office::scare) {
-                oslGetSoundChannel(sfx::office::scare); // Pre-warm audio system
-                preCachedBytes += 8000; // scare.wav - Office scare sound
-            }
-            
-            // Pre-cache jumpscare sounds
-            if (sfx::jumpscare::jumpscare) {
-                oslGetSoundChannel(sfx::jumpscare::jumpscare); // Pre-warm audio system
-                preCachedBytes += 15000; // jumpscare.wav
-            }
-            
-            if (sfx::jumpscare::dead) {
-                oslGetSoundChannel(sfx::jumpscare::dead); // Pre-warm audio system
-                preCachedBytes += 10000; // dead.wav
-            }
-            
-            // Pre-cache ambience
-            if (ambience::office::ambience) {
-                oslGetSoundChannel(ambience::office::ambience); // Pre-warm audio system
-                preCachedBytes += 50000; // ambience_mix.wav
-            }
-            
-            if (ambience::office::fan) {
-                oslGetSoundChannel(ambience::office::fan); // Pre-warm audio system
-                preCachedBytes += 20000; // fan.wav
-            }
-            
-            // Pre-cache phone calls
-            for (int i = 0; i < 5; ++i) {
-                if (call::phoneCalls[i]) {
-                    oslGetSoundChannel(call::phoneCalls[i]); // Pre-warm audio system
-                    preCachedBytes += 30000; // call1-5.wav
+            for (const Entry& e : entries) {
+                if (!e.sound) continue;
+                if (e.resident && !stream::resident(e.sound)) {
+                    DEBUG_PRINTF("audio precache: %s is not resident, its first play reads the file\n",
+                                 e.sound->filename);
                 }
-            }
-            
-            // Pre-cache ending music
-            if (music::n_ending::endingSong) {
-                oslGetSoundChannel(music::n_ending::endingSong); // Pre-warm audio system
-                preCachedBytes += 100000; // music.wav
-            }
-            
-            // Pre-cache Six AM chimes
-            if (sfx::sixam::chimes) {
-                oslGetSoundChannel(sfx::sixam::chimes); // Pre-warm audio system
-                preCachedBytes += 15000; // chimes.wav
+                preCachedBytes += e.bytes;
             }
             
             // Track memory usage and store for cleanup
@@ -0,0 +1,99 @@
+#include "included/boot.hpp"
+#include "included/image2.hpp"
+#include "included/audio.hpp"
+#include "included/state.hpp"
+#include "included/memory.hpp"
+
+namespace boot {
+
+    struct Step {
+        const char* name;
+        void (*load)();
+    };
+
+    static void loadOtherFrames() {
+        for (int frame = 1; frame < 4; ++frame) image::menu::loadMenuBackgroundFrame(frame);
+    }
+
+    // In the order the menu wants them; the first makes it usable
+    static const Step kSteps[] = {
+        {"menu text",      image::menu::loadTextAndCursor},
+        {"night numbers",  text::global::loadNormalNumbers},
+        {"star",           sprite::menu::loadStar},
+        {"copyright",      image::menu::loadCopyright},
+        {"menu frames",    loadOtherFrames},
+        {"static",         image::global::n_static::loadStatic},
+        {"office numbers", text::global::loadPixelNumbers},
+    };
+    static constexpr int kStepCount = sizeof(kSteps) / sizeof(kSteps[0]);
+
+    static volatile int stepsDone = kStepCount; // nothing staged until begin()
+    static bool musicAttached = true;
+    static bool reported = true;
+    static unsigned int origin = 0;
+    static unsigned int firstFrame = 0;
+    static unsigned int interactiveAt = 0;
+
+    static void runStep(int step) {
+        const unsigned int start = sceKernelGetSystemTimeLow();
+        kSteps[step].load();
+        memory::reportBootStep(kSteps[step].name, sceKernelGetSystemTimeLow() - start);
+        stepsDone = step + 1;
+    }
+
+    static int bootWorker(SceSize, void*) {
+        for (int step = stepsDone; step < kStepCount; ++step) runStep(step);
+        sceKernelExitDeleteThread(0);
+        return 0;
+    }
+
+    void begin(unsigned int originMicros) {
+        origin = originMicros;
+        stepsDone = 0;
+        musicAttached = false;
+        reported = false;
+
+        image::menu::loadMenuBackgroundFrame(0);
+        image::menu::loadLogo();
+        state::startLoaded(state::kMenu);
+
+        const int prio  = 0x30;    // below main (0x20): idle time only
+        const int stack = 0x4000;  // PNG decode
+        SceUID thread = sceKernelCreateThread("boot_loader", bootWorker, prio, stack, 0, NULL);
+        if (thread < 0 || sceKernelStartThread(thread, 0, NULL) < 0) {
+            // No thread: the old all-at-once boot
+            for (int step = 0; step < kStepCount; ++step) runStep(step);
+        }
+    }
+
+    void loadShared() {
+        text::global::loadNightText();
+        image::global::n_static::loadStatic();
+    }
+
+    bool interactive() { return stepsDone > 0; }
+
+    static void attachMusic() {
+        if (musicAttached) return;
+        musicAttached = true;
+        music::menu::loadMenuMusic();
+        if (state::current() == state::kMenu) music::menu::playMenuMusic();
+    }
+
+    void finish() {
+        while (stepsDone < kStepCount) sceKernelDelayThread(1000);
+        attachMusic();
+    }
+
+    void postFrame() {
+        if (reported) return;
+        const unsigned int now = sceKernelGetSystemTimeLow() - origin;
+        if (!firstFrame) firstFrame = now;
+        if (!interactive()) return;
+        if (!interactiveAt) interactiveAt = now;
+        attachMusic();
+        if (stepsDone < kStepCount) return;
+        memory::reportBootTimeline(firstFrame, interactiveAt, now);
+        reported = true;
+    }
+}
@@ -25,8 +25,6 @@ volatile int delay = 3; // volatile for thread safety
 volatile int reticleX = 353; // volatile for thread safety
 volatile int reticleY = 115; // volatile for thread safety
 
-std::string buttonState = "up"; // thread safety handled differently for strings
-
 // Note: Camera switching throttling removed - relying on existing kCamReloadBudget system
 // in image2.cpp plus double-check safety in render functions
 
@@ -49,12 +47,31 @@ void reset() {
     reticleX = 353;
     reticleY = 115;
 
-    buttonState = "up";
-    
     // Force camera reload after reset to ensure images are loaded
     animatronic::setReload();
 }
 
+void saveSnapshot(snapshot::Writer& out) {
+    out.u8(whichCamera);
+    out.flag(isUsing);
+    out.flag(opening);
+    out.flag(closing);
+    out.u8(whichFrame);
+    out.u8(waitFrames);
+    out.u8(delay);
+}
+
+void restoreSnapshot(snapshot::Reader& in) {
+    whichCamera = clamp(in.u8(), 0, kCamCount - 1);
+    isUsing = in.flag();
+    opening = in.flag();
+    closing = in.flag();
+    whichFrame = clamp(in.u8(), 0, kFlipFrameCount - 1);
+    waitFrames = in.u8();
+    delay = in.u8();
+    system::setReticle();
+}
+
 namespace render {
 
     void renderCamFlip() {
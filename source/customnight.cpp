@@ -1,4 +1,6 @@
 #include "included/customnight.hpp"
+#include <cstdlib>
+#include <cstring>
 
 namespace customnight{
 
@@ -9,6 +11,51 @@ namespace customnight{
     float crashDelay = 300;
     bool mustCrash = false;
 
+    // Survival estimates, from romfs/ai/difficulty.bin (tools/nightsim). The
+    // state loads the table with the custom night screen and frees it after;
+    // only the survival byte of each entry is kept (190 KB). -1 without it.
+    static constexpr int kTableLevels = animatronic::kMaxLevel + 1;
+    static constexpr int kTableEntries = kTableLevels * kTableLevels * kTableLevels * kTableLevels;
+    static constexpr int kTableHeaderBytes = 16;
+    static constexpr int kTableEntryBytes = 2; // survival percent, power left
+    static unsigned char* survival = nullptr;
+
+    void loadTable() {
+        unloadTable();
+        SceUID fd = sceIoOpen("romfs/ai/difficulty.bin", PSP_O_RDONLY, 0);
+        if (fd < 0) return;
+        const int fileBytes = kTableHeaderBytes + kTableEntries * kTableEntryBytes;
+        unsigned char* file = (unsigned char*)malloc(fileBytes);
+        const bool read = file && sceIoRead(fd, file, fileBytes) == fileBytes;
+        sceIoClose(fd);
+        if (!read || memcmp(file, "CNDT", 4) != 0 || file[4] != 1 || file[8] != kTableLevels) {
+            DEBUG_PRINTF("customnight: bad difficulty table, no estimates\n");
+            free(file);
+            return;
+        }
+
+        // Survival bytes to the front, then give the rest back
+        for (int i = 0; i < kTableEntries; ++i) {
+            file[i] = file[kTableHeaderBytes + i * kTableEntryBytes];
+        }
+        unsigned char* shrunk = (unsigned char*)realloc(file, kTableEntries);
+        survival = shrunk ? shrunk : file;
+    }
+
+    void unloadTable() {
+        free(survival);
+        survival = nullptr;
+    }
+
+    static int survivalEstimate() {
+        if (!survival) return -1;
+        int key = 0;
+        for (int id = 0; id < animatronic::kCount; ++id) {
+            key = key * kTableLevels + animatronic::table.level[id];
+        }
+        return survival[key] <= 100 ? survival[key] : -1;
+    }
+
     void reset(){
         reticlePosition = 0;
         actualReticlePosition = 60;
@@ -83,29 +130,32 @@ namespace customnight{
 
         void renderLevels() {
             if (!mustCrash) {
-                struct Animatronic {
-                    float totalLevel;
-                    int levelOnes;
-                    int levelTenths;
-                    int offsetX;
-                };
-
-                const Animatronic animatronics[] = {
-                    {animatronic::freddy::totalLevel, animatronic::freddy::levelOnes, animatronic::freddy::levelTenths, 88},
-                    {animatronic::bonnie::totalLevel, animatronic::bonnie::levelOnes, animatronic::bonnie::levelTenths, 188},
-                    {animatronic::chika::totalLevel, animatronic::chika::levelOnes, animatronic::chika::levelTenths, 288},
-                    {animatronic::foxy::totalLevel, animatronic::foxy::levelOnes, animatronic::foxy::levelTenths, 388},
-                };
-
-                for (const auto& ani : animatronics) {
-                    drawCheckedSprite(text::global::nightNumbersNormal[ani.levelOnes], 0, 0, 20, 20, ani.offsetX, 160, 0);
-                    if (ani.totalLevel > 9) {
-                        drawCheckedSprite(text::global::nightNumbersNormal[ani.levelTenths], 0, 0, 20, 20, ani.offsetX - 15, 160, 0);
+                static const int offsetX[animatronic::kCount] = {88, 188, 288, 388};
+
+                for (int id = 0; id < animatronic::kCount; ++id) {
+                    const int level = animatronic::table.level[id];
+                    drawCheckedSprite(text::global::nightNumbersNormal[level % 10], 0, 0, 20, 20, offsetX[id], 160, 0);
+                    if (level > 9) {
+                        drawCheckedSprite(text::global::nightNumbersNormal[level / 10], 0, 0, 20, 20, offsetX[id] - 15, 160, 0);
                     }
                 }
             }
         }
 
+        void renderEstimate() {
+            if (!mustCrash) {
+                const int percent = survivalEstimate();
+                if (percent < 0) return;
+
+                const int digits = percent >= 100 ? 3 : (percent >= 10 ? 2 : 1);
+                int x = 240 - (digits + 1) * 15 / 2;
+                for (int divisor = digits == 3 ? 100 : (digits == 2 ? 10 : 1); divisor > 0; divisor /= 10, x += 15) {
+                    drawCheckedSprite(text::global::nightNumbersPixel[percent / divisor % 10], 0, 0, 20, 20, x, 188, 0);
+                }
+                drawCheckedSprite(text::global::symbols, 0, 0, 20, 20, x, 188, 0);
+            }
+        }
+
         void renderActions() {
             if (!mustCrash) {
                 drawCheckedSprite(sprite::UI::customnight::create, 0, 0, 78, 18, 380, 242, 0);
@@ -130,121 +180,29 @@ namespace customnight{
     
 
     namespace edit {
-        // Define a map for plus and minus operations.
-        std::unordered_map<std::string, std::function<void()>> operations = {
-            {"freddy", []() {
-                if (animatronic::freddy::totalLevel < 20) {
-                    animatronic::freddy::totalLevel += 1;
-                    animatronic::freddy::levelOnes += 1;
-                }
-            }},
-            {"bonnie", []() {
-                if (animatronic::bonnie::totalLevel < 20) {
-                    animatronic::bonnie::totalLevel += 1;
-                    animatronic::bonnie::levelOnes += 1;
-                }
-            }},
-            {"chika", []() {
-                if (animatronic::chika::totalLevel < 20) {
-                    animatronic::chika::totalLevel += 1;
-                    animatronic::chika::levelOnes += 1;
-                }
-            }},
-            {"foxy", []() {
-                if (animatronic::foxy::totalLevel < 20) {
-                    animatronic::foxy::totalLevel += 1;
-                    animatronic::foxy::levelOnes += 1;
-                }
-            }}
-        };
-
-        std::unordered_map<std::string, std::function<void()>> decrementOperations = {
-            {"freddy", []() {
-                if (animatronic::freddy::totalLevel > 0) {
-                    animatronic::freddy::totalLevel -= 1;
-                    animatronic::freddy::levelOnes -= 1;
-                }
-            }},
-            {"bonnie", []() {
-                if (animatronic::bonnie::totalLevel > 0) {
-                    animatronic::bonnie::totalLevel -= 1;
-                    animatronic::bonnie::levelOnes -= 1;
-                }
-            }},
-            {"chika", []() {
-                if (animatronic::chika::totalLevel > 0) {
-                    animatronic::chika::totalLevel -= 1;
-                    animatronic::chika::levelOnes -= 1;
-                }
-            }},
-            {"foxy", []() {
-                if (animatronic::foxy::totalLevel > 0) {
-                    animatronic::foxy::totalLevel -= 1;
-                    animatronic::foxy::levelOnes -= 1;
-                }
-            }}
-        };
-
-        std::unordered_map<std::string, std::function<void()>> valueAdjustments = {
-            {"freddy", []() {
-                if (animatronic::freddy::levelOnes == 10) {
-                    animatronic::freddy::levelOnes = 0;
-                    animatronic::freddy::levelTenths += 1;
-                } else if (animatronic::freddy::levelOnes < 0 && animatronic::freddy::levelTenths > 0) {
-                    animatronic::freddy::levelOnes = 9;
-                    animatronic::freddy::levelTenths -= 1;
-                }
-            }},
-            {"bonnie", []() {
-                if (animatronic::bonnie::levelOnes == 10) {
-                    animatronic::bonnie::levelOnes = 0;
-                    animatronic::bonnie::levelTenths += 1;
-                } else if (animatronic::bonnie::levelOnes < 0 && animatronic::bonnie::levelTenths > 0) {
-                    animatronic::bonnie::levelOnes = 9;
-                    animatronic::bonnie::levelTenths -= 1;
-                }
-            }},
-            {"chika", []() {
-                if (animatronic::chika::levelOnes == 10) {
-                    animatronic::chika::levelOnes = 0;
-                    animatronic::chika::levelTenths += 1;
-                } else if (animatronic::chika::levelOnes < 0 && animatronic::chika::levelTenths > 0) {
-                    animatronic::chika::levelOnes = 9;
-                    animatronic::chika::levelTenths -= 1;
-                }
-            }},
-            {"foxy", []() {
-                if (animatronic::foxy::levelOnes == 10) {
-                    animatronic::foxy::levelOnes = 0;
-                    animatronic::foxy::levelTenths += 1;
-                } else if (animatronic::foxy::levelOnes < 0 && animatronic::foxy::levelTenths > 0) {
-                    animatronic::foxy::levelOnes = 9;
-                    animatronic::foxy::levelTenths -= 1;
-                }
-            }}
-        };
+        // The animatronic under the reticle
+        static int editingId() {
+            if (editing == "bonnie") return animatronic::kBonnie;
+            if (editing == "chika") return animatronic::kChica;
+            if (editing == "foxy") return animatronic::kFoxy;
+            return animatronic::kFreddy;
+        }
 
         void plus() {
             if (mustCrash == false) {
-                if (operations.find(editing) != operations.end()) {
-                    operations[editing]();
+                const int id = editingId();
+                if (animatronic::table.level[id] < animatronic::kMaxLevel) {
+                    animatronic::table.level[id] += 1;
                 }
-                editValue();
             }
         }
 
         void minus() {
             if (mustCrash == false) {
-                if (decrementOperations.find(editing) != decrementOperations.end()) {
-                    decrementOperations[editing]();
+                const int id = editingId();
+                if (animatronic::table.level[id] > 0) {
+                    animatronic::table.level[id] -= 1;
                 }
-                editValue();
-            }
-        }
-
-        void editValue() {
-            if (valueAdjustments.find(editing) != valueAdjustments.end()) {
-                valueAdjustments[editing]();
             }
         }
     }
@@ -292,31 +250,18 @@ namespace actions {
 
     void returnToMenuFromCrash() {
         mustCrash = false;
-        sprite::UI::customnight::unloadGoldenFreddy();
-
-        state::isCustomNight = false;
-
-        image::menu::loadMenuBackground();
-        image::menu::loadLogo();
-        image::menu::loadCopyright();
-        image::menu::loadTextAndCursor();
-        sprite::menu::loadStar();
+        sfx::jumpscare::unloadJumpscare2Sound();
 
-        menu::menuCursor::moveCursor();
-
-        music::menu::loadMenuMusic();
-        music::menu::playMenuMusic();
-
-        state::isMenu = true;
+        state::request(state::kMenu);
 
         crashDelay = 300;
     }
 
     void create(){
-        if (animatronic::freddy::totalLevel == 1 && animatronic::bonnie::totalLevel == 9 && animatronic::chika::totalLevel == 8 && animatronic::foxy::totalLevel == 7){
+        if (animatronic::table.level[animatronic::kFreddy] == 1 && animatronic::table.level[animatronic::kBonnie] == 9 &&
+            animatronic::table.level[animatronic::kChica] == 8 && animatronic::table.level[animatronic::kFoxy] == 7){
             if (mustCrash == false){
-                state::isCustomNight = false;
-
+                // The crash stays in this state: only Golden Freddy is left on screen
                 sfx::jumpscare::loadJumpscare2Sound();
 
                 sprite::UI::customnight::unloadIcons();
@@ -330,27 +275,12 @@ namespace actions {
 
                 sfx::jumpscare::playJumpscare2Sound();
 
-                state::isCustomNight = true;
-
                 mustCrash = true;
             }
         }
         else{
             save::whichNight = 7;
-            state::isCustomNight = false;
-
-            sprite::UI::customnight::unloadIcons();
-            sprite::UI::customnight::unloadReticle();
-            sprite::UI::customnight::unloadInstructions();
-            sprite::UI::customnight::unloadTitle();
-            sprite::UI::customnight::unloadArrows();
-            sprite::UI::customnight::unloadText();
-            sprite::UI::customnight::unloadNames();
-            sprite::UI::customnight::unloadActions();
-            sprite::UI::customnight::unloadGoldenFreddy();
-
-            sprite::nightinfo::loadNightInfoSprite();
-            state::isNightinfo = true;
+            state::request(state::kNightinfo);
         }
     }
 
@@ -359,30 +289,7 @@ namespace actions {
             if (save::whichNight > 5){
                 save::readData();
             }
-            state::isCustomNight = false;
-
-            sprite::UI::customnight::unloadIcons();
-            sprite::UI::customnight::unloadReticle();
-            sprite::UI::customnight::unloadInstructions();
-            sprite::UI::customnight::unloadTitle();
-            sprite::UI::customnight::unloadArrows();
-            sprite::UI::customnight::unloadText();
-            sprite::UI::customnight::unloadNames();
-            sprite::UI::customnight::unloadActions();
-            sprite::UI::customnight::unloadGoldenFreddy();
-
-            image::menu::loadMenuBackground();
-            image::menu::loadLogo();
-            image::menu::loadCopyright();
-            image::menu::loadTextAndCursor();
-            sprite::menu::loadStar();
-
-            menu::menuCursor::moveCursor();
-
-            music::menu::loadMenuMusic();
-            music::menu::playMenuMusic();
-
-            state::isMenu = true;
+            state::request(state::kMenu);
         }
     }
  }
@@ -0,0 +1,260 @@
+#include "included/graph.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace graph {
+
+    static constexpr int kHeaderBytes = 20;
+    static constexpr int kCharacterBytes = 20 + kMaxNodes * 4;
+    static constexpr int kRuleBytes = 16;
+    static constexpr int kMaxFileBytes = kHeaderBytes + kCharacters * kCharacterBytes + kMaxRules * kRuleBytes + kMaxStringBytes;
+
+    static const char* const kNames[kCharacters] = {"freddy", "bonnie", "chica", "foxy"};
+
+    // ==============================
+    // Built-in graph, for when map.bin is missing or bad. It must stay the
+    // same as romfs/ai/map.txt: tests/graph compiles that and compares them.
+    // ==============================
+    struct BuiltinNode {
+        signed char position;
+        Node node;
+    };
+
+    struct BuiltinCharacter {
+        unsigned short period;
+        signed char door, blockedTo;
+        unsigned char side, flags;
+        unsigned char nodeCount;
+        BuiltinNode nodes[10];
+    };
+
+    static const BuiltinCharacter kBuiltinCharacters[kCharacters] = {
+        // Freddy: creeps up only while the cameras are down, gets in only while they are up
+        {650, 6, 6, kRightDoor, kLaughs | kNeedsCams, 7, {
+            {0, {1, 0, -1, 0}}, {1, {2, 0, -1, 0}}, {2, {3, 0, -1, 0}}, {3, {4, 0, -1, 0}},
+            {4, {5, 0, -1, 0}}, {5, {6, 0, -1, 0}}, {6, {6, kDoor | kPushed, -1, 0}},
+        }},
+        // Bonnie: a 2 from rooms 2 or 3 sends him to room 7, the next move brings him back
+        {389, 6, 1, kLeftDoor, 0, 8, {
+            {0, {1, kWatched, -1, 0}}, {1, {2, kWatched, -1, 0}}, {2, {3, kWatched, 2, 7}}, {3, {4, kWatched, 2, 7}},
+            {4, {5, kWatched, -1, 0}}, {5, {6, kWatched, -1, 0}}, {6, {6, kDoor | kPushed, -1, 0}},
+            {7, {2, kSide | kReturn, -1, 0}},
+        }},
+        // Chica: a 3 from room 1 goes to room 7, a 6 from room 2 to room 9
+        {432, 6, 1, kRightDoor, kForgetsRoom, 10, {
+            {0, {1, kWatched, -1, 0}}, {1, {2, kWatched, 3, 7}}, {2, {3, kWatched, 6, 9}}, {3, {4, kWatched, -1, 0}},
+            {4, {5, kWatched, -1, 0}}, {5, {6, kWatched, -1, 0}}, {6, {6, kDoor | kPushed, -1, 0}},
+            {7, {8, kSide | kWatched, -1, 0}}, {8, {1, kSide | kReturn, -1, 0}}, {9, {1, kSide | kReturn, -1, 0}},
+        }},
+        // Foxy: leaves the cove only while the cameras are down, except for the last step
+        {460, 4, 0, kLeftDoor, kRuns, 5, {
+            {0, {1, 0, -1, 0}}, {1, {2, 0, -1, 0}}, {2, {3, 0, -1, 0}},
+            {3, {4, kWatched | kPushed, -1, 0}}, {4, {4, kDoor | kPushed, -1, 0}},
+        }},
+    };
+
+    static const Rule kBuiltinRules[] = {
+        // Cam 1A: the stage
+        {"animatronic/cam1a/cam1a-empty", 1, {{kVarFreddy, kGt, 0}}},
+        {"main/cam1a", 3, {{kVarFreddy, kEq, 0}, {kVarBonnie, kEq, 0}, {kVarChica, kEq, 0}}},
+        {"animatronic/cam1a/cam1a-freddy&chica", 3, {{kVarFreddy, kEq, 0}, {kVarBonnie, kGt, 0}, {kVarChica, kEq, 0}}},
+        {"animatronic/cam1a/cam1a-freddy&bonnie", 3, {{kVarFreddy, kEq, 0}, {kVarBonnie, kEq, 0}, {kVarChica, kGt, 0}}},
+        {"animatronic/cam1a/cam1a-freddy", 4, {{kVarFreddy, kEq, 0}, {kVarBonnie, kGt, 0}, {kVarChica, kGt, 0}, {kVarNight, kLt, 4}}},
+        {"animatronic/cam1a/cam1a-freddyStare", 3, {{kVarFreddy, kEq, 0}, {kVarBonnie, kGt, 0}, {kVarChica, kGt, 0}}},
+        {"animatronic/cam1a/cam1a-empty", 0, {}},
+        // Cam 1B: dining area
+        {"animatronic/cam1b/cam1b-bonnie", 3, {{kVarBonnie, kEq, 1}, {kVarChica, kNe, 1}, {kVarFreddy, kNe, 1}}},
+        {"animatronic/cam1b/cam1b-chica", 3, {{kVarBonnie, kNe, 1}, {kVarChica, kEq, 1}, {kVarFreddy, kNe, 1}}},
+        {"animatronic/cam1b/cam1b-freddy", 1, {{kVarFreddy, kEq, 1}}},
+        {"main/cam1b", 0, {}},
+        // Cam 1C: pirate cove
+        {"main/cam1c", 1, {{kVarFoxy, kEq, 0}}},
+        {"animatronic/cam1c/cam1c-foxy1", 1, {{kVarFoxy, kEq, 1}}},
+        {"animatronic/cam1c/cam1c-foxy2", 1, {{kVarFoxy, kEq, 2}}},
+        {"animatronic/cam1c/cam1c-foxy3", 0, {}},
+        // Cam 2A: west hall
+        {"animatronic/cam2a/cam2a-bonnie", 1, {{kVarBonnie, kEq, 3}}},
+        {"main/cam2a", 0, {}},
+        // Cam 2B: west hall corner
+        {"animatronic/cam2b/cam2b-bonnie", 1, {{kVarBonnie, kEq, 5}}},
+        {"main/cam2b", 0, {}},
+        // Cam 3: supply closet
+        {"animatronic/cam3/cam3-bonnie", 1, {{kVarBonnie, kEq, 4}}},
+        {"main/cam3", 0, {}},
+        // Cam 4A: east hall
+        {"animatronic/cam4a/cam4a-chica", 2, {{kVarChica, kEq, 3}, {kVarFreddy, kNe, 3}}},
+        {"animatronic/cam4a/cam4a-chicaclose", 2, {{kVarChica, kEq, 4}, {kVarFreddy, kNe, 3}}},
+        {"animatronic/cam4a/cam4a-freddy", 1, {{kVarFreddy, kEq, 3}}},
+        {"main/cam4a", 0, {}},
+        // Cam 4B: east hall corner
+        {"animatronic/cam4b/cam4b-chica", 2, {{kVarChica, kEq, 5}, {kVarFreddy, kNe, 4}}},
+        {"animatronic/cam4b/cam4b-freddy", 1, {{kVarFreddy, kEq, 4}}},
+        {"main/cam4b", 0, {}},
+        // Cam 5: backstage
+        {"animatronic/cam5/cam5-bonnieclose", 2, {{kVarBonnie, kEq, 7}, {kVarNight, kGt, 4}}},
+        {"animatronic/cam5/cam5-bonnie", 1, {{kVarBonnie, kEq, 7}}},
+        {"main/cam5", 0, {}},
+        // Cam 6: kitchen, audio only
+        {"main/cam6", 0, {}},
+        // Cam 7: restrooms
+        {"animatronic/cam7/cam7-chica", 2, {{kVarChica, kEq, 7}, {kVarFreddy, kNe, 2}}},
+        {"animatronic/cam7/cam7-chicaclose", 2, {{kVarChica, kEq, 8}, {kVarFreddy, kNe, 2}}},
+        {"animatronic/cam7/cam7-freddy", 1, {{kVarFreddy, kEq, 2}}},
+        {"main/cam7", 0, {}},
+    };
+    static const unsigned char kBuiltinRuleCount[kCameras] = {7, 4, 4, 2, 2, 2, 4, 3, 3, 1, 4};
+
+    // ==============================
+    // Active graph
+    // ==============================
+    static Character builtinCharacters[kCharacters];
+    static Character fileCharacters[kCharacters];
+    static Rule fileRules[kMaxRules];
+    static char fileStrings[kMaxStringBytes];
+
+    static const Rule* rules = nullptr;
+    static int ruleStart[kCameras + 1];
+    static bool fromFile = false;
+
+    // Positions a character does not list behave as its door
+    static void fillUnlisted(Character& character) {
+        for (int i = 0; i < kMaxNodes; ++i) {
+            character.nodes[i] = {character.door, kDoor, -1, 0};
+        }
+    }
+
+    static const Character* useBuiltin() {
+        for (int id = 0; id < kCharacters; ++id) {
+            const BuiltinCharacter& from = kBuiltinCharacters[id];
+            Character& to = builtinCharacters[id];
+            strncpy(to.name, kNames[id], sizeof(to.name) - 1);
+            to.period = from.period;
+            to.door = from.door;
+            to.blockedTo = from.blockedTo;
+            to.side = from.side;
+            to.flags = from.flags;
+            fillUnlisted(to);
+            for (int n = 0; n < from.nodeCount; ++n) {
+                to.nodes[from.nodes[n].position] = from.nodes[n].node;
+            }
+        }
+        rules = kBuiltinRules;
+        ruleStart[0] = 0;
+        for (int camera = 0; camera < kCameras; ++camera) {
+            ruleStart[camera + 1] = ruleStart[camera] + kBuiltinRuleCount[camera];
+        }
+        return builtinCharacters;
+    }
+
+    const Character* characters = useBuiltin();
+
+    static unsigned int le16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+    static unsigned int le32(const unsigned char* p) { return le16(p) | (le16(p + 2) << 16); }
+
+    static bool validPosition(int position) { return position >= 0 && position < kMaxNodes; }
+
+    static bool parse(const unsigned char* file, int fileBytes) {
+        if (fileBytes < kHeaderBytes || memcmp(file, "AIGR", 4) != 0 || le32(file + 4) != 1) return false;
+        const int characterCount = (int)le32(file + 8);
+        const int ruleCount = (int)le32(file + 12);
+        const int stringBytes = (int)le32(file + 16);
+        if (characterCount != kCharacters || ruleCount <= 0 || ruleCount > kMaxRules
+            || stringBytes <= 0 || stringBytes > kMaxStringBytes
+            || fileBytes != kHeaderBytes + characterCount * kCharacterBytes + ruleCount * kRuleBytes + stringBytes) {
+            return false;
+        }
+        const unsigned char* at = file + kHeaderBytes;
+
+        // Characters may come in any order; each name must be one of ours, once
+        bool seen[kCharacters] = {false, false, false, false};
+        for (int i = 0; i < characterCount; ++i, at += kCharacterBytes) {
+            int id = 0;
+            while (id < kCharacters && strncmp((const char*)at, kNames[id], 12) != 0) ++id;
+            if (id == kCharacters || seen[id]) return false;
+            seen[id] = true;
+
+            Character& c = fileCharacters[id];
+            memcpy(c.name, at, sizeof(c.name));
+            c.name[sizeof(c.name) - 1] = 0;
+            c.period = (unsigned short)le16(at + 12);
+            c.door = (signed char)at[14];
+            c.blockedTo = (signed char)at[15];
+            c.side = at[16];
+            c.flags = at[17];
+            if (c.period == 0 || !validPosition(c.door) || !validPosition(c.blockedTo) || c.side > kRightDoor) return false;
+            for (int n = 0; n < kMaxNodes; ++n) {
+                const unsigned char* node = at + 20 + n * 4;
+                c.nodes[n] = {(signed char)node[0], node[1], (signed char)node[2], (signed char)node[3]};
+                if (!validPosition(c.nodes[n].next) || (c.nodes[n].detourRoll >= 0 && !validPosition(c.nodes[n].detourTo))) {
+                    return false;
+                }
+            }
+        }
+
+        const char* strings = (const char*)file + kHeaderBytes + characterCount * kCharacterBytes + ruleCount * kRuleBytes;
+        if (strings[stringBytes - 1] != 0) return false;
+        memcpy(fileStrings, strings, stringBytes);
+
+        // Rules come grouped by camera, in camera order
+        int camera = 0;
+        ruleStart[0] = 0;
+        for (int r = 0; r < ruleCount; ++r, at += kRuleBytes) {
+            if (at[0] < camera || at[0] >= kCameras || at[1] > kMaxClauses || (int)le16(at + 2) >= stringBytes) return false;
+            while (camera < at[0]) ruleStart[++camera] = r;
+            Rule& rule = fileRules[r];
+            rule.image = fileStrings + le16(at + 2);
+            rule.clauses = at[1];
+            for (int k = 0; k < kMaxClauses; ++k) {
+                rule.clause[k] = {at[4 + k * 3], at[5 + k * 3], (signed char)at[6 + k * 3]};
+                if (k < rule.clauses && (rule.clause[k].var >= kVarCount || rule.clause[k].op > kGt)) return false;
+            }
+        }
+        while (camera < kCameras) ruleStart[++camera] = ruleCount;
+        return true;
+    }
+
+    bool load(const char* path) {
+        SceUID fd = sceIoOpen(path, PSP_O_RDONLY, 0);
+        if (fd < 0) return false;
+        const int fileBytes = sceIoLseek32(fd, 0, PSP_SEEK_END);
+        sceIoLseek32(fd, 0, PSP_SEEK_SET);
+        unsigned char* file = fileBytes > 0 && fileBytes <= kMaxFileBytes ? (unsigned char*)malloc(fileBytes) : nullptr;
+        const bool read = file && sceIoRead(fd, file, fileBytes) == fileBytes;
+        sceIoClose(fd);
+
+        const bool ok = read && parse(file, fileBytes);
+        free(file);
+        if (!ok) {
+            DEBUG_PRINTF("graph: bad map %s, keeping the built-in one\n", path);
+            characters = useBuiltin();
+            fromFile = false;
+            return false;
+        }
+        characters = fileCharacters;
+        rules = fileRules;
+        fromFile = true;
+        return true;
+    }
+
+    bool loadedFromFile() { return fromFile; }
+
+    const char* cameraImage(int camera, const int* vars) {
+        if (camera < 0 || camera >= kCameras) return nullptr;
+        for (int r = ruleStart[camera]; r < ruleStart[camera + 1]; ++r) {
+            const Rule& rule = rules[r];
+            bool match = true;
+            for (int k = 0; k < rule.clauses && match; ++k) {
+                const Clause& clause = rule.clause[k];
+                const int value = vars[clause.var];
+                switch (clause.op) {
+                    case kEq: match = value == clause.value; break;
+                    case kNe: match = value != clause.value; break;
+                    case kLt: match = value < clause.value; break;
+                    default:  match = value > clause.value; break;
+                }
+            }
+            if (match) return rule.image;
+        }
+        return nullptr;
+    }
+}
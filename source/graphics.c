@@ -13,8 +13,10 @@ void drawSpriteAlpha(int sx, int sy, int width, int height, Image* source, int d
     }
     
     sceGuTexFunc(GU_TFX_REPLACE,GU_TCC_RGBA);
-    sceGuTexMode(source->format, 0, 0, source->isSwizzled);
-    sceGuTexImage(0, source->textureWidth, source->textureHeight, source->textureWidth, source->data);
+    // DXT blocks have their own layout; the swizzle bit must stay off for them
+    int swizzled = source->format >= GU_PSM_DXT1 ? 0 : source->isSwizzled;
+    sceGuTexMode(source->format, 0, 0, swizzled);
+    sceGuTexImage(0, source->textureWidth, source->textureHeight, source->textureWidth, vramTouch(source));
     sceGuTexFilter(GU_NEAREST, GU_NEAREST);
 
     // Safety check for division by zero
@@ -8,19 +8,30 @@
 
 #ifdef _PSP
 #include<pspgu.h>
+#include<pspiofilemgr.h>
+#include<pspkernel.h>
 #else
+#include <pthread.h>
+#include <unistd.h>
 #define GU_PSM_5650 (0)
+#define GU_PSM_5551 (1)
+#define GU_PSM_4444 (2)
 #define GU_PSM_8888 (3)
 #define GU_PSM_T4 (4)
 #define GU_PSM_T8 (5)
+#define GU_PSM_DXT1 (8)
+#define GU_PSM_DXT3 (9)
+#define GU_PSM_DXT5 (10)
 #endif
 
 #define png_infopp_NULL (png_infopp)NULL
 #define int_p_NULL (int*)NULL
 #define png_bytep_NULL (png_bytep)NULL
+#define png_bytepp_NULL (png_bytepp)NULL
 
 #include "included/image.h"
 #include "included/graphics.h"
+#include "included/vram.h"
 //#define Color unsigned long
 
 // Debug logging control for C files
@@ -32,8 +43,135 @@
 #endif
 
 #define MAX(X, Y) ((X) > (Y) ? (X) : (Y))
+#define MIN(X, Y) ((X) < (Y) ? (X) : (Y))
+// Load counters. loadPng also runs on the boot loader and the jumpscare
+// reserve threads, and host batches (see loadPngBatch) use several, so a
+// plain += could lose another thread's update; the PSP masks interrupts
+// around it, as the mixer does for its queue
+#ifdef _PSP
+static void addBytes(int *counter,int bytes)
+{
+	int intr=sceKernelCpuSuspendIntr();
+	*counter+=bytes;
+	sceKernelCpuResumeIntr(intr);
+}
+#define ADD_BYTES(counter,bytes) addBytes(&(counter),(bytes))
+#else
+#define ADD_BYTES(counter,bytes) __sync_fetch_and_add(&(counter),(bytes))
+#endif
 int imageRamAlloc=0;
-void freeVRam(void *address,int length);
+int imageBytesSaved=0;
+int imageBytesDecoded=0;
+int textureAutoFormat=1;
+int textureDither=1;
+int textureCompressed=1;
+
+int imageDataBytes(Image *image)
+{
+	int blockRows=(image->imageHeight+3)&~3;
+	switch(image->format) {
+	case GU_PSM_8888: return image->imageHeight*image->textureWidth*4;
+	case GU_PSM_DXT1: return blockRows*image->textureWidth/2;
+	case GU_PSM_DXT3:
+	case GU_PSM_DXT5: return blockRows*image->textureWidth;
+	default: return image->imageHeight*image->textureWidth*2;
+	}
+}
+
+// What the same image would take as 8888, for the savings counter
+static int imageSavedBytes(Image *image)
+{
+	return image->imageHeight*image->textureWidth*4-imageDataBytes(image);
+}
+
+static unsigned int readLe16(const unsigned char *p)
+{
+	return p[0]|(p[1]<<8);
+}
+
+static unsigned int readLe32(const unsigned char *p)
+{
+	return readLe16(p)|(readLe16(p+2)<<16);
+}
+
+int swizzleOnLoad=0;
+
+// The GE swizzle works on 16-byte x 8-line blocks
+static int canSwizzle(Image *image)
+{
+	int rowBytes=image->textureWidth*(image->format==GU_PSM_8888 ? 4 : 2);
+	return (image->imageHeight&7)==0 && (rowBytes&15)==0;
+}
+
+// Swizzle one 8-line band of linear texels into its block row
+static void swizzleBand(const unsigned char *src, unsigned char *dst, int rowBytes)
+{
+	unsigned int *out=(unsigned int *)dst;
+	int blockx,i;
+	for (blockx = 0; blockx < rowBytes/16; ++blockx) {
+		const unsigned int *in=(const unsigned int *)(src+blockx*16);
+		for (i=0;i<8;i++) {
+			*(out++) = in[0];
+			*(out++) = in[1];
+			*(out++) = in[2];
+			*(out++) = in[3];
+			in += rowBytes/4;
+		}
+	}
+}
+
+/* Precompressed textures written by tools/dxtenc: "PDXT", four 16-bit sizes
+   (image w/h, texture w/h), 32-bit format and byte count, then the blocks
+   already in the layout the GE samples. */
+Image *loadDxt(const char *filename)
+{
+	char path[256];
+	unsigned char header[20];
+	strcpy(path,filename);
+	char *ext=strrchr(path,'.');
+	if(!ext) return NULL;
+	strcpy(ext,".dxt");
+
+	FILE *fp=fopen(path,"rb");
+	if(!fp) return NULL;
+	if(fread(header,1,20,fp)!=20 || memcmp(header,"PDXT",4)!=0) {
+		fclose(fp);
+		DEBUG_PRINTF("Bad dxt header %s\n",path);
+		return NULL;
+	}
+	Image *image=(Image *)calloc(sizeof(Image),1);
+	if(!image) {
+		fclose(fp);
+		return NULL;
+	}
+	strcpy(image->filename,filename);
+	image->imageWidth=readLe16(header+4);
+	image->imageHeight=readLe16(header+6);
+	image->textureWidth=readLe16(header+8);
+	image->textureHeight=readLe16(header+10);
+	image->format=readLe32(header+12);
+	int length=readLe32(header+16);
+	if((image->format!=GU_PSM_DXT1 && image->format!=GU_PSM_DXT3 && image->format!=GU_PSM_DXT5)
+		|| length!=imageDataBytes(image) || image->textureWidth>512 || image->textureHeight>512) {
+		fclose(fp);
+		free(image);
+		DEBUG_PRINTF("Bad dxt header %s\n",path);
+		return NULL;
+	}
+	image->data=(Color *)memalign(16,length);
+	if(!image->data || fread(image->data,1,length,fp)!=(size_t)length) {
+		fclose(fp);
+		free(image->data);
+		free(image);
+		DEBUG_PRINTF("Couldn't load %s\n",path);
+		return NULL;
+	}
+	fclose(fp);
+	ADD_BYTES(imageRamAlloc,length);
+	ADD_BYTES(imageBytesDecoded,length);
+	ADD_BYTES(imageBytesSaved,imageSavedBytes(image));
+	return image;
+}
 
 static int getNextPower2(int width)
 {
@@ -63,26 +201,45 @@ Image *newImage(int width,int height)
 	while((image->textureHeight>>1)>=height) image->textureHeight>>=1;
 
 	image->data=(Color *)malloc(image->imageHeight*image->textureWidth*4);
-	imageRamAlloc+=image->imageHeight*image->textureWidth*4;
+	ADD_BYTES(imageRamAlloc,image->imageHeight*image->textureWidth*4);
 //DEBUG_PRINTF("NEWImage ram usage: %.4f MB\n",imageRamAlloc/(1024.0f*1024.0f));
 
 	return image;
 }
 
-Image* loadPng(const char* filename)
+// Memory source for batch loads: the file has already been read whole
+struct PngBuffer {
+	const unsigned char *data;
+	png_size_t size, pos;
+};
+
+static void readPngBuffer(png_structp png_ptr, png_bytep out, png_size_t length)
+{
+	struct PngBuffer *src=(struct PngBuffer *)png_get_io_ptr(png_ptr);
+	if(length>src->size-src->pos) png_error(png_ptr,"read past end");
+	memcpy(out,src->data+src->pos,length);
+	src->pos+=length;
+}
+
+static int pinnedFormat(const char *filename);
+
+/* Decode from the file, or from buffer when the caller already read it */
+static Image *decodePng(const char* filename, const unsigned char *buffer, int size)
 {
 	png_structp png_ptr;
 	png_infop info_ptr;
 	unsigned int sig_read = 0;
 	png_uint_32 width, height;
-	int bit_depth, color_type, interlace_type, x, y;
-	unsigned int* line;
-	FILE *fp;
+	int bit_depth, color_type, interlace_type, y;
+	FILE *fp = NULL;
+	struct PngBuffer source;
 	Image* image = (Image*) malloc(sizeof(Image));
 	if (!image) return NULL;
 	image->isSwizzled=0;
 	image->vram=0;
 	image->palette=0;
+	image->vramData=0;
+	image->lastUsed=0;
 	image->format=GU_PSM_8888;
 	strcpy(image->filename,filename);
 
@@ -93,11 +250,22 @@ Image* loadPng(const char* filename)
 	if(strstr(remix,".JPG")!=0) strcpy(strstr(remix,".JPG"),".png");
 	filename=remix;
 
-	if ((fp = fopen(filename, "rb")) == NULL) return NULL;
+	if(textureCompressed && !buffer) {
+		Image *dxt=loadDxt(filename);
+		if(dxt) {
+			free(image);
+			return dxt;
+		}
+	}
+
+	if (!buffer && (fp = fopen(filename, "rb")) == NULL) {
+		free(image);
+		return NULL;
+	}
 	png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
 	if (png_ptr == NULL) {
 		free(image);
-		fclose(fp);
+		if (fp) fclose(fp);
 		DEBUG_PRINTF("Couldn't load 1 %s (%08x)\n",filename,(int)image);
 		return NULL;;
 	}
@@ -105,18 +273,25 @@ Image* loadPng(const char* filename)
 	info_ptr = png_create_info_struct(png_ptr);
 	if (info_ptr == NULL) {
 		free(image);
-		fclose(fp);
+		if (fp) fclose(fp);
 		png_destroy_read_struct(&png_ptr, png_infopp_NULL, png_infopp_NULL);
 		DEBUG_PRINTF("Couldn't load 2 %s (%08x)\n",filename,(int)image);
 		return NULL;
 	} 
-	png_init_io(png_ptr, fp);
+	if (buffer) {
+		source.data = buffer;
+		source.size = size;
+		source.pos = 0;
+		png_set_read_fn(png_ptr, &source, readPngBuffer);
+	} else {
+		png_init_io(png_ptr, fp);
+	}
 	png_set_sig_bytes(png_ptr, sig_read);
 	png_read_info(png_ptr, info_ptr);
 	png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, &interlace_type, int_p_NULL, int_p_NULL);
 	if (width > 512 || height > 512) {
 		free(image);
-		fclose(fp);
+		if (fp) fclose(fp);
 		png_destroy_read_struct(&png_ptr, png_infopp_NULL, png_infopp_NULL);
 		DEBUG_PRINTF("Couldn't load 3 %s (%08x)\n",filename,(int)image);
 		return NULL;
@@ -136,37 +311,388 @@ Image* loadPng(const char* filename)
 
 	if (!image->data) {
 		free(image);
-		fclose(fp);
+		if (fp) fclose(fp);
 		png_destroy_read_struct(&png_ptr, png_infopp_NULL, png_infopp_NULL);
 		DEBUG_PRINTF("Couldn't load 4 %s (%08x)\n",filename,(int)image);
 		return NULL;
 	}
 	
-	imageRamAlloc+=image->imageHeight*image->textureWidth*4;
+	ADD_BYTES(imageRamAlloc,image->imageHeight*image->textureWidth*4);
+	ADD_BYTES(imageBytesDecoded,image->imageHeight*image->textureWidth*4);
 //DEBUG_PRINTF("LOADImage ram usage: %.4f MB\n",imageRamAlloc/(1024.0f*1024.0f));
-	line = (unsigned int *) malloc(width * 4);
-	if (!line) {
-		free(image->data);
-		free(image);
-		fclose(fp);
-		png_destroy_read_struct(&png_ptr, png_infopp_NULL, png_infopp_NULL);
-		DEBUG_PRINTF("Couldn't load 5 %s (%08x)\n",filename,(int)image);
-		return NULL;
+
+	// Rows are decoded straight into the texture; only a banded swizzle of a
+	// final-format (8888) image needs an intermediate buffer. Under
+	// textureAutoFormat that is an image the manifest pins to 8888, the rest
+	// are swizzled as convertImage16 writes their 16-bit texels.
+	int rowBytes=image->textureWidth*4;
+	int finalFormat=textureAutoFormat ? pinnedFormat(image->filename) : GU_PSM_8888;
+	if(swizzleOnLoad && finalFormat==GU_PSM_8888 && interlace_type==PNG_INTERLACE_NONE && canSwizzle(image)) {
+		unsigned char *band=(unsigned char *)memalign(16,rowBytes*8);
+		if(band) {
+			png_bytep rows[8];
+			for (y = 0; y < 8; y++) rows[y] = band + y*rowBytes;
+			for (y = 0; y < height; y += 8) {
+				png_read_rows(png_ptr, rows, png_bytepp_NULL, 8);
+				swizzleBand(band, (unsigned char *)image->data + y*rowBytes, rowBytes);
+			}
+			free(band);
+			image->isSwizzled=1;
+		}
 	}
-	for (y = 0; y < height; y++) {
-		png_read_row(png_ptr, (unsigned char *) line, png_bytep_NULL);
-		for (x = 0; x < width; x++) {
-			unsigned int color = line[x];
-			image->data[x + y * image->textureWidth] =  color;
+	if (!image->isSwizzled) {
+		// Heap, not stack: the camera reload thread only has 4KB of stack
+		png_bytepp rows = (png_bytepp) malloc(height * sizeof(png_bytep));
+		if (!rows) {
+			free(image->data);
+			ADD_BYTES(imageRamAlloc,-(image->imageHeight*image->textureWidth*4));
+			free(image);
+			if (fp) fclose(fp);
+			png_destroy_read_struct(&png_ptr, &info_ptr, png_infopp_NULL);
+			DEBUG_PRINTF("Couldn't load 5 %s (%08x)\n",filename,(int)image);
+			return NULL;
 		}
+		for (y = 0; y < height; y++) rows[y] = (png_bytep)(image->data + y*image->textureWidth);
+		png_set_interlace_handling(png_ptr);
+		png_read_image(png_ptr, rows);
+		free(rows);
 	}
-	free(line);
 	png_read_end(png_ptr, info_ptr);
 	png_destroy_read_struct(&png_ptr, &info_ptr, png_infopp_NULL);
-	fclose(fp);
+	if (fp) fclose(fp);
 	//DEBUG_PRINTF("Loaded %s (%08x)\n",filename,image);
+	if(textureAutoFormat) {
+		convertImage16(image,chooseImageFormat(image));
+		if(swizzleOnLoad && !image->isSwizzled) swizzleFast(image);	// no room to convert, or no whole blocks
+	}
 	return image;
 }
+
+Image* loadPng(const char* filename)
+{
+	return decodePng(filename, NULL, 0);
+}
+
+#ifdef _PSP
+// One file being read in the background while the previous one decodes
+struct PendingRead {
+	int fd;
+	unsigned char *data;
+	int size;
+};
+
+static int startRead(const char *path, struct PendingRead *read)
+{
+	read->fd=-1;
+	read->data=0;
+	read->size=0;
+	read->fd=sceIoOpen(path,PSP_O_RDONLY,0);
+	if(read->fd<0) return 0;
+	read->size=(int)sceIoLseek(read->fd,0,PSP_SEEK_END);
+	sceIoLseek(read->fd,0,PSP_SEEK_SET);
+	read->data=(unsigned char *)malloc(read->size);
+	if(read->size<=0 || !read->data || sceIoReadAsync(read->fd,read->data,read->size)<0) {
+		sceIoClose(read->fd);
+		free(read->data);
+		read->fd=-1;
+		read->data=0;
+		return 0;
+	}
+	return 1;
+}
+
+static int finishRead(struct PendingRead *read)
+{
+	if(read->fd>=0) {
+		SceInt64 result=0;
+		sceIoWaitAsync(read->fd,&result);
+		sceIoClose(read->fd);
+		read->fd=-1;
+		if(result!=read->size) {
+			free(read->data);
+			read->data=0;
+		}
+	}
+	return read->data!=0;
+}
+
+// Loads any DXT assets directly; returns the index of the next PNG to read
+static int skipDxt(const char *const *paths, Image **out, int from, int count, int *loaded)
+{
+	while(from<count && textureCompressed && (out[from]=loadDxt(paths[from]))!=0) {
+		(*loaded)++;
+		from++;
+	}
+	return from;
+}
+
+/* Load several images in one go. The read of file N+1 is queued with
+   sceIoReadAsync before file N is decoded, so inflate overlaps the I/O.
+   Slots that fail to load come back as 0; returns how many loaded. */
+int loadPngBatch(const char *const *paths, Image **out, int count)
+{
+	struct PendingRead current,next;
+	int i,loaded=0;
+
+	for(i=0;i<count;i++) out[i]=0;
+
+	i=skipDxt(paths,out,0,count,&loaded);
+	int pending=i<count && startRead(paths[i],&next);
+	while(i<count) {
+		current=next;
+		int haveCurrent=pending && finishRead(&current);
+
+		int j=skipDxt(paths,out,i+1,count,&loaded);
+		pending=j<count && startRead(paths[j],&next);
+
+		if(haveCurrent) {
+			out[i]=decodePng(paths[i],current.data,current.size);
+			free(current.data);
+		} else {
+			out[i]=decodePng(paths[i],NULL,0);	// fall back to a plain blocking read
+		}
+		if(out[i]) loaded++;
+		i=j;
+	}
+	return loaded;
+}
+#else
+/* Host builds (tests/, tools/) have cores to spare: the batch is shared out
+   over imageBatchThreads workers, each taking the next path and loading it
+   whole. Same result as the PSP pipeline, slot for slot. */
+int imageBatchThreads=0;	// 0: one per core
+
+static void readFormatManifest();
+
+struct BatchWork {
+	const char *const *paths;
+	Image **out;
+	int count;
+	int next;
+	int loaded;
+};
+
+static void *batchWorker(void *arg)
+{
+	struct BatchWork *work=(struct BatchWork *)arg;
+	int i;
+	while((i=__sync_fetch_and_add(&work->next,1))<work->count) {
+		Image *image=textureCompressed ? loadDxt(work->paths[i]) : 0;
+		if(!image) image=decodePng(work->paths[i],NULL,0);
+		work->out[i]=image;
+		if(image) __sync_fetch_and_add(&work->loaded,1);
+	}
+	return 0;
+}
+
+int loadPngBatch(const char *const *paths, Image **out, int count)
+{
+	struct BatchWork work={paths,out,count,0,0};
+	pthread_t threads[32];
+	int i,started=0;
+	int threadCount=imageBatchThreads>0 ? imageBatchThreads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+	for(i=0;i<count;i++) out[i]=0;
+	// Nothing below may be set up lazily from two threads at once, and
+	// swizzling into VRAM goes through the allocator, which has no lock
+	readFormatManifest();
+	if(swizzleOnLoad && swizzleToVRam) threadCount=1;
+	if(threadCount>count) threadCount=count;
+	if(threadCount>32) threadCount=32;
+
+	for(i=1;i<threadCount;i++) {
+		if(pthread_create(&threads[started],NULL,batchWorker,&work)==0) started++;
+	}
+	batchWorker(&work);	// the caller works too
+	for(i=0;i<started;i++) pthread_join(threads[i],NULL);
+	return work.loaded;
+}
+#endif
+
+/* Per-asset format overrides, one "path format" pair per line, e.g.
+   "romfs/gfx/menu/logo.png 8888". Lines starting with # are comments. */
+#define FORMAT_MANIFEST "romfs/gfx/formats.txt"
+#define MAX_FORMAT_OVERRIDES 64
+static struct {
+	char path[128];
+	int format;
+} formatOverride[MAX_FORMAT_OVERRIDES];
+static int formatOverrideCount=-1;	// -1: manifest not read yet
+
+static int parseFormatName(const char *name)
+{
+	if(strcmp(name,"5650")==0) return GU_PSM_5650;
+	if(strcmp(name,"5551")==0) return GU_PSM_5551;
+	if(strcmp(name,"4444")==0) return GU_PSM_4444;
+	if(strcmp(name,"8888")==0) return GU_PSM_8888;
+	return -1;	// "auto" or unknown
+}
+
+static void loadFormatManifest()
+{
+	char line[256],path[128],name[16];
+	formatOverrideCount=0;
+	FILE *fp=fopen(FORMAT_MANIFEST,"r");
+	if(!fp) return;
+	while(fgets(line,sizeof(line),fp) && formatOverrideCount<MAX_FORMAT_OVERRIDES) {
+		if(line[0]=='#') continue;
+		if(sscanf(line,"%127s %15s",path,name)!=2) continue;
+		strcpy(formatOverride[formatOverrideCount].path,path);
+		formatOverride[formatOverrideCount].format=parseFormatName(name);
+		formatOverrideCount++;
+	}
+	fclose(fp);
+	DEBUG_PRINTF("Loaded %d texture format overrides\n",formatOverrideCount);
+}
+
+static void readFormatManifest()
+{
+	if(formatOverrideCount<0) loadFormatManifest();
+}
+
+// The format the manifest pins filename to, or -1 to pick it from the alpha
+static int pinnedFormat(const char *filename)
+{
+	int i;
+	readFormatManifest();
+	for(i=0;i<formatOverrideCount;i++) {
+		if(strcmp(formatOverride[i].path,filename)==0) return formatOverride[i].format;
+	}
+	return -1;
+}
+
+int chooseImageFormat(Image *image)
+{
+	int x,y;
+	int pinned=pinnedFormat(image->filename);
+	if(pinned>=0) return pinned;
+
+	// Alpha histogram: fully opaque, cut-out (0/255 only) or translucent.
+	// Values within a step of either end are invisible once quantised.
+	int clear=0,solid=0,partial=0;
+	for(y=0;y<image->imageHeight;y++) {
+		Color *row=image->data+y*image->textureWidth;
+		for(x=0;x<image->imageWidth;x++) {
+			unsigned int a=row[x]>>24;
+			if(a>=248) solid++;
+			else if(a<8) clear++;
+			else partial++;
+		}
+	}
+	if(partial==0 && clear==0) return GU_PSM_5650;
+	if(partial==0) return GU_PSM_5551;
+	return GU_PSM_4444;
+}
+
+// 4x4 ordered dither thresholds, 0..15
+static const unsigned char bayer4[4][4]={
+	{ 0, 8, 2,10},
+	{12, 4,14, 6},
+	{ 3,11, 1, 9},
+	{15, 7,13, 5}
+};
+
+// One row of 8888 texels to 16 bits. add holds the row's dither offset per
+// channel (r, g, b) for x&3, one output step spread across the 16
+// thresholds, so the loop has no per-texel branch on the format or the
+// dither: gcc -O3 vectorises it on the host, and the Allegrex runs it
+// straight. Padding past imageWidth is converted too, it is never sampled.
+static void convertRow5650(const Color *src,unsigned short *dst,int count,const unsigned char add[3][4])
+{
+	unsigned int ar[4],ag[4],ab[4];	// locals, so the stores cannot alias them
+	int x;
+	for(x=0;x<4;x++) {
+		ar[x]=add[0][x];
+		ag[x]=add[1][x];
+		ab[x]=add[2][x];
+	}
+	for(x=0;x<count;x++) {
+		unsigned int c=src[x];
+		unsigned int r=MIN((c&0xff)+ar[x&3],255);
+		unsigned int g=MIN(((c>>8)&0xff)+ag[x&3],255);
+		unsigned int b=MIN(((c>>16)&0xff)+ab[x&3],255);
+		dst[x]=(r>>3)|((g>>2)<<5)|((b>>3)<<11);
+	}
+}
+
+static void convertRow5551(const Color *src,unsigned short *dst,int count,const unsigned char add[3][4])
+{
+	unsigned int ar[4],ag[4],ab[4];	// locals, so the stores cannot alias them
+	int x;
+	for(x=0;x<4;x++) {
+		ar[x]=add[0][x];
+		ag[x]=add[1][x];
+		ab[x]=add[2][x];
+	}
+	for(x=0;x<count;x++) {
+		unsigned int c=src[x];
+		unsigned int r=MIN((c&0xff)+ar[x&3],255);
+		unsigned int g=MIN(((c>>8)&0xff)+ag[x&3],255);
+		unsigned int b=MIN(((c>>16)&0xff)+ab[x&3],255);
+		dst[x]=(r>>3)|((g>>3)<<5)|((b>>3)<<10)|((c>>31)<<15);
+	}
+}
+
+static void convertRow4444(const Color *src,unsigned short *dst,int count,const unsigned char add[3][4])
+{
+	unsigned int ar[4],ag[4],ab[4];	// locals, so the stores cannot alias them
+	int x;
+	for(x=0;x<4;x++) {
+		ar[x]=add[0][x];
+		ag[x]=add[1][x];
+		ab[x]=add[2][x];
+	}
+	for(x=0;x<count;x++) {
+		unsigned int c=src[x];
+		unsigned int r=MIN((c&0xff)+ar[x&3],255);
+		unsigned int g=MIN(((c>>8)&0xff)+ag[x&3],255);
+		unsigned int b=MIN(((c>>16)&0xff)+ab[x&3],255);
+		dst[x]=(r>>4)|((g>>4)<<4)|((b>>4)<<8)|((c>>28)<<12);
+	}
+}
+
+void convertImage16(Image *image,int format)
+{
+	if(!image || !image->data || image->format!=GU_PSM_8888 || image->isSwizzled || image->vram) return;
+	if(format!=GU_PSM_5650 && format!=GU_PSM_5551 && format!=GU_PSM_4444) return;
+
+	int oldBytes=imageDataBytes(image);
+	unsigned short *out=(unsigned short *)memalign(16,oldBytes/2);
+	if(!out) return;	// keep the 8888 copy, it still draws fine
+
+	// Swizzle as we go, one block row at a time, so no second pass is needed
+	int swizzle=swizzleOnLoad && (image->imageHeight&7)==0 && ((image->textureWidth*2)&15)==0;
+	unsigned short *band=swizzle ? (unsigned short *)memalign(16,image->textureWidth*2*8) : 0;
+	if(!band) swizzle=0;
+
+	int rb=format==GU_PSM_4444 ? 4 : 5;
+	int gb=format==GU_PSM_5650 ? 6 : (format==GU_PSM_5551 ? 5 : 4);
+	void (*convertRow)(const Color *,unsigned short *,int,const unsigned char [3][4])=
+		format==GU_PSM_5650 ? convertRow5650 : (format==GU_PSM_5551 ? convertRow5551 : convertRow4444);
+	unsigned char add[3][4];
+	int i,y;
+	for(y=0;y<image->imageHeight;y++) {
+		const Color *src=image->data+y*image->textureWidth;
+		unsigned short *dst=swizzle ? band+(y&7)*image->textureWidth : out+y*image->textureWidth;
+		for(i=0;i<4;i++) {
+			int d=textureDither ? bayer4[y&3][i] : 0;
+			add[0][i]=add[2][i]=(d<<(8-rb))>>4;
+			add[1][i]=(d<<(8-gb))>>4;
+		}
+		convertRow(src,dst,image->textureWidth,add);
+		if(swizzle && (y&7)==7) {
+			swizzleBand((unsigned char *)band,(unsigned char *)(out+(y&~7)*image->textureWidth),image->textureWidth*2);
+		}
+	}
+	free(band);
+	image->isSwizzled=swizzle;
+
+	free(image->data);
+	image->data=(Color *)out;
+	image->format=format;
+	ADD_BYTES(imageRamAlloc,imageDataBytes(image)-oldBytes);
+	ADD_BYTES(imageBytesSaved,imageSavedBytes(image));
+}
 /* 
 ImageMip* loadPngMip(const char* filename)
 {
@@ -313,20 +839,24 @@ ImageMip* loadPngMip(const char* filename)
 } */
 
 Image *vimage[64];
+static void vramForget(Image *image);
+void freeVRam(void *address,int length);
 
 void freeImage(Image *image)
 {
 	if(!image) return;
+	vramForget(image);
+	if(image->vramData) {
+		freeVRam(image->vramData,imageDataBytes(image));
+		image->vramData=0;
+	}
+	ADD_BYTES(imageBytesSaved,-imageSavedBytes(image));
 	if(image->data && image->vram==0) {
 		free(image->data);
-		imageRamAlloc-=image->imageHeight*image->textureWidth*4;
+		ADD_BYTES(imageRamAlloc,-imageDataBytes(image));
 		DEBUG_PRINTF("FREEImage '%s' from ram\n",image->filename);
 	} else if( image->data && image->vram) {
-		int i;
-		for(i=0;i<64;i++) {
-			if(vimage[i]==image) vimage[i]=0;
-		}
-		freeVRam(image->data,image->imageHeight*image->textureWidth*4);
+		freeVRam(image->data,imageDataBytes(image));
 		DEBUG_PRINTF("FREEImage '%s' from vram\n",image->filename);
 	}
 	image->data=0;
@@ -406,8 +936,9 @@ void saveImagePng(const char* filename, Color* data, int width, int height, int
 }
 
 int swizzleToVRam=0;
-//unsigned char *nextVRam=(unsigned char *)0x04000000+0x154000;	// after depth buffer
-int availableVRam=0x200000-0x154000;
+int vramResidency=1;
+int vramHits=0,vramMisses=0;
+int availableVRam=0;
 int biggestVRam=0;
 struct VRamBlock {
 	struct VRamBlock *next,*prev;
@@ -415,56 +946,93 @@ struct VRamBlock {
 	int length;
 } *vramBlock=0;
 
+#ifdef _PSP
+#define VRAM_BASE ((unsigned char *)0x04000000)
+#define VRAM_UNCACHED(p) ((void *)((unsigned int)(p)|0x40000000))
+#else
+// Host builds (tests/) get the same 2MB, in plain memory
+static unsigned char hostVRam[0x200000] __attribute__((aligned(16)));
+#define VRAM_BASE hostVRam
+#define VRAM_UNCACHED(p) ((void *)(p))
+#endif
+#define VRAM_END (VRAM_BASE+0x200000)
+#define VRAM_COLD_FRAMES 30	// frames without a draw before a texture may be evicted
+#define VRAM_PROMOTE_PER_FRAME 1	// each promotion copies up to ~550KB
+
+static int vramFrame=1;
+static Image *vramTouched[64];
+static int vramTouchedCount=0;
+
+static void updateVRamStats()
+{
+	struct VRamBlock *b;
+	biggestVRam=0;
+	availableVRam=0;
+	for(b=vramBlock;b!=NULL;b=b->next) {
+		if(b->length>biggestVRam) biggestVRam=b->length;
+		availableVRam+=b->length;
+	}
+}
+
 void reportVRam()
 {
 	struct VRamBlock *b;
-	int i=0;
+	int blocks=0;
+	for(b=vramBlock;b!=0;b=b->next) blocks++;
+
+	// Fragmentation: how much of the free space is unusable for one big allocation.
+	DEBUG_PRINTF("VRAM free %d bytes in %d blocks (biggest %d, %d%% fragmented)\n",availableVRam,blocks,biggestVRam,
+		availableVRam ? 100-(int)((long long)biggestVRam*100/availableVRam) : 0);
 
-	for(b=vramBlock;b!=0;b=b->next) {
-		i++;
-	}
-	DEBUG_PRINTF("There is %d VRAM available in %d blocks (biggest is %d)\n",availableVRam,i,biggestVRam);
 	int used=0;
-	int count=1;
+	int count=0;
+	int i;
 	for(i=0;i<64;i++) {
 		if(vimage[i]) {
-			used+=vimage[i]->textureWidth*vimage[i]->textureHeight*4;
+			used+=imageDataBytes(vimage[i]);
 			count++;
-			DEBUG_PRINTF("vimage: %s\n",vimage[i]->filename);
+			DEBUG_PRINTF("vimage: %s (last drawn frame %d)\n",vimage[i]->filename,vimage[i]->lastUsed);
 		}
 	}
 	DEBUG_PRINTF("^^^ %d vimages use %d bytes of vram\n",count,used);
+
+	DEBUG_PRINTF("VRAM texture hit rate %d%% (%d of %d draws)\n",
+		(vramHits+vramMisses) ? vramHits*100/(vramHits+vramMisses) : 0,vramHits,vramHits+vramMisses);
 }
 
 void resetVRam()
 {
-	unsigned char *nextVRam=(unsigned char *)0x04000000+0x154000;	// after depth buffer
-	availableVRam=0x200000-0x154000;
+	struct VRamBlock *b;
+	while(vramBlock) {
+		b=vramBlock->next;
+		free(vramBlock);
+		vramBlock=b;
+	}
+#ifdef _PSP
+	// Everything after the static framebuffers is ours.
+	unsigned char *nextVRam=(unsigned char *)getStaticVramTexture(0,0,GU_PSM_8888);
+#else
+	unsigned char *nextVRam=VRAM_BASE+0x88000;	// two 16-bit framebuffers
+#endif
 	vramBlock=(struct VRamBlock *)malloc(sizeof(struct VRamBlock));
 	vramBlock->next=0;
+	vramBlock->prev=0;
 	vramBlock->addr=nextVRam;
-	vramBlock->length=availableVRam;
-	biggestVRam=0x200000-0x154000;
+	vramBlock->length=VRAM_END-nextVRam;
+	updateVRamStats();
+	vramHits=vramMisses=0;
 	DEBUG_PRINTF("reset: "); reportVRam();
 }
 
 void *allocVRam(int length)
 {
 	struct VRamBlock *b;
-	struct VRamBlock *biggest=NULL,*closest=NULL,*alloc=NULL;
+	struct VRamBlock *alloc=NULL;
+	length=(length+15)&~15;	// GE wants 16-byte aligned textures
 	if(biggestVRam<length) return 0;	// common case is faster.
+	// Best fit keeps the big hole free for the next full-screen texture.
 	for(b=vramBlock;b!=NULL;b=b->next) {
-		if(biggest==0 || biggest->length<b->length) biggest=b;
-		if(b->length>=length) {
-			if(closest==0 || closest->length>b->length) closest=b;
-		}
-	}
-	if(closest && closest->length==length) {
-		// match, so allocate and return.
-		alloc=closest;
-	}
-	if(biggest && biggest->length>=length) {
-		alloc=biggest;
+		if(b->length>=length && (alloc==0 || alloc->length>b->length)) alloc=b;
 	}
 	if(alloc) {
 		unsigned char *out=(unsigned char*)alloc->addr;
@@ -479,13 +1047,7 @@ void *allocVRam(int length)
 			alloc->length-=length;
 			alloc->addr+=length;
 		}
-		biggestVRam=0;
-		availableVRam=0;
-		for(b=vramBlock;b!=NULL;b=b->next) {
-			if(b->length>biggestVRam) biggestVRam=b->length;
-			availableVRam+=b->length;
-		}
-		DEBUG_PRINTF("alloc: "); reportVRam();
+		updateVRamStats();
 		return out;
 	}
 	DEBUG_PRINTF("ASSERT COULDN'T ALLOC: "); reportVRam();
@@ -494,35 +1056,25 @@ void *allocVRam(int length)
 
 void freeVRam(void *address,int length)
 {
-	struct VRamBlock *b,*curr=0;
+	struct VRamBlock *b,*prev=0,*curr;
+	length=(length+15)&~15;
 
-	for(b=vramBlock;b!=0;b=b->next) {
-		if(b->addr+b->length==address) {
-			b->length+=length;
-			curr=b;
-			break;
-		}
-	}
-	if(!curr) {
-		// new node before the next higher address.
+	// The free list is kept sorted by address so neighbours can be merged.
+	for(b=vramBlock;b!=0 && b->addr<(unsigned char *)address;b=b->next) prev=b;
+
+	if(prev && prev->addr+prev->length==address) {
+		curr=prev;
+		curr->length+=length;
+	} else {
 		curr=(struct VRamBlock *)malloc(sizeof(struct VRamBlock));
-		curr->next=0;
-		curr->prev=0;
+		if(!curr) return;
 		curr->addr=(unsigned char *)address;
 		curr->length=length;
-		for(b=vramBlock;b!=0;b=b->next) {
-			if((int)b->addr>(int)address) {
-				curr->prev=b->prev;
-				curr->next=b;
-				b->prev=curr;
-				if(curr->prev) {
-					curr->prev->next=curr;
-				} else {
-					vramBlock=curr;
-				}
-			}
-		}
-		if(vramBlock==0) vramBlock=curr;
+		curr->prev=prev;
+		curr->next=b;
+		if(b) b->prev=curr;
+		if(prev) prev->next=curr;
+		else vramBlock=curr;
 	}
 	if(curr->next && curr->next->addr==curr->addr+curr->length) {
 		// merge blocks.
@@ -532,25 +1084,300 @@ void freeVRam(void *address,int length)
 		if(curr->next) curr->next->prev=curr;
 		free(b);
 	}
-	biggestVRam=0;
-	availableVRam=0;
-	for(b=vramBlock;b!=NULL;b=b->next) {
-		if(b->length>biggestVRam) biggestVRam=b->length;
+	updateVRamStats();
+}
 
-		availableVRam+=b->length;
+static void vramForget(Image *image)
+{
+	int i;
+	for(i=0;i<64;i++) {
+		if(vimage[i]==image) vimage[i]=0;
+	}
+	for(i=0;i<vramTouchedCount;i++) {
+		if(vramTouched[i]==image) vramTouched[i]=0;
 	}
-	DEBUG_PRINTF("post-free vram: "); reportVRam();
-	// Note: 'b' and 'curr' are already freed above in the merge logic
+}
+
+static void vramEvict(Image *image)
+{
+	int i;
+	for(i=0;i<64;i++) {
+		if(vimage[i]==image) vimage[i]=0;
+	}
+	freeVRam(image->vramData,imageDataBytes(image));
+	image->vramData=0;
+	DEBUG_PRINTF("^^^Image '%s' evicted from vram\n",image->filename);
+}
+
+static Image *vramColdest()
+{
+	Image *coldest=0;
+	int i;
+	for(i=0;i<64;i++) {
+		Image *v=vimage[i];
+		if(!v || !v->vramData) continue;	// swizzled-to-vram images are permanent
+		if(vramFrame-v->lastUsed<VRAM_COLD_FRAMES) continue;
+		if(!coldest || v->lastUsed<coldest->lastUsed) coldest=v;
+	}
+	return coldest;
+}
+
+static int vramPromote(Image *image)
+{
+	int length=imageDataBytes(image);
+	void *out;
+	int i;
+
+	if(image->vram || image->vramData || !image->data) return 1;
+	while((out=allocVRam(length))==0) {
+		Image *victim=vramColdest();
+		if(!victim) return 0;
+		vramEvict(victim);
+	}
+	for(i=0;i<64;i++) {
+		if(vimage[i]==0) {
+			vimage[i]=image;
+			break;
+		}
+	}
+	if(i==64) {
+		freeVRam(out,length);
+		return 0;
+	}
+	memcpy(VRAM_UNCACHED(out),image->data,length);
+	image->vramData=(Color *)out;
+	DEBUG_PRINTF("^^^Image '%s' promoted to vram\n",image->filename);
+	return 1;
+}
+
+// Called for every draw; returns the copy the GE should sample from.
+Color *vramTouch(Image *image)
+{
+	if(image->lastUsed!=vramFrame) {
+		image->lastUsed=vramFrame;
+		if(vramResidency && !image->vram && !image->vramData && vramTouchedCount<64) {
+			vramTouched[vramTouchedCount++]=image;
+		}
+	}
+	if(image->vram) {
+		vramHits++;
+		return image->data;
+	}
+	if(image->vramData) {
+		vramHits++;
+		return image->vramData;
+	}
+	vramMisses++;
+	return image->data;
+}
+
+// Call once per frame after the swap, when the GE no longer reads any texture.
+void vramEndFrame()
+{
+	int i,promoted=0;
+	if(!vramBlock) resetVRam();
+	for(i=0;i<vramTouchedCount && promoted<VRAM_PROMOTE_PER_FRAME;i++) {
+		Image *image=vramTouched[i];
+		if(!image || image->vramData) continue;
+		if(vramPromote(image)) promoted++;
+	}
+	vramTouchedCount=0;
+	vramFrame++;
+}
+
+/* Animations written by tools/jsqenc: "JSQ1", six 16-bit fields (width,
+   height, texture width, format, frame count, tile size), frame count + 1
+   32-bit offsets, then per frame a bitmap of the tiles that changed and each
+   changed tile run-length coded. Frame 0 sets every tile. The file is small
+   and stays resident; frames are rebuilt in two buffers taking turns. */
+struct Sequence {
+	unsigned char *file;
+	int fileBytes;
+	int width,height,textureWidth,format,frames,tile;
+	Image *buffer[2];
+	int holds[2];	// frame in each buffer, -1 for none
+};
+
+Sequence *loadSequence(const char *filename)
+{
+	FILE *fp=fopen(filename,"rb");
+	if(!fp) return NULL;
+	fseek(fp,0,SEEK_END);
+	int length=(int)ftell(fp);
+	fseek(fp,0,SEEK_SET);
+	Sequence *sequence=(Sequence *)calloc(sizeof(Sequence),1);
+	unsigned char *file=length>16 ? (unsigned char *)malloc(length) : 0;
+	if(!sequence || !file || fread(file,1,length,fp)!=(size_t)length) {
+		fclose(fp);
+		free(file);
+		free(sequence);
+		DEBUG_PRINTF("Couldn't load %s\n",filename);
+		return NULL;
+	}
+	fclose(fp);
+	sequence->file=file;
+	sequence->fileBytes=length;
+	sequence->width=readLe16(file+4);
+	sequence->height=readLe16(file+6);
+	sequence->textureWidth=readLe16(file+8);
+	sequence->format=readLe16(file+10);
+	sequence->frames=readLe16(file+12);
+	sequence->tile=readLe16(file+14);
+	sequence->holds[0]=sequence->holds[1]=-1;
+	int ok=memcmp(file,"JSQ1",4)==0 && sequence->frames>0 && sequence->tile>0
+		&& (sequence->format==GU_PSM_5650 || sequence->format==GU_PSM_5551 || sequence->format==GU_PSM_4444)
+		&& sequence->width<=sequence->textureWidth && sequence->textureWidth<=512 && sequence->height<=512
+		&& 16+(sequence->frames+1)*4<=length
+		&& (int)readLe32(file+16+sequence->frames*4)<=length;
+	if(!ok) {
+		DEBUG_PRINTF("Bad sequence header %s\n",filename);
+		freeSequence(sequence);
+		return NULL;
+	}
+	return sequence;
+}
+
+int sequenceFrames(Sequence *sequence)
+{
+	return sequence->frames;
+}
+
+int sequenceBytes(Sequence *sequence)
+{
+	int bytes=sequence->fileBytes,i;
+	for(i=0;i<2;i++) {
+		if(sequence->buffer[i]) bytes+=imageDataBytes(sequence->buffer[i]);
+	}
+	return bytes;
+}
+
+// A buffer the GE samples directly: VRAM when there is room, so it is never
+// promoted (and copied again) after each rewrite
+static Image *newSequenceBuffer(Sequence *sequence)
+{
+	Image *image=(Image *)calloc(sizeof(Image),1);
+	if(!image) return NULL;
+	sprintf(image->filename,"sequence%dx%d",sequence->width,sequence->height);
+	image->imageWidth=sequence->width;
+	image->imageHeight=sequence->height;
+	image->textureWidth=sequence->textureWidth;
+	image->textureHeight=1;
+	while(image->textureHeight<sequence->height) image->textureHeight<<=1;
+	image->format=sequence->format;
+	int length=imageDataBytes(image);
+	image->data=(Color *)allocVRam(length);
+	if(image->data) {
+		image->vram=1;
+	} else {
+		image->data=(Color *)memalign(16,length);
+		if(!image->data) {
+			free(image);
+			return NULL;
+		}
+		ADD_BYTES(imageRamAlloc,length);
+	}
+	ADD_BYTES(imageBytesSaved,imageSavedBytes(image));
+	return image;
+}
+
+// One frame's changed tiles on top of whatever dst holds; 0 if the data is bad
+static int applySequenceFrame(Sequence *sequence,int frame,unsigned short *dst)
+{
+	const unsigned char *at=sequence->file+readLe32(sequence->file+16+frame*4);
+	const unsigned char *end=sequence->file+readLe32(sequence->file+16+(frame+1)*4);
+	int tile=sequence->tile,stride=sequence->textureWidth;
+	int tilesX=(sequence->width+tile-1)/tile,tilesY=(sequence->height+tile-1)/tile;
+	const unsigned char *bitmap=at;
+	at+=(tilesX*tilesY+7)/8;
+	if(at>end) return 0;
+	int t,decoded=0;
+	for(t=0;t<tilesX*tilesY;t++) {
+		if(!(bitmap[t>>3]&(1<<(t&7)))) continue;
+		int x0=(t%tilesX)*tile,y0=(t/tilesX)*tile;
+		int w=MIN(tile,sequence->width-x0),h=MIN(tile,sequence->height-y0);
+		int left=w*h,x=0;
+		unsigned short *row=dst+y0*stride+x0;
+		// Runs continue across the tile's rows
+		while(left>0) {
+			if(at>=end) return 0;
+			int control=*at++;
+			int count=control<128 ? control+1 : control-126;
+			int literal=control<128;
+			if(count>left || at+(literal ? count*2 : 2)>end) return 0;
+			unsigned short value=readLe16(at);
+			left-=count;
+			while(count--) {
+				if(literal) {
+					value=readLe16(at);
+					at+=2;
+				}
+				row[x]=value;
+				if(++x==w) {
+					x=0;
+					row+=stride;
+				}
+			}
+			if(!literal) at+=2;
+		}
+		decoded+=w*h*2;
+	}
+	ADD_BYTES(imageBytesDecoded,decoded);
+	return 1;
+}
+
+// Builds frame into the buffer not holding frame-1 (its previous content is
+// frame-2, or anything for a new start) and returns it. The caller must no
+// longer be drawing what that buffer held.
+Image *sequenceFrame(Sequence *sequence,int frame)
+{
+	if(frame<0 || frame>=sequence->frames) return NULL;
+	int b=frame&1;
+	if(!sequence->buffer[b]) sequence->buffer[b]=newSequenceBuffer(sequence);
+	Image *image=sequence->buffer[b];
+	if(!image) return NULL;
+
+	int from=sequence->holds[b];
+	if(from>frame) from=-1;	// rewound: start again from the keyframe
+	int other=sequence->holds[b^1];
+	if(from<0 && other>=0 && other<frame && sequence->buffer[b^1]) {
+		memcpy(image->data,sequence->buffer[b^1]->data,imageDataBytes(image));
+		from=other;
+	}
+	int f;
+	for(f=from+1;f<=frame;f++) {
+		if(!applySequenceFrame(sequence,f,(unsigned short *)image->data)) {
+			DEBUG_PRINTF("Bad sequence frame %d\n",f);
+			sequence->holds[b]=-1;
+			return NULL;
+		}
+	}
+	sequence->holds[b]=frame;
+	if(image->vramData) vramEvict(image);	// the resident copy is stale now
+#ifdef _PSP
+	sceKernelDcacheWritebackRange(image->data,imageDataBytes(image));
+#endif
+	return image;
+}
+
+void freeSequence(Sequence *sequence)
+{
+	if(!sequence) return;
+	freeImage(sequence->buffer[0]);
+	freeImage(sequence->buffer[1]);
+	free(sequence->file);
+	free(sequence);
 }
 
 void swizzleFast(Image *source)
 {
 	if(source==0) return;
-	unsigned int width = source->textureWidth*4;
+	if(source->format>=GU_PSM_DXT1) return;	// compressed blocks are never swizzled
+	if(source->vramData) vramEvict(source);	// the resident copy is about to go stale
+	unsigned int width = source->textureWidth*(source->format==GU_PSM_8888 ? 4 : 2);
 	unsigned int height = source->imageHeight;
-	unsigned long* out;
+	unsigned int* out;
 
-	if(swizzleToVRam && (out=(unsigned long*)allocVRam(width*height))) {
+	if(swizzleToVRam && (out=(unsigned int*)allocVRam(width*height))) {
 		DEBUG_PRINTF("texture to vram\n");
 		source->vram=1;
 		int i;
@@ -563,12 +1390,12 @@ void swizzleFast(Image *source)
 			}	
 		}
 	} else {
-		out=(unsigned long *)malloc(width*height);
+		out=(unsigned int *)malloc(width*height);
 		if(!out) {
 			DEBUG_PRINTF("^^^couldn't allocate memory for swizzling!\n");
 			return;
 		}	// couldn't do it!
-		imageRamAlloc+=width*height;
+		ADD_BYTES(imageRamAlloc,width*height);
 		//DEBUG_PRINTF("SWIZ^Image ram usage: %.4f MB\n",imageRamAlloc/(1024.0f*1024.0f));
 	}
 	unsigned int blockx, blocky;
@@ -581,12 +1408,12 @@ void swizzleFast(Image *source)
 	unsigned int srcRow = width * 8;
 
 	const unsigned char* ysrc = (unsigned char *)source->data;;
-	unsigned long * dst = out;
+	unsigned int * dst = out;
 
 	for (blocky = 0; blocky < heightBlocks; ++blocky) {
 		const unsigned char* xsrc = ysrc;
 		for (blockx = 0; blockx < widthBlocks; ++blockx) {
-			const unsigned long* src = (unsigned long*)xsrc;
+			const unsigned int* src = (unsigned int*)xsrc;
 			for (i=0;i<8;i++) {
 				*(dst++) = *(src++);
 				*(dst++) = *(src++);
@@ -599,7 +1426,7 @@ void swizzleFast(Image *source)
 		ysrc += srcRow;
 	}
 	free(source->data);
-	imageRamAlloc-=width*height;
+	ADD_BYTES(imageRamAlloc,-(width*height));
 	DEBUG_PRINTF("SWIZvImage ram usage: %.4f MB\n",imageRamAlloc/(1024.0f*1024.0f));
 	source->data=(Color *)out;
 	source->isSwizzled=1;
@@ -1,6 +1,8 @@
 #include "included/image2.hpp"
 #include "included/memory.hpp"
+#include "included/graph.hpp"
 #include <string>
+#include <cstdio>
 
 // Helpers: safe free + array free
 static inline void freeImageSafe(Image*& img) {
@@ -34,11 +36,18 @@ namespace image {
         Image* logo = nullptr;
         Image* copyright = nullptr;
 
+        void loadMenuBackgroundFrame(int frame) {
+            static const char* const paths[4] = {
+                "romfs/gfx/menu/frame_1.png",
+                "romfs/gfx/menu/frame_2.png",
+                "romfs/gfx/menu/frame_3.png",
+                "romfs/gfx/menu/frame_4.png"
+            };
+            if (frame < 0 || frame >= 4 || menuBackground[frame]) return;
+            menuBackground[frame] = loadPng(paths[frame]);
+        }
         void loadMenuBackground() {
-            menuBackground[0] = loadPng("romfs/gfx/menu/frame_1.png");
-            menuBackground[1] = loadPng("romfs/gfx/menu/frame_2.png");
-            menuBackground[2] = loadPng("romfs/gfx/menu/frame_3.png");
-            menuBackground[3] = loadPng("romfs/gfx/menu/frame_4.png");
+            for (int frame = 0; frame < 4; ++frame) loadMenuBackgroundFrame(frame);
         }
         void unloadMenuBackground() {
             freeImageArray(menuBackground);
@@ -283,88 +292,13 @@ void postFrame() {
 
             bool loaded = false;
             
-// Build the desired file path for a camera slot based on animatronic positions
+// Build the desired file path for a camera slot based on animatronic positions;
+// which image each camera shows is described by graph (romfs/ai/map.txt)
 static std::string buildCamPath(int idx) {
-    // Helper to compose paths
-    auto P = [](const char* subdir, const char* name) {
-        return std::string("romfs/gfx/office/camera/") + subdir + name + ".png";
-    };
-
-    // Shortcuts
-    int f = freddyPosition;
-    int b = bonniePosition;
-    int c = chicaPosition;
-    int x = foxyPosition;
-
-    switch (idx) {
-        case 0: // Cam 1A
-            // NEW LOGIC: Show cam1a-empty whenever Freddy is NOT at position 0
-            // This indicates Freddy has moved from his starting position
-            if (f > 0) {
-                return P("animatronic/cam1a/", "cam1a-empty");
-            }
-            
-            // Original logic for when Freddy is at position 0
-            if (f == 0 && b == 0 && c == 0) return P("main/", "cam1a");
-            if (f == 0 && b > 0 && c == 0)  return P("animatronic/cam1a/", "cam1a-freddy&chica");
-            if (f == 0 && b == 0 && c > 0)  return P("animatronic/cam1a/", "cam1a-freddy&bonnie");
-            if (f == 0 && b > 0 && c > 0)   return (save::whichNight < 4)
-                                                ? P("animatronic/cam1a/", "cam1a-freddy")
-                                                : P("animatronic/cam1a/", "cam1a-freddystare");
-            return P("animatronic/cam1a/", "cam1a-empty");
-
-        case 1: // Cam 1B
-            if (b == 1 && c != 1 && f != 1) return P("animatronic/cam1b/", "cam1b-bonnie");
-            if (b != 1 && c == 1 && f != 1) return P("animatronic/cam1b/", "cam1b-chica");
-            if (f == 1)                     return P("animatronic/cam1b/", "cam1b-freddy");
-            return P("main/", "cam1b");
-
-        case 2: // Cam 1C (Foxy)
-            switch (x) {
-                case 0:  return P("main/", "cam1c");
-                case 1:  return P("animatronic/cam1c/", "cam1c-foxy1");
-                case 2:  return P("animatronic/cam1c/", "cam1c-foxy2");
-                default: return P("animatronic/cam1c/", "cam1c-foxy3");
-            }
-
-        case 3: // Cam 2A
-            return (b == 3) ? P("animatronic/cam2a/", "cam2a-bonnie") : P("main/", "cam2a");
-
-        case 4: // Cam 2B
-            return (b == 5) ? P("animatronic/cam2b/", "cam2b-bonnie") : P("main/", "cam2b");
-
-        case 5: // Cam 3
-            return (b == 4) ? P("animatronic/cam3/", "cam3-bonnie") : P("main/", "cam3");
-
-        case 6: // Cam 4A
-            if (c == 3 && f != 3) return P("animatronic/cam4a/", "cam4a-chica");
-            if (c == 4 && f != 3) return P("animatronic/cam4a/", "cam4a-chicaclose");
-            if (f == 3)           return P("animatronic/cam4a/", "cam4a-freddy");
-            return P("main/", "cam4a");
-
-        case 7: // Cam 4B
-            if (c == 5 && f != 4) return P("animatronic/cam4b/", "cam4b-chica");
-            if (f == 4)           return P("animatronic/cam4b/", "cam4b-freddy");
-            return P("main/", "cam4b");
-
-        case 8: // Cam 5
-            if (b == 7)
-                return (save::whichNight > 4)
-                    ? P("animatronic/cam5/", "cam5-bonnieclose")
-                    : P("animatronic/cam5/", "cam5-bonnie");
-            return P("main/", "cam5");
-
-        case 9: // Cam 6
-            return P("main/", "cam6");
-
-        case 10: // Cam 7
-            if (c == 7 && f != 2) return P("animatronic/cam7/", "cam7-chica");
-            if (c == 8 && f != 2) return P("animatronic/cam7/", "cam7-chicaclose");
-            if (f == 2)           return P("animatronic/cam7/", "cam7-freddy");
-            return P("main/", "cam7");
-    }
-    // Fallback (shouldn’t happen)
-    return P("main/", "cam6");
+    const int vars[graph::kVarCount] = {freddyPosition, bonniePosition, chicaPosition, foxyPosition, save::whichNight};
+    const char* image = graph::cameraImage(idx, vars);
+    // Fallback (shouldn't happen)
+    return std::string("romfs/gfx/office/camera/") + (image ? image : "main/cam6") + ".png";
 }
 static int nextCamIdx = 0;
 static constexpr int kCamReloadBudget = 8; // tune 2..4
@@ -398,16 +332,28 @@ void loadAllCams() {
     // This ensures all cameras are visible from the start of early levels
     if (!loaded) { for (int i = 0; i < 11; ++i) lastPath[i].clear(); }
 
+    // Gather the cameras that need (re)loading and read them as one batch
+    std::string paths[11];
+    const char* list[11];
+    int slot[11];
+    int count = 0;
     for (int i = 0; i < 11; ++i) {
-        const std::string newPath = buildCamPath(i);
-        
-        if (!(lastPath[i] == newPath && cams[i])) {
-            Image* newImg = loadPng(newPath.c_str());
-            if (newImg) {
-                queueRetire(cams[i]);
-                cams[i] = newImg;
-                lastPath[i] = newPath;
-            }
+        paths[i] = buildCamPath(i);
+        if (!(lastPath[i] == paths[i] && cams[i])) {
+            list[count] = paths[i].c_str();
+            slot[count] = i;
+            count++;
+        }
+    }
+
+    Image* loadedImgs[11] = {nullptr};
+    loadPngBatch(list, loadedImgs, count);
+    for (int k = 0; k < count; ++k) {
+        const int i = slot[k];
+        if (loadedImgs[k]) {
+            queueRetire(cams[i]);
+            cams[i] = loadedImgs[k];
+            lastPath[i] = paths[i];
         }
     }
     loaded = true;
@@ -453,35 +399,48 @@ void unloadCams() {
             Image* camMap    = nullptr;
 
             void loadCamUi() {
-                camBorder = loadPng("romfs/gfx/office/ui/camera_border.png"); 
-                camMap    = loadPng("romfs/gfx/office/ui/camera-map.png");
-                recording = loadPng("romfs/gfx/office/ui/recording.png");
-
-                camNames[0] = loadPng("romfs/gfx/office/ui/cam-names/ShowStage.png");
-                camNames[1] = loadPng("romfs/gfx/office/ui/cam-names/DiningArea.png");
-                camNames[2] = loadPng("romfs/gfx/office/ui/cam-names/PirateCove.png");
-                camNames[3] = loadPng("romfs/gfx/office/ui/cam-names/W-Hall.png");
-                camNames[4] = loadPng("romfs/gfx/office/ui/cam-names/W-Hall-corner.png");
-                camNames[5] = loadPng("romfs/gfx/office/ui/cam-names/Closet.png");
-                camNames[6] = loadPng("romfs/gfx/office/ui/cam-names/E-Hall.png");
-                camNames[7] = loadPng("romfs/gfx/office/ui/cam-names/E-Hall-corner.png");
-                camNames[8] = loadPng("romfs/gfx/office/ui/cam-names/BackStage.png");
-                camNames[9] = loadPng("romfs/gfx/office/ui/cam-names/Kitchen.png");
-                camNames[10]= loadPng("romfs/gfx/office/ui/cam-names/Restrooms.png");
-
-                camButtons[0]  = loadPng("romfs/gfx/office/camera/main/buttons/cam1a.png");
-                camButtons[1]  = loadPng("romfs/gfx/office/camera/main/buttons/cam1b.png");
-                camButtons[2]  = loadPng("romfs/gfx/office/camera/main/buttons/cam1c.png");
-                camButtons[3]  = loadPng("romfs/gfx/office/camera/main/buttons/cam2a.png");
-                camButtons[4]  = loadPng("romfs/gfx/office/camera/main/buttons/cam2b.png");
-                camButtons[5]  = loadPng("romfs/gfx/office/camera/main/buttons/cam3.png");
-                camButtons[6]  = loadPng("romfs/gfx/office/camera/main/buttons/cam4a.png");
-                camButtons[7]  = loadPng("romfs/gfx/office/camera/main/buttons/cam4b.png");
-                camButtons[8]  = loadPng("romfs/gfx/office/camera/main/buttons/cam5.png");
-                camButtons[9]  = loadPng("romfs/gfx/office/camera/main/buttons/cam6.png");
-                camButtons[10] = loadPng("romfs/gfx/office/camera/main/buttons/cam7.png");
-
-                reticle = loadPng("romfs/gfx/office/camera/main/buttons/reticle.png");
+                static const char* const uiPaths[] = {
+                    "romfs/gfx/office/ui/camera_border.png",
+                    "romfs/gfx/office/ui/camera-map.png",
+                    "romfs/gfx/office/ui/recording.png",
+                    "romfs/gfx/office/camera/main/buttons/reticle.png"
+                };
+                static const char* const namePaths[11] = {
+                    "romfs/gfx/office/ui/cam-names/ShowStage.png",
+                    "romfs/gfx/office/ui/cam-names/DiningArea.png",
+                    "romfs/gfx/office/ui/cam-names/PirateCove.png",
+                    "romfs/gfx/office/ui/cam-names/W-Hall.png",
+                    "romfs/gfx/office/ui/cam-names/W-Hall-corner.png",
+                    "romfs/gfx/office/ui/cam-names/Closet.png",
+                    "romfs/gfx/office/ui/cam-names/E-Hall.png",
+                    "romfs/gfx/office/ui/cam-names/E-Hall-corner.png",
+                    "romfs/gfx/office/ui/cam-names/BackStage.png",
+                    "romfs/gfx/office/ui/cam-names/Kitchen.png",
+                    "romfs/gfx/office/ui/cam-names/Restrooms.png"
+                };
+                static const char* const buttonPaths[11] = {
+                    "romfs/gfx/office/camera/main/buttons/cam1a.png",
+                    "romfs/gfx/office/camera/main/buttons/cam1b.png",
+                    "romfs/gfx/office/camera/main/buttons/cam1c.png",
+                    "romfs/gfx/office/camera/main/buttons/cam2a.png",
+                    "romfs/gfx/office/camera/main/buttons/cam2b.png",
+                    "romfs/gfx/office/camera/main/buttons/cam3.png",
+                    "romfs/gfx/office/camera/main/buttons/cam4a.png",
+                    "romfs/gfx/office/camera/main/buttons/cam4b.png",
+                    "romfs/gfx/office/camera/main/buttons/cam5.png",
+                    "romfs/gfx/office/camera/main/buttons/cam6.png",
+                    "romfs/gfx/office/camera/main/buttons/cam7.png"
+                };
+
+                Image* ui[4] = {nullptr};
+                loadPngBatch(uiPaths, ui, 4);
+                camBorder = ui[0];
+                camMap    = ui[1];
+                recording = ui[2];
+                reticle   = ui[3];
+
+                loadPngBatch(namePaths, camNames, 11);
+                loadPngBatch(buttonPaths, camButtons, 11);
             }
             void unloadCamUi() {
                 freeImageSafe(camBorder);
@@ -589,82 +548,266 @@ void unloadCams() {
         int whichJumpscare = 0;
         bool loaded = false;
 
+        int framesLoaded = 0;
+        static char who[8];
+
+        // A character with a .jsq (tools/jsqenc.c) plays from it: frames are
+        // rebuilt in the sequence's two buffers and jumpscareAnim only points
+        // at them. Without one the PNGs are loaded one per frame.
+        static Sequence* sequence = nullptr;
+
+        static const char* const names[5] = {"", "freddy", "bonnie", "chica", "foxy"};
+
+        static Sequence* openSequence(int which) {
+            char path[48];
+            snprintf(path, sizeof(path), "romfs/gfx/jumpscare/%s.jsq", names[which]);
+            Sequence* opened = loadSequence(path);
+            if (opened && sequenceFrames(opened) != 9) { // the animation plays nine
+                freeSequence(opened);
+                opened = nullptr;
+            }
+            return opened;
+        }
+
         static inline void unloadFrames() {
-            freeImageArray(jumpscareAnim);
+            if (sequence) {
+                for (Image*& frame : jumpscareAnim) frame = nullptr; // the sequence owns them
+                freeSequence(sequence);
+                sequence = nullptr;
+            } else {
+                freeImageArray(jumpscareAnim);
+            }
+            framesLoaded = 0;
             loaded = false;
         }
 
-        void loadFreddy() {
-            unloadFrames();
-            jumpscareAnim[0] = loadPng("romfs/gfx/jumpscare/freddy/0.png");
-            jumpscareAnim[1] = loadPng("romfs/gfx/jumpscare/freddy/1.png");
-            jumpscareAnim[2] = loadPng("romfs/gfx/jumpscare/freddy/2.png");
-            jumpscareAnim[3] = loadPng("romfs/gfx/jumpscare/freddy/3.png");
-            jumpscareAnim[4] = loadPng("romfs/gfx/jumpscare/freddy/4.png");
-            jumpscareAnim[5] = loadPng("romfs/gfx/jumpscare/freddy/5.png");
-            jumpscareAnim[6] = loadPng("romfs/gfx/jumpscare/freddy/6.png");
-            jumpscareAnim[7] = loadPng("romfs/gfx/jumpscare/freddy/7.png");
-            jumpscareAnim[8] = loadPng("romfs/gfx/jumpscare/freddy/8.png");
-            loaded = true;
+        static int residentBytes() {
+            if (sequence) return sequenceBytes(sequence);
+            int bytes = 0;
+            for (int i = 0; i < framesLoaded; ++i) {
+                if (jumpscareAnim[i]) bytes += imageDataBytes(jumpscareAnim[i]);
+            }
+            return bytes;
         }
 
-        void loadBonnie() {
-            unloadFrames();
-            jumpscareAnim[0] = loadPng("romfs/gfx/jumpscare/bonnie/0.png");
-            jumpscareAnim[1] = loadPng("romfs/gfx/jumpscare/bonnie/1.png");
-            jumpscareAnim[2] = loadPng("romfs/gfx/jumpscare/bonnie/2.png");
-            jumpscareAnim[3] = loadPng("romfs/gfx/jumpscare/bonnie/3.png");
-            jumpscareAnim[4] = loadPng("romfs/gfx/jumpscare/bonnie/4.png");
-            jumpscareAnim[5] = loadPng("romfs/gfx/jumpscare/bonnie/5.png");
-            jumpscareAnim[6] = loadPng("romfs/gfx/jumpscare/bonnie/6.png");
-            jumpscareAnim[7] = loadPng("romfs/gfx/jumpscare/bonnie/7.png");
-            jumpscareAnim[8] = loadPng("romfs/gfx/jumpscare/bonnie/8.png");
+        bool loadNextFrame(int shown) {
+            if (!who[0] || framesLoaded >= 9) return true;
+            const int next = framesLoaded;
+            const unsigned int start = sceKernelGetSystemTimeLow();
+            if (sequence) {
+                // Frame n goes into the buffer holding n - 2, so wait until
+                // the frame after that is the one on screen
+                if (next - 1 > shown) return false;
+                jumpscareAnim[next] = sequenceFrame(sequence, next);
+                if (!jumpscareAnim[next]) return false;
+                if (next >= 2) jumpscareAnim[next - 2] = nullptr;
+            } else {
+                char path[48];
+                snprintf(path, sizeof(path), "romfs/gfx/jumpscare/%s/%d.png", who, next);
+                jumpscareAnim[next] = loadPng(path);
+                if (!jumpscareAnim[next]) return false; // retried next call
+            }
+            framesLoaded++;
             loaded = true;
+            memory::reportJumpscareFrame(next, sceKernelGetSystemTimeLow() - start, residentBytes());
+            return framesLoaded >= 9;
         }
 
-        void loadChica() {
-            unloadFrames();
-            jumpscareAnim[0] = loadPng("romfs/gfx/jumpscare/chica/0.png");
-            jumpscareAnim[1] = loadPng("romfs/gfx/jumpscare/chica/1.png");
-            jumpscareAnim[2] = loadPng("romfs/gfx/jumpscare/chica/2.png");
-            jumpscareAnim[3] = loadPng("romfs/gfx/jumpscare/chica/3.png");
-            jumpscareAnim[4] = loadPng("romfs/gfx/jumpscare/chica/4.png");
-            jumpscareAnim[5] = loadPng("romfs/gfx/jumpscare/chica/5.png");
-            jumpscareAnim[6] = loadPng("romfs/gfx/jumpscare/chica/6.png");
-            jumpscareAnim[7] = loadPng("romfs/gfx/jumpscare/chica/7.png");
-            jumpscareAnim[8] = loadPng("romfs/gfx/jumpscare/chica/8.png");
-            loaded = true;
+        // ==============================
+        // Reserve
+        // ==============================
+        // A character one step from its door has its set made ready here by
+        // a thread below the main one, so it only runs while the frame waits
+        // on vblank: the .jsq file if there is one, else the PNG frames. Two
+        // slots: one per door. The lock covers the slots; work finished for a
+        // slot that was discarded meanwhile is freed unused. Those loads and
+        // frees count into imageRamAlloc from the worker, which image.c's
+        // ADD_BYTES keeps whole against the main thread's own.
+        static constexpr int kReserveSlots = 2;
+        struct Reserve {
+            int which;          // whichJumpscare value, 0 = free
+            int generation;     // bumped on every claim and discard
+            bool triedSequence; // looked for a .jsq already
+            Sequence* sequence; // the .jsq, read but not decoded
+            int ready;          // else PNG frames 0..ready-1 are in
+            Image* frames[9];
+        };
+        static Reserve reserve[kReserveSlots];
+        static SceUID reserveLock = -1;
+        static SceUID reserveSignal = -1;
+        static SceUID reserveThread = -1;
+        static int reserveBytes = 0;
+        static int reservePeak = 0;
+        static int shownWarm = 0, shownPartial = 0, shownCold = 0;
+
+        static inline void lockReserve()   { sceKernelWaitSema(reserveLock, 1, nullptr); }
+        static inline void unlockReserve() { sceKernelSignalSema(reserveLock, 1); }
+
+        static inline bool slotDone(const Reserve& slot) {
+            return slot.sequence || slot.ready >= 9;
         }
 
-        void loadFoxy() {
-            unloadFrames();
-            jumpscareAnim[0] = loadPng("romfs/gfx/jumpscare/foxy/0.png");
-            jumpscareAnim[1] = loadPng("romfs/gfx/jumpscare/foxy/1.png");
-            jumpscareAnim[2] = loadPng("romfs/gfx/jumpscare/foxy/2.png");
-            jumpscareAnim[3] = loadPng("romfs/gfx/jumpscare/foxy/3.png");
-            jumpscareAnim[4] = loadPng("romfs/gfx/jumpscare/foxy/4.png");
-            jumpscareAnim[5] = loadPng("romfs/gfx/jumpscare/foxy/5.png");
-            jumpscareAnim[6] = loadPng("romfs/gfx/jumpscare/foxy/6.png");
-            jumpscareAnim[7] = loadPng("romfs/gfx/jumpscare/foxy/7.png");
-            jumpscareAnim[8] = loadPng("romfs/gfx/jumpscare/foxy/8.png");
-            loaded = true;
+        // Caller holds the lock
+        static void clearSlot(Reserve& slot) {
+            for (int i = 0; i < slot.ready; ++i) {
+                reserveBytes -= imageDataBytes(slot.frames[i]);
+                freeImageSafe(slot.frames[i]);
+            }
+            if (slot.sequence) {
+                reserveBytes -= sequenceBytes(slot.sequence);
+                freeSequence(slot.sequence);
+                slot.sequence = nullptr;
+            }
+            slot.which = 0;
+            slot.ready = 0;
+            slot.triedSequence = false;
+            slot.generation++;
+        }
+
+        static int reserveWorker(SceSize, void*) {
+            for (;;) {
+                sceKernelWaitSema(reserveSignal, 1, nullptr);
+                for (;;) {
+                    lockReserve();
+                    int index = -1;
+                    for (int s = 0; s < kReserveSlots; ++s) {
+                        if (reserve[s].which && !slotDone(reserve[s])) { index = s; break; }
+                    }
+                    if (index < 0) { unlockReserve(); break; }
+                    const int which = reserve[index].which;
+                    const int generation = reserve[index].generation;
+                    const bool trySequence = !reserve[index].triedSequence;
+                    const int frame = reserve[index].ready;
+                    unlockReserve();
+
+                    Sequence* opened = nullptr;
+                    Image* image = nullptr;
+                    if (trySequence) {
+                        opened = openSequence(which);
+                    } else {
+                        char path[48];
+                        snprintf(path, sizeof(path), "romfs/gfx/jumpscare/%s/%d.png", names[which], frame);
+                        image = loadPng(path);
+                    }
+
+                    lockReserve();
+                    Reserve& slot = reserve[index];
+                    if (slot.generation != generation) {
+                        // Retreated while we worked; drop it below
+                    } else if (trySequence) {
+                        slot.triedSequence = true;
+                        slot.sequence = opened;
+                        if (opened) reserveBytes += sequenceBytes(opened);
+                        opened = nullptr;
+                    } else if (!image) {
+                        clearSlot(slot); // leave it cold rather than retry forever
+                    } else {
+                        slot.frames[frame] = image;
+                        slot.ready++;
+                        reserveBytes += imageDataBytes(image);
+                        image = nullptr;
+                    }
+                    if (reserveBytes > reservePeak) reservePeak = reserveBytes;
+                    unlockReserve();
+                    freeImageSafe(image);
+                    freeSequence(opened);
+                }
+            }
+            return 0;
+        }
+
+        static void ensureReserveWorker() {
+            if (reserveLock < 0) {
+                reserveLock = sceKernelCreateSema("jumpscare_reserve", 0, 1, 1, nullptr);
+            }
+            if (reserveSignal < 0) {
+                reserveSignal = sceKernelCreateSema("jumpscare_warm", 0, 0, 8, nullptr);
+            }
+            if (reserveThread < 0) {
+                const int prio  = 0x30;    // below main (0x20): idle time only
+                const int stack = 0x4000;  // PNG decode needs more than the reload worker
+                reserveThread = sceKernelCreateThread("jumpscare_reserve", reserveWorker, prio, stack, 0, NULL);
+                if (reserveThread >= 0) sceKernelStartThread(reserveThread, 0, NULL);
+            }
+        }
+
+        void warm(int which) {
+            if (which < 1 || which > 4) return;
+            ensureReserveWorker();
+            lockReserve();
+            int open = -1;
+            for (int s = 0; s < kReserveSlots; ++s) {
+                if (reserve[s].which == which) { unlockReserve(); return; }
+                if (!reserve[s].which && open < 0) open = s;
+            }
+            if (open >= 0) {
+                reserve[open].which = which;
+                reserve[open].ready = 0;
+                reserve[open].generation++;
+            }
+            unlockReserve();
+            if (open >= 0) sceKernelSignalSema(reserveSignal, 1);
+        }
+
+        void discard(int which) {
+            if (reserveLock < 0) return;
+            lockReserve();
+            for (int s = 0; s < kReserveSlots; ++s) {
+                if (reserve[s].which && (which == 0 || reserve[s].which == which)) clearSlot(reserve[s]);
+            }
+            unlockReserve();
+        }
+
+        // Moves what the reserve holds for whichJumpscare into the animation
+        // and frees the rest; false if it had nothing
+        static bool adoptReserve() {
+            if (reserveLock < 0) return false;
+            lockReserve();
+            for (int s = 0; s < kReserveSlots; ++s) {
+                Reserve& slot = reserve[s];
+                if (slot.which != whichJumpscare) continue;
+                if (slot.sequence) {
+                    reserveBytes -= sequenceBytes(slot.sequence);
+                    sequence = slot.sequence;
+                    slot.sequence = nullptr;
+                }
+                for (int i = 0; i < slot.ready; ++i) {
+                    reserveBytes -= imageDataBytes(slot.frames[i]);
+                    jumpscareAnim[i] = slot.frames[i];
+                    slot.frames[i] = nullptr;
+                }
+                framesLoaded = slot.ready;
+                slot.ready = 0;
+                break;
+            }
+            for (int s = 0; s < kReserveSlots; ++s) {
+                if (reserve[s].which) clearSlot(reserve[s]);
+            }
+            unlockReserve();
+            loaded = framesLoaded > 0;
+            return loaded || sequence;
         }
 
         void loadJumpscare() {
-            // CRITICAL: Add atomic loading to prevent race conditions
-            // Set loaded to false first to prevent rendering during load
-            loaded = false;
-            
             // Always unload the previous set before loading a new one
             unloadFrames();
 
-            if (whichJumpscare == 1)      loadFreddy();
-            else if (whichJumpscare == 2) loadBonnie();
-            else if (whichJumpscare == 3) loadChica();
-            else if (whichJumpscare == 4) loadFoxy();
-            
-            // Only set loaded to true after all frames are loaded
-            // This prevents accessing partially loaded sprite arrays
+            const bool known = whichJumpscare >= 1 && whichJumpscare <= 4;
+            snprintf(who, sizeof(who), "%s", known ? names[whichJumpscare] : "");
+
+            // Whatever the reserve made ready is taken as it is
+            const bool warmed = adoptReserve();
+            if (warmed && (sequence || framesLoaded >= 9)) shownWarm++;
+            else if (warmed) shownPartial++;
+            else shownCold++;
+            memory::reportJumpscareReserve(shownWarm, shownPartial, shownCold, reservePeak);
+
+            if (!warmed && known) sequence = openSequence(whichJumpscare);
+
+            // Only the first frame now, so it is on screen next frame; the
+            // rest follow through loadNextFrame(), one per presented frame,
+            // well ahead of an animation that holds each frame for three
+            if (!framesLoaded) loadNextFrame(0);
         }
 
         void unloadJumpscare() {
@@ -706,31 +849,42 @@ namespace text {
         Image* nightNumbersPixel[10]  = {nullptr};
         Image* symbols = nullptr;
 
-        void loadNightText() {
-            nightNumbersNormal[0] = loadPng("romfs/gfx/global/numbers/normal/0-2.png");
-            nightNumbersNormal[1] = loadPng("romfs/gfx/global/numbers/normal/1.png");
-            nightNumbersNormal[2] = loadPng("romfs/gfx/global/numbers/normal/2.png");
-            nightNumbersNormal[3] = loadPng("romfs/gfx/global/numbers/normal/3.png");
-            nightNumbersNormal[4] = loadPng("romfs/gfx/global/numbers/normal/4.png");
-            nightNumbersNormal[5] = loadPng("romfs/gfx/global/numbers/normal/5.png");
-            nightNumbersNormal[6] = loadPng("romfs/gfx/global/numbers/normal/6.png");
-            nightNumbersNormal[7] = loadPng("romfs/gfx/global/numbers/normal/7.png");
-            nightNumbersNormal[8] = loadPng("romfs/gfx/global/numbers/normal/8.png");
-            nightNumbersNormal[9] = loadPng("romfs/gfx/global/numbers/normal/9.png");
-
-            nightNumbersPixel[0] = loadPng("romfs/gfx/global/numbers/pixel/0.png");
-            nightNumbersPixel[1] = loadPng("romfs/gfx/global/numbers/pixel/1.png");
-            nightNumbersPixel[2] = loadPng("romfs/gfx/global/numbers/pixel/2.png");
-            nightNumbersPixel[3] = loadPng("romfs/gfx/global/numbers/pixel/3.png");
-            nightNumbersPixel[4] = loadPng("romfs/gfx/global/numbers/pixel/4.png");
-            nightNumbersPixel[5] = loadPng("romfs/gfx/global/numbers/pixel/5.png");
-            nightNumbersPixel[6] = loadPng("romfs/gfx/global/numbers/pixel/6.png");
-            nightNumbersPixel[7] = loadPng("romfs/gfx/global/numbers/pixel/7.png");
-            nightNumbersPixel[8] = loadPng("romfs/gfx/global/numbers/pixel/8.png");
-            nightNumbersPixel[9] = loadPng("romfs/gfx/global/numbers/pixel/9.png");
+        void loadNormalNumbers() {
+            static const char* const normalPaths[10] = {
+                "romfs/gfx/global/numbers/normal/0-2.png",
+                "romfs/gfx/global/numbers/normal/1.png",
+                "romfs/gfx/global/numbers/normal/2.png",
+                "romfs/gfx/global/numbers/normal/3.png",
+                "romfs/gfx/global/numbers/normal/4.png",
+                "romfs/gfx/global/numbers/normal/5.png",
+                "romfs/gfx/global/numbers/normal/6.png",
+                "romfs/gfx/global/numbers/normal/7.png",
+                "romfs/gfx/global/numbers/normal/8.png",
+                "romfs/gfx/global/numbers/normal/9.png"
+            };
+            loadPngBatch(normalPaths, nightNumbersNormal, 10);
+        }
+        void loadPixelNumbers() {
+            static const char* const pixelPaths[10] = {
+                "romfs/gfx/global/numbers/pixel/0.png",
+                "romfs/gfx/global/numbers/pixel/1.png",
+                "romfs/gfx/global/numbers/pixel/2.png",
+                "romfs/gfx/global/numbers/pixel/3.png",
+                "romfs/gfx/global/numbers/pixel/4.png",
+                "romfs/gfx/global/numbers/pixel/5.png",
+                "romfs/gfx/global/numbers/pixel/6.png",
+                "romfs/gfx/global/numbers/pixel/7.png",
+                "romfs/gfx/global/numbers/pixel/8.png",
+                "romfs/gfx/global/numbers/pixel/9.png"
+            };
+            loadPngBatch(pixelPaths, nightNumbersPixel, 10);
 
             symbols = loadPng("romfs/gfx/global/numbers/symbols/%.png");
         }
+        void loadNightText() {
+            loadNormalNumbers();
+            loadPixelNumbers();
+        }
         void unloadNightText() {
             freeImageArray(nightNumbersNormal);
             freeImageArray(nightNumbersPixel);
@@ -748,149 +902,56 @@ namespace text {
         static size_t lastJumpscarePreCachedBytes = 0;
         
         void preloadCameraAssets() {
-            // ULTRA-AGGRESSIVE: Pre-cache ALL camera graphics for zero-latency
-            // This eliminates ANY potential loading stutter when switching cameras
-            // Now includes BOTH main/ AND animatronic/ images for complete coverage!
-            // Total size: ~1.5 MB (main + animatronic) - well within our 60MB budget!
-            
-            size_t preCachedBytes = 0;
-            
-            // Pre-cache all main camera images (11 cameras)
-            const char* mainCams[] = {
-                "cam1a", "cam1b", "cam1c", "cam2a", "cam2b", 
-                "cam3", "cam4a", "cam4b", "cam5", "cam6", "cam7"
+            // Pre-cache every camera feed, main/ and animatronic/, so the first
+            // switch to each doesn't stall. The images are only loaded to warm
+            // the file cache, so they go through loadPngBatch a few at a time and
+            // each chunk is freed before the next: at most kChunk decoded
+            // feeds (~500KB each) are held at once, never all 35.
+            static constexpr int kChunk = 4;
+            static const char* const paths[] = {
+                "romfs/gfx/office/camera/main/cam1a.png", "romfs/gfx/office/camera/main/cam1b.png",
+                "romfs/gfx/office/camera/main/cam1c.png", "romfs/gfx/office/camera/main/cam2a.png",
+                "romfs/gfx/office/camera/main/cam2b.png", "romfs/gfx/office/camera/main/cam3.png",
+                "romfs/gfx/office/camera/main/cam4a.png", "romfs/gfx/office/camera/main/cam4b.png",
+                "romfs/gfx/office/camera/main/cam5.png", "romfs/gfx/office/camera/main/cam6.png",
+                "romfs/gfx/office/camera/main/cam7.png",
+                "romfs/gfx/office/camera/animatronic/cam1a/cam1a-empty.png",
+                "romfs/gfx/office/camera/animatronic/cam1a/cam1a-freddy.png",
+                "romfs/gfx/office/camera/animatronic/cam1a/cam1a-freddy&bonnie.png",
+                "romfs/gfx/office/camera/animatronic/cam1a/cam1a-freddy&chica.png",
+                "romfs/gfx/office/camera/animatronic/cam1a/cam1a-freddyStare.png",
+                "romfs/gfx/office/camera/animatronic/cam1b/cam1b-bonnie.png",
+                "romfs/gfx/office/camera/animatronic/cam1b/cam1b-chica.png",
+                "romfs/gfx/office/camera/animatronic/cam1b/cam1b-freddy.png",
+                "romfs/gfx/office/camera/animatronic/cam1c/cam1c-foxy1.png",
+                "romfs/gfx/office/camera/animatronic/cam1c/cam1c-foxy2.png",
+                "romfs/gfx/office/camera/animatronic/cam1c/cam1c-foxy3.png",
+                "romfs/gfx/office/camera/animatronic/cam2a/cam2a-bonnie.png",
+                "romfs/gfx/office/camera/animatronic/cam2b/cam2b-bonnie.png",
+                "romfs/gfx/office/camera/animatronic/cam3/cam3-bonnie.png",
+                "romfs/gfx/office/camera/animatronic/cam4a/cam4a-chica.png",
+                "romfs/gfx/office/camera/animatronic/cam4a/cam4a-chicaclose.png",
+                "romfs/gfx/office/camera/animatronic/cam4a/cam4a-freddy.png",
+                "romfs/gfx/office/camera/animatronic/cam4b/cam4b-chica.png",
+                "romfs/gfx/office/camera/animatronic/cam4b/cam4b-freddy.png",
+                "romfs/gfx/office/camera/animatronic/cam5/cam5-bonnie.png",
+                "romfs/gfx/office/camera/animatronic/cam5/cam5-bonnieclose.png",
+                "romfs/gfx/office/camera/animatronic/cam7/cam7-chica.png",
+                "romfs/gfx/office/camera/animatronic/cam7/cam7-chicaclose.png",
+                "romfs/gfx/office/camera/animatronic/cam7/cam7-freddy.png",
             };
-            for (int i = 0; i < 11; ++i) {
-                std::string path = "romfs/gfx/office/camera/main/" + std::string(mainCams[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    // This avoids race conditions with the main game loop
-                    preCachedBytes += 25000; // Average estimate
-                    freeImageSafe(img); // Load and immediately free to pre-cache
-                }
-            }
-            
-            // Pre-cache ALL animatronic camera images for complete coverage
-            // This ensures zero-latency when animatronics move between cameras
-            
-            // Cam 1A animatronic images
-            const char* cam1a_anim[] = {"cam1a-empty", "cam1a-freddy", "cam1a-freddy&bonnie", "cam1a-freddy&chica", "cam1a-freddystare"};
-            for (int i = 0; i < 5; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam1a/" + std::string(cam1a_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000; // Estimate per image
-                    freeImageSafe(img); // Load and immediately free to pre-cache
-                }
-            }
-            
-            // Cam 1B animatronic images
-            const char* cam1b_anim[] = {"cam1b-bonnie", "cam1b-chica", "cam1b-freddy"};
-            for (int i = 0; i < 3; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam1b/" + std::string(cam1b_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000;
-                    freeImageSafe(img);
-                }
-            }
-            
-            // Cam 1C animatronic images (Foxy)
-            const char* cam1c_anim[] = {"cam1c-foxy1", "cam1c-foxy2", "cam1c-foxy3"};
-            for (int i = 0; i < 3; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam1c/" + std::string(cam1c_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000;
-                    freeImageSafe(img);
-                }
-            }
-            
-            // Cam 2A animatronic images
-            const char* cam2a_anim[] = {"cam2a-bonnie"};
-            for (int i = 0; i < 1; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam2a/" + std::string(cam2a_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000;
-                    freeImageSafe(img);
-                }
-            }
-            
-            // Cam 2B animatronic images
-            const char* cam2b_anim[] = {"cam2b-bonnie"};
-            for (int i = 0; i < 1; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam2b/" + std::string(cam2b_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000;
-                    freeImageSafe(img);
-                }
-            }
-            
-            // Cam 3 animatronic images
-            const char* cam3_anim[] = {"cam3-bonnie"};
-            for (int i = 0; i < 1; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam3/" + std::string(cam3_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000;
-                    freeImageSafe(img);
-                }
-            }
-            
-            // Cam 4A animatronic images
-            const char* cam4a_anim[] = {"cam4a-chica", "cam4a-chicaclose", "cam4a-freddy"};
-            for (int i = 0; i < 3; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam4a/" + std::string(cam4a_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000;
-                    freeImageSafe(img);
-                }
-            }
-            
-            // Cam 4B animatronic images
-            const char* cam4b_anim[] = {"cam4b-chica", "cam4b-freddy"};
-            for (int i = 0; i < 2; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam4b/" + std::string(cam4b_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000;
-                    freeImageSafe(img);
-                }
-            }
-            
-            // Cam 5 animatronic images
-            const char* cam5_anim[] = {"cam5-bonnie", "cam5-bonnieclose"};
-            for (int i = 0; i < 2; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam5/" + std::string(cam5_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000;
-                    freeImageSafe(img);
-                }
-            }
-            
-            // Cam 7 animatronic images
-            const char* cam7_anim[] = {"cam7-chica", "cam7-chicaclose", "cam7-freddy"};
-            for (int i = 0; i < 3; ++i) {
-                std::string path = "romfs/gfx/office/camera/animatronic/cam7/" + std::string(cam7_anim[i]) + ".png";
-                Image* img = loadPng(path.c_str());
-                if (img) {
-                    // SAFER: Just load and free without queueRetire during pre-caching
-                    preCachedBytes += 50000;
-                    freeImageSafe(img);
+            static constexpr int kMainCams = 11;
+            static constexpr int kCount = sizeof(paths) / sizeof(paths[0]);
+
+            size_t preCachedBytes = 0;
+            Image* chunk[kChunk];
+            for (int first = 0; first < kCount; first += kChunk) {
+                int count = kCount - first < kChunk ? kCount - first : kChunk;
+                loadPngBatch(paths + first, chunk, count);
+                for (int i = 0; i < count; ++i) {
+                    if (!chunk[i]) continue;
+                    preCachedBytes += first + i < kMainCams ? 25000 : 50000; // Estimates
+                    freeImageSafe(chunk[i]);
                 }
             }
             
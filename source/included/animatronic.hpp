@@ -7,6 +7,8 @@
 #include "save.hpp"
 #include "state.hpp"
 #include "jumpscare.hpp"
+#include "scheduler.hpp"
+#include "snapshot.hpp"
 
 // Optional: set to 1 if you must match std::rand() semantics/seeding.
 // Default (0) uses a faster xorshift RNG internally for performance.
@@ -32,7 +34,26 @@ namespace animatronic {
 
     extern bool unloaded;
 
-    extern int waitBeforeForceReset;
+    enum Id { kFreddy, kBonnie, kChica, kFoxy, kCount };
+
+    static constexpr int kMaxLevel = 20;
+
+    // Every animatronic's state, one array per field indexed by Id. Positions
+    // count up the path to the office door; anything past the door is a side room.
+    struct Table {
+        signed char position[kCount];
+        signed char level[kCount];        // AI level, 0..kMaxLevel
+        unsigned char roll[kCount];       // d20 of the last opportunity
+        bool atDoor[kCount];
+        bool inOtherRoom[kCount];
+        scheduler::Timer opportunity[kCount];
+    };
+    extern Table table;
+
+    // AI clock: advanced once per office frame unless Foxy's attack pauses the AI.
+    // Each animatronic keeps a timer on it for its next movement opportunity;
+    // a custom character only has to schedule its own.
+    extern scheduler::Wheel ai;
 
     void reset();
     void resetForDeath(); // Enhanced reset for death transitions to prevent deadlock inheritance
@@ -40,110 +61,14 @@ namespace animatronic {
     int reloadCams(SceSize args, void* argp);
     void setReload();
     void runAiLoop();
-    void unloadMain();
-    void initJumpscare();
-
-    // Freddy
-    namespace freddy {
-        extern int levelOnes;
-        extern int levelTenths;
-        extern float totalLevel;
-        extern float position;
-        extern int delay;
-        extern bool atDoor;
-
-        void wait();
-        void incrementDifficulty();
-        void generateRandom();
-        void evaluateMovement();
-        bool shouldMoveOrAttack();
-        void decideNextMove();
-        void handleAtDoor();
-        void triggerJumpscare();
-        void blockAttack();
-        void moveForward();
-        void reloadPosition();
-    }
-
-    // Bonnie
-    namespace bonnie {
-        extern int levelOnes;
-        extern int levelTenths;
-        extern float totalLevel;
-        extern float position;
-        extern int delay;
-        extern bool atDoor;
-        extern bool inOtherRoom;
-
-        void wait();
-        void incrementDifficulty();
-        void generateRandom();
-        void processMovementDecision();
-        bool shouldMoveOrAttack();
-        void resetToStart();
-        void evaluateOpportunity();
-        void moveToRoom(int targetRoom);
-        void handleAtDoor();
-        void triggerJumpscare();
-        void blockAttack();
-        void moveForward();
-        void reloadPosition();
-    }
-
-    // Chika
-    namespace chika {
-        extern int levelOnes;
-        extern int levelTenths;
-        extern float totalLevel;
-        extern float position;
-        extern int delay;
-        extern bool atDoor;
-        extern bool inOtherRoom;
-
-        void wait();
-        void incrementDifficulty();
-        void generateRandom();
-        void processMovementDecision();
-        bool shouldMoveOrAttack();
-        void resetToStart();
-        void evaluateOpportunity();
-        void moveToRoom(int targetRoom);
-        void handleAtDoor();
-        void triggerJumpscare();
-        void blockAttack();
-        void moveForward();
-        void reloadPosition();
-    }
-
-    // Foxy
-    namespace foxy {
-        extern int levelOnes;
-        extern int levelTenths;
-        extern float totalLevel;
-        extern float position;
-        extern int delay;
-        extern bool atDoor;
-
-        void wait();
-        void incrementDifficulty();
-        void generateRandomEvent();
-        void processRandomEvent();
-        bool shouldMoveOrAttack();
-        void attemptMoveOrAttack();
-        void handleAtDoor();
-        void handleAttackFrame();
-        void handleMovement();
-        void triggerJumpscare();
-        void blockAttack();
-        void resetToIdle();
-        void resetAttackState();
-        void reloadPosition();
-
-        // Returns the global animatronic::isMoving flag.
-        bool isMoving();
-    }
 
+    void incrementDifficulty(int id);
     void setDefault();
+
+    // Table, timers, Foxy's run and the RNG; restoring also re-points the
+    // camera sprites and queues a camera reload
+    void saveSnapshot(snapshot::Writer& out);
+    void restoreSnapshot(snapshot::Reader& in);
 }
 
-#endif // ANIMATRONIC_HPP
\ No newline at end of file
+#endif // ANIMATRONIC_HPP
@@ -1,6 +1,11 @@
 #include "global.hpp"
 #include "save.hpp"
 
+namespace audio{
+    // Bytes of audio currently held in RAM (stream buffers + resident sounds)
+    size_t residentBytes();
+}
+
 namespace music{
     namespace menu{
         void loadMenuMusic();
@@ -85,7 +90,7 @@ namespace sfx{
     }
     namespace sixam{
 
-        extern OSL_SOUND* ding;
+        extern OSL_SOUND* chimes;
 
         void loadSixAm();
         void unloadSixAm();
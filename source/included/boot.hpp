@@ -0,0 +1,27 @@
+#pragma once
+
+#include "global.hpp"
+
+// Staged boot. The menu's first frame needs only background frame 0 and the
+// logo: begin() loads those, enters the menu and leaves the rest to a thread
+// below the main one, most wanted first. The menu text and cursor come first,
+// and the menu takes input once they are in. Then come the night number, the
+// star, the copyright, the other background frames, the static and the
+// office's numbers. The music is attached on the main thread once the menu
+// is interactive. Drawing skips images that are not in yet.
+namespace boot {
+    // After the save is read; originMicros is when main() started
+    void begin(unsigned int originMicros);
+    // The images every state shares (static, numbers), all at once, for a
+    // boot that goes straight to the office
+    void loadShared();
+
+    bool interactive();
+    // Waits for the rest; before leaving the menu, whose groups the next
+    // state frees
+    void finish();
+
+    // Once per frame after the swap: attaches the music when due, and reports
+    // time to first frame, to interactive and to fully loaded once all is in
+    void postFrame();
+}
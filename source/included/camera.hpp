@@ -2,6 +2,7 @@
 #include "image2.hpp"
 #include "audio.hpp"
 #include "office.hpp"
+#include "snapshot.hpp"
 
 namespace camera{
     extern volatile int whichCamera; // volatile for thread safety
@@ -9,11 +10,14 @@ namespace camera{
 
     extern volatile bool opening; // volatile for thread safety
     extern volatile bool closing; // volatile for thread safety
-
-    extern std::string buttonState; // thread safety handled differently for strings
+    extern volatile int whichFrame; // camera flip animation
 
     void reset();
 
+    // Which camera, whether it is up, and the flip mid-animation
+    void saveSnapshot(snapshot::Writer& out);
+    void restoreSnapshot(snapshot::Reader& in);
+
     namespace render{
         void renderCamFlip();
         void renderCamera();
@@ -8,6 +8,10 @@
 namespace customnight{
 
     void reset();
+
+    // The survival estimates, while the custom night screen is up
+    void loadTable();
+    void unloadTable();
     
     namespace render {
         // Helper function to draw sprites with null checks
@@ -20,6 +24,7 @@ namespace customnight{
         void renderArrows();
         void renderText();
         void renderLevels();
+        void renderEstimate();   // survival chance from tools/nightsim
         void renderActions();
         void renderGoldenFreddy();
     }
@@ -27,8 +32,6 @@ namespace customnight{
     namespace edit{
         void plus();
         void minus();
-
-        void editValue();
     }
 
     namespace reticle{
@@ -7,10 +7,10 @@
 
 namespace dead{
 
-    // Call after guSwapBuffers (deferred transition)
-    void postFrame();
-    
     void reset();
+
+    // State hook: static and the dead sound
+    void enter();
     
     namespace n_static{
         void renderStatic();
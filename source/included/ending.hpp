@@ -3,22 +3,22 @@
 #include "audio.hpp"
 #include "menu.hpp"
 #include "save.hpp"
+#include "state.hpp"
 
 namespace ending {
 
-    // Call after guSwapBuffers (deferred transition)
-    void postFrame();
-
     // Reset the ending state/timer
     void reset();
 
+    // State hook: the ending music
+    void enter();
+
     namespace render {
         void renderEnding();
     }
 
     namespace wait {
         void waitForFrames();
-        // Now acts as a scheduler; actual work done in postFrame()
         void initMenu();
     }
 }
\ No newline at end of file
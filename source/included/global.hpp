@@ -33,6 +33,13 @@ using namespace std;
 // Debug logging control - set to 0 to disable all debug prints for release
 #define DEBUG_LOGGING 0
 
+// Set to 1 to time each press to the vblank that first shows it (see input::presented)
+#define INPUT_LATENCY 0
+
+// Set to 1 to sample the pad and build each frame as late before vblank as
+// recent frames allow, instead of straight after the last swap
+#define LOW_LATENCY_PRESENT 0
+
 #if DEBUG_LOGGING
     #define DEBUG_PRINTF(...) printf(__VA_ARGS__)
 #else
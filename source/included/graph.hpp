@@ -0,0 +1,81 @@
+#pragma once
+
+#include "global.hpp"
+
+// Movement graph: for every animatronic one node per position saying where it
+// goes from there, and for every camera the rules picking its image from where
+// everyone stands. load() reads romfs/ai/map.bin, which `make assets` compiles
+// from romfs/ai/map.txt with tools/mapc, so maps and characters can change
+// without rebuilding the engine; a built-in copy of map.txt is the fallback.
+namespace graph {
+    static constexpr int kCharacters = 4;   // one per animatronic::Id
+    static constexpr int kMaxNodes = 16;    // positions 0..15
+    static constexpr int kCameras = 11;
+    static constexpr int kMaxRules = 96;
+    static constexpr int kMaxClauses = 4;
+    static constexpr int kMaxStringBytes = 2048;
+
+    enum NodeFlags {
+        kDoor    = 1 << 0, // attacks from here
+        kSide    = 1 << 1, // off the path to the door; the watchdog leaves it alone
+        kReturn  = 1 << 2, // walks back to next, if a detour brought it here
+        kWatched = 1 << 3, // steps forward even while the player is on the cameras
+        kPushed  = 1 << 4, // moves whatever the roll (kRuns: whenever nothing is moving)
+    };
+
+    enum CharacterFlags {
+        kLaughs      = 1 << 0, // plays the laugh when it steps forward
+        kNeedsCams   = 1 << 1, // only gets in while the player is on the cameras
+        kForgetsRoom = 1 << 2, // loses track of its side room at every opportunity
+        kRuns        = 1 << 3, // Foxy: a roll equal to the level still counts and the
+                               // door starts a timed run instead of an attack
+    };
+
+    enum Door { kLeftDoor, kRightDoor };
+
+    struct Node {
+        signed char next;        // forward step, or where kReturn walks back to
+        unsigned char flags;
+        signed char detourRoll;  // -1 for none
+        signed char detourTo;
+    };
+
+    struct Character {
+        char name[12];
+        unsigned short period;   // frames between movement opportunities
+        signed char door;        // position it attacks from
+        signed char blockedTo;   // where a closed door sends it back to
+        unsigned char side;      // Door
+        unsigned char flags;
+        Node nodes[kMaxNodes];
+    };
+
+    // Camera images: the first rule of a camera whose clauses all hold wins
+    enum Var { kVarFreddy, kVarBonnie, kVarChica, kVarFoxy, kVarNight, kVarCount };
+    enum Op { kEq, kNe, kLt, kGt };
+
+    struct Clause {
+        unsigned char var;
+        unsigned char op;
+        signed char value;
+    };
+
+    struct Rule {
+        const char* image;       // under romfs/gfx/office/camera/, without .png
+        unsigned char clauses;
+        Clause clause[kMaxClauses];
+    };
+
+    // false keeps the built-in graph
+    bool load(const char* path);
+    bool loadedFromFile();
+
+    extern const Character* characters; // kCharacters, indexed by animatronic::Id
+
+    inline const Node& node(int id, int position) {
+        return characters[id].nodes[position < 0 ? 0 : (position >= kMaxNodes ? kMaxNodes - 1 : position)];
+    }
+
+    // vars holds kVarCount values: the four positions and the night
+    const char* cameraImage(int camera, const int* vars);
+}
@@ -57,6 +57,8 @@ typedef struct Image
         int format;		// default is GU_COLOR_8888
         Color* data;
         Color* palette;	// used for 4 bpp and 8bpp modes.
+        Color* vramData;	// resident VRAM copy of data, or 0
+        int lastUsed;	// frame number of the last draw, for VRAM LRU
         char filename[256];	// for debug purposes
 } Image;
 /* typedef struct ImageMip
@@ -73,12 +75,55 @@ typedef struct Image
         char filename[256];	// for debug purposes
 } ImageMip; */
 Image *loadPng(const char *filename);
+// Loads count images, overlapping the read of each file with the decode of the previous
+int loadPngBatch(const char *const *paths, Image **out, int count);
+#ifndef _PSP
+extern int imageBatchThreads;	// host builds decode a batch on this many threads, 0 for all cores
+#endif
 //ImageMip *loadPngMip(const char *filename);
 void freeImage(Image *image);
 //void freeImageMip(ImageMip *image);
 void resetVRam();
 void reportVRam();
 extern int swizzleToVRam;
+
+// 16-bit textures: loadPng picks 5650, 5551 or 4444 from the alpha histogram
+// unless romfs/gfx/formats.txt says otherwise. data then holds 16-bit texels.
+extern int textureAutoFormat;
+extern int textureDither;
+extern int imageRamAlloc;
+extern int imageBytesSaved;
+extern int imageBytesDecoded; // running total written by loads, for benchmarks
+int imageDataBytes(Image *image);
+int chooseImageFormat(Image *image);
+void convertImage16(Image *image,int format);
+
+// DXT: loadPng prefers a .dxt next to the .png (see tools/dxtenc.c).
+extern int textureCompressed;
+Image *loadDxt(const char *filename);
+
+// Animations as a keyframe plus changed tiles (see tools/jsqenc.c), rebuilt
+// frame by frame in two buffers instead of holding every frame.
+typedef struct Sequence Sequence;
+Sequence *loadSequence(const char *filename);	// reads the file, decodes nothing yet
+int sequenceFrames(Sequence *sequence);
+int sequenceBytes(Sequence *sequence);	// the file plus the buffers made so far
+Image *sequenceFrame(Sequence *sequence,int frame);
+void freeSequence(Sequence *sequence);
+
+// VRAM residency: textures drawn every frame are copied into free VRAM and
+// sampled from there; cold ones are evicted least-recently-used first.
+extern int vramResidency;
+extern int vramHits, vramMisses;
+Color *vramTouch(Image *image);
+void vramEndFrame();
+// The allocator underneath: best fit over the VRAM after the framebuffers,
+// neighbours merged on free
+void *allocVRam(int length);
+void freeVRam(void *address,int length);
+extern int availableVRam, biggestVRam;
+// Swizzle textures while they are decoded/converted instead of in a second pass
+extern int swizzleOnLoad;
 void swizzleFast(Image *source);
 //void swizzleFastMip(ImageMip *source);
 void saveImagePng(const char* filename, Color* data, int width, int height, int lineSize, int saveAlpha);
@@ -13,6 +13,8 @@ namespace image{
 
         void loadMenuBackground();
         void unloadMenuBackground();
+        // One frame, if it is not in yet; the staged boot brings them in one by one
+        void loadMenuBackgroundFrame(int frame);
 
         void loadLogo();
         void unloadLogo();
@@ -208,10 +210,19 @@ namespace sprite{
         extern Image *jumpscareAnim[9];
         extern int whichJumpscare;
 
-        extern bool loaded;
+        extern bool loaded;      // the first frame is in
+        extern int framesLoaded; // frames up to framesLoaded-1 have been decoded;
+                                 // from a .jsq only the last two are still kept
 
         void loadJumpscare();
+        // Decodes one more frame, given the frame on screen; true once all nine are done
+        bool loadNextFrame(int shown);
         void unloadJumpscare();
+
+        // Decodes a set in the background ahead of an attack, so
+        // loadJumpscare can start from it; discard(0) drops every set
+        void warm(int which);
+        void discard(int which);
     }
 }
 
@@ -232,8 +243,10 @@ namespace text{
         extern Image *nightNumbersPixel[10];
         extern Image *symbols;
 
-        void loadNightText();
+        void loadNightText(); // both sets and the symbols
         void unloadNightText();
+        void loadNormalNumbers(); // the menu's
+        void loadPixelNumbers();  // the office's, with the symbols
     }
     
     // Pre-caching System
@@ -0,0 +1,70 @@
+#pragma once
+
+// The pad, sampled once per frame. Gameplay reads bitmasks of PSP_CTRL_*
+// values: what is held, what went down this frame and what came up, so two
+// buttons at once are seen as two buttons. Edges are also kept as timestamped
+// events. sample() takes the raw bits, so a recorded stream can be fed through
+// it on the host.
+namespace input {
+    // Held buttons report again after delay frames, then every interval frames
+    struct Repeat {
+        int delay;
+        int interval;
+    };
+
+    struct Event {
+        unsigned int micros;  // when the frame sampled it
+        unsigned int frame;   // which sample
+        unsigned int button;  // one PSP_CTRL_* bit
+        bool down;
+    };
+
+    static constexpr int kEventLog = 64; // most recent edges kept
+
+    // Reads the pad; once per frame before the state runs
+    void poll();
+    // poll() without the pad: buttons are the raw bits, micros the time read
+    void sample(unsigned int buttons, unsigned int micros);
+    // Forgets everything, as if no button had ever been down
+    void reset();
+
+    unsigned int held();
+    unsigned int pressed();
+    unsigned int released();
+    unsigned int frame();
+
+    inline bool isHeld(unsigned int mask)     { return (held() & mask) != 0; }
+    inline bool isPressed(unsigned int mask)  { return (pressed() & mask) != 0; }
+    inline bool isReleased(unsigned int mask) { return (released() & mask) != 0; }
+
+    // Every button of mask is down and the last of them went down this frame
+    bool chord(unsigned int mask);
+
+    // A button of mask went down this frame, or has been held long enough to
+    // repeat on this one
+    bool repeated(unsigned int mask, const Repeat& repeat);
+
+    // Events oldest first; only the last kEventLog are kept
+    int eventCount();
+    const Event& event(int index);
+
+    // Input-to-screen latency. Call once per frame shown, with a value that
+    // changes whenever something a button controls changes on screen and the
+    // time of the vblank that put it there; a press is timed from half a
+    // driver cycle before its sample, where it lands on average, to the first
+    // frame shown with a different value. Presses that change nothing within
+    // kLatencyTimeout frames are dropped.
+    static constexpr int kLatencySamples = 128;
+    static constexpr int kLatencyTimeout = 30;
+    static constexpr unsigned int kVblankMicros = 16683; // sampling cycle 0
+
+    struct Latency {
+        int count;             // presses timed, at most kLatencySamples
+        unsigned int p50, p90, max;
+    };
+
+    void presented(unsigned int visible, unsigned int micros);
+    int latencyCount();
+    Latency latency();
+    void resetLatency();
+}
@@ -25,4 +25,17 @@ namespace memory {
     // Utility functions
     bool isMemoryBudgetOK();
     void printMemoryReport();
+    void reportTextureSavings(const char* stateName);
+    void reportAudioResident(const char* stateName, size_t bytes);
+    void reportAudioTiming(const char* what, unsigned int micros, int allocations);
+    void reportTransition(const char* from, const char* to, unsigned int frameMicros, unsigned int micros);
+    void reportRelease(const char* group, unsigned int micros);
+    void reportJumpscareReserve(int warm, int partial, int cold, int peakBytes);
+    void reportJumpscareFrame(int frame, unsigned int micros, int residentBytes);
+    void reportInputLatency(const char* mode, int presses, unsigned int p50, unsigned int p90, unsigned int max);
+    void reportSave(const char* what, unsigned int micros);
+    void reportSnapshot(int bytes);
+    void reportResume(int bytes, unsigned int micros);
+    void reportBootStep(const char* step, unsigned int micros);
+    void reportBootTimeline(unsigned int firstFrame, unsigned int interactive, unsigned int loaded);
 }
\ No newline at end of file
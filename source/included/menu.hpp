@@ -5,6 +5,9 @@
 #include "audio.hpp"
 
 namespace menu{
+    // State hook: cursor in place and menu music playing
+    void enter();
+
     namespace render{
         void renderBackground();
         void animateBackground();
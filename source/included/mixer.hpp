@@ -0,0 +1,59 @@
+#pragma once
+
+#include "global.hpp"
+
+// Software mixer: every stream sound is mixed into a fixed set of voices that
+// play through a single oslib channel. When all voices are busy the quietest
+// claim loses: the lowest priority voice, and among equals the oldest one, is
+// stolen for a sound of at least the same priority.
+//
+// Only the audio thread touches the voices. play / stop / pause post an event
+// to a lock-free queue that the mixer drains at the top of every block, so any
+// thread can trigger a sound; the same sound posted twice in one block plays once.
+namespace mixer {
+    enum Category { kMusic, kAmbience, kVoice, kSfx, kCategoryCount };
+
+    static constexpr int kVoices = 8;
+    static constexpr int kChannel = 0;       // the one oslib channel the mixer owns
+    static constexpr int kVolumeMax = 0x8000; // Q15 unity gain
+
+    void init();
+
+    // Makes a stream sound playable; returns s so loads can be wrapped in it
+    OSL_SOUND* attach(OSL_SOUND* s);
+
+    // Restarts s from the top on a voice. Returns false if the event was dropped;
+    // whether a voice is free is only known once the mixer gets to it. A streamed
+    // sound that is still playing restarts from the next collect() instead.
+    // pan runs from -kVolumeMax (left) to kVolumeMax (right).
+    bool play(OSL_SOUND* s, Category category, int priority, bool loop = false,
+              int volume = kVolumeMax, int pan = 0);
+    void stop(OSL_SOUND* s);
+    void pause(OSL_SOUND* s, bool paused);
+    // On a voice, or started and not yet seen by the mixer
+    bool playing(OSL_SOUND* s);
+
+    void setCategoryVolume(Category category, int volume);
+
+    // Deferred destruction: the object is destroyed by collect() once every mix
+    // that started before the call has finished, so nothing ever waits on the
+    // audio thread. release() detaches a sound and defers its oslDeleteSound;
+    // forget() only detaches one whose memory belongs to something else.
+    void release(OSL_SOUND* s);
+    void forget(OSL_SOUND* s);
+    void defer(void (*destroy)(void*), void* object);
+    void collect(); // once per frame; also restarts streamed sounds play() had to stop first
+    int pendingReleases();
+
+    // Voices taken from a playing sound, and plays refused for lack of a voice
+    extern volatile int steals;
+    extern volatile int rejected;
+
+    // Queue traffic: events accepted, folded into another in the same block,
+    // and lost to a full queue or a sound released in the meantime
+    extern volatile int eventsPosted;
+    extern volatile int eventsMerged;
+    extern volatile int eventsDropped;
+
+    void report(const char* stateName);
+}
@@ -9,9 +9,6 @@
 
 namespace nightinfo{
 
-// Call after guSwapBuffers (deferred transition)
-    void postFrame();
-
     void reset();
     
     namespace render{
@@ -1,14 +1,21 @@
+#pragma once
+
 #include "global.hpp"
 #include "audio.hpp"
 #include "image2.hpp"
 #include "animatronic.hpp"
+#include "snapshot.hpp"
 
 namespace office{
     extern int wichOfficeFrame;
-    extern std::string dir;
     extern std::string state;
-    extern std::string buttonState;
-    extern std::string doorButtonState;
+
+    // Which way the office image slides this frame
+    enum Scroll { kStill, kScrollLeft, kScrollRight };
+    extern Scroll scroll;
+    extern bool lightHeld; // the light button is down
+    extern int leftDoorFrame;
+    extern int rightDoorFrame;
 
     extern volatile int usageCountdown; // volatile for thread safety
     extern volatile bool leftEdge; // volatile for thread safety
@@ -26,6 +33,14 @@ namespace office{
 
     void reset();
 
+    // Scroll, lights, doors mid-swing and the scares already played; the
+    // buttons' frames and what is held follow from these and the pad
+    void saveSnapshot(snapshot::Writer& out);
+    void restoreSnapshot(snapshot::Reader& in);
+
+    // State hook: night settings, then ambience, fan and the phone call
+    void enter();
+    void exit();
 
     namespace render{
         void renderOffice();
@@ -5,6 +5,7 @@
 #include "state.hpp"
 
 #include "office.hpp"
+#include "snapshot.hpp"
 //#include "powerout.hpp"
 
 namespace power{
@@ -12,6 +13,10 @@ namespace power{
 
     void reset();
 
+    // Power left and the countdown to the next percent
+    void saveSnapshot(snapshot::Writer& out);
+    void restoreSnapshot(snapshot::Reader& in);
+
     namespace render{
         void renderPowerLeft();
     }
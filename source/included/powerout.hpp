@@ -12,12 +12,12 @@
 
 namespace powerout {
 
-    // Call after guSwapBuffers (deferred unload)
-    void postFrame();
-
     // Reset state for this system
     void reset();
 
+    // State hook: the music box starts once the lights are out
+    void enter();
+
     namespace render {
         void renderPowerout();
     }
@@ -1,5 +1,14 @@
+#pragma once
+
 #include "global.hpp"
 
+// Progress lives in one record, saves/save.bin: a version, a generation and
+// a CRC around the four values below. A write goes to saves/save.tmp first
+// and then takes save.bin's place by rename, so one cut short leaves the
+// previous record; loading takes the newest of the two that checks out.
+// Writes run on a thread below the main one, so the frame loop never waits
+// on the Memory Stick. The first boot that finds the old one-file-per-value
+// saves converts them once and deletes them.
 namespace save{
 
     extern int whichNight;
@@ -9,20 +18,30 @@ namespace save{
 
     extern bool loadedData;
 
-    extern std::string night;
-    extern std::string mode1;
-    extern std::string mode2;
-    extern std::string stars;
+    static constexpr int kVersion = 1;
+    static constexpr int kRecordBytes = 20;
+
+    struct Record {
+        unsigned int generation; // bumped by every write
+        unsigned char night;     // 1..5, the next night to play
+        unsigned char mode1;     // 6th night unlocked
+        unsigned char mode2;     // custom night unlocked
+        unsigned char stars;     // 0..3
+    };
+
+    // The on-disk form, no I/O; decode is false on a bad magic, version,
+    // size, CRC or value
+    void encode(const Record& record, unsigned char* out);
+    bool decode(const unsigned char* in, int bytes, Record& record);
+    unsigned int crc32(const unsigned char* data, int bytes);
 
+    // Reads the record the first time; then, except during the custom
+    // night, puts it back into the values above
     void file();
     void readData();
+    // Records the night just won and queues a write
     void saveData();
     void clearData();
-    
-    /*
-    void createFile();
-    void saveData();
-    void readData();
-    void loadData();
-    */
-}
\ No newline at end of file
+    // Returns once every queued write is on the Memory Stick
+    void flush();
+}
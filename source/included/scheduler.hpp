@@ -0,0 +1,63 @@
+#pragma once
+
+// Timer wheel for game-tick timers. A timer sits in the slot of the tick it is
+// due on, so advancing the clock only walks that slot: the cost per tick is the
+// timers expiring on it, not every timer that is counting down.
+//
+// Delays count ticks the same way the old per-frame countdowns did: a timer
+// scheduled with delay d fires on the (d + 1)th advance, and a periodic timer
+// is re-armed with its period before it fires.
+namespace scheduler {
+    struct Timer {
+        void (*fire)(Timer* timer);
+        int period;         // re-armed with this delay when it fires; 0 = one shot
+        int order;          // timers due on the same tick fire in ascending order
+
+        // Owned by the wheel
+        unsigned int due;
+        int remaining;      // ticks left while suspended
+        bool armed;
+        bool suspended;
+        Timer* next;
+        Timer* prev;
+    };
+
+    class Wheel {
+    public:
+        static constexpr int kSlots = 1024; // power of two, longer delays take extra laps
+
+        Wheel();
+
+        void schedule(Timer& timer, int delay);
+        void cancel(Timer& timer);
+
+        // A suspended timer keeps its remaining delay and does not count down
+        void suspend(Timer& timer) { if (timer.armed) park(timer); }
+        void resume(Timer& timer) { if (timer.suspended) schedule(timer, timer.remaining); }
+
+        // Ticks left before the advance that fires it, like the old countdown value; -1 if idle
+        int remaining(const Timer& timer) const;
+
+        // Moves the clock one tick and fires what is due; returns how many fired.
+        // Most ticks find their slot empty and stay inline.
+        int advance() {
+            ++tick;
+            return slots[tick & (kSlots - 1)] ? fireDue() : 0;
+        }
+
+        // Moves the clock over ticks the caller knows fire nothing (see remaining());
+        // for fast-forwarding a simulated night
+        void skip(int ticks) { tick += static_cast<unsigned int>(ticks); }
+
+        unsigned int now() const { return tick; }
+
+    private:
+        void link(Timer& timer);
+        void unlink(Timer& timer);
+        void park(Timer& timer);
+        int fireDue();
+
+        Timer* slots[kSlots];
+        unsigned int tick;
+    };
+}
@@ -12,11 +12,11 @@
 
 namespace sixam{
 
-    // Call after guSwapBuffers (deferred transition)
-    void postFrame();
-
     void reset();
 
+    // State hook: saves the night and plays the chime
+    void enter();
+
     namespace saveIt{
         void saveTheData();
     }
@@ -28,8 +28,6 @@ namespace sixam{
     }
     namespace next{
         void wait();
-        void resetGameScene();
-        void clearRest();
         void initNightinfo();
         void initEnding();
         void initMenu();
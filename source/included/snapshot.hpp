@@ -0,0 +1,77 @@
+#pragma once
+
+// Quick resume. Leaving the game mid-night (HOME, or the PSP suspending)
+// writes the whole night to saves/resume.bin: who stands where with what
+// level and how long until their next move, Foxy's run, power, the clock,
+// doors, lights and the camera. The next boot takes it and goes straight
+// into the office with only the office's manifest loaded, skipping the menu,
+// newspaper and nightinfo; the file is deleted as it is read, so a night is
+// resumed once. Each module writes and reads its own fields, in the same
+// order, through Writer and Reader.
+namespace snapshot {
+    static constexpr int kVersion = 1;
+    static constexpr int kMaxBytes = 256;
+
+    struct Writer {
+        unsigned char* at;
+        unsigned char* end;
+        bool overflow;
+
+        void u8(int value) {
+            if (at < end) *at++ = static_cast<unsigned char>(value);
+            else overflow = true;
+        }
+        void s16(int value) {
+            u8(value & 0xff);
+            u8((value >> 8) & 0xff);
+        }
+        void u32(unsigned int value) {
+            s16(value & 0xffff);
+            s16(value >> 16);
+        }
+        void flag(bool value) { u8(value ? 1 : 0); }
+    };
+
+    struct Reader {
+        const unsigned char* at;
+        const unsigned char* end;
+        bool overrun;
+
+        int u8() {
+            if (at < end) return *at++;
+            overrun = true;
+            return 0;
+        }
+        int s16() {
+            const int low = u8();
+            return static_cast<short>(low | (u8() << 8));
+        }
+        unsigned int u32() {
+            const unsigned int low = static_cast<unsigned short>(s16());
+            return low | (static_cast<unsigned int>(static_cast<unsigned short>(s16())) << 16);
+        }
+        bool flag() { return u8() != 0; }
+    };
+
+    // The night as it stands, framed with a magic, version, size and CRC;
+    // 0 if it does not fit
+    int capture(unsigned char* out, int capacity);
+    // The night capture() was given, or 0 if the bytes do not check out
+    int night(const unsigned char* in, int bytes);
+    // Puts every module back as captured; call once the office is entered.
+    // False when the body does not match the modules' fields, with them
+    // partly overwritten
+    bool restore(const unsigned char* in, int bytes);
+
+    // At boot: enters the office from saves/resume.bin if there is one, on
+    // the night it holds from the start if its body does not read back;
+    // false to start at the menu as usual
+    bool resume();
+
+    // From the exit or power callback: has the main thread write (or, when
+    // no night is being played, delete) the snapshot at the end of its
+    // frame, and waits up to timeoutMicros for it
+    void request(bool keep, unsigned int timeoutMicros);
+    // Call once per frame after state::postFrame
+    void postFrame();
+}
@@ -1,17 +1,52 @@
+#pragma once
+
 #include "global.hpp"
 
+// Game states and the transitions between them. Each state declares the asset
+// groups it needs (its manifest) plus optional enter, exit and postFrame hooks;
+// a transition frees what the next state does not declare and loads only what
+// it lacks, so screens no longer hand-write their own load and unload calls.
+// A state may also retain groups it does not draw, so a won night's office
+// waits through six am and nightinfo instead of being decoded again.
 namespace state{
-    extern bool isMenu;
-    extern bool isNewspaper;
-    extern bool isNightinfo;
-    extern bool isOffice;
-    extern bool isCustomNight;
-    extern bool isSixAm;
-    extern bool isPowerOut;
-    extern bool isDead;
-    extern bool isEnding;
-    extern bool isJumpscare;
-    extern volatile bool isFoxyAttackPaused; // volatile for thread safety
+    enum Id {
+        kMenu,
+        kNewspaper,
+        kNightinfo,
+        kOffice,
+        kCustomNight,
+        kSixAm,
+        kPowerOut,
+        kJumpscare,
+        kEnding,
+        kDead,
+        kCount,
+        kNone = kCount
+    };
+
+    Id current();
+    const char* name(Id id);
+
+    // Loads the first state's manifest and enters it; once at boot
+    void start(Id first);
+    // start() for a caller that brings the manifest in itself, as the staged
+    // boot does; it counts as resident from here on
+    void startLoaded(Id first);
 
-    //extern bool endOfNight;
-}
\ No newline at end of file
+    // Switches after the frame has been presented (see postFrame). Only moves
+    // listed in the transition table are taken, and the first request of a
+    // frame wins.
+    void request(Id next);
+
+    // Loads one group of next's manifest that is not resident yet, so a screen
+    // can bring in the next state a little per frame; true once nothing is left
+    bool preloadStep(Id next);
+
+    // Call once per frame after sceGuSwapBuffers with the time the frame took
+    // to build: applies a pending request (reporting both timings), or else
+    // frees a couple of groups the last switch left behind; then runs the
+    // current state's postFrame hook
+    void postFrame(unsigned int frameMicros);
+
+    extern volatile bool isFoxyAttackPaused; // volatile for thread safety
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "global.hpp"
+
+// Streaming audio: WAV data is decoded on a dedicated thread into two small
+// output buffers, so only those buffers stay resident instead of the whole file.
+// The returned OSL_SOUND works with the usual oslPlaySound / oslSetSoundLoop /
+// oslDeleteSound calls; looping sounds wrap around without a gap.
+//
+// A .vag next to the WAV (tools/vagenc) is used instead when present: 4-bit
+// ADPCM, decoded a chunk at a time as the buffers are filled.
+namespace stream {
+    static constexpr int kDefaultBufferFrames = 4096; // ~93 ms at 44.1 kHz
+
+    OSL_SOUND* open(const char* path, int bufferFrames = kDefaultBufferFrames);
+
+    // Short effects: the compressed data stays in RAM and is decoded by the
+    // mixer one block at a time, so no 44.1 kHz copy is ever kept around
+    OSL_SOUND* load(const char* path);
+
+    // A bank (tools/sfxbank) is one file read into one allocation; its sounds
+    // decode straight out of that block like load()ed ones. Bank sounds must not
+    // go through oslDeleteSound: stop them, then free the whole bank.
+    struct Bank;
+    Bank* loadBank(const char* path);
+    OSL_SOUND* bankSound(Bank* bank, const char* name);
+    void freeBank(Bank* bank);
+
+    // Pulls the next frames of a stream sound (stereo s16 at 44.1 kHz) for the
+    // software mixer; frames must be a multiple of 4. Returns 0 once it has ended.
+    int read(OSL_SOUND* s, short* out, int frames);
+
+    // Times the mixer found an empty buffer and had to output silence
+    extern volatile int underruns;
+
+    // True for load() and bank sounds, which start without touching the file system
+    bool resident(OSL_SOUND* s);
+
+    // Heap blocks taken by open / load / loadBank so far
+    extern int allocations;
+
+    size_t residentBytes();
+}
@@ -4,12 +4,17 @@
 #include "animatronic.hpp"
 #include "state.hpp"
 #include "sixam.hpp"
+#include "snapshot.hpp"
 
 namespace timegame{
 
     extern int gtime;
 
     void reset();
+
+    // The hour and the frames until the next one
+    void saveSnapshot(snapshot::Writer& out);
+    void restoreSnapshot(snapshot::Reader& in);
     
     namespace render{
         void renderTime();
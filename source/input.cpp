@@ -0,0 +1,146 @@
+#include "included/input.hpp"
+#include <pspctrl.h>
+#include <pspkernel.h>
+
+namespace input {
+
+    static unsigned int current = 0;
+    static unsigned int previous = 0;
+    static unsigned int frames = 0;
+
+    // Samples each bit has been down for, 1 on the frame it went down
+    static int heldFor[32];
+
+    static Event events[kEventLog];
+    static int eventStart = 0;
+    static int eventTotal = 0;
+
+    // One press timed at a time
+    static unsigned int latencies[kLatencySamples];
+    static int latencyTotal = 0;
+    static bool timing = false;
+    static unsigned int timingSince = 0;
+    static unsigned int timingVisible = 0;
+    static int timingFrames = 0;
+    static unsigned int lastVisible = 0;
+    // Half the driver's sampling cycle: how long a press waits, on average,
+    // for the sample that sees it. Zero when fed through sample() directly.
+    static unsigned int driverWait = 0;
+
+    static void record(unsigned int micros, unsigned int button, bool down) {
+        const int at = (eventStart + eventTotal) % kEventLog;
+        events[at] = Event{micros, frames, button, down};
+        if (eventTotal < kEventLog) {
+            ++eventTotal;
+        } else {
+            eventStart = (eventStart + 1) % kEventLog;
+        }
+    }
+
+    void poll() {
+        SceCtrlData pad{};
+        sceCtrlPeekBufferPositive(&pad, 1);
+        int cycle = 0;
+        sceCtrlGetSamplingCycle(&cycle);
+        driverWait = (cycle ? cycle : kVblankMicros) / 2;
+        // When the driver read the pad, which can be well before this call
+        sample(pad.Buttons, pad.TimeStamp ? pad.TimeStamp : sceKernelGetSystemTimeLow());
+    }
+
+    void sample(unsigned int buttons, unsigned int micros) {
+        previous = current;
+        current = buttons;
+        ++frames;
+
+        unsigned int changed = previous ^ current;
+        for (int bit = 0; bit < 32; ++bit) {
+            const unsigned int mask = 1u << bit;
+            if (current & mask) {
+                ++heldFor[bit];
+            } else {
+                heldFor[bit] = 0;
+            }
+            if (changed & mask) record(micros, mask, (current & mask) != 0);
+        }
+
+        if (!timing && pressed()) {
+            timing = true;
+            timingSince = micros - driverWait;
+            timingVisible = lastVisible;
+            timingFrames = 0;
+        }
+    }
+
+    void reset() {
+        current = previous = 0;
+        for (int& count : heldFor) count = 0;
+        eventStart = eventTotal = 0;
+    }
+
+    unsigned int held()     { return current; }
+    unsigned int pressed()  { return current & ~previous; }
+    unsigned int released() { return previous & ~current; }
+    unsigned int frame()    { return frames; }
+
+    bool chord(unsigned int mask) {
+        return (current & mask) == mask && (pressed() & mask) != 0;
+    }
+
+    bool repeated(unsigned int mask, const Repeat& repeat) {
+        for (int bit = 0; bit < 32; ++bit) {
+            if (!(mask & (1u << bit)) || !heldFor[bit]) continue;
+            const int since = heldFor[bit] - 1; // 0 on the press itself
+            if (since == 0) return true;
+            if (since >= repeat.delay && (since - repeat.delay) % repeat.interval == 0) return true;
+        }
+        return false;
+    }
+
+    int eventCount() { return eventTotal; }
+
+    const Event& event(int index) {
+        return events[(eventStart + index) % kEventLog];
+    }
+
+    void presented(unsigned int visible, unsigned int micros) {
+        if (timing) {
+            if (visible != timingVisible) {
+                latencies[latencyTotal % kLatencySamples] = micros - timingSince;
+                ++latencyTotal;
+                timing = false;
+            } else if (++timingFrames > kLatencyTimeout) {
+                timing = false;
+            }
+        }
+        lastVisible = visible;
+    }
+
+    Latency latency() {
+        unsigned int sorted[kLatencySamples];
+        const int count = latencyTotal < kLatencySamples ? latencyTotal : kLatencySamples;
+        for (int i = 0; i < count; ++i) sorted[i] = latencies[i];
+        // Insertion sort: called once per kLatencySamples presses
+        for (int i = 1; i < count; ++i) {
+            const unsigned int value = sorted[i];
+            int j = i;
+            for (; j > 0 && sorted[j - 1] > value; --j) sorted[j] = sorted[j - 1];
+            sorted[j] = value;
+        }
+        Latency result{count, 0, 0, 0};
+        if (count) {
+            result.p50 = sorted[count / 2];
+            result.p90 = sorted[count * 9 / 10];
+            result.max = sorted[count - 1];
+        }
+        return result;
+    }
+
+    int latencyCount() {
+        return latencyTotal < kLatencySamples ? latencyTotal : kLatencySamples;
+    }
+
+    void resetLatency() {
+        latencyTotal = 0;
+        timing = false;
+    }
+}
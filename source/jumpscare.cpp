@@ -74,8 +74,9 @@ namespace animate {
             soundPlayed = true;
         }
 
-        // Advance frames up to the last frame
+        // Advance frames up to the last frame, never past one still decoding
         if (whichFrame < (kFrameCount - 1)) {
+            if (whichFrame + 1 >= sprite::n_jumpscare::framesLoaded) return;
             if (--frameCounter <= 0) {
                 ++whichFrame;
                 frameCounter = frameDelay;
@@ -97,27 +98,23 @@ namespace animate {
     }
 
     void initDeathScreen() {
-        state::isJumpscare = false;
-
-        sprite::n_jumpscare::unloadJumpscare();
-        sfx::jumpscare::unloadJumpscareSound();
-
-        sfx::jumpscare::loadDeadSound();
-        sfx::jumpscare::playDeadSound();
-
-        state::isDead = true;
+        state::request(state::kDead);
     }
 }
 
 namespace load {
     int waitBeforeLoading = 2; // in frames
 
+    // State hook, after each presented frame: the rest of the set one frame
+    // at a time, or the whole load again if even the first frame failed
     void loadWithDelay() {
         if (!sprite::n_jumpscare::loaded) {
             if (--waitBeforeLoading <= 0) {
                 sprite::n_jumpscare::loadJumpscare();
                 waitBeforeLoading = 2;
             }
+        } else {
+            sprite::n_jumpscare::loadNextFrame(whichFrame);
         }
     }
 }
@@ -3,6 +3,8 @@
 //globally used
 #include "included/image2.hpp"
 #include "included/audio.hpp"
+#include "included/mixer.hpp"
+#include "included/graph.hpp"
 #include "included/state.hpp"
 #include "included/save.hpp"
 #include "included/power.hpp"
@@ -20,6 +22,10 @@
 #include "included/ending.hpp"
 #include "included/jumpscare.hpp"
 #include "included/powerout.hpp"
+#include "included/memory.hpp"
+#include "included/input.hpp"
+#include "included/snapshot.hpp"
+#include "included/boot.hpp"
 
 // PSP Power Management
 #include <psppower.h>
@@ -47,16 +53,36 @@ static unsigned int __attribute__((aligned(16))) DisplayList[64 * 1024]; // 256
 //static unsigned int __attribute__((aligned(16))) DisplayList[262144]; //1MB Display
 
 
+// Snapshot requests wait for the main thread to finish its frame
+static constexpr unsigned int kSnapshotTimeout = 200000;
+
 static int exit_callback(int /*arg1*/, int /*arg2*/, void* /*common*/) {
+    snapshot::request(true, kSnapshotTimeout); // a night in progress resumes next boot
+    save::flush(); // a night won just before HOME is still written
     sceKernelExitGame();
     return 0;
 }
 
+static int power_callback(int /*unknown*/, int flags, void* /*common*/) {
+    if (flags & PSP_POWER_CB_SUSPENDING) {
+        // In case the battery runs out while suspended
+        snapshot::request(true, kSnapshotTimeout);
+        save::flush();
+    } else if (flags & PSP_POWER_CB_RESUME_COMPLETE) {
+        snapshot::request(false, 0); // the night goes on in memory
+    }
+    return 0;
+}
+
 static int callbackThread(SceSize /*args*/, void* /*argp*/) {
     int cbid = sceKernelCreateCallback("Exit Callback", exit_callback, nullptr);
     if (cbid >= 0) {
         sceKernelRegisterExitCallback(cbid);
     }
+    int powerCbid = sceKernelCreateCallback("Power Callback", power_callback, nullptr);
+    if (powerCbid >= 0) {
+        scePowerRegisterCallback(0, powerCbid);
+    }
     sceKernelSleepThreadCB();
     return 0;
 }
@@ -83,6 +109,9 @@ void InitGU() {
     sceGuDrawBuffer(GU_PSM_5650, fbp0, BUF_WIDTH);
     sceGuDispBuffer(SCR_WIDTH, SCR_HEIGHT, fbp1, BUF_WIDTH);
 
+    // VRAM left after the framebuffers goes to the texture residency cache
+    resetVRam();
+
     // 2D-friendly viewport
     sceGuOffset(2048 - (SCR_WIDTH / 2), 2048 - (SCR_HEIGHT / 2));
     sceGuViewport(2048, 2048, SCR_WIDTH, SCR_HEIGHT);
@@ -126,7 +155,12 @@ void initEngine(){
     setupCallbacks();
     //pspDebugScreenInit();
 
+#if LOW_LATENCY_PRESENT
+    // Fastest cycle, so the late read sees a pad state newer than the last vblank
+    sceCtrlSetSamplingCycle(5555);
+#else
     sceCtrlSetSamplingCycle(0);
+#endif
     sceCtrlSetSamplingMode(PSP_CTRL_MODE_ANALOG);
 
     InitGU();
@@ -134,29 +168,27 @@ void initEngine(){
     //oslInit();
     VirtualFileInit();
     oslInitAudio();
+    mixer::init();
 }
 
+// When main() started; the boot timeline counts from here
+static unsigned int bootMicros = 0;
+
 void initGame(){
-    //state::isMenu = false;
 
     save::file();
     //save::readData();
 
-    image::global::n_static::loadStatic();
-
-    image::menu::loadMenuBackground();
-    image::menu::loadLogo();
-    sprite::menu::loadStar();
-    image::menu::loadTextAndCursor();
-    image::menu::loadCopyright();
-    text::global::loadNightText();
-
-    menu::menuCursor::moveCursor();
+    // Compiled movement graph, if tools/mapc built one; the built-in copy otherwise
+    graph::load("romfs/ai/map.bin");
 
-    music::menu::loadMenuMusic();
-    music::menu::playMenuMusic();
-
-    //state::isMenu = true;
+    // A night left mid-way goes straight back to the office; otherwise the
+    // menu is up after two images and the rest follows in the background
+    if (snapshot::resume()) {
+        boot::loadShared();
+    } else {
+        boot::begin(bootMicros);
+    }
 }
 
 bool reseted = true;
@@ -187,9 +219,12 @@ void resetMain(){
     }
 }
 
-int cursorMoveTime = 5;
+// Held cursor buttons step again every eighth / eleventh frame, as the old
+// per-screen cooldown counters did
+static constexpr input::Repeat kMenuRepeat        = {8, 8};
+static constexpr input::Repeat kCustomNightRepeat = {11, 11};
 
-void handleMenuState(SceCtrlData ctrlData){
+void handleMenuState(){
     menu::render::renderBackground();
     menu::render::animateBackground();
     menu::render::renderLogo();
@@ -200,13 +235,12 @@ void handleMenuState(SceCtrlData ctrlData){
     menu::n_static::renderStatic();
     menu::n_static::animateStatic();
 
-if (cursorMoveTime <= 0) {
-    if (ctrlData.Buttons & PSP_CTRL_CROSS) { menu::menuCursor::select(); cursorMoveTime = 7; }
-    if (ctrlData.Buttons & PSP_CTRL_UP)    { menu::menuCursor::cursorPos--; menu::menuCursor::moveCursor(); cursorMoveTime = 7; }
-    if (ctrlData.Buttons & PSP_CTRL_DOWN)  { menu::menuCursor::cursorPos++; menu::menuCursor::moveCursor(); cursorMoveTime = 7; }
-} else {
-    cursorMoveTime -= 1;
-}
+    // No choices until their text is in
+    if (boot::interactive()) {
+        if (input::isPressed(PSP_CTRL_CROSS))             { menu::menuCursor::select(); }
+        if (input::repeated(PSP_CTRL_UP, kMenuRepeat))    { menu::menuCursor::cursorPos--; menu::menuCursor::moveCursor(); }
+        if (input::repeated(PSP_CTRL_DOWN, kMenuRepeat))  { menu::menuCursor::cursorPos++; menu::menuCursor::moveCursor(); }
+    }
 
     resetMain();
 }
@@ -227,7 +261,7 @@ void handleNightInfoState(){
     resetMain();
 }
 
-void handleOfficeState(SceCtrlData ctrlData) {
+void handleOfficeState() {
     // Render the office when the camera is not in use or closing
     if (!camera::isUsing || camera::closing) {
         office::render::renderOffice();
@@ -301,83 +335,36 @@ void handleOfficeState(SceCtrlData ctrlData) {
 
     // Office directional controls
     if (!camera::isUsing) {
-        switch (ctrlData.Buttons) {
-            case PSP_CTRL_LEFT:
-                office::dir = "right";
-                break;
-            case PSP_CTRL_RIGHT:
-                office::dir = "left";
-                break;
-            default:
-                office::dir = "none";
-                break;
-        }
+        // The image slides the opposite way to the button; both at once hold still
+        const bool left = input::isHeld(PSP_CTRL_LEFT);
+        const bool right = input::isHeld(PSP_CTRL_RIGHT);
+        office::scroll = left == right ? office::kStill : (left ? office::kScrollRight : office::kScrollLeft);
 
-        office::buttonState = (ctrlData.Buttons & PSP_CTRL_SQUARE) ? "down" : "up";
+        office::lightHeld = input::isHeld(PSP_CTRL_SQUARE);
 
-        if (ctrlData.Buttons & PSP_CTRL_CROSS) {
-            if (office::doorButtonState == "up") {
-                office::doors::doors();
-            }
-            office::doorButtonState = "held";
-        } else {
-            office::doorButtonState = "up";
+        if (input::isPressed(PSP_CTRL_CROSS)) {
+            office::doors::doors();
         }
     }
 
     // Handle phone call stop
-    if (ctrlData.Buttons & PSP_CTRL_CIRCLE) {
+    if (input::isHeld(PSP_CTRL_CIRCLE)) {
         if (!call::stopped) {
             call::unloadPhoneCalls();
         }
     }
 
-    // Camera directional and button controls
-    switch (ctrlData.Buttons) {
-        case PSP_CTRL_TRIANGLE:
-            if (camera::buttonState == "up") {
-                camera::animation::camera();
-            }
-            camera::buttonState = "held";
-            break;
-
-        case PSP_CTRL_UP:
-            if (camera::buttonState == "up") {
-                camera::system::up();
-            }
-            camera::buttonState = "held";
-            break;
-
-        case PSP_CTRL_DOWN:
-            if (camera::buttonState == "up") {
-                camera::system::down();
-            }
-            camera::buttonState = "held";
-            break;
-
-        case PSP_CTRL_LEFT:
-            if (camera::buttonState == "up") {
-                camera::system::left();
-            }
-            camera::buttonState = "held";
-            break;
-
-        case PSP_CTRL_RIGHT:
-            if (camera::buttonState == "up") {
-                camera::system::right();
-            }
-            camera::buttonState = "held";
-            break;
-
-        default:
-            camera::buttonState = "up";
-            break;
-    }
+    // Camera toggle and switching, once per press
+    if (input::isPressed(PSP_CTRL_TRIANGLE)) camera::animation::camera();
+    if (input::isPressed(PSP_CTRL_UP))       camera::system::up();
+    if (input::isPressed(PSP_CTRL_DOWN))     camera::system::down();
+    if (input::isPressed(PSP_CTRL_LEFT))     camera::system::left();
+    if (input::isPressed(PSP_CTRL_RIGHT))    camera::system::right();
 
     reseted = false;
 }
 
-void handleCustomNightState(SceCtrlData ctrlData) {
+void handleCustomNightState() {
     // Render all Custom Night elements
     customnight::render::renderHeads();
     customnight::render::renderReticle();
@@ -387,51 +374,20 @@ void handleCustomNightState(SceCtrlData ctrlData) {
     customnight::render::renderArrows();
     customnight::render::renderText();
     customnight::render::renderLevels();
+    customnight::render::renderEstimate();
     customnight::render::renderActions();
     customnight::render::renderGoldenFreddy();
 
     // Update the position of the reticle
     customnight::reticle::updatePosition();
 
-    // Handle input only when the cursor is ready to move
-    if (cursorMoveTime <= 0) {
-        switch (ctrlData.Buttons) {
-            case PSP_CTRL_RTRIGGER:
-                customnight::reticle::moveReticleRight();
-                cursorMoveTime = 10;
-                break;
-
-            case PSP_CTRL_LTRIGGER:
-                customnight::reticle::moveReticleLeft();
-                cursorMoveTime = 10;
-                break;
-
-            case PSP_CTRL_RIGHT:
-                customnight::edit::plus();
-                cursorMoveTime = 10;
-                break;
-
-            case PSP_CTRL_LEFT:
-                customnight::edit::minus();
-                cursorMoveTime = 10;
-                break;
-
-            case PSP_CTRL_CROSS:
-                customnight::actions::create();
-                cursorMoveTime = 10;
-                break;
-
-            case PSP_CTRL_CIRCLE:
-                customnight::actions::exit();
-                cursorMoveTime = 10;
-                break;
-
-            default:
-                break;
-        }
-    } else {
-        cursorMoveTime -= 1; // Decrease the cursor move timer
-    }
+    // Held buttons repeat so a level can be run up or down
+    if (input::repeated(PSP_CTRL_RTRIGGER, kCustomNightRepeat)) customnight::reticle::moveReticleRight();
+    if (input::repeated(PSP_CTRL_LTRIGGER, kCustomNightRepeat)) customnight::reticle::moveReticleLeft();
+    if (input::repeated(PSP_CTRL_RIGHT, kCustomNightRepeat))    customnight::edit::plus();
+    if (input::repeated(PSP_CTRL_LEFT, kCustomNightRepeat))     customnight::edit::minus();
+    if (input::isPressed(PSP_CTRL_CROSS))                       customnight::actions::create();
+    if (input::isPressed(PSP_CTRL_CIRCLE))                      customnight::actions::exit();
 
     resetMain(); // Reset any game-related states
 }
@@ -456,7 +412,6 @@ void handlePoweroutState(){
 }
 
 void handleJumpscareState(){
-    jumpscare::load::loadWithDelay();
     jumpscare::render::renderJumpscare();
     jumpscare::animate::animateJumpscare();
 
@@ -492,55 +447,109 @@ void handleDeadState(){
     reseted = false;
 }
 
-void handleState(SceCtrlData ctrlData) {
-    if (state::isMenu){
-        handleMenuState(ctrlData);
-    }
-    else if (state::isNewspaper){
-        handleNewspaperState();
-    }
-    else if (state::isNightinfo){
-        handleNightInfoState();
-    }
-    else if (state::isOffice){
-        handleOfficeState(ctrlData);
-    }
-    else if (state::isCustomNight){
-        handleCustomNightState(ctrlData);
+void handleState() {
+    switch (state::current()) {
+        case state::kMenu:        handleMenuState();        break;
+        case state::kNewspaper:   handleNewspaperState();   break;
+        case state::kNightinfo:   handleNightInfoState();   break;
+        case state::kOffice:      handleOfficeState();      break;
+        case state::kCustomNight: handleCustomNightState(); break;
+        case state::kSixAm:       handleSixAmState();       break;
+        case state::kPowerOut:    handlePoweroutState();    break;
+        case state::kJumpscare:   handleJumpscareState();   break;
+        case state::kEnding:      handleEndingState();      break;
+        case state::kDead:        handleDeadState();        break;
+        default:                                            break;
     }
-    else if (state::isSixAm){
-        handleSixAmState();
-    }
-    else if (state::isPowerOut){
-        handlePoweroutState();
-    }
-    else if (state::isJumpscare){
-        handleJumpscareState();
-    }
-    else if (state::isEnding){
-        handleEndingState();
+}
+
+
+#if INPUT_LATENCY
+// What the buttons change on screen, folded into one value for input::presented
+static unsigned int visibleState() {
+    unsigned int visible = state::current();
+    visible = visible * 31 + office::leftDoorFrame;
+    visible = visible * 31 + office::rightDoorFrame;
+    visible = visible * 31 + office::wichOfficeFrame;
+    visible = visible * 31 + camera::whichFrame;
+    visible = visible * 31 + camera::whichCamera;
+    visible = visible * 31 + menu::menuCursor::cursorPos;
+    return visible;
+}
+
+// sceGuSwapBuffers only queues the buffer (PSP_DISPLAY_SETBUF_NEXTFRAME): the
+// frame reaches the screen at the first vblank after the swap. The swap is
+// noted here and handed to input::presented after the next vblank wait,
+// dated back to the vblank that showed it if the frame after ran long.
+static unsigned int swapVisible = 0;
+static int swapVcount = -1;
+
+static void swapped() {
+    swapVisible = visibleState();
+    swapVcount = sceDisplayGetVcount();
+}
+
+static void shown() {
+    if (swapVcount < 0) return;
+    const unsigned int late = sceDisplayGetVcount() - swapVcount - 1;
+    input::presented(swapVisible, sceKernelGetSystemTimeLow() - late * input::kVblankMicros);
+    if (input::latencyCount() == input::kLatencySamples) {
+        const input::Latency measured = input::latency();
+        memory::reportInputLatency(LOW_LATENCY_PRESENT ? "late" : "default",
+                                   measured.count, measured.p50, measured.p90, measured.max);
+        input::resetLatency();
     }
-    else if (state::isDead){
-        handleDeadState();
+}
+#endif
+
+#if LOW_LATENCY_PRESENT
+// Sleeps until the second slowest of the recent frames, plus a margin, would
+// just finish by the next vblank. One stall, like a jumpscare frame decoding,
+// is not allowed to push every later frame back to an early start; a frame
+// slower than that misses the vblank.
+static constexpr unsigned int kRefreshMicros = 16683; // 59.94 Hz
+static constexpr unsigned int kPresentMargin = 1000;
+static constexpr int kBuildHistory = 32;
+static unsigned int buildMicros[kBuildHistory];
+static int buildNext = 0;
+
+static void waitForLateStart(unsigned int vblankMicros) {
+    unsigned int slowest = 0, second = 0;
+    for (unsigned int micros : buildMicros) {
+        if (micros > slowest) {
+            second = slowest;
+            slowest = micros;
+        } else if (micros > second) {
+            second = micros;
+        }
     }
+    if (second + kPresentMargin >= kRefreshMicros) return;
+    const unsigned int start = kRefreshMicros - second - kPresentMargin;
+    const unsigned int elapsed = sceKernelGetSystemTimeLow() - vblankMicros;
+    if (elapsed < start) sceKernelDelayThread(start - elapsed);
 }
-
+#endif
 
 auto main() -> int {
     // PERFORMANCE: Enable CPU boost for better framerate and responsiveness
     // 333MHz CPU, 333MHz BUS, 166MHz Memory - optimal for PSP games
     scePowerSetClockFrequency(333, 333, 166);
+    bootMicros = sceKernelGetSystemTimeLow();
 
-    SceCtrlData ctrlData{};
     initEngine();
     initGame();
 
-    // For better input handling
+#if LOW_LATENCY_PRESENT
+    unsigned int vblankMicros = sceKernelGetSystemTimeLow();
+#endif
 
     while (true) {
-        // PERFORMANCE: Use non-blocking input for better responsiveness
-        // This prevents input lag and improves overall game feel
-        sceCtrlPeekBufferPositive(&ctrlData, 1);
+#if LOW_LATENCY_PRESENT
+        waitForLateStart(vblankMicros);
+        const unsigned int buildStart = sceKernelGetSystemTimeLow();
+#endif
+        // Non-blocking read; every state sees the same edges this frame
+        input::poll();
 
         sceGuStart(GU_DIRECT, DisplayList);
 
@@ -554,17 +563,31 @@ auto main() -> int {
         // sceGumMatrixMode(GU_VIEW);
         // sceGumLoadIdentity();
 
-        handleState(ctrlData); // your draw+update
+        const unsigned int frameStart = sceKernelGetSystemTimeLow();
+        handleState(); // your draw+update
+        const unsigned int frameMicros = sceKernelGetSystemTimeLow() - frameStart;
 
         sceGuFinish();
         sceGuSync(GU_SYNC_FINISH, GU_SYNC_WHAT_DONE);
+#if LOW_LATENCY_PRESENT
+        buildMicros[buildNext++ % kBuildHistory] = sceKernelGetSystemTimeLow() - buildStart;
+#endif
 
         // PERFORMANCE: Optimized frame timing for better battery life
         // Cap to 60 Hz; wait AFTER finishing the list
         sceDisplayWaitVblankStartCB();
+#if LOW_LATENCY_PRESENT
+        vblankMicros = sceKernelGetSystemTimeLow();
+#endif
+#if INPUT_LATENCY
+        shown();
+#endif
 
         // Present
         sceGuSwapBuffers();
+#if INPUT_LATENCY
+        swapped();
+#endif
         
         // PERFORMANCE: Optional frame skip for very intensive scenes
         // This helps maintain 60fps during heavy operations
@@ -575,11 +598,13 @@ auto main() -> int {
         }
 
         // Safe place for deferred load/unload (GPU is done with textures)
-        powerout::postFrame();
-        ending::postFrame();
-        dead::postFrame();
-        sixam::postFrame();
-        nightinfo::postFrame(); 
-        sprite::UI::office::postFrame(); 
+        state::postFrame(frameMicros);
+        snapshot::postFrame();
+        boot::postFrame();
+        sprite::UI::office::postFrame();
+
+        // Promote hot textures into VRAM once deferred frees are done
+        vramEndFrame();
+        mixer::collect();
     }
 }
\ No newline at end of file
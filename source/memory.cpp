@@ -157,4 +157,72 @@ namespace memory {
                (float)(totalGraphicsMemory + totalAudioMemory + totalSystemMemory) / MAX_TOTAL_MEMORY * 100.0f);
         DEBUG_PRINTF("============================\n\n");
     }
+
+    // 16-bit texture conversion: what each state holds and what it saved
+    void reportTextureSavings(const char* stateName) {
+        DEBUG_PRINTF("Textures [%s]: %d KB resident, %d KB saved by 16-bit formats\n",
+               stateName, imageRamAlloc / 1024, imageBytesSaved / 1024);
+    }
+
+    void reportAudioResident(const char* stateName, size_t bytes) {
+        DEBUG_PRINTF("Audio [%s]: %zu KB resident\n", stateName, bytes / 1024);
+    }
+
+    void reportAudioTiming(const char* what, unsigned int micros, int allocations) {
+        DEBUG_PRINTF("Audio timing [%s]: %u us, %d allocations\n", what, micros, allocations);
+    }
+
+    // State switches run after the swap; frameMicros is the frame that asked
+    // for one (an attack frame for a jumpscare). Releases trail a few per frame.
+    void reportTransition(const char* from, const char* to, unsigned int frameMicros, unsigned int micros) {
+        DEBUG_PRINTF("State timing [%s -> %s]: frame %u us, switch %u us\n", from, to, frameMicros, micros);
+    }
+
+    void reportRelease(const char* group, unsigned int micros) {
+        DEBUG_PRINTF("State timing [release %s]: %u us\n", group, micros);
+    }
+
+    // Jumpscares shown so far by how much of their set the reserve had
+    // decoded, and the most the reserve has held at once
+    void reportJumpscareReserve(int warm, int partial, int cold, int peakBytes) {
+        DEBUG_PRINTF("Jumpscare reserve: %d warm, %d partial, %d cold; peak %d KB\n",
+               warm, partial, cold, peakBytes / 1024);
+    }
+
+    // Each jumpscare frame as it is decoded, and what the set holds after it
+    void reportJumpscareFrame(int frame, unsigned int micros, int residentBytes) {
+        DEBUG_PRINTF("Jumpscare frame %d: %u us, %d KB resident\n", frame, micros, residentBytes / 1024);
+    }
+
+    // Press to first swap that shows it, over the last presses timed
+    void reportInputLatency(const char* mode, int presses, unsigned int p50, unsigned int p90, unsigned int max) {
+        DEBUG_PRINTF("Input latency [%s]: %d presses, median %u us, p90 %u us, max %u us\n",
+               mode, presses, p50, p90, max);
+    }
+
+    // Reading the save at boot, and each write on the save thread
+    void reportSave(const char* what, unsigned int micros) {
+        DEBUG_PRINTF("Save [%s]: %u us\n", what, micros);
+    }
+
+    // Quick resume: the snapshot written on the way out, and at boot the
+    // time from opening it to the office being playable
+    void reportSnapshot(int bytes) {
+        DEBUG_PRINTF("Snapshot: %d bytes\n", bytes);
+    }
+
+    void reportResume(int bytes, unsigned int micros) {
+        DEBUG_PRINTF("Resume: %d bytes, playable in %u us\n", bytes, micros);
+    }
+
+    // Each staged boot step as the loader thread finishes it, and the boot
+    // as a whole, counted from main()
+    void reportBootStep(const char* step, unsigned int micros) {
+        DEBUG_PRINTF("Boot step [%s]: %u us\n", step, micros);
+    }
+
+    void reportBootTimeline(unsigned int firstFrame, unsigned int interactive, unsigned int loaded) {
+        DEBUG_PRINTF("Boot: first frame %u us, interactive %u us, fully loaded %u us\n",
+               firstFrame, interactive, loaded);
+    }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "included/menu.hpp"
+#include "included/boot.hpp"
 
 namespace menu{
 
@@ -8,7 +9,9 @@ namespace menu{
     namespace render {
         void renderBackground() {
             if (whichFrame < 4) { // Ensure no out-of-bounds access
-                drawSpriteAlpha(0, 0, 300, 272, image::menu::menuBackground[whichFrame], 180, 0, 0);
+                // Frame 0 stands in for frames the boot has not loaded yet
+                Image* frame = image::menu::menuBackground[whichFrame];
+                drawSpriteAlpha(0, 0, 300, 272, frame ? frame : image::menu::menuBackground[0], 180, 0, 0);
             }
         }
 
@@ -63,6 +66,11 @@ namespace menu{
         }
     }
 
+    void enter(){
+        menuCursor::moveCursor();
+        music::menu::playMenuMusic();
+    }
+
     namespace menuCursor{
         int cursorPos = 0;
         int cursorLimit = 1;
@@ -103,6 +111,9 @@ namespace menu{
         }
 
         void select() {
+            // The next state frees the menu's groups; the boot may still be filling them
+            boot::finish();
+
             switch (cursorPos) {
                 case 0:
                     if (save::whichNight == 1) {
@@ -169,54 +180,15 @@ namespace menu{
         }
 
         void initNewspaper(){
-            state::isMenu = false;
-            image::menu::unloadMenuBackground();
-            //image::unloadStatic();
-            image::menu::unloadLogo();
-            image::menu::unloadCopyright();
-            image::menu::unloadTextAndCursor();
-            music::menu::unloadMenuMusic();
-            sprite::menu::unloadStar();
-
-            image::n_newspaper::loadNewsPaper();
-            state::isNewspaper = true;
+            state::request(state::kNewspaper);
         }
 
         void initNightinfo(){
-            state::isMenu = false;
-            image::menu::unloadMenuBackground();
-            //image::unloadStatic();
-            image::menu::unloadLogo();
-            image::menu::unloadCopyright();
-            image::menu::unloadTextAndCursor();
-            music::menu::unloadMenuMusic();
-            sprite::menu::unloadStar();
-
-            sprite::nightinfo::loadNightInfoSprite();
-            state::isNightinfo = true;
+            state::request(state::kNightinfo);
         }
 
         void initCustomNight(){
-            state::isMenu = false;
-            image::menu::unloadMenuBackground();
-            //image::unloadStatic();
-            image::menu::unloadLogo();
-            image::menu::unloadCopyright();
-            image::menu::unloadTextAndCursor();
-            music::menu::unloadMenuMusic();
-            sprite::menu::unloadStar();
-
-            sprite::UI::customnight::loadIcons();
-            sprite::UI::customnight::loadReticle();
-            sprite::UI::customnight::loadInstructions();
-            sprite::UI::customnight::loadTitle();
-            sprite::UI::customnight::loadArrows();
-            sprite::UI::customnight::loadText();
-            sprite::UI::customnight::loadNames();
-            sprite::UI::customnight::loadActions();
-            sprite::UI::customnight::loadGoldenFreddy();
-
-            state::isCustomNight = true;
+            state::request(state::kCustomNight);
         }
     }
 }
@@ -0,0 +1,489 @@
+#include "included/mixer.hpp"
+#include "included/stream.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace mixer {
+
+    volatile int steals = 0;
+    volatile int rejected = 0;
+    volatile int eventsPosted = 0;
+    volatile int eventsMerged = 0;
+    volatile int eventsDropped = 0;
+
+    static constexpr int kBlockFrames = 512;
+    static constexpr int kMaxPending = 32;     // to start with; the list grows rather than wait
+    static constexpr int kMaxRestarts = 8;
+    static constexpr int kMaxSounds = 48;
+    static constexpr int kQueueSize = 64; // power of two
+
+    enum EventKind { kPlay, kStart, kStop, kPause, kResume };
+
+    struct Event {
+        OSL_SOUND* sound;          // checked against its slot when drained
+        short slot;
+        unsigned char kind;
+        unsigned char category;
+        int priority;
+        int volume;                // Q15
+        int pan;                   // -kVolumeMax (left) .. kVolumeMax (right)
+    };
+
+    struct Voice {
+        OSL_SOUND* volatile sound; // null == free
+        int slot;
+        int category;
+        int priority;
+        int volume, pan;
+        int gainLeft, gainRight;   // Q15, volume and pan folded together
+        unsigned int age;          // start order, older voices are stolen first
+        bool paused;
+    };
+
+    // Something handed to defer(), destroyed once no mix can still be using it
+    struct Pending {
+        void (*destroy)(void*);
+        void* object;
+        int slot;                  // sound slot to hand back afterwards, or -1
+        unsigned int fence;        // mixes started when it was released
+    };
+
+    // A streamed sound played again while a voice still reads it, waiting for
+    // collect() to prime its buffers once no mix can be reading them
+    struct Restart {
+        OSL_SOUND* sound;
+        int slot;
+        int category, priority, volume, pan;
+        unsigned int fence;
+    };
+
+    // Only the audio thread writes voices; everyone else talks to it through the queue
+    static Voice voices[kVoices];
+    static int categoryVolume[kCategoryCount] = {kVolumeMax, kVolumeMax, kVolumeMax, kVolumeMax};
+    static unsigned int sequence = 0;
+    static OSL_SOUND* output = nullptr;
+
+    // Sounds the mixer may play. A released sound's slot holds kRetired until
+    // its fence passes, so late events for it are dropped instead of replayed.
+    static OSL_SOUND* volatile slots[kMaxSounds];
+    static OSL_SOUND* const kRetired = (OSL_SOUND*)1;
+
+    // Multi-producer, single-consumer ring. The Allegrex has no LL/SC, so
+    // producers claim a slot with interrupts masked for a handful of
+    // instructions; nobody ever blocks and the mixer never waits.
+    static Event queue[kQueueSize];
+    static volatile unsigned int queueHead = 0; // next write
+    static volatile unsigned int queueTail = 0; // next read, audio thread only
+
+    // Per sound slot, the queue position just past its last kStart. Until the
+    // mixer has drained that far the start may still take a voice, so the
+    // sound counts as playing and a play() must not prime it again.
+    static volatile unsigned int startQueued[kMaxSounds];
+
+    // The mix boundary: a voice whose slot was retired before a mix started is never read by it
+    static volatile unsigned int mixesStarted = 0;
+    static volatile unsigned int mixesFinished = 0;
+    static Pending* pending = nullptr;
+    static int pendingCount = 0;
+    static int pendingCapacity = 0;
+    static Restart restarts[kMaxRestarts];
+    static int restartCount = 0;
+    static SceUID pendingLock = -1;
+
+    // Only touched from the oslib audio thread
+    static int accum[kBlockFrames * 2];
+    static short scratch[kBlockFrames * 2];
+
+    static inline void lock()   { sceKernelWaitSema(pendingLock, 1, nullptr); }
+    static inline void unlock() { sceKernelSignalSema(pendingLock, 1); }
+
+    static inline short clamp16(int v) {
+        return (short)(v < -32768 ? -32768 : (v > 32767 ? 32767 : v));
+    }
+
+    static int findSlot(OSL_SOUND* s) {
+        for (int i = 0; i < kMaxSounds; ++i) {
+            if (slots[i] == s) return i;
+        }
+        return -1;
+    }
+
+    static bool post(const Event& e) {
+        const int intr = sceKernelCpuSuspendIntr();
+        const bool full = queueHead - queueTail >= (unsigned int)kQueueSize;
+        if (!full) {
+            queue[queueHead & (kQueueSize - 1)] = e;
+            queueHead = queueHead + 1;
+            if (e.kind == kStart) startQueued[e.slot] = queueHead;
+            eventsPosted++;
+        } else {
+            eventsDropped++;
+        }
+        sceKernelCpuResumeIntr(intr);
+        return !full;
+    }
+
+    static bool postFor(OSL_SOUND* s, EventKind kind, Category category = kSfx, int priority = 0,
+                        int volume = kVolumeMax, int pan = 0) {
+        if (!s || !output) return false;
+        Event e;
+        e.sound = s;
+        e.slot = (short)findSlot(s);
+        e.kind = (unsigned char)kind;
+        e.category = (unsigned char)category;
+        e.priority = priority;
+        e.volume = volume;
+        e.pan = pan;
+        if (e.slot < 0) {
+            // Never attached, or already released
+            const int intr = sceKernelCpuSuspendIntr();
+            eventsDropped++;
+            sceKernelCpuResumeIntr(intr);
+            return false;
+        }
+        return post(e);
+    }
+
+    static void setGains(Voice& voice) {
+        const int gain = (voice.volume * categoryVolume[voice.category]) >> 15;
+        voice.gainLeft = voice.pan > 0 ? (gain * (kVolumeMax - voice.pan)) >> 15 : gain;
+        voice.gainRight = voice.pan < 0 ? (gain * (kVolumeMax + voice.pan)) >> 15 : gain;
+    }
+
+    static int findVoice(OSL_SOUND* s) {
+        for (int v = 0; v < kVoices; ++v) {
+            if (voices[v].sound == s) return v;
+        }
+        return -1;
+    }
+
+    // A free voice, else the lowest priority and oldest one if the newcomer outranks it
+    static int claimVoice(int priority) {
+        int chosen = findVoice(nullptr);
+        if (chosen >= 0) return chosen;
+        chosen = 0;
+        for (int v = 1; v < kVoices; ++v) {
+            const Voice& a = voices[v];
+            const Voice& b = voices[chosen];
+            if (a.priority < b.priority || (a.priority == b.priority && a.age < b.age)) chosen = v;
+        }
+        if (voices[chosen].priority > priority) {
+            rejected++;
+            return -1;
+        }
+        steals++;
+        return chosen;
+    }
+
+    static void startVoice(const Event& e, int* started) {
+        OSL_SOUND* s = e.sound;
+        int v = started[e.slot];
+        if (v >= 0) {
+            // Same sound twice in one block: keep one voice, take the louder request
+            eventsMerged++;
+            Voice& voice = voices[v];
+            if (e.priority > voice.priority) voice.priority = e.priority;
+            if (e.volume > voice.volume) voice.volume = e.volume;
+            setGains(voice);
+            return;
+        }
+
+        v = findVoice(s);
+        if (v < 0) v = claimVoice(e.priority);
+        if (v < 0) return;
+        if (e.kind == kPlay) s->playSound(s); // resident: a rewind, nothing touches the disk
+        Voice& voice = voices[v];
+        voice.sound = s;
+        voice.slot = e.slot;
+        voice.category = e.category;
+        voice.priority = e.priority;
+        voice.volume = e.volume;
+        voice.pan = e.pan;
+        voice.age = ++sequence;
+        voice.paused = false;
+        setGains(voice);
+        started[e.slot] = v;
+    }
+
+    // Runs at the top of every mix block
+    static void drainEvents() {
+        int started[kMaxSounds];
+        memset(started, 0xff, sizeof(started));
+        while (queueTail != queueHead) {
+            const Event e = queue[queueTail & (kQueueSize - 1)];
+            if (slots[e.slot] != e.sound) {
+                eventsDropped++; // released since it was posted
+                queueTail = queueTail + 1;
+                continue;
+            }
+            const int v = findVoice(e.sound);
+            switch (e.kind) {
+                case kPlay:
+                case kStart:
+                    startVoice(e, started);
+                    break;
+                case kStop:
+                    if (v >= 0) voices[v].sound = nullptr;
+                    break;
+                case kPause:
+                case kResume:
+                    if (v >= 0) voices[v].paused = e.kind == kPause;
+                    break;
+            }
+            // Only once the event has taken effect: a start is pending, or
+            // else has its voice, whenever playing() looks
+            queueTail = queueTail + 1;
+        }
+    }
+
+    static int mixBlock(short* out, int frames) {
+        memset(accum, 0, frames * 2 * sizeof(int));
+        for (int v = 0; v < kVoices; ++v) {
+            Voice& voice = voices[v];
+            OSL_SOUND* sound = voice.sound;
+            if (!sound) continue;
+            if (slots[voice.slot] != sound) {
+                voice.sound = nullptr; // released
+                continue;
+            }
+            if (voice.paused) continue;
+            if (stream::read(sound, scratch, frames) == 0) {
+                voice.sound = nullptr; // played out
+                continue;
+            }
+            const int left = voice.gainLeft, right = voice.gainRight;
+            if (left >= kVolumeMax && right >= kVolumeMax) {
+                for (int i = 0; i < frames * 2; ++i) accum[i] += scratch[i];
+            } else {
+                for (int i = 0; i < frames * 2; i += 2) {
+                    accum[i]     += (scratch[i] * left) >> 15;
+                    accum[i + 1] += (scratch[i + 1] * right) >> 15;
+                }
+            }
+        }
+        for (int i = 0; i < frames * 2; ++i) out[i] = clamp16(accum[i]);
+        return frames;
+    }
+
+    // The mixer never finishes, so oslib keeps its channel for the whole run
+    static int audioCallback(unsigned int, void* buf, unsigned int reqn) {
+        short* out = (short*)buf;
+        mixesStarted++;
+        for (unsigned int done = 0; done < reqn; ) {
+            drainEvents();
+            int frames = (int)(reqn - done) < kBlockFrames ? (int)(reqn - done) : kBlockFrames;
+            done += mixBlock(out + done * 2, frames);
+        }
+        mixesFinished = mixesStarted;
+        return 1;
+    }
+
+    static void playSound(OSL_SOUND*) {}
+    static void stopSound(OSL_SOUND*) {}
+    static void deleteSound(OSL_SOUND*) {}
+
+    void init() {
+        if (output) return;
+        pendingLock = sceKernelCreateSema("mixer_lock", 0, 1, 1, nullptr);
+        output = (OSL_SOUND*)calloc(1, sizeof(OSL_SOUND));
+        if (pendingLock < 0 || !output) {
+            DEBUG_PRINTF("mixer: init failed\n");
+            free(output);
+            output = nullptr;
+            return;
+        }
+        strcpy(output->filename, "mixer");
+        output->mono = 0;
+        output->volumeLeft = output->volumeRight = OSL_VOLUME_MAX;
+        output->numSamples = osl_audioDefaultNumSamples;
+        output->playSound = playSound;
+        output->stopSound = stopSound;
+        output->audioCallback = audioCallback;
+        output->deleteSound = deleteSound;
+        oslPlaySound(output, kChannel);
+    }
+
+    // Mixes run in order on one thread, so once the finished count reaches the
+    // fence every mix that could have seen the object is over
+    static bool fencePassed(unsigned int fence) {
+        return !output || (int)(mixesFinished - fence) >= 0;
+    }
+
+    OSL_SOUND* attach(OSL_SOUND* s) {
+        if (!s) return nullptr;
+        const int intr = sceKernelCpuSuspendIntr();
+        int slot = findSlot(s);
+        if (slot < 0) {
+            slot = findSlot(nullptr);
+            if (slot >= 0) slots[slot] = s;
+        }
+        sceKernelCpuResumeIntr(intr);
+        if (slot < 0) DEBUG_PRINTF("mixer: no slot for %s\n", s->filename);
+        return s;
+    }
+
+    static int findRestart(OSL_SOUND* s) {
+        for (int i = 0; i < restartCount; ++i) {
+            if (restarts[i].sound == s) return i;
+        }
+        return -1;
+    }
+
+    // The stop is already queued, so every mix that starts after the fence
+    // drops the voice before it reads a sample
+    static bool queueRestart(OSL_SOUND* s, Category category, int priority, int volume, int pan) {
+        const int slot = findSlot(s);
+        if (slot < 0) return false;
+        lock();
+        int i = findRestart(s);
+        if (i < 0 && restartCount < kMaxRestarts) i = restartCount++;
+        if (i >= 0) restarts[i] = {s, slot, category, priority, volume, pan, mixesStarted};
+        unlock();
+        if (i < 0) {
+            const int intr = sceKernelCpuSuspendIntr();
+            eventsDropped++;
+            sceKernelCpuResumeIntr(intr);
+        }
+        return i >= 0;
+    }
+
+    static void cancelRestart(OSL_SOUND* s) {
+        if (pendingLock < 0) return;
+        lock();
+        const int i = findRestart(s);
+        if (i >= 0) restarts[i] = restarts[--restartCount];
+        unlock();
+    }
+
+    bool play(OSL_SOUND* s, Category category, int priority, bool loop, int volume, int pan) {
+        if (!s || !output) return false;
+        oslSetSoundLoop(s, loop ? 1 : 0);
+        if (stream::resident(s)) return postFor(s, kPlay, category, priority, volume, pan);
+
+        // Streamed sounds prime their buffers from the file here, off the audio
+        // thread. One a voice may still be reading is stopped now and primed by
+        // collect() after the next mix boundary, so the caller never waits.
+        if (playing(s) || findRestart(s) >= 0) {
+            if (!postFor(s, kStop)) return false;
+            return queueRestart(s, category, priority, volume, pan);
+        }
+        s->playSound(s);
+        return postFor(s, kStart, category, priority, volume, pan);
+    }
+
+    void stop(OSL_SOUND* s) {
+        cancelRestart(s);
+        postFor(s, kStop);
+    }
+
+    void pause(OSL_SOUND* s, bool paused) {
+        postFor(s, paused ? kPause : kResume);
+    }
+
+    // The queue first: a start drained after the check has its voice by the time findVoice looks
+    bool playing(OSL_SOUND* s) {
+        if (!s) return false;
+        const int slot = findSlot(s);
+        if (slot >= 0 && (int)(startQueued[slot] - queueTail) > 0) return true;
+        return findVoice(s) >= 0;
+    }
+
+    void setCategoryVolume(Category category, int volume) {
+        if (category >= 0 && category < kCategoryCount) categoryVolume[category] = volume;
+    }
+
+    void collect() {
+        if (pendingLock < 0) return;
+        lock();
+        int kept = 0;
+        for (int i = 0; i < pendingCount; ++i) {
+            if (fencePassed(pending[i].fence)) {
+                if (pending[i].destroy) pending[i].destroy(pending[i].object);
+                if (pending[i].slot >= 0) slots[pending[i].slot] = nullptr;
+            } else {
+                pending[kept++] = pending[i];
+            }
+        }
+        pendingCount = kept;
+
+        Restart ready[kMaxRestarts];
+        int readyCount = 0;
+        kept = 0;
+        for (int i = 0; i < restartCount; ++i) {
+            if (fencePassed(restarts[i].fence)) ready[readyCount++] = restarts[i];
+            else restarts[kept++] = restarts[i];
+        }
+        restartCount = kept;
+        unlock();
+
+        // Priming reads the file, so it happens outside the lock play() takes
+        for (int i = 0; i < readyCount; ++i) {
+            const Restart& r = ready[i];
+            if (slots[r.slot] != r.sound) continue; // released meanwhile
+            r.sound->playSound(r.sound);
+            postFor(r.sound, kStart, (Category)r.category, r.priority, r.volume, r.pan);
+        }
+    }
+
+    static void deferSlot(void (*destroy)(void*), void* object, int slot) {
+        if (pendingLock < 0) {
+            if (destroy) destroy(object);
+            if (slot >= 0) slots[slot] = nullptr;
+            return;
+        }
+        collect();
+        lock();
+        const unsigned int fence = mixesStarted;
+        if (pendingCount == pendingCapacity) {
+            // More releases in one frame than ever before: grow, never wait on the mixer
+            const int capacity = pendingCapacity ? pendingCapacity * 2 : kMaxPending;
+            Pending* grown = (Pending*)realloc(pending, capacity * sizeof(Pending));
+            if (!grown) {
+                unlock();
+                DEBUG_PRINTF("mixer: out of memory, leaking a release\n");
+                return; // still safer than freeing it under a mix
+            }
+            pending = grown;
+            pendingCapacity = capacity;
+        }
+        pending[pendingCount++] = {destroy, object, slot, fence};
+        unlock();
+    }
+
+    void defer(void (*destroy)(void*), void* object) {
+        if (object) deferSlot(destroy, object, -1);
+    }
+
+    // Retiring the slot is what takes the sound off its voice: the next mix sees the mismatch
+    static int retire(OSL_SOUND* s) {
+        const int intr = sceKernelCpuSuspendIntr();
+        const int slot = findSlot(s);
+        if (slot >= 0) slots[slot] = kRetired;
+        sceKernelCpuResumeIntr(intr);
+        return slot;
+    }
+
+    static void deleteSoundLater(void* s) {
+        oslDeleteSound((OSL_SOUND*)s);
+    }
+
+    void release(OSL_SOUND* s) {
+        if (!s) return;
+        deferSlot(deleteSoundLater, s, retire(s));
+    }
+
+    void forget(OSL_SOUND* s) {
+        if (!s) return;
+        const int slot = retire(s);
+        if (slot >= 0) deferSlot(nullptr, nullptr, slot);
+    }
+
+    int pendingReleases() {
+        return pendingCount;
+    }
+
+    void report(const char* stateName) {
+        DEBUG_PRINTF("Mixer [%s]: %d events posted, %d merged, %d dropped; %d steals, %d rejected\n",
+                     stateName, eventsPosted, eventsMerged, eventsDropped, steals, rejected);
+    }
+}
@@ -22,9 +22,7 @@ namespace newspaper{
         void initNightinfo(){
             if (countdown <= 0 && deactivated == false){
                 deactivated = true;
-                state::isNewspaper = false;
-                sprite::nightinfo::loadNightInfoSprite();
-                state::isNightinfo = true;
+                state::request(state::kNightinfo);
             }
             else{
                 countdown -= 1;
@@ -9,11 +9,7 @@ namespace nightinfo {
     bool loadedMain = false;
 
     // Incremental loader
-    static int  loadStep = 0;
     static int  loadsPerFrame = 2; // tune: do a couple of steps per frame
-    // Deferred transition to Office
-    static bool requestOffice = false;
-    static bool transitioning = false;
 
     void reset() {
         countdown = 400;
@@ -21,10 +17,6 @@ namespace nightinfo {
         isLoading = false;
         deactivated = false;
         loadedMain = false;
-
-        loadStep = 0;
-        requestOffice = false;
-        transitioning = false;
     }
 
     namespace render {
@@ -50,103 +42,31 @@ namespace nightinfo {
 
     namespace next {
 
-        // One tiny task per step to avoid frame spikes.
-        // Note: sprite::UI::office::loadAllCams() loads all camera images at once for initial setup.
-        // This ensures all cameras are visible from the start of early levels.
-        static void tickLoader() {
-            switch (loadStep) {
-                case 0:
-                    if (image::n_newspaper::loaded) {
-                        image::n_newspaper::unloadNewsPaper();
-                    }
-                    loadStep++;
-                    break;
-
-                case 1: officeImage::loadOffice1Sprites(); loadStep++; break;
-                case 2: officeImage::loadOffice2Sprites(); loadStep++; break;
-
-                case 3: sprite::office::loadButtons();     loadStep++; break;
-                case 4: sprite::office::loadDoors();       loadStep++; break;
-
-                case 5: sprite::UI::office::loadCamFlip();  loadStep++; break;
-                case 6: sprite::UI::office::loadPowerInfo();loadStep++; break;
-                case 7: sprite::UI::office::loadTimeInfo(); loadStep++; break;
-
-                case 8: sprite::UI::office::loadAllCams();  loadStep++; break;
-                case 9: sprite::UI::office::loadCamUi();    loadStep++; break;
-
-                case 10:
-                    power::update::setDrainTime();
-                    office::main::setX();
-                    animatronic::setDefault();
-                    loadStep++;
-                    break;
-
-                case 11: ambience::office::loadAmbience(); loadStep++; break;
-                case 12: ambience::office::loadFanSound(); loadStep++; break;
-                case 13: sfx::office::loadSfx();           loadStep++; break;
-                case 14: call::loadPhoneCalls();           loadStep++; break;
-                
-                // Pre-caching for performance
-                case 15: text::preload::preloadCameraAssets(); loadStep++; break; // Pre-cache ALL camera graphics
-                case 16: text::preload::preloadJumpscareAssets(); loadStep++; break; // Pre-cache ALL jumpscare graphics
-                case 17: sfx::preload::preloadCriticalAudio(); loadStep++; break; // Pre-cache critical audio
-
-                default:
-                    officeObjectsLoaded = true;
-                    isLoading = false;
-                    loadedMain = true;
-                    break;
-            }
-        }
-
+        // The office manifest comes in one asset group per step to avoid
+        // frame spikes; the state table lists the groups (see state.cpp)
         void preloadOffice() {
             if (officeObjectsLoaded || deactivated) return;
-
-            // Start incremental loading
-            if (!isLoading) {
-                isLoading = true;
-                loadStep = 0;
-            }
+            isLoading = true;
 
             // Do a few steps per frame to keep things smooth
             int steps = loadsPerFrame;
             while (isLoading && steps-- > 0) {
-                tickLoader();
+                if (state::preloadStep(state::kOffice)) {
+                    officeObjectsLoaded = true;
+                    isLoading = false;
+                    loadedMain = true;
+                }
             }
         }
 
         void initOffice() {
             if (countdown <= 0 && officeObjectsLoaded && !deactivated) {
-                // Schedule transition; real work happens in postFrame()
-                requestOffice = true;
-                // Optional: prevent re-scheduling if called again
+                // Switches after this frame is presented
+                state::request(state::kOffice);
                 deactivated = true;
             } else {
                 countdown -= 1;
             }
         }
     }
-
-    // Call once per frame AFTER buffer swap (like ending/powerout/sixam/dead)
-    void postFrame() {
-        if (!requestOffice || transitioning) return;
-        transitioning = true;
-
-        // Leave nightinfo state
-        state::isNightinfo = false;
-
-        // Free nightinfo textures now that the last frame using them has been presented
-        sprite::nightinfo::unloadNightInfoSprite();
-
-        // Start ambience/fan/call playback (assets already loaded during preload)
-        ambience::office::playAmbience();
-        ambience::office::playFanSound();
-        call::playPhoneCalls();
-
-        state::isOffice = true;
-
-        requestOffice = false;
-        transitioning = false;
-    }
-}
\ No newline at end of file
+}
@@ -1,4 +1,6 @@
 #include "included/office.hpp"
+#include "included/power.hpp"
+#include "included/mixer.hpp"
 
 namespace office {
 
@@ -6,7 +8,7 @@ namespace office {
     int xPos[6];
     int speed = 1;
     int speedMultiplier = 5;
-    std::string dir = "none";
+    Scroll scroll = kStill;
 
     volatile int usageCountdown = 10; // volatile for thread safety
     volatile bool leftEdge = false; // volatile for thread safety
@@ -23,8 +25,7 @@ namespace office {
     volatile bool openingRight = false; // volatile for thread safety
 
     std::string state = "none";
-    std::string buttonState = "up";
-    std::string doorButtonState = "up";
+    bool lightHeld = false;
 
     int leftButtonFrame = 0;
     int rightButtonFrame = 0;
@@ -43,13 +44,6 @@ namespace office {
     bool scareLeftPlayed = false;
     bool scareRightPlayed = false;
 
-    static inline char firstCharLower(const std::string& s, char def = 'n') {
-        if (s.empty()) return def;
-        char c = s[0];
-        if (c >= 'A' && c <= 'Z') c = char(c + ('a' - 'A'));
-        return c;
-    }
-
     void reset() {
         wichOfficeFrame = 0;
 
@@ -65,8 +59,8 @@ namespace office {
         openingRight = false;
 
         state = "none";
-        buttonState = "up";
-        doorButtonState = "up";
+        scroll = kStill;
+        lightHeld = false;
 
         leftButtonFrame = 0;
         rightButtonFrame = 0;
@@ -84,6 +78,76 @@ namespace office {
         rightEdge = true;
     }
 
+    // Everything scrolls together, so the first image's x places the rest
+    void saveSnapshot(snapshot::Writer& out) {
+        out.u8(wichOfficeFrame);
+        out.s16(xPos[0]);
+        out.flag(leftEdge);
+        out.flag(rightEdge);
+
+        out.flag(leftOn);
+        out.flag(rightOn);
+        out.flag(leftClosed);
+        out.flag(rightClosed);
+        out.flag(closingLeft);
+        out.flag(openingLeft);
+        out.flag(closingRight);
+        out.flag(openingRight);
+
+        out.u8(leftDoorTimer);
+        out.u8(rightDoorTimer);
+        out.u8(leftDoorFrame);
+        out.u8(rightDoorFrame);
+        out.flag(scareLeftPlayed);
+        out.flag(scareRightPlayed);
+    }
+
+    void restoreSnapshot(snapshot::Reader& in) {
+        wichOfficeFrame = in.u8();
+        main::setX();
+        const int shift = in.s16() - xPos[0];
+        for (int i = 0; i < 6; ++i) xPos[i] += shift;
+        leftEdge = in.flag();
+        rightEdge = in.flag();
+
+        leftOn = in.flag();
+        rightOn = in.flag();
+        leftClosed = in.flag();
+        rightClosed = in.flag();
+        closingLeft = in.flag();
+        openingLeft = in.flag();
+        closingRight = in.flag();
+        openingRight = in.flag();
+
+        leftDoorTimer = in.u8();
+        rightDoorTimer = in.u8();
+        leftDoorFrame = in.u8();
+        rightDoorFrame = in.u8();
+        scareLeftPlayed = in.flag();
+        scareRightPlayed = in.flag();
+
+        scroll = kStill;
+        lightHeld = false;
+        buttons::setButtonFrame();
+    }
+
+    void enter() {
+        power::update::setDrainTime();
+        main::setX();
+        animatronic::setDefault();
+
+        // Assets are already resident from the nightinfo preload
+        ambience::office::playAmbience();
+        ambience::office::playFanSound();
+        call::playPhoneCalls();
+    }
+
+    void exit() {
+        // A won night keeps these loaded for the next one; silence them meanwhile
+        mixer::stop(ambience::office::ambience);
+        mixer::stop(ambience::office::fan);
+    }
+
     namespace render {
         void renderOffice() {
             drawSpriteAlpha(0, 0, 480, 272, officeImage::office1Sprites[wichOfficeFrame], xPos[0], 0, 0);
@@ -117,13 +181,11 @@ namespace office {
         }
 
         void moveOffice() {
-            // Use first char checks to avoid heavy string comparisons
-            const char d = firstCharLower(dir, 'n'); // 'l' 'r' 'n'
             const int step = speed * speedMultiplier;
 
-            if (d == 'l' && xPos[1] > 364) {
+            if (scroll == kScrollLeft && xPos[1] > 364) {
                 for (int i = 0; i < 6; ++i) xPos[i] -= step;
-            } else if (d == 'r' && xPos[0] < 0) {
+            } else if (scroll == kScrollRight && xPos[0] < 0) {
                 for (int i = 0; i < 6; ++i) xPos[i] += step;
             }
 
@@ -154,18 +216,16 @@ namespace office {
 
     namespace lights {
         void lights() {
-            const char btn = firstCharLower(buttonState, 'u'); // 'd' or 'u'
-
-            if (btn == 'd') {
+            if (lightHeld) {
                 // Right side (triggered when at left edge)
                 if (leftEdge) {
-                    wichOfficeFrame = (animatronic::chika::position == 6) ? 4 : 1;
+                    wichOfficeFrame = (animatronic::table.position[animatronic::kChica] == 6) ? 4 : 1;
                     if (!rightOn) {
                         rightOn = true;
                         sfx::office::playLightOn(); // transition ON
                     }
                     // Scare once while light is held, if applicable
-                    if (animatronic::chika::position == 6 && !rightClosed) {
+                    if (animatronic::table.position[animatronic::kChica] == 6 && !rightClosed) {
                         if (!scareRightPlayed) {
                             sfx::office::playScare();
                             scareRightPlayed = true;
@@ -177,12 +237,12 @@ namespace office {
 
                 // Left side (triggered when at right edge)
                 if (rightEdge) {
-                    wichOfficeFrame = (animatronic::bonnie::position == 6) ? 3 : 2;
+                    wichOfficeFrame = (animatronic::table.position[animatronic::kBonnie] == 6) ? 3 : 2;
                     if (!leftOn) {
                         leftOn = true;
                         sfx::office::playLightOn(); // transition ON
                     }
-                    if (animatronic::bonnie::position == 6 && !leftClosed) {
+                    if (animatronic::table.position[animatronic::kBonnie] == 6 && !leftClosed) {
                         if (!scareLeftPlayed) {
                             sfx::office::playScare();
                             scareLeftPlayed = true;
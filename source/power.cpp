@@ -24,6 +24,22 @@ namespace power{
         ones = 9;
     }
 
+    void saveSnapshot(snapshot::Writer& out){
+        out.u8(usage);
+        out.u8(total);
+        out.s16(drainTime);
+        out.u8(tenths);
+        out.u8(ones);
+    }
+
+    void restoreSnapshot(snapshot::Reader& in){
+        usage = in.u8();
+        total = in.u8();
+        drainTime = in.s16();
+        tenths = in.u8();
+        ones = in.u8();
+    }
+
     namespace render{
         void renderPowerLeft(){
             drawSpriteAlpha(0, 0, 72, 17, sprite::UI::office::usageFrame, 10, 215, 0);
@@ -98,25 +114,7 @@ namespace update {
 
 
         void initPowerOut(){
-            state::isOffice = false;
-
-            //sprite::UI::office::unloadPowerInfo();
-            //sprite::office::unloadDoors();
-            //sprite::office::unloadButtons();
-            sprite::UI::office::unloadCamFlip();
-            //sprite::UI::office::unloadCamUi();
-            sprite::UI::office::unloadCams();
-
-            sfx::office::unloadSfx();
-            ambience::office::unloadAmbience();
-            ambience::office::unloadFanSound();
-
-            image::n_noPower::loadNoPower();
-
-            music::n_ending::loadEndingSong();
-            music::n_ending::playEndingSong();
-
-            state::isPowerOut = true;
+            state::request(state::kPowerOut);
         }
     }
 }
\ No newline at end of file
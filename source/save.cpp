@@ -1,4 +1,6 @@
 #include "included/save.hpp"
+#include "included/memory.hpp"
+#include <cstring>
 
 namespace save{
 
@@ -9,145 +11,304 @@ namespace save{
 
     bool loadedData = false;
 
-    std::string night;
-    std::string mode1;
-    std::string mode2;
-    std::string stars;
+    static const char* const kSavePath = "saves/save.bin";
+    static const char* const kTempPath = "saves/save.tmp";
 
-    void file(){
-        std::fstream nightData("saves/night.bin");
-        std::fstream extraMode1Data("saves/mode1.bin");
-        std::fstream extraMode2Data("saves/mode2.bin");
-        std::fstream starData("saves/star.bin");
-        
+    // What the record holds now; the disk catches up on the writer thread
+    static Record stored = {0, 1, 0, 0, 0};
+    static bool loadedFile = false;
 
-        if (!nightData && !extraMode1Data && !extraMode2Data && !starData){
-            clearData();
-            
-        }
+    // ==============================
+    // Record
+    // ==============================
+    // "FNSV", u16 version, u16 size, u32 generation, the four values,
+    // u32 CRC-32 of everything before it; little-endian
+    static constexpr unsigned char kMagic[4] = {'F', 'N', 'S', 'V'};
 
-        std::getline(nightData, night);
-        std::getline(extraMode1Data, mode1);
-        std::getline(extraMode2Data, mode2);
-        std::getline(starData, stars);
+    static unsigned int le16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+    static unsigned int le32(const unsigned char* p) { return le16(p) | (le16(p + 2) << 16); }
 
-        if (whichNight != 7){
-            readData();
-        }
+    static void put16(unsigned char* p, unsigned int value) {
+        p[0] = value & 0xff;
+        p[1] = (value >> 8) & 0xff;
     }
 
-    
-    void readData(){
-        if (night == "01101110 01101001 01100111 01101000 01110100 00100000 00110001"){ //night 1
-            whichNight = 1;
-        }
-        else if (night == "01101110 01101001 01100111 01101000 01110100 00100000 00110010"){ //night 2
-            whichNight = 2;
-        }
-        else if (night == "01101110 01101001 01100111 01101000 01110100 00100000 00110011"){ //night 3
-            whichNight = 3;
-        }
-        else if (night == "01101110 01101001 01100111 01101000 01110100 00100000 00110100"){ //night 4
-            whichNight = 4;
-        }
-        else if (night == "01101110 01101001 01100111 01101000 01110100 00100000 00110101"){ //night 5
-            whichNight = 5;
+    static void put32(unsigned char* p, unsigned int value) {
+        put16(p, value & 0xffff);
+        put16(p + 2, value >> 16);
+    }
+
+    unsigned int crc32(const unsigned char* data, int bytes) {
+        unsigned int crc = 0xffffffff;
+        for (int i = 0; i < bytes; ++i) {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
         }
+        return ~crc;
+    }
 
+    void encode(const Record& record, unsigned char* out) {
+        memcpy(out, kMagic, 4);
+        put16(out + 4, kVersion);
+        put16(out + 6, kRecordBytes);
+        put32(out + 8, record.generation);
+        out[12] = record.night;
+        out[13] = record.mode1;
+        out[14] = record.mode2;
+        out[15] = record.stars;
+        put32(out + 16, crc32(out, 16));
+    }
 
-        if (mode1 == "01101100 01101111 01100011 01101011 01100101 01100100"){ //locked m1
-            mode1Unlocked = 0;
-        }
-        else if (mode1 == "01110101 01101110 01101100 01101111 01100011 01101011 01100101 01100100"){ //unlocked m1
-            mode1Unlocked = 1;
+    bool decode(const unsigned char* in, int bytes, Record& record) {
+        if (bytes != kRecordBytes || memcmp(in, kMagic, 4) != 0) return false;
+        if (le16(in + 4) != kVersion || le16(in + 6) != kRecordBytes) return false;
+        if (le32(in + 16) != crc32(in, 16)) return false;
+        if (in[12] < 1 || in[12] > 5 || in[13] > 1 || in[14] > 1 || in[15] > 3) return false;
+        record.generation = le32(in + 8);
+        record.night = in[12];
+        record.mode1 = in[13];
+        record.mode2 = in[14];
+        record.stars = in[15];
+        return true;
+    }
+
+    // ==============================
+    // Disk
+    // ==============================
+    static bool readRecord(const char* path, Record& record) {
+        SceUID fd = sceIoOpen(path, PSP_O_RDONLY, 0);
+        if (fd < 0) return false;
+        unsigned char buffer[kRecordBytes + 1];
+        const int bytes = sceIoRead(fd, buffer, sizeof(buffer));
+        sceIoClose(fd);
+        return decode(buffer, bytes, record);
+    }
+
+    static bool writeRecord(const Record& record) {
+        const unsigned int start = sceKernelGetSystemTimeLow();
+        unsigned char buffer[kRecordBytes];
+        encode(record, buffer);
+
+        sceIoMkdir("saves", 0777);
+        SceUID fd = sceIoOpen(kTempPath, PSP_O_WRONLY | PSP_O_CREAT | PSP_O_TRUNC, 0777);
+        if (fd < 0) return false;
+        const bool written = sceIoWrite(fd, buffer, kRecordBytes) == kRecordBytes;
+        sceIoClose(fd);
+        if (!written) return false;
+
+        // The Memory Stick will not rename over a file. Until the rename
+        // lands, save.tmp is the newest good record and load() takes it.
+        sceIoRemove(kSavePath);
+        const bool renamed = sceIoRename(kTempPath, kSavePath) >= 0;
+        memory::reportSave("write", sceKernelGetSystemTimeLow() - start);
+        return renamed;
+    }
+
+    // The old saves: a line of ASCII binary per value, one file each
+    static const char* const kLegacyPaths[4] = {
+        "saves/night.bin", "saves/mode1.bin", "saves/mode2.bin", "saves/star.bin"
+    };
+    static const char* const kLegacyNights[5] = {
+        "01101110 01101001 01100111 01101000 01110100 00100000 00110001", // night 1
+        "01101110 01101001 01100111 01101000 01110100 00100000 00110010",
+        "01101110 01101001 01100111 01101000 01110100 00100000 00110011",
+        "01101110 01101001 01100111 01101000 01110100 00100000 00110100",
+        "01101110 01101001 01100111 01101000 01110100 00100000 00110101",
+    };
+    static const char* const kLegacyModes[2] = {
+        "01101100 01101111 01100011 01101011 01100101 01100100",                   // locked
+        "01110101 01101110 01101100 01101111 01100011 01101011 01100101 01100100", // unlocked
+    };
+    static const char* const kLegacyStars[4] = {
+        "01110011 01110100 01100001 01110010 00100000 00110000", // star 0
+        "01110011 01110100 01100001 01110010 00100000 00110001",
+        "01110011 01110100 01100001 01110010 00100000 00110010",
+        "01110011 01110100 01100001 01110010 00100000 00110011",
+    };
+
+    // Index of the file's first line in values, or -1 (no file counts as -2)
+    static int readLegacy(const char* path, const char* const* values, int count) {
+        SceUID fd = sceIoOpen(path, PSP_O_RDONLY, 0);
+        if (fd < 0) return -2;
+        char line[96];
+        const int bytes = sceIoRead(fd, line, sizeof(line) - 1);
+        sceIoClose(fd);
+        if (bytes <= 0) return -1;
+        line[bytes] = 0;
+        line[strcspn(line, "\r\n")] = 0;
+        for (int i = 0; i < count; ++i) {
+            if (strcmp(line, values[i]) == 0) return i;
         }
+        return -1;
+    }
 
+    // False when there are no old saves; values they do not hold stay as
+    // they are in record
+    static bool migrateLegacy(Record& record) {
+        const int night = readLegacy(kLegacyPaths[0], kLegacyNights, 5);
+        const int mode1 = readLegacy(kLegacyPaths[1], kLegacyModes, 2);
+        const int mode2 = readLegacy(kLegacyPaths[2], kLegacyModes, 2);
+        const int stars = readLegacy(kLegacyPaths[3], kLegacyStars, 4);
+        if (night == -2 && mode1 == -2 && mode2 == -2 && stars == -2) return false;
+        if (night >= 0) record.night = night + 1;
+        if (mode1 >= 0) record.mode1 = mode1;
+        if (mode2 >= 0) record.mode2 = mode2;
+        if (stars >= 0) record.stars = stars;
+        return true;
+    }
 
-        if (mode2 == "01101100 01101111 01100011 01101011 01100101 01100100"){ //locked m2
-            mode2Unlocked = 0;
+    static void load() {
+        const unsigned int start = sceKernelGetSystemTimeLow();
+        Record saved, temp;
+        const bool haveSaved = readRecord(kSavePath, saved);
+        const bool haveTemp = readRecord(kTempPath, temp);
+        if (haveSaved && (!haveTemp || saved.generation >= temp.generation)) {
+            stored = saved;
+            if (haveTemp) sceIoRemove(kTempPath); // a write before last whose remove failed
+        } else if (haveTemp) {
+            // A write whose rename never landed. Finish it now: the next write
+            // truncates save.tmp, and cut short there it would take the only copy.
+            stored = temp;
+            sceIoRemove(kSavePath);
+            sceIoRename(kTempPath, kSavePath);
+        } else {
+            if (migrateLegacy(stored)) {
+                // Once, at boot: the old files go only after the record is down
+                if (writeRecord(stored)) {
+                    for (const char* path : kLegacyPaths) sceIoRemove(path);
+                }
+            } else {
+                writeRecord(stored);
+            }
         }
-        else if (mode2 == "01110101 01101110 01101100 01101111 01100011 01101011 01100101 01100100"){ //unlocked m2
-            mode2Unlocked = 1;
+        memory::reportSave("load", sceKernelGetSystemTimeLow() - start);
+    }
+
+    // ==============================
+    // Writer
+    // ==============================
+    // saveData and clearData leave the record here and wake the thread;
+    // records queued faster than they are written collapse into the last
+    static Record pending;
+    static bool pendingWrite = false;
+    static bool writing = false;
+    static SceUID writerLock = -1;
+    static SceUID writerSignal = -1;
+    static SceUID writerThread = -1;
+
+    static inline void lockWriter()   { sceKernelWaitSema(writerLock, 1, nullptr); }
+    static inline void unlockWriter() { sceKernelSignalSema(writerLock, 1); }
+
+    static int writerWorker(SceSize, void*) {
+        for (;;) {
+            sceKernelWaitSema(writerSignal, 1, nullptr);
+            for (;;) {
+                lockWriter();
+                if (!pendingWrite) { unlockWriter(); break; }
+                const Record record = pending;
+                pendingWrite = false;
+                writing = true;
+                unlockWriter();
+
+                writeRecord(record);
+
+                lockWriter();
+                writing = false;
+                unlockWriter();
+            }
         }
+        return 0;
+    }
 
+    static void ensureWriter() {
+        if (writerLock < 0) {
+            writerLock = sceKernelCreateSema("save_writer", 0, 1, 1, nullptr);
+        }
+        if (writerSignal < 0) {
+            writerSignal = sceKernelCreateSema("save_pending", 0, 0, 8, nullptr);
+        }
+        if (writerThread < 0 && writerLock >= 0 && writerSignal >= 0) {
+            const int prio  = 0x30;    // below main (0x20): idle time only
+            const int stack = 0x1000;  // one 20-byte record
+            writerThread = sceKernelCreateThread("save_writer", writerWorker, prio, stack, 0, NULL);
+            if (writerThread >= 0) sceKernelStartThread(writerThread, 0, NULL);
+        }
+    }
 
-        if (stars == "01110011 01110100 01100001 01110010 00100000 00110000"){ //star 0
-            starAmount = 0;
+    static void queueWrite() {
+        stored.generation++;
+        ensureWriter();
+        if (writerThread < 0) {
+            writeRecord(stored); // no thread: write it here rather than lose it
+            return;
         }
-        else if (stars == "01110011 01110100 01100001 01110010 00100000 00110001"){ //star 1
-            starAmount = 1;
+        lockWriter();
+        pending = stored;
+        pendingWrite = true;
+        unlockWriter();
+        sceKernelSignalSema(writerSignal, 1);
+    }
+
+    void flush() {
+        if (writerThread < 0) return;
+        for (;;) {
+            lockWriter();
+            const bool busy = pendingWrite || writing;
+            unlockWriter();
+            if (!busy) return;
+            sceKernelDelayThread(1000);
         }
-        else if (stars == "01110011 01110100 01100001 01110010 00100000 00110010"){ //star 2
-            starAmount = 2;
+    }
+
+    // ==============================
+    // Game
+    // ==============================
+    void file(){
+        if (!loadedFile) {
+            load();
+            loadedFile = true;
         }
-        else if (stars == "01110011 01110100 01100001 01110010 00100000 00110011"){ //star 3
-            starAmount = 3;
+
+        if (whichNight != 7){
+            readData();
         }
+    }
+
+    void readData(){
+        whichNight = stored.night;
+        mode1Unlocked = stored.mode1;
+        mode2Unlocked = stored.mode2;
+        starAmount = stored.stars;
 
         loadedData = true;
     }
 
-
     void saveData(){
-        if (whichNight == 1){
-            std::remove("saves/night.bin");
-            std::ofstream nightData("saves/night.bin");
-            nightData << "01101110 01101001 01100111 01101000 01110100 00100000 00110010" << std::endl;
-        }
-        else if (whichNight == 2){
-            std::remove("saves/night.bin");
-            std::ofstream nightData("saves/night.bin");
-            nightData << "01101110 01101001 01100111 01101000 01110100 00100000 00110011" << std::endl;
-        }
-        else if (whichNight == 3){
-            std::remove("saves/night.bin");
-            std::ofstream nightData("saves/night.bin");
-            nightData << "01101110 01101001 01100111 01101000 01110100 00100000 00110100" << std::endl;
-        }
-        else if (whichNight == 4){
-            std::remove("saves/night.bin");
-            std::ofstream nightData("saves/night.bin");
-            nightData << "01101110 01101001 01100111 01101000 01110100 00100000 00110101" << std::endl;
+        if (whichNight >= 1 && whichNight <= 4){
+            stored.night = whichNight + 1;
         }
         else if (whichNight == 5){
-            std::remove("saves/mode1.bin");
-            std::ofstream extraMode1Data("saves/mode1.bin");
-            extraMode1Data << "01110101 01101110 01101100 01101111 01100011 01101011 01100101 01100100" << std::endl;
-
-            std::remove("saves/star.bin");
-            std::ofstream starData("saves/star.bin");
-            starData << "01110011 01110100 01100001 01110010 00100000 00110001" << std::endl;
+            stored.mode1 = 1;
+            stored.stars = 1;
         }
         else if (whichNight == 6){
-            std::remove("saves/mode2.bin");
-            std::ofstream extraMode2Data("saves/mode2.bin");
-            extraMode2Data << "01110101 01101110 01101100 01101111 01100011 01101011 01100101 01100100" << std::endl;
-
-            std::remove("saves/star.bin");
-            std::ofstream starData("saves/star.bin");
-            starData << "01110011 01110100 01100001 01110010 00100000 00110010" << std::endl;
+            stored.mode2 = 1;
+            stored.stars = 2;
         }
         else if (whichNight == 7){
-            std::remove("saves/star.bin");
-            std::ofstream starData("saves/star.bin");
-            starData << "01110011 01110100 01100001 01110010 00100000 00110011" << std::endl;
+            stored.stars = 3;
+        }
+        else {
+            return;
         }
+        queueWrite();
     }
 
     void clearData(){
-        std::remove("saves/night.bin");
-        std::remove("saves/mode1.bin");
-        std::remove("saves/mode2.bin");
-        std::remove("saves/star.bin");        
-        
-        std::ofstream nightData("saves/night.bin");
-        std::ofstream extraMode1Data("saves/mode1.bin");
-        std::ofstream extraMode2Data("saves/mode2.bin");
-        std::ofstream starData("saves/star.bin");
-
-        nightData << "01101110 01101001 01100111 01101000 01110100 00100000 00110001" << std::endl;
-        extraMode1Data << "01101100 01101111 01100011 01101011 01100101 01100100" << std::endl;
-        extraMode2Data << "01101100 01101111 01100011 01101011 01100101 01100100" << std::endl;
-        starData << "01110011 01110100 01100001 01110010 00100000 00110000" << std::endl;
-    }
-}
\ No newline at end of file
+        stored.night = 1;
+        stored.mode1 = 0;
+        stored.mode2 = 0;
+        stored.stars = 0;
+        queueWrite();
+    }
+}
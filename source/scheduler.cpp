@@ -0,0 +1,75 @@
+#include "included/scheduler.hpp"
+
+namespace scheduler {
+
+    static constexpr unsigned int kMask = Wheel::kSlots - 1;
+
+    Wheel::Wheel() : tick(0) {
+        for (int i = 0; i < kSlots; ++i) slots[i] = nullptr;
+    }
+
+    // Slot lists are kept sorted by order, so ties on a tick fire in a fixed order
+    void Wheel::link(Timer& timer) {
+        Timer** at = &slots[timer.due & kMask];
+        Timer* prev = nullptr;
+        while (*at && (*at)->order <= timer.order) {
+            prev = *at;
+            at = &(*at)->next;
+        }
+        timer.prev = prev;
+        timer.next = *at;
+        if (*at) (*at)->prev = &timer;
+        *at = &timer;
+        timer.armed = true;
+    }
+
+    void Wheel::unlink(Timer& timer) {
+        if (timer.prev) timer.prev->next = timer.next;
+        else slots[timer.due & kMask] = timer.next;
+        if (timer.next) timer.next->prev = timer.prev;
+        timer.next = timer.prev = nullptr;
+        timer.armed = false;
+    }
+
+    void Wheel::schedule(Timer& timer, int delay) {
+        if (timer.armed) unlink(timer);
+        timer.suspended = false;
+        timer.due = tick + static_cast<unsigned int>(delay > 0 ? delay : 0) + 1;
+        link(timer);
+    }
+
+    void Wheel::cancel(Timer& timer) {
+        if (timer.armed) unlink(timer);
+        timer.suspended = false;
+    }
+
+    void Wheel::park(Timer& timer) {
+        timer.remaining = static_cast<int>(timer.due - tick - 1);
+        unlink(timer);
+        timer.suspended = true;
+    }
+
+    int Wheel::remaining(const Timer& timer) const {
+        if (timer.suspended) return timer.remaining;
+        if (!timer.armed) return -1;
+        return static_cast<int>(timer.due - tick - 1);
+    }
+
+    int Wheel::fireDue() {
+        int fired = 0;
+
+        // Rescan from the head after every callback: a callback may cancel or
+        // reschedule anything, and the slot only holds a handful of timers
+        for (;;) {
+            Timer* timer = slots[tick & kMask];
+            while (timer && timer->due != tick) timer = timer->next;
+            if (!timer) break;
+
+            unlink(*timer);
+            if (timer->period > 0) schedule(*timer, timer->period);
+            timer->fire(timer);
+            ++fired;
+        }
+        return fired;
+    }
+}
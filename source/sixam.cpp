@@ -6,18 +6,20 @@ namespace sixam {
     int delayChange = 150;
     int delayReload = 500;
 
-    // Deferred transition
-    enum class Pending { None, Nightinfo, Ending, Menu };
-    static Pending pending = Pending::None;
-    static bool transitioning = false;
+    static bool requested = false;
 
     void reset() {
         whichNumber = 5;
         delayChange = 150;
         delayReload = 500;
 
-        pending = Pending::None;
-        transitioning = false;
+        requested = false;
+    }
+
+    void enter() {
+        saveIt::saveTheData();
+        sfx::sixam::playSixAm();
+        sprite::n_jumpscare::discard(0); // nobody attacks tonight any more
     }
 
     namespace saveIt {
@@ -56,30 +58,22 @@ namespace sixam {
     }
 
     namespace next {
-        // Keep clearRest here; we’ll call it from postFrame.
-        void clearRest() {
-            officeImage::unloadOffice2Sprites();
-
-            sprite::UI::office::unloadPowerInfo();
-            sprite::UI::office::unloadTimeInfo();
-            sprite::office::unloadDoors();
-            sprite::office::unloadButtons();
-        }
-
-        // These now just schedule transitions; actual work happens in sixam::postFrame()
         void initNightinfo() {
-            pending = Pending::Nightinfo;
+            save::readData();
+            state::request(state::kNightinfo);
         }
         void initEnding() {
-            pending = Pending::Ending;
+            state::request(state::kEnding);
         }
         void initMenu() {
-            pending = Pending::Menu;
+            save::readData();
+            state::request(state::kMenu);
         }
 
         void wait() {
             if (delayReload <= 0) {
-                if (pending == Pending::None) {
+                if (!requested) {
+                    requested = true;
                     switch (save::whichNight) {
                         case 5: case 7:
                             initEnding();
@@ -97,62 +91,4 @@ namespace sixam {
             }
         }
     }
-
-    // Call this after swap in your main loop (like ending::postFrame)
-    void postFrame() {
-        if (pending == Pending::None || transitioning) return;
-        transitioning = true;
-
-        // Leave sixam state first
-        state::isSixAm = false;
-
-        // Free office assets safely now
-        next::clearRest();
-
-        // Perform the scheduled transition
-        switch (pending) {
-            case Pending::Nightinfo: {
-                save::readData();
-                sprite::nightinfo::loadNightInfoSprite();
-                sfx::sixam::unloadSixAm();
-                state::isNightinfo = true;
-            } break;
-
-            case Pending::Ending: {
-                image::n_ending::loadEnding();
-                music::n_ending::loadEndingSong();
-                music::n_ending::playEndingSong();
-                state::isEnding = true;
-            } break;
-
-            case Pending::Menu: {
-                save::readData();
-
-                // CRITICAL: Unload pre-cached assets to prevent interference with menu system
-                text::preload::unloadCameraAssets();
-                text::preload::unloadJumpscareAssets();
-                sfx::preload::unloadCriticalAudio();
-
-                image::menu::loadMenuBackground();
-                image::menu::loadLogo();
-                sprite::menu::loadStar();
-                image::menu::loadCopyright();
-                text::global::loadNightText();
-
-                menu::menuCursor::moveCursor();
-
-                music::menu::loadMenuMusic();
-                music::menu::playMenuMusic();
-
-                state::isMenu = true;
-            } break;
-
-            case Pending::None:
-            default:
-                break;
-        }
-
-        pending = Pending::None;
-        transitioning = false;
-    }
-}
\ No newline at end of file
+}
@@ -0,0 +1,147 @@
+#include "included/snapshot.hpp"
+#include "included/save.hpp"
+#include "included/state.hpp"
+#include "included/animatronic.hpp"
+#include "included/office.hpp"
+#include "included/camera.hpp"
+#include "included/power.hpp"
+#include "included/time.hpp"
+#include "included/audio.hpp"
+#include "included/memory.hpp"
+#include <cstring>
+
+namespace snapshot {
+
+    static const char* const kResumePath = "saves/resume.bin";
+
+    // "FNRS", u16 version, u16 size, u8 night, then each module's fields,
+    // then the CRC-32 of everything before it
+    static constexpr unsigned char kMagic[4] = {'F', 'N', 'R', 'S'};
+    static constexpr int kHeaderBytes = 9;
+
+    enum Request { kIdle, kKeep, kDiscard };
+    static volatile int requested = kIdle;
+    static volatile bool handled = false;
+
+    int capture(unsigned char* out, int capacity) {
+        if (capacity < kHeaderBytes + 4) return 0;
+        Writer writer{out, out + capacity - 4, false};
+        for (unsigned char byte : kMagic) writer.u8(byte);
+        writer.s16(kVersion);
+        writer.s16(0); // size, once known
+        writer.u8(save::whichNight);
+
+        animatronic::saveSnapshot(writer);
+        office::saveSnapshot(writer);
+        camera::saveSnapshot(writer);
+        power::saveSnapshot(writer);
+        timegame::saveSnapshot(writer);
+        writer.flag(call::stopped);
+        if (writer.overflow) return 0;
+
+        const int bytes = static_cast<int>(writer.at - out) + 4;
+        Writer size{out + 6, out + 8, false};
+        size.s16(bytes);
+        Writer crc{writer.at, writer.at + 4, false};
+        crc.u32(save::crc32(out, bytes - 4));
+        return bytes;
+    }
+
+    int night(const unsigned char* in, int bytes) {
+        if (bytes < kHeaderBytes + 4 || memcmp(in, kMagic, 4) != 0) return 0;
+        Reader reader{in + 4, in + bytes, false};
+        if (reader.s16() != kVersion || reader.s16() != bytes) return 0;
+        const int night = reader.u8();
+        Reader crc{in + bytes - 4, in + bytes, false};
+        if (crc.u32() != save::crc32(in, bytes - 4)) return 0;
+        return night >= 1 && night <= 7 ? night : 0;
+    }
+
+    bool restore(const unsigned char* in, int bytes) {
+        const int playing = night(in, bytes);
+        if (!playing) return false;
+        save::whichNight = playing;
+
+        Reader reader{in + kHeaderBytes, in + bytes - 4, false};
+        animatronic::restoreSnapshot(reader);
+        office::restoreSnapshot(reader);
+        camera::restoreSnapshot(reader);
+        power::restoreSnapshot(reader);
+        timegame::restoreSnapshot(reader);
+        const bool callOver = reader.flag();
+        if (reader.overrun || reader.at != reader.end) return false;
+        // The call cannot pick up where it was; one already over stays over
+        if (callOver && !call::stopped) call::unloadPhoneCalls();
+        return true;
+    }
+
+    // A body that does not parse has been read partway into the modules;
+    // they go back to a fresh night, set up as office::enter sets it
+    static void startOver() {
+        timegame::reset();
+        office::reset();
+        power::reset();
+        animatronic::reset();
+        camera::reset();
+        power::update::setDrainTime();
+        animatronic::setDefault();
+    }
+
+    bool resume() {
+        SceUID fd = sceIoOpen(kResumePath, PSP_O_RDONLY, 0);
+        if (fd < 0) return false;
+        const unsigned int start = sceKernelGetSystemTimeLow();
+        unsigned char buffer[kMaxBytes];
+        const int bytes = sceIoRead(fd, buffer, sizeof(buffer));
+        sceIoClose(fd);
+        sceIoRemove(kResumePath); // once only, good or bad
+
+        const int playing = bytes > 0 ? night(buffer, bytes) : 0;
+        if (!playing) return false;
+
+        // The office's enter hook sets the night up from scratch; the
+        // snapshot goes on top of it
+        save::whichNight = playing;
+        state::start(state::kOffice);
+        if (!restore(buffer, bytes)) {
+            startOver();
+            return true;
+        }
+        memory::reportResume(bytes, sceKernelGetSystemTimeLow() - start);
+        return true;
+    }
+
+    static void write() {
+        unsigned char buffer[kMaxBytes];
+        const int bytes = capture(buffer, sizeof(buffer));
+        if (!bytes) return;
+        sceIoMkdir("saves", 0777);
+        SceUID fd = sceIoOpen(kResumePath, PSP_O_WRONLY | PSP_O_CREAT | PSP_O_TRUNC, 0777);
+        if (fd < 0) return;
+        sceIoWrite(fd, buffer, bytes);
+        sceIoClose(fd);
+        memory::reportSnapshot(bytes);
+    }
+
+    void request(bool keep, unsigned int timeoutMicros) {
+        handled = false;
+        requested = keep ? kKeep : kDiscard;
+        const unsigned int start = sceKernelGetSystemTimeLow();
+        while (!handled && sceKernelGetSystemTimeLow() - start < timeoutMicros) {
+            sceKernelDelayThread(1000);
+        }
+    }
+
+    // Between frames, so every module is caught on the same tick
+    void postFrame() {
+        const int what = requested;
+        if (what == kIdle) return;
+        requested = kIdle;
+        if (what == kKeep && state::current() == state::kOffice && !animatronic::jumpscaring) {
+            write();
+        } else {
+            sceIoRemove(kResumePath);
+        }
+        handled = true;
+    }
+}
@@ -1,17 +1,372 @@
 #include "included/state.hpp"
+#include "included/image2.hpp"
+#include "included/audio.hpp"
+#include "included/mixer.hpp"
+#include "included/memory.hpp"
+#include "included/menu.hpp"
+#include "included/customnight.hpp"
+#include "included/office.hpp"
+#include "included/sixam.hpp"
+#include "included/powerout.hpp"
+#include "included/jumpscare.hpp"
+#include "included/dead.hpp"
+#include "included/ending.hpp"
 
 namespace state{
-    bool isMenu = true;
-    bool isNewspaper = false;
-    bool isNightinfo = false;
-    bool isOffice = false;
-    bool isCustomNight = false;
-    bool isSixAm = false;
-    bool isPowerOut = false;
-    bool isDead = false;
-    bool isEnding = false;
-    bool isJumpscare = false;
     volatile bool isFoxyAttackPaused = false; // volatile for thread safety
 
-    //bool endOfNight = false;
-}
\ No newline at end of file
+    // ==============================
+    // Asset groups
+    // ==============================
+    // One bit per group. The office groups come in the order nightinfo
+    // preloads them.
+    enum Asset {
+        kMenuScreen,
+        kMenuMusic,
+        kNewspaperImage,
+        kNightinfoSprite,
+        kCustomNightUi,
+        kDifficultyTable,
+        kOffice1,
+        kOffice2,
+        kButtons,
+        kDoors,
+        kCamFlip,
+        kPowerInfo,
+        kTimeInfo,
+        kCams,
+        kCamUi,
+        kAmbience,
+        kFan,
+        kOfficeSfx,
+        kPhoneCalls,
+        kCameraPrecache,
+        kJumpscarePrecache,
+        kAudioPrecache,
+        kSixAmSound,
+        kNoPower,
+        kEndingSong,
+        kEndingImage,
+        kJumpscareFrames,
+        kJumpscareSound,
+        kDeadSound,
+        kAssetCount
+    };
+    static_assert(kAssetCount <= 32, "asset groups must fit a manifest");
+
+    typedef unsigned int Manifest;
+    static constexpr Manifest bit(Asset asset) { return 1u << asset; }
+
+    static void loadMenuScreen() {
+        image::menu::loadMenuBackground();
+        image::menu::loadLogo();
+        image::menu::loadCopyright();
+        image::menu::loadTextAndCursor();
+        sprite::menu::loadStar();
+    }
+    static void unloadMenuScreen() {
+        image::menu::unloadMenuBackground();
+        image::menu::unloadLogo();
+        image::menu::unloadCopyright();
+        image::menu::unloadTextAndCursor();
+        sprite::menu::unloadStar();
+    }
+
+    static void loadCustomNightUi() {
+        sprite::UI::customnight::loadIcons();
+        sprite::UI::customnight::loadReticle();
+        sprite::UI::customnight::loadInstructions();
+        sprite::UI::customnight::loadTitle();
+        sprite::UI::customnight::loadArrows();
+        sprite::UI::customnight::loadText();
+        sprite::UI::customnight::loadNames();
+        sprite::UI::customnight::loadActions();
+        sprite::UI::customnight::loadGoldenFreddy();
+    }
+    static void unloadCustomNightUi() {
+        sprite::UI::customnight::unloadIcons();
+        sprite::UI::customnight::unloadReticle();
+        sprite::UI::customnight::unloadInstructions();
+        sprite::UI::customnight::unloadTitle();
+        sprite::UI::customnight::unloadArrows();
+        sprite::UI::customnight::unloadText();
+        sprite::UI::customnight::unloadNames();
+        sprite::UI::customnight::unloadActions();
+        sprite::UI::customnight::unloadGoldenFreddy();
+    }
+
+    struct AssetGroup {
+        const char* name;
+        void (*load)();
+        void (*unload)();
+    };
+
+    static const AssetGroup kAssets[kAssetCount] = {
+        {"menu screen",       loadMenuScreen,                         unloadMenuScreen},
+        {"menu music",        music::menu::loadMenuMusic,             music::menu::unloadMenuMusic},
+        {"newspaper",         image::n_newspaper::loadNewsPaper,      image::n_newspaper::unloadNewsPaper},
+        {"nightinfo",         sprite::nightinfo::loadNightInfoSprite, sprite::nightinfo::unloadNightInfoSprite},
+        {"custom night ui",   loadCustomNightUi,                      unloadCustomNightUi},
+        {"difficulty table",  customnight::loadTable,                 customnight::unloadTable},
+        {"office 1",          officeImage::loadOffice1Sprites,        officeImage::unloadOffice1Sprites},
+        {"office 2",          officeImage::loadOffice2Sprites,        officeImage::unloadOffice2Sprites},
+        {"buttons",           sprite::office::loadButtons,            sprite::office::unloadButtons},
+        {"doors",             sprite::office::loadDoors,              sprite::office::unloadDoors},
+        {"cam flip",          sprite::UI::office::loadCamFlip,        sprite::UI::office::unloadCamFlip},
+        {"power info",        sprite::UI::office::loadPowerInfo,      sprite::UI::office::unloadPowerInfo},
+        {"time info",         sprite::UI::office::loadTimeInfo,       sprite::UI::office::unloadTimeInfo},
+        {"cams",              sprite::UI::office::loadAllCams,        sprite::UI::office::unloadCams},
+        {"cam ui",            sprite::UI::office::loadCamUi,          sprite::UI::office::unloadCamUi},
+        {"ambience",          ambience::office::loadAmbience,         ambience::office::unloadAmbience},
+        {"fan",               ambience::office::loadFanSound,         ambience::office::unloadFanSound},
+        {"office sfx",        sfx::office::loadSfx,                   sfx::office::unloadSfx},
+        {"phone calls",       call::loadPhoneCalls,                   call::unloadPhoneCalls},
+        {"camera precache",   text::preload::preloadCameraAssets,     text::preload::unloadCameraAssets},
+        {"jumpscare precache", text::preload::preloadJumpscareAssets, text::preload::unloadJumpscareAssets},
+        {"audio precache",    sfx::preload::preloadCriticalAudio,     sfx::preload::unloadCriticalAudio},
+        {"six am sound",      sfx::sixam::loadSixAm,                  sfx::sixam::unloadSixAm},
+        {"no power",          image::n_noPower::loadNoPower,          image::n_noPower::unloadNoPower},
+        {"ending song",       music::n_ending::loadEndingSong,        music::n_ending::unloadEndingSong},
+        {"ending image",      image::n_ending::loadEnding,            image::n_ending::unloadEnding},
+        {"jumpscare frames",  sprite::n_jumpscare::loadJumpscare,     sprite::n_jumpscare::unloadJumpscare}, // whichJumpscare picks the set
+        {"jumpscare sound",   sfx::jumpscare::loadJumpscareSound,     sfx::jumpscare::unloadJumpscareSound},
+        {"dead sound",        sfx::jumpscare::loadDeadSound,          sfx::jumpscare::unloadDeadSound},
+    };
+
+    // Groups whose contents follow the game rather than the file list: a
+    // held copy is loaded again on the way back in, and the loader only
+    // decodes what changed (the cameras follow the animatronic positions)
+    static constexpr Manifest kRefreshed = bit(kCams);
+
+    // Retained groups are dropped, largest first, while textures and audio
+    // together would sit above this. A fat PSP's 24 MB of user memory also
+    // has to fit the code, the streams' buffers and the heap.
+    static constexpr size_t kRetainCeiling = 16 * 1024 * 1024;
+
+    // Groups freed per frame after a switch; the office takes about eight
+    // frames, well inside the jumpscare
+    static constexpr int kReleasesPerFrame = 2;
+
+    // ==============================
+    // States
+    // ==============================
+    static constexpr Manifest kOfficeManifest =
+        bit(kOffice1) | bit(kOffice2) | bit(kButtons) | bit(kDoors) | bit(kCamFlip) | bit(kPowerInfo) |
+        bit(kTimeInfo) | bit(kCams) | bit(kCamUi) | bit(kAmbience) | bit(kFan) | bit(kOfficeSfx) |
+        bit(kPhoneCalls) | bit(kCameraPrecache) | bit(kJumpscarePrecache) | bit(kAudioPrecache);
+
+    // What a won night carries to the next one; the phone call is per night
+    static constexpr Manifest kNextNight = kOfficeManifest & ~bit(kPhoneCalls);
+
+    static constexpr Manifest kCustomNightManifest = bit(kCustomNightUi) | bit(kDifficultyTable);
+
+    struct State {
+        const char* name;
+        Manifest manifest;
+        Manifest retain;     // kept through this state if already resident
+        void (*enter)();     // after the manifest is resident
+        void (*exit)();      // before anything is freed
+        void (*postFrame)(); // after every presented frame while current
+    };
+
+    static const State kStates[kCount] = {
+        {"menu",        bit(kMenuScreen) | bit(kMenuMusic),    0,               menu::enter,     nullptr,      nullptr},
+        {"newspaper",   bit(kNewspaperImage),                  0,               nullptr,         nullptr,      nullptr},
+        {"nightinfo",   bit(kNightinfoSprite),                 kOfficeManifest, nullptr,         nullptr,      nullptr},
+        {"office",      kOfficeManifest,                       0,               office::enter,   office::exit, nullptr},
+        {"customnight", kCustomNightManifest,                  0,               nullptr,         nullptr,      nullptr},
+        {"sixam",       bit(kTimeInfo) | bit(kSixAmSound),     kNextNight,      sixam::enter,    nullptr,      nullptr},
+        {"powerout",    bit(kNoPower) | bit(kEndingSong),      0,               powerout::enter, nullptr,      nullptr},
+        {"jumpscare",   bit(kJumpscareFrames) | bit(kJumpscareSound), 0,        nullptr,         nullptr,      jumpscare::load::loadWithDelay},
+        {"ending",      bit(kEndingImage) | bit(kEndingSong),  0,               ending::enter,   nullptr,      nullptr},
+        {"dead",        bit(kDeadSound),                       0,               dead::enter,     nullptr,      nullptr},
+    };
+
+    static constexpr unsigned int to(Id id) { return 1u << id; }
+
+    // Where each state may go
+    static const unsigned int kTransitions[kCount] = {
+        to(kNewspaper) | to(kNightinfo) | to(kCustomNight), // menu
+        to(kNightinfo),                                     // newspaper
+        to(kOffice),                                        // nightinfo
+        to(kSixAm) | to(kPowerOut) | to(kJumpscare),        // office
+        to(kNightinfo) | to(kMenu),                         // customnight
+        to(kNightinfo) | to(kEnding) | to(kMenu),           // sixam
+        to(kJumpscare),                                     // powerout
+        to(kDead),                                          // jumpscare
+        to(kMenu),                                          // ending
+        to(kMenu),                                          // dead
+    };
+
+    static Id currentState = kNone;
+    static Id pendingState = kNone;
+    static Manifest resident = 0;
+    static Manifest stale = 0;            // held kRefreshed groups due a reload
+    static Manifest releasing = 0;        // resident groups no state wants any more
+    static size_t groupBytes[kAssetCount]; // measured on each group's last full load
+    static bool retention = true;          // off only for tests/state's reload pass
+
+    static size_t residentBytes() {
+        return static_cast<size_t>(imageRamAlloc) + audio::residentBytes();
+    }
+
+    Id current() { return currentState; }
+
+    const char* name(Id id) {
+        return id < kCount ? kStates[id].name : "none";
+    }
+
+    static void loadGroup(int asset) {
+        const Manifest mask = bit(static_cast<Asset>(asset));
+        const bool full = !(resident & mask);
+        const size_t before = residentBytes();
+        kAssets[asset].load();
+        if (full) {
+            const size_t after = residentBytes();
+            groupBytes[asset] = after > before ? after - before : 0;
+        }
+        resident |= mask;
+        stale &= ~mask;
+    }
+
+    // Groups of a manifest that still need a load
+    static Manifest missing(Manifest wanted) {
+        return wanted & (~resident | stale);
+    }
+
+    static void load(Manifest wanted) {
+        const Manifest todo = missing(wanted);
+        for (int asset = 0; asset < kAssetCount; ++asset) {
+            if (todo & bit(static_cast<Asset>(asset))) loadGroup(asset);
+        }
+    }
+
+    static void unload(Manifest unwanted) {
+        for (int asset = 0; asset < kAssetCount; ++asset) {
+            const Manifest mask = bit(static_cast<Asset>(asset));
+            if ((unwanted & mask) && (resident & mask)) {
+                kAssets[asset].unload();
+                resident &= ~mask;
+                stale &= ~mask;
+                releasing &= ~mask;
+            }
+        }
+    }
+
+    // Frees up to count groups still waiting to be released
+    static void release(int count) {
+        for (int asset = 0; asset < kAssetCount && count > 0; ++asset) {
+            const Manifest mask = bit(static_cast<Asset>(asset));
+            if (releasing & mask) {
+                const unsigned int start = sceKernelGetSystemTimeLow();
+                unload(mask);
+                memory::reportRelease(kAssets[asset].name, sceKernelGetSystemTimeLow() - start);
+                --count;
+            }
+        }
+    }
+
+    // Makes room until what stays plus what the manifest still has to load
+    // fits under the ceiling: pending releases go first, then held groups,
+    // largest first
+    static void trim(Manifest held, Manifest manifest) {
+        size_t incoming = 0;
+        const Manifest todo = missing(manifest);
+        for (int asset = 0; asset < kAssetCount; ++asset) {
+            if (todo & bit(static_cast<Asset>(asset))) incoming += groupBytes[asset];
+        }
+        while (residentBytes() + incoming > kRetainCeiling) {
+            if (releasing) {
+                unload(releasing);
+                continue;
+            }
+            if (!held) break;
+            int largest = -1;
+            for (int asset = 0; asset < kAssetCount; ++asset) {
+                if ((held & bit(static_cast<Asset>(asset))) &&
+                    (largest < 0 || groupBytes[asset] > groupBytes[largest])) {
+                    largest = asset;
+                }
+            }
+            held &= ~bit(static_cast<Asset>(largest));
+            unload(bit(static_cast<Asset>(largest)));
+        }
+    }
+
+    static void enter(Id next) {
+        const State& from = kStates[currentState];
+        const State& into = kStates[next];
+        if (from.exit) from.exit();
+
+        // Report the state we're leaving while its assets are still loaded
+        memory::reportTextureSavings(from.name);
+        memory::reportAudioResident(from.name, audio::residentBytes());
+        mixer::report(from.name);
+
+        // What the next state neither needs nor retains is released over the
+        // following frames (see postFrame), so the switch only pays for loads;
+        // retained groups stay as long as they fit
+        const Manifest keep = into.manifest | (retention ? into.retain : 0);
+        releasing = (releasing | resident) & ~keep;
+        const Manifest held = resident & ~releasing & ~into.manifest;
+        trim(held, into.manifest);
+        stale |= resident & ~releasing & ~into.manifest & kRefreshed;
+        load(into.manifest);
+
+        currentState = next;
+        if (into.enter) into.enter();
+    }
+
+    void start(Id first) {
+        if (currentState != kNone || first >= kCount) return;
+        load(kStates[first].manifest);
+        currentState = first;
+        if (kStates[first].enter) kStates[first].enter();
+    }
+
+    void startLoaded(Id first) {
+        if (currentState != kNone || first >= kCount) return;
+        resident |= kStates[first].manifest;
+        currentState = first;
+        if (kStates[first].enter) kStates[first].enter();
+    }
+
+    void request(Id next) {
+        if (pendingState != kNone || currentState == kNone || next >= kCount) return;
+        if (!(kTransitions[currentState] & to(next))) {
+            DEBUG_PRINTF("state: no transition %s -> %s\n", name(currentState), name(next));
+            return;
+        }
+        pendingState = next;
+    }
+
+    bool preloadStep(Id next) {
+        if (next >= kCount) return true;
+        releasing &= ~kStates[next].manifest;
+        const Manifest todo = missing(kStates[next].manifest);
+        for (int asset = 0; asset < kAssetCount; ++asset) {
+            const Manifest mask = bit(static_cast<Asset>(asset));
+            if (todo & mask) {
+                loadGroup(asset);
+                return (todo & ~mask) == 0;
+            }
+        }
+        return true;
+    }
+
+    void postFrame(unsigned int frameMicros) {
+        if (pendingState != kNone) {
+            const Id from = currentState;
+            const Id next = pendingState;
+            const unsigned int start = sceKernelGetSystemTimeLow();
+            pendingState = kNone;
+            enter(next);
+            memory::reportTransition(name(from), name(next), frameMicros, sceKernelGetSystemTimeLow() - start);
+        } else {
+            release(kReleasesPerFrame);
+        }
+        if (currentState != kNone && kStates[currentState].postFrame) {
+            kStates[currentState].postFrame();
+        }
+    }
+}
@@ -0,0 +1,631 @@
+#include "included/stream.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace stream {
+
+    volatile int underruns = 0;
+    int allocations = 0;
+
+    static constexpr int kOutputRate = 44100;
+    static constexpr int kRawChunkBytes = 512;
+    static constexpr int kVagFrameBytes = 16;   // 2 header bytes + 28 nibbles
+    static constexpr int kVagFrameSamples = 28;
+    static constexpr int kChunkFrames = kRawChunkBytes / kVagFrameBytes * kVagFrameSamples;
+
+    enum Codec { kPcm, kVag };
+
+    // VAG predictor coefficients, in 1/64ths
+    static const int kVagFilters[5][2] = {
+        {0, 0}, {60, 0}, {115, -52}, {98, -55}, {122, -60}
+    };
+
+    struct Stream {
+        char path[64];
+        SceUID fd;
+        unsigned char* memory;   // whole data of a resident sound, else null
+        int dataOffset;          // start of the sample data in the file
+        int dataBytes;           // length of the sample data
+        int readBytes;           // how far into the data we have read
+        int codec;
+        int channels, bits, step; // step: output frames per source frame
+        int frameBytes;          // smallest readable unit: one PCM frame or one VAG frame per channel
+        int history[2][2];       // VAG predictor state per channel
+
+        short pcm[kChunkFrames * 2]; // one decoded chunk, stereo at the source rate
+        int pcmFrames, pcmPos;
+
+        short* buffers[2];       // stereo s16 at 44.1 kHz
+        int bufferFrames;
+        volatile int filled[2];  // frames ready in each buffer, 0 == empty
+        int fillBuffer;          // buffers are filled and played in turn
+        int playBuffer, playPos;
+        volatile bool eof;
+
+        unsigned char raw[kRawChunkBytes];
+        OSL_SOUND* sound;
+        Stream* next;
+    };
+
+    static Stream* streams = nullptr;
+    static SceUID listLock = -1;
+    static SceUID wakeSema = -1;
+    static SceUID thread = -1;
+
+    static inline void lock()   { sceKernelWaitSema(listLock, 1, nullptr); }
+    static inline void unlock() { sceKernelSignalSema(listLock, 1); }
+
+    static void* allocate(size_t bytes, bool zero = false) {
+        void* p = zero ? calloc(1, bytes) : malloc(bytes);
+        if (p) allocations++;
+        return p;
+    }
+
+    static inline unsigned int le16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+    static inline unsigned int le32(const unsigned char* p) { return le16(p) | (le16(p + 2) << 16); }
+    static inline unsigned int be32(const unsigned char* p) { return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+
+    static bool setRate(Stream* st, int rate) {
+        if (rate <= 0 || kOutputRate % rate != 0) return false;
+        st->step = kOutputRate / rate;
+        return true;
+    }
+
+    // Finds the fmt and data chunks; only plain PCM at 11/22/44 kHz is handled
+    static bool parseWav(Stream* st) {
+        unsigned char header[12];
+        if (sceIoRead(st->fd, header, 12) != 12) return false;
+        if (memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) return false;
+
+        bool haveFormat = false;
+        int pos = 12;
+        for (;;) {
+            unsigned char chunk[24];
+            if (sceIoRead(st->fd, chunk, 8) != 8) return false;
+            const int length = (int)le32(chunk + 4);
+            pos += 8;
+            if (memcmp(chunk, "fmt ", 4) == 0) {
+                if (length < 16 || sceIoRead(st->fd, chunk + 8, 16) != 16) return false;
+                const int format = le16(chunk + 8);
+                st->channels = le16(chunk + 10);
+                st->bits = le16(chunk + 22);
+                if (format != 1 || !setRate(st, (int)le32(chunk + 12))) return false;
+                if (st->channels < 1 || st->channels > 2 || (st->bits != 8 && st->bits != 16)) return false;
+                st->frameBytes = st->channels * st->bits / 8;
+                haveFormat = true;
+                sceIoLseek32(st->fd, pos + length + (length & 1), PSP_SEEK_SET);
+            } else if (memcmp(chunk, "data", 4) == 0) {
+                st->codec = kPcm;
+                st->dataOffset = pos;
+                st->dataBytes = length - length % (haveFormat ? st->frameBytes : 1);
+                return haveFormat;
+            } else {
+                sceIoLseek32(st->fd, pos + length + (length & 1), PSP_SEEK_SET);
+            }
+            pos += length + (length & 1);
+        }
+    }
+
+    // ADPCM from tools/vagenc: 48-byte big-endian "VAGp" header with the
+    // channel count in byte 0x1e, then 16-byte frames interleaved per channel
+    static bool parseVag(Stream* st) {
+        unsigned char header[48];
+        if (sceIoRead(st->fd, header, 48) != 48 || memcmp(header, "VAGp", 4) != 0) return false;
+        st->codec = kVag;
+        st->channels = header[0x1e] ? header[0x1e] : 1;
+        st->bits = 16;
+        if (st->channels > 2 || !setRate(st, (int)be32(header + 16))) return false;
+        st->frameBytes = kVagFrameBytes * st->channels;
+        st->dataOffset = 48;
+        st->dataBytes = (int)be32(header + 12);
+        st->dataBytes -= st->dataBytes % st->frameBytes;
+        return true;
+    }
+
+    // Prefers the .vag written next to the WAV, falling back to the WAV itself
+    static bool openSource(Stream* st, const char* path) {
+        char vagPath[sizeof(st->path)];
+        strncpy(vagPath, path, sizeof(vagPath) - 1);
+        vagPath[sizeof(vagPath) - 1] = 0;
+        char* ext = strrchr(vagPath, '.');
+        if (ext && strlen(vagPath) + 1 < sizeof(vagPath)) {
+            strcpy(ext, ".vag");
+            st->fd = sceIoOpen(vagPath, PSP_O_RDONLY, 0);
+            if (st->fd >= 0) {
+                if (parseVag(st)) {
+                    strcpy(st->path, vagPath);
+                    return true;
+                }
+                DEBUG_PRINTF("stream: bad vag header %s\n", vagPath);
+                sceIoClose(st->fd);
+            }
+        }
+        snprintf(st->path, sizeof(st->path), "%s", path);
+        st->fd = sceIoOpen(path, PSP_O_RDONLY, 0);
+        if (st->fd < 0) return false;
+        if (parseWav(st)) return true;
+        sceIoClose(st->fd);
+        st->fd = -1;
+        return false;
+    }
+
+    static bool looping(Stream* st) {
+        return st->sound->endCallback == oslSoundLoopFunc;
+    }
+
+    // Everything has been decoded, so an empty buffer means the end, not an underrun
+    static bool atEnd(Stream* st) {
+        return st->readBytes >= st->dataBytes && st->pcmPos >= st->pcmFrames && !looping(st);
+    }
+
+    static void rewind(Stream* st) {
+        st->readBytes = 0;
+        st->pcmFrames = st->pcmPos = 0;
+        memset(st->history, 0, sizeof(st->history));
+        if (!st->memory) sceIoLseek32(st->fd, st->dataOffset, PSP_SEEK_SET);
+    }
+
+    // Reads up to maxBytes of sample data, reopening the file if a stand-by closed it
+    static int readRaw(Stream* st, int maxBytes) {
+        int got = sceIoRead(st->fd, st->raw, maxBytes);
+        if (got < 0) {
+            sceIoClose(st->fd);
+            st->fd = sceIoOpen(st->path, PSP_O_RDONLY, 0);
+            if (st->fd < 0) return -1;
+            sceIoLseek32(st->fd, st->dataOffset + st->readBytes, PSP_SEEK_SET);
+            got = sceIoRead(st->fd, st->raw, maxBytes);
+        }
+        return got;
+    }
+
+    static inline int clamp16(int v) {
+        return v < -32768 ? -32768 : (v > 32767 ? 32767 : v);
+    }
+
+    // One 28-sample VAG frame into every other slot of out
+    static void decodeVagFrame(const unsigned char* in, int* history, short* out) {
+        int filter = in[0] >> 4;
+        const int shift = in[0] & 15;
+        if (filter > 4) filter = 0;
+        const int f0 = kVagFilters[filter][0], f1 = kVagFilters[filter][1];
+        int h1 = history[0], h2 = history[1];
+        for (int i = 0; i < kVagFrameSamples; ++i) {
+            const int nibble = (in[2 + (i >> 1)] >> ((i & 1) << 2)) & 15;
+            const int sample = clamp16(((short)(nibble << 12) >> shift) + ((h1 * f0 + h2 * f1 + 32) >> 6));
+            h2 = h1;
+            h1 = sample;
+            out[i * 2] = (short)sample;
+        }
+        history[0] = h1;
+        history[1] = h2;
+    }
+
+    // Reads and decodes the next chunk into st->pcm; false at the end of the data
+    static bool decodeChunk(Stream* st) {
+        st->pcmFrames = st->pcmPos = 0;
+        if (st->readBytes >= st->dataBytes) {
+            if (!looping(st)) return false;
+            rewind(st);
+        }
+
+        int wantBytes = kRawChunkBytes - kRawChunkBytes % st->frameBytes;
+        if (wantBytes > st->dataBytes - st->readBytes) wantBytes = st->dataBytes - st->readBytes;
+        // Resident data is decoded in place
+        const int got = st->memory ? wantBytes : readRaw(st, wantBytes);
+        const unsigned char* raw = st->memory ? st->memory + st->readBytes : st->raw;
+        if (got < st->frameBytes) {
+            st->readBytes = st->dataBytes; // treat read errors as end of data
+            return false;
+        }
+        st->readBytes += got;
+
+        const int units = got / st->frameBytes;
+        if (st->codec == kVag) {
+            for (int u = 0; u < units; ++u) {
+                short* out = st->pcm + u * kVagFrameSamples * 2;
+                const unsigned char* in = raw + u * st->frameBytes;
+                decodeVagFrame(in, st->history[0], out);
+                if (st->channels == 2) {
+                    decodeVagFrame(in + kVagFrameBytes, st->history[1], out + 1);
+                } else {
+                    for (int i = 0; i < kVagFrameSamples; ++i) out[i * 2 + 1] = out[i * 2];
+                }
+            }
+            st->pcmFrames = units * kVagFrameSamples;
+        } else {
+            for (int i = 0; i < units; ++i) {
+                int left, right;
+                if (st->bits == 16) {
+                    // Byte loads: raw sits at an odd offset in Stream, and the
+                    // Allegrex faults on a misaligned halfword
+                    const unsigned char* s = raw + i * st->frameBytes;
+                    left = (short)le16(s);
+                    right = st->channels == 2 ? (short)le16(s + 2) : left;
+                } else {
+                    const unsigned char* s = raw + i * st->frameBytes;
+                    left = ((int)s[0] - 128) << 8;
+                    right = st->channels == 2 ? ((int)s[1] - 128) << 8 : left;
+                }
+                st->pcm[i * 2]     = (short)left;
+                st->pcm[i * 2 + 1] = (short)right;
+            }
+            st->pcmFrames = units;
+        }
+        return true;
+    }
+
+    // Fills one block of output; returns the number of frames produced.
+    // frames is a multiple of 4, so an 11 kHz sample never straddles two blocks.
+    static int fill(Stream* st, short* out, int frames) {
+        int produced = 0;
+        while (produced < frames) {
+            if (st->pcmPos >= st->pcmFrames && !decodeChunk(st)) break;
+
+            int count = (frames - produced) / st->step;
+            if (count > st->pcmFrames - st->pcmPos) count = st->pcmFrames - st->pcmPos;
+            if (count <= 0) break;
+            const short* in = st->pcm + st->pcmPos * 2;
+            if (st->step == 1) {
+                memcpy(out + produced * 2, in, count * 4);
+                produced += count;
+            } else {
+                for (int i = 0; i < count; ++i) {
+                    for (int k = 0; k < st->step; ++k) {
+                        out[produced * 2]     = in[i * 2];
+                        out[produced * 2 + 1] = in[i * 2 + 1];
+                        produced++;
+                    }
+                }
+            }
+            st->pcmPos += count;
+        }
+        return produced;
+    }
+
+    static int streamThread(SceSize, void*) {
+        for (;;) {
+            // Woken when a buffer is consumed; the timeout covers missed signals
+            SceUInt timeout = 20000;
+            sceKernelWaitSema(wakeSema, 1, &timeout);
+
+            lock();
+            for (Stream* st = streams; st; st = st->next) {
+                if (st->memory) continue; // decoded by the mixer
+                while (!st->eof && st->filled[st->fillBuffer] == 0) {
+                    const int b = st->fillBuffer;
+                    const int frames = fill(st, st->buffers[b], st->bufferFrames);
+                    if (frames > 0) {
+                        st->filled[b] = frames;
+                        st->fillBuffer = b ^ 1;
+                    }
+                    if (frames == 0 || atEnd(st)) st->eof = true;
+                }
+            }
+            unlock();
+        }
+        return 0;
+    }
+
+    static void ensureThread() {
+        if (listLock < 0) listLock = sceKernelCreateSema("stream_lock", 0, 1, 1, nullptr);
+        if (wakeSema < 0) wakeSema = sceKernelCreateSema("stream_wake", 0, 0, 8, nullptr);
+        if (thread < 0) {
+            // Above the main thread so decoding keeps up while a frame is busy
+            thread = sceKernelCreateThread("stream_thread", streamThread, 0x12, 0x4000, 0, nullptr);
+            if (thread >= 0) sceKernelStartThread(thread, 0, nullptr);
+        }
+    }
+
+    // Resident sounds are small enough to decode right here, one mixing block at a time
+    static int residentCallback(Stream* st, short* out, unsigned int reqn) {
+        const int done = fill(st, out, (int)reqn);
+        if (done == 0) return 0; // finished
+        if (done < (int)reqn) memset(out + done * 2, 0, (reqn - done) * 4);
+        return 1;
+    }
+
+    // One block of output for whoever is playing the stream; 0 once it has finished
+    static int render(Stream* st, short* out, unsigned int reqn) {
+        unsigned int done = 0;
+        if (st->memory) return residentCallback(st, out, reqn);
+
+        while (done < reqn) {
+            const int b = st->playBuffer;
+            const int available = st->filled[b] - st->playPos;
+            if (st->filled[b] == 0) {
+                if (st->eof && st->filled[b ^ 1] == 0) {
+                    if (done == 0) return 0; // finished
+                    break;
+                }
+                underruns++;
+                break;
+            }
+
+            int n = (int)(reqn - done) < available ? (int)(reqn - done) : available;
+            memcpy(out + done * 2, st->buffers[b] + st->playPos * 2, n * 4);
+            done += n;
+            st->playPos += n;
+            if (st->playPos >= st->filled[b]) {
+                st->filled[b] = 0;
+                st->playPos = 0;
+                st->playBuffer = b ^ 1;
+                sceKernelSignalSema(wakeSema, 1);
+            }
+        }
+        if (done < reqn) memset(out + done * 2, 0, (reqn - done) * 4);
+        return 1;
+    }
+
+    // Runs on the oslib channel thread for every block of output samples
+    static int audioCallback(unsigned int voice, void* buf, unsigned int reqn) {
+        OSL_SOUND* s = osl_audioVoices[voice].sound;
+        Stream* st = s ? (Stream*)s->data : nullptr;
+        return st ? render(st, (short*)buf, reqn) : 0;
+    }
+
+    // oslPlaySound: restart from the top with both buffers primed. Resident
+    // sounds only rewind, which is cheap and lock-free enough for the mixer.
+    static void playSound(OSL_SOUND* s) {
+        Stream* st = (Stream*)s->data;
+        if (st->memory) {
+            rewind(st);
+            return;
+        }
+        lock();
+        rewind(st);
+        st->playBuffer = 0;
+        st->playPos = 0;
+        st->eof = false;
+        st->filled[0] = st->filled[1] = 0;
+        for (int b = 0; b < 2 && !st->eof; ++b) {
+            st->filled[b] = fill(st, st->buffers[b], st->bufferFrames);
+            if (st->filled[b] == 0 || atEnd(st)) st->eof = true;
+        }
+        st->fillBuffer = st->filled[1] ? 0 : 1;
+        unlock();
+    }
+
+    static void stopSound(OSL_SOUND*) {
+    }
+
+    static void freeStream(Stream* st) {
+        if (st->fd >= 0) sceIoClose(st->fd);
+        free(st->memory);
+        free(st->buffers[0]);
+        free(st->buffers[1]);
+        free(st);
+    }
+
+    static void deleteSound(OSL_SOUND* s) {
+        Stream* st = (Stream*)s->data;
+        if (!st) return;
+        lock();
+        for (Stream** p = &streams; *p; p = &(*p)->next) {
+            if (*p == st) {
+                *p = st->next;
+                break;
+            }
+        }
+        unlock();
+        freeStream(st);
+        s->data = nullptr;
+    }
+
+    static OSL_SOUND* makeSound(Stream* st, const char* path) {
+        OSL_SOUND* s = (OSL_SOUND*)allocate(sizeof(OSL_SOUND), true);
+        if (!s) {
+            freeStream(st);
+            return nullptr;
+        }
+
+        snprintf(s->filename, sizeof(s->filename), "%s", path);
+        s->data = st;
+        s->mono = 0; // always stereo out
+        s->volumeLeft = s->volumeRight = OSL_VOLUME_MAX;
+        s->numSamples = osl_audioDefaultNumSamples;
+        s->playSound = playSound;
+        s->stopSound = stopSound;
+        s->audioCallback = audioCallback;
+        s->deleteSound = deleteSound;
+        st->sound = s;
+        st->eof = true; // nothing decoded until the first play
+
+        lock();
+        st->next = streams;
+        streams = st;
+        unlock();
+        return s;
+    }
+
+    OSL_SOUND* open(const char* path, int bufferFrames) {
+        ensureThread();
+        if (listLock < 0 || wakeSema < 0 || thread < 0) return nullptr;
+
+        Stream* st = (Stream*)allocate(sizeof(Stream), true);
+        if (!st) return nullptr;
+        st->bufferFrames = (bufferFrames + 3) & ~3; // whole groups at 11 kHz
+        if (!openSource(st, path)) {
+            DEBUG_PRINTF("stream: can't open %s\n", path);
+            freeStream(st);
+            return nullptr;
+        }
+
+        st->buffers[0] = (short*)allocate(st->bufferFrames * 4);
+        st->buffers[1] = (short*)allocate(st->bufferFrames * 4);
+        if (!st->buffers[0] || !st->buffers[1]) {
+            freeStream(st);
+            return nullptr;
+        }
+        return makeSound(st, path);
+    }
+
+    OSL_SOUND* load(const char* path) {
+        ensureThread();
+        if (listLock < 0) return nullptr;
+
+        Stream* st = (Stream*)allocate(sizeof(Stream), true);
+        if (!st) return nullptr;
+        if (!openSource(st, path)) {
+            DEBUG_PRINTF("stream: can't load %s\n", path);
+            freeStream(st);
+            return nullptr;
+        }
+
+        st->memory = (unsigned char*)allocate(st->dataBytes > 0 ? st->dataBytes : 1);
+        sceIoLseek32(st->fd, st->dataOffset, PSP_SEEK_SET);
+        if (!st->memory || sceIoRead(st->fd, st->memory, st->dataBytes) != st->dataBytes) {
+            DEBUG_PRINTF("stream: can't load %s\n", path);
+            freeStream(st);
+            return nullptr;
+        }
+        sceIoClose(st->fd);
+        st->fd = -1;
+        return makeSound(st, path);
+    }
+
+    // Bank sounds live inside the bank's block and go away with it
+    static void bankDeleteSound(OSL_SOUND*) {
+    }
+
+    struct Bank {
+        int count;
+        Stream* streams;
+        OSL_SOUND* sounds;
+        unsigned char* file;
+    };
+
+    static constexpr int kBankHeaderBytes = 12;
+    static constexpr int kBankEntryBytes = 32;
+
+    static inline size_t align16(size_t n) { return (n + 15) & ~(size_t)15; }
+
+    Bank* loadBank(const char* path) {
+        ensureThread();
+        if (listLock < 0) return nullptr;
+
+        SceUID fd = sceIoOpen(path, PSP_O_RDONLY, 0);
+        if (fd < 0) return nullptr;
+        unsigned char header[kBankHeaderBytes];
+        const int fileBytes = sceIoLseek32(fd, 0, PSP_SEEK_END);
+        sceIoLseek32(fd, 0, PSP_SEEK_SET);
+        const int count = sceIoRead(fd, header, kBankHeaderBytes) == kBankHeaderBytes ? (int)le32(header + 8) : 0;
+        if (memcmp(header, "SBNK", 4) != 0 || le32(header + 4) != 1 || count <= 0 || count > 64
+            || fileBytes < kBankHeaderBytes + count * kBankEntryBytes) {
+            DEBUG_PRINTF("stream: bad bank %s\n", path);
+            sceIoClose(fd);
+            return nullptr;
+        }
+
+        // Bank, streams, sounds and the whole file share one block
+        const size_t streamsAt = align16(sizeof(Bank));
+        const size_t soundsAt = streamsAt + align16(sizeof(Stream) * count);
+        const size_t fileAt = soundsAt + align16(sizeof(OSL_SOUND) * count);
+        unsigned char* block = (unsigned char*)allocate(fileAt + fileBytes);
+        if (!block) {
+            sceIoClose(fd);
+            return nullptr;
+        }
+        memset(block, 0, fileAt);
+        Bank* bank = (Bank*)block;
+        bank->count = count;
+        bank->streams = (Stream*)(block + streamsAt);
+        bank->sounds = (OSL_SOUND*)(block + soundsAt);
+        bank->file = block + fileAt;
+        memcpy(bank->file, header, kBankHeaderBytes);
+        const int rest = fileBytes - kBankHeaderBytes;
+        const bool ok = sceIoRead(fd, bank->file + kBankHeaderBytes, rest) == rest;
+        sceIoClose(fd);
+        if (!ok) {
+            DEBUG_PRINTF("stream: can't read bank %s\n", path);
+            free(block);
+            return nullptr;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const unsigned char* entry = bank->file + kBankHeaderBytes + i * kBankEntryBytes;
+            Stream* st = &bank->streams[i];
+            OSL_SOUND* s = &bank->sounds[i];
+            const int offset = (int)le32(entry + 16);
+            st->fd = -1;
+            memcpy(st->path, entry, 16); // the name, always NUL padded by the tool
+            st->path[15] = 0;
+            st->memory = bank->file + offset;
+            st->dataBytes = (int)le32(entry + 20);
+            st->codec = entry[28] == 1 ? kVag : kPcm;
+            st->channels = entry[29];
+            st->bits = entry[30];
+            st->frameBytes = st->codec == kVag ? kVagFrameBytes * st->channels : st->channels * st->bits / 8;
+            if (!setRate(st, (int)le32(entry + 24)) || st->channels < 1 || st->channels > 2
+                || (st->bits != 8 && st->bits != 16) || offset < 0 || st->dataBytes < 0
+                || offset + st->dataBytes > fileBytes) {
+                DEBUG_PRINTF("stream: bad bank entry %s in %s\n", st->path, path);
+                st->dataBytes = 0; // stays silent
+                st->step = 1;
+                st->frameBytes = 1;
+            }
+            st->dataBytes -= st->dataBytes % st->frameBytes;
+
+            snprintf(s->filename, sizeof(s->filename), "%s", st->path);
+            s->data = st;
+            s->mono = 0;
+            s->volumeLeft = s->volumeRight = OSL_VOLUME_MAX;
+            s->numSamples = osl_audioDefaultNumSamples;
+            s->playSound = playSound;
+            s->stopSound = stopSound;
+            s->audioCallback = audioCallback;
+            s->deleteSound = bankDeleteSound;
+            st->sound = s;
+            st->eof = true;
+        }
+
+        lock();
+        for (int i = 0; i < count; ++i) {
+            bank->streams[i].next = streams;
+            streams = &bank->streams[i];
+        }
+        unlock();
+        return bank;
+    }
+
+    OSL_SOUND* bankSound(Bank* bank, const char* name) {
+        if (!bank) return nullptr;
+        for (int i = 0; i < bank->count; ++i) {
+            if (strcmp(bank->streams[i].path, name) == 0) return &bank->sounds[i];
+        }
+        DEBUG_PRINTF("stream: no %s in bank\n", name);
+        return nullptr;
+    }
+
+    void freeBank(Bank* bank) {
+        if (!bank) return;
+        lock();
+        for (Stream** p = &streams; *p; ) {
+            if (*p >= bank->streams && *p < bank->streams + bank->count) *p = (*p)->next;
+            else p = &(*p)->next;
+        }
+        unlock();
+        free(bank);
+    }
+
+    int read(OSL_SOUND* s, short* out, int frames) {
+        if (!s || s->audioCallback != audioCallback || !s->data) return 0;
+        return render((Stream*)s->data, out, (unsigned int)frames);
+    }
+
+    bool resident(OSL_SOUND* s) {
+        return s && s->audioCallback == audioCallback && s->data && ((Stream*)s->data)->memory;
+    }
+
+    size_t residentBytes() {
+        size_t total = 0;
+        if (listLock < 0) return 0;
+        lock();
+        for (Stream* st = streams; st; st = st->next) {
+            total += sizeof(Stream);
+            total += st->memory ? st->dataBytes : st->bufferFrames * 4 * 2;
+        }
+        unlock();
+        return total;
+    }
+}
@@ -10,6 +10,16 @@ namespace timegame{
         framesPerUpdate = 5100;
     }
 
+    void saveSnapshot(snapshot::Writer& out){
+        out.u8(gtime);
+        out.s16(framesPerUpdate);
+    }
+
+    void restoreSnapshot(snapshot::Reader& in){
+        gtime = in.u8();
+        framesPerUpdate = in.s16();
+    }
+
     namespace render{
         void renderTime(){
             if (gtime == 0){
@@ -33,11 +43,11 @@ namespace timegame{
 
                 switch (gtime) {
                     case 2:
-                        animatronic::bonnie::incrementDifficulty();
+                        animatronic::incrementDifficulty(animatronic::kBonnie);
                         break;
                     case 3: case 4: case 5:
-                        animatronic::bonnie::incrementDifficulty();
-                        animatronic::chika::incrementDifficulty();
+                        animatronic::incrementDifficulty(animatronic::kBonnie);
+                        animatronic::incrementDifficulty(animatronic::kChica);
                         break;
                     case 6:
                         initSixAm();
@@ -53,23 +63,7 @@ namespace timegame{
 
 
         void initSixAm(){
-            state::isOffice = false;
-
-            sfx::office::unloadSfx();
-            ambience::office::unloadAmbience();
-            ambience::office::unloadFanSound();
-
-            sprite::UI::office::unloadCams();
-            sprite::UI::office::unloadCamFlip();
-
-            officeImage::unloadOffice1Sprites();
-
-            sixam::saveIt::saveTheData();
-
-            sfx::sixam::loadSixAm();
-            sfx::sixam::playSixAm();
-
-            state::isSixAm = true;
+            state::request(state::kSixAm);
         }
     }
 
@@ -0,0 +1,262 @@
+// ai - sixty seeded nights through the animatronic AI, hashed frame by frame
+//
+// The test plays the player with its own seeded generator: the cameras go up
+// and down, doors shut when someone is close and open again, and Foxy's runs
+// are met or missed. The office frame is run as main.cpp runs it (runAiLoop,
+// then the watchdog) and the hours raise Bonnie's and Chica's levels as
+// time.cpp does. The camera reload worker is held (pspstubHoldThreads) and its
+// job done here, taking a seeded zero to three frames, so the run is the same
+// every time. A jumpscare ends the night.
+//
+// Every frame the AI's state goes into an FNV-1a hash: positions and levels,
+// door and side-room flags, the opportunity countdowns, the camera sprite
+// positions, isMoving, reloaded, the jumpscare and Foxy's pause, and a count
+// of every sound and camera reload asked for. kReference is the hash the
+// per-character code from before the timer wheel and the table (42d348f, with
+// the setReload fix) gives under this same harness; AI_TRACE=<file> writes the fields out as
+// text, to diff against the old code's when the hashes part:
+//
+//   make -C tests ai-reference            rebuild the harness on 42d348f
+//   make -C tests ai-reference REV=<rev>  or on any revision with the old API
+//
+// animatronic.cpp is included rather than linked, so the harness can do the
+// reload worker's bookkeeping; AI_SOURCE and AI_LEGACY point it at an old one.
+#ifndef AI_SOURCE
+#define AI_SOURCE "../source/animatronic.cpp"
+#endif
+#include AI_SOURCE
+
+#include <cstdio>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static constexpr unsigned long long kReference = 0x38b66ad86d56a9c3ull;
+
+static constexpr int kNights = 60;
+static constexpr int kHourFrames = 5101; // timegame::update::updateTime: 5100, then the hour turns
+static constexpr int kHours = 6;
+
+// ------------------------------
+// What the AI calls
+// ------------------------------
+static int laughs = 0, runs = 0, knocks = 0, moves = 0, camReloads = 0, jumpscares = 0;
+
+namespace save { int whichNight = 1; }
+namespace sfx { namespace office {
+    void playLaugh() { laughs++; }
+    void playRun() { runs++; }
+    void playKnock() { knocks++; }
+    void playMove() { moves++; }
+} }
+namespace sprite {
+    namespace UI { namespace office {
+        int freddyPosition = 0, bonniePosition = 0, chicaPosition = 0, foxyPosition = 0;
+        void updateChangedCams() { camReloads++; }
+    } }
+    namespace n_jumpscare { int whichJumpscare = 0; }
+}
+namespace state { volatile bool isFoxyAttackPaused = false; }
+
+#ifdef AI_LEGACY
+// The old code unloaded the office itself when it struck
+namespace state { bool isOffice = true, isJumpscare = false; }
+namespace sfx {
+    namespace office { void unloadSfx() {} }
+    namespace jumpscare { void loadJumpscareSound() {} }
+    namespace preload { void unloadCriticalAudio() {} }
+}
+namespace ambience { namespace office { void unloadAmbience() {} void unloadFanSound() {} } }
+namespace call { void unloadPhoneCalls() {} }
+namespace officeImage { void unloadOffice1Sprites() {} void unloadOffice2Sprites() {} }
+namespace sprite {
+    namespace UI { namespace office {
+        void unloadCamUi() {} void unloadPowerInfo() {} void unloadTimeInfo() {} void unloadCams() {} void unloadCamFlip() {}
+    } }
+    namespace office { void unloadDoors() {} void unloadButtons() {} }
+    namespace n_jumpscare { void loadJumpscare() {} }
+}
+namespace text { namespace preload { void unloadCameraAssets() {} void unloadJumpscareAssets() {} } }
+#else
+namespace state { void request(Id) {} }
+namespace sprite { namespace n_jumpscare { void warm(int) {} void discard(int) {} } }
+#endif
+
+// ------------------------------
+// The AI's state, through either API
+// ------------------------------
+using namespace animatronic;
+
+struct Probe {
+    int position, level, countdown;
+    bool atDoor, inOtherRoom;
+};
+
+#ifdef AI_LEGACY
+enum Id { kFreddy, kBonnie, kChica, kFoxy };
+
+static Probe probe(int id) {
+    switch (id) {
+        case 0: return {(int)freddy::position, (int)freddy::totalLevel, freddy::delay, freddy::atDoor, false};
+        case 1: return {(int)bonnie::position, (int)bonnie::totalLevel, bonnie::delay, bonnie::atDoor, bonnie::inOtherRoom};
+        case 2: return {(int)chika::position, (int)chika::totalLevel, chika::delay, chika::atDoor, chika::inOtherRoom};
+        default: return {(int)foxy::position, (int)foxy::totalLevel, foxy::delay, foxy::atDoor, false};
+    }
+}
+
+static void setLevel(int id, int level) {
+    float* levels[] = {&freddy::totalLevel, &bonnie::totalLevel, &chika::totalLevel, &foxy::totalLevel};
+    *levels[id] = (float)level;
+}
+
+static void nextHour(int hour) {
+    if (hour >= 2) bonnie::incrementDifficulty();
+    if (hour >= 3) chika::incrementDifficulty();
+}
+#else
+static Probe probe(int id) {
+    return {table.position[id], table.level[id], ai.remaining(table.opportunity[id]), table.atDoor[id],
+            table.inOtherRoom[id]};
+}
+
+static void setLevel(int id, int level) { table.level[id] = (signed char)level; }
+
+static void nextHour(int hour) {
+    if (hour >= 2) incrementDifficulty(kBonnie);
+    if (hour >= 3) incrementDifficulty(kChica);
+}
+#endif
+
+// ------------------------------
+// The reload worker, one frame at a time (reloadCams without the wait)
+// ------------------------------
+static int reloadLeft = -1;
+
+static void reloadFrame(int frames) {
+    if (reloadLeft < 0) {
+        if (sceKernelPollSema(ReloadSemaphore, 1) < 0) return;
+        while (sceKernelPollSema(ReloadSemaphore, 1) >= 0) { /* drain */ }
+        sPendingReloads = 0;
+        if (jumpscaring) return;
+        reloaded = false;
+        isMoving = true;
+        sprite::UI::office::updateChangedCams();
+        reloadLeft = frames;
+    }
+    if (reloadLeft-- > 0) return;
+    if (usingCams) sfx::office::playMove();
+    reloaded = true;
+    isMoving = false;
+    reloadLeft = -1;
+}
+
+// ------------------------------
+// The player
+// ------------------------------
+static unsigned int playerSeed = 1987;
+
+static int roll(int n) {
+    playerSeed = playerSeed * 1103515245u + 12345u;
+    return (int)((playerSeed >> 16) % (unsigned int)n);
+}
+
+// Doors close more often the closer someone stands; the cameras come up now and then
+static void playerFrame() {
+    if (roll(usingCams ? 240 : 400) == 0) usingCams = !usingCams;
+
+    bool leftThreat = probe(kBonnie).position >= 5 || probe(kFoxy).position >= 3;
+    bool rightThreat = probe(kChica).position >= 5 || probe(kFreddy).position >= 5;
+    if (!leftClosed && roll(leftThreat ? 40 : 3000) == 0) leftClosed = true;
+    if (leftClosed && roll(leftThreat ? 900 : 120) == 0) leftClosed = false;
+    if (!rightClosed && roll(rightThreat ? 40 : 3000) == 0) rightClosed = true;
+    if (rightClosed && roll(rightThreat ? 900 : 120) == 0) rightClosed = false;
+}
+
+// ------------------------------
+// The trace
+// ------------------------------
+static unsigned long long trace = 0xcbf29ce484222325ull;
+
+static void mix(int value) {
+    for (int i = 0; i < 4; ++i) {
+        trace ^= (unsigned char)(value >> (8 * i));
+        trace *= 0x100000001b3ull;
+    }
+}
+
+static FILE* dump = nullptr; // AI_TRACE
+
+static void traceFrame(int night, int frame) {
+    int fields[4 * 4 + 11], n = 0;
+    for (int id = 0; id < 4; ++id) {
+        const Probe p = probe(id);
+        fields[n++] = p.position;
+        fields[n++] = p.level;
+        fields[n++] = p.countdown;
+        fields[n++] = p.atDoor | p.inOtherRoom << 1;
+    }
+    fields[n++] = sprite::UI::office::freddyPosition;
+    fields[n++] = sprite::UI::office::bonniePosition;
+    fields[n++] = sprite::UI::office::chicaPosition;
+    fields[n++] = sprite::UI::office::foxyPosition;
+    fields[n++] = isMoving | reloaded << 1 | jumpscaring << 2 | state::isFoxyAttackPaused << 3 | usingCams << 4 |
+                  leftClosed << 5 | rightClosed << 6;
+    fields[n++] = sprite::n_jumpscare::whichJumpscare;
+    fields[n++] = laughs;
+    fields[n++] = runs;
+    fields[n++] = knocks;
+    fields[n++] = moves;
+    fields[n++] = camReloads;
+
+    for (int i = 0; i < n; ++i) mix(fields[i]);
+    if (dump) {
+        fprintf(dump, "%d %d:", night, frame);
+        for (int i = 0; i < n; ++i) fprintf(dump, " %d", fields[i]);
+        fprintf(dump, "\n");
+    }
+}
+
+int main() {
+    pspstubHoldThreads = 1;
+    if (const char* path = getenv("AI_TRACE")) dump = fopen(path, "w");
+
+    int frames = 0, survived = 0;
+    for (int night = 0; night < kNights; ++night) {
+        reset();
+        reloadLeft = -1;
+        save::whichNight = 1 + night % 7;
+        setDefault();
+        if (save::whichNight == 7) {
+            for (int id = 0; id < 4; ++id) setLevel(id, roll(21));
+        }
+
+        bool died = false;
+        for (int frame = 0; frame < kHours * kHourFrames && !died; ++frame) {
+            if (frame > 0 && frame % kHourFrames == 0) nextHour(frame / kHourFrames);
+            playerFrame();
+            reloadFrame(roll(4));
+            runAiLoop();
+            forceAnimatronicAiReset();
+            traceFrame(night, frame);
+            frames++;
+            died = jumpscaring;
+        }
+        if (died) {
+            jumpscares++;
+            resetForDeath();
+        } else {
+            survived++;
+        }
+    }
+
+    printf("%d nights, %d frames: %d survived, %d jumpscares, %d runs, %d knocks, %d laughs, %d reloads\n",
+           kNights, frames, survived, jumpscares, runs, knocks, laughs, camReloads);
+    printf("trace %016llx\n", trace);
+    if (dump) fclose(dump);
+#ifndef AI_LEGACY
+    CHECK(trace == kReference, "the trace differs from the original code's (%016llx)", kReference);
+#endif
+    printf("ai: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
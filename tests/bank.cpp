@@ -0,0 +1,102 @@
+// bank - the office effects out of one bank against the loose files
+//
+// The Makefile encodes the office effects with tools/vagenc and packs them
+// with tools/sfxbank into tests/build/sfx/office.bank, as the top Makefile
+// does for the game; kitchen.wav goes in without a .vag, so the bank holds
+// both codecs. sfx::office plays bank sounds when the bank is there and
+// stream::load()s the loose files when it is not, so every sound in the bank
+// must decode to exactly what stream::load gives for its loose file (the .vag
+// where there is one, the WAV for kitchen), sample for sample and to the
+// same length.
+//
+// The bank must come in as one heap block against at least two a sound for
+// the loose files; both load times are printed, as reportAudioTiming prints
+// them on the device.
+#include "included/stream.hpp"
+#include "oslstub.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static const char* const kBank = "tests/build/sfx/office.bank";
+static const char* const kNames[] = {
+    "buzz", "door", "scare", "switch", "laugh", "move", "walk", "run", "knock", "openCam", "closeCam", "kitchen",
+};
+static constexpr int kSounds = sizeof(kNames) / sizeof(kNames[0]);
+static constexpr int kBlock = 512;
+static constexpr int kMaxFrames = 44100 * 30;
+
+// Every block up to the end, as the mixer pulls it
+static std::vector<short> decode(OSL_SOUND* s) {
+    std::vector<short> out;
+    short block[kBlock * 2];
+    s->playSound(s);
+    while ((int)out.size() < kMaxFrames * 2 && stream::read(s, block, kBlock)) {
+        out.insert(out.end(), block, block + kBlock * 2);
+    }
+    return out;
+}
+
+int main() {
+    const int bankBefore = stream::allocations;
+    unsigned int start = sceKernelGetSystemTimeLow();
+    stream::Bank* bank = stream::loadBank(kBank);
+    const unsigned int bankMicros = sceKernelGetSystemTimeLow() - start;
+    const int bankAllocations = stream::allocations - bankBefore;
+    if (!bank) {
+        printf("FAIL can't load %s\nbank: FAILED\n", kBank);
+        return 1;
+    }
+
+    OSL_SOUND* loose[kSounds];
+    const int looseBefore = stream::allocations;
+    start = sceKernelGetSystemTimeLow();
+    for (int i = 0; i < kSounds; ++i) {
+        char path[64];
+        snprintf(path, sizeof(path), "tests/build/sfx/%s.wav", kNames[i]);
+        loose[i] = stream::load(path);
+    }
+    const unsigned int looseMicros = sceKernelGetSystemTimeLow() - start;
+    const int looseAllocations = stream::allocations - looseBefore;
+
+    int frames = 0;
+    for (int i = 0; i < kSounds; ++i) {
+        OSL_SOUND* packed = stream::bankSound(bank, kNames[i]);
+        CHECK(packed && loose[i], "%s: in the bank %d, loose %d", kNames[i], packed != nullptr, loose[i] != nullptr);
+        if (!packed || !loose[i]) continue;
+        CHECK(stream::resident(packed), "%s: the bank sound is not resident", kNames[i]);
+
+        const std::vector<short> got = decode(packed);
+        const std::vector<short> want = decode(loose[i]);
+        frames += (int)want.size() / 2;
+        CHECK(!want.empty() && got.size() == want.size(), "%s: %d frames from the bank, %d loose", kNames[i],
+              (int)got.size() / 2, (int)want.size() / 2);
+        for (size_t j = 0; j < got.size() && j < want.size(); ++j) {
+            if (got[j] != want[j]) {
+                CHECK(false, "%s: frame %d channel %d is %d from the bank, %d loose", kNames[i], (int)(j / 2),
+                      (int)(j & 1), got[j], want[j]);
+                break;
+            }
+        }
+    }
+
+    CHECK(bankAllocations == 1, "the bank took %d heap blocks", bankAllocations);
+    CHECK(looseAllocations >= 2 * kSounds, "the loose files took %d heap blocks for %d sounds", looseAllocations,
+          kSounds);
+    printf("bank: %d sounds, %d frames; bank %u us in %d block, loose files %u us in %d blocks (host)\n", kSounds,
+           frames, bankMicros, bankAllocations, looseMicros, looseAllocations);
+
+    for (OSL_SOUND* s : loose) {
+        if (!s) continue;
+        s->deleteSound(s);
+        free(s);
+    }
+    stream::freeBank(bank);
+    printf("bank: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,121 @@
+/* batch - loadPngBatch against loadPng, and how the host fan-out scales
+ *
+ * The camera precache set (11 feeds and 24 animatronic overlays) is loaded
+ * once image by image with loadPng, then through loadPngBatch on 1, 2, 4 and
+ * all threads. Every slot must come back with the same size, format and
+ * texels as the serial load, and the load counters must add up the same
+ * whatever the thread count. Timings are printed, not checked: they depend on
+ * the machine.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "included/image.h"
+
+#define GU_PSM_8888 3
+
+static int failures=0;
+
+#define CHECK(cond,...) do { if(!(cond)) { printf("FAIL %s:%d: ",__FILE__,__LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while(0)
+
+static const char *const paths[]={
+	"romfs/gfx/office/camera/main/cam1a.png","romfs/gfx/office/camera/main/cam1b.png",
+	"romfs/gfx/office/camera/main/cam1c.png","romfs/gfx/office/camera/main/cam2a.png",
+	"romfs/gfx/office/camera/main/cam2b.png","romfs/gfx/office/camera/main/cam3.png",
+	"romfs/gfx/office/camera/main/cam4a.png","romfs/gfx/office/camera/main/cam4b.png",
+	"romfs/gfx/office/camera/main/cam5.png","romfs/gfx/office/camera/main/cam6.png",
+	"romfs/gfx/office/camera/main/cam7.png",
+	"romfs/gfx/office/camera/animatronic/cam1a/cam1a-empty.png",
+	"romfs/gfx/office/camera/animatronic/cam1a/cam1a-freddy.png",
+	"romfs/gfx/office/camera/animatronic/cam1a/cam1a-freddy&bonnie.png",
+	"romfs/gfx/office/camera/animatronic/cam1a/cam1a-freddy&chica.png",
+	"romfs/gfx/office/camera/animatronic/cam1a/cam1a-freddyStare.png",
+	"romfs/gfx/office/camera/animatronic/cam1b/cam1b-bonnie.png",
+	"romfs/gfx/office/camera/animatronic/cam1b/cam1b-chica.png",
+	"romfs/gfx/office/camera/animatronic/cam1b/cam1b-freddy.png",
+	"romfs/gfx/office/camera/animatronic/cam1c/cam1c-foxy1.png",
+	"romfs/gfx/office/camera/animatronic/cam1c/cam1c-foxy2.png",
+	"romfs/gfx/office/camera/animatronic/cam1c/cam1c-foxy3.png",
+	"romfs/gfx/office/camera/animatronic/cam2a/cam2a-bonnie.png",
+	"romfs/gfx/office/camera/animatronic/cam2b/cam2b-bonnie.png",
+	"romfs/gfx/office/camera/animatronic/cam3/cam3-bonnie.png",
+	"romfs/gfx/office/camera/animatronic/cam4a/cam4a-chica.png",
+	"romfs/gfx/office/camera/animatronic/cam4a/cam4a-chicaclose.png",
+	"romfs/gfx/office/camera/animatronic/cam4a/cam4a-freddy.png",
+	"romfs/gfx/office/camera/animatronic/cam4b/cam4b-chica.png",
+	"romfs/gfx/office/camera/animatronic/cam4b/cam4b-freddy.png",
+	"romfs/gfx/office/camera/animatronic/cam5/cam5-bonnie.png",
+	"romfs/gfx/office/camera/animatronic/cam5/cam5-bonnieclose.png",
+	"romfs/gfx/office/camera/animatronic/cam7/cam7-chica.png",
+	"romfs/gfx/office/camera/animatronic/cam7/cam7-chicaclose.png",
+	"romfs/gfx/office/camera/animatronic/cam7/cam7-freddy.png",
+};
+#define COUNT ((int)(sizeof(paths)/sizeof(paths[0])))
+
+static double now()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return t.tv_sec+t.tv_nsec/1e9;
+}
+
+// Texels only: the row padding out to textureWidth is never written
+static int sameImage(Image *a,Image *b)
+{
+	int y,texel=a->format==GU_PSM_8888 ? 4 : 2;
+	if(a->imageWidth!=b->imageWidth || a->imageHeight!=b->imageHeight ||
+		a->textureWidth!=b->textureWidth || a->format!=b->format || a->isSwizzled!=b->isSwizzled) return 0;
+	for(y=0;y<a->imageHeight;y++) {
+		int offset=y*a->textureWidth*texel;
+		if(memcmp((char *)a->data+offset,(char *)b->data+offset,a->imageWidth*texel)) return 0;
+	}
+	return 1;
+}
+
+int main()
+{
+	Image *serial[COUNT],*batch[COUNT];
+	int i,run;
+	long ncpu=sysconf(_SC_NPROCESSORS_ONLN);
+	int threads[]={1,2,4,(int)ncpu};
+
+	textureCompressed=0;	// time the PNG decode, which is what the pool spreads out
+	int ramBefore=imageRamAlloc,decodedBefore=imageBytesDecoded;
+	double start=now();
+	for(i=0;i<COUNT;i++) {
+		serial[i]=loadPng(paths[i]);
+		if(!serial[i]) {
+			printf("FAIL can't load %s\n",paths[i]);
+			return 1;
+		}
+	}
+	double serialTime=now()-start;
+	int ramSerial=imageRamAlloc-ramBefore,decodedSerial=imageBytesDecoded-decodedBefore;
+	printf("loadPng x%d: %.1f ms\n",COUNT,serialTime*1000);
+
+	for(run=0;run<(int)(sizeof(threads)/sizeof(threads[0]));run++) {
+		imageBatchThreads=threads[run];
+		ramBefore=imageRamAlloc;
+		decodedBefore=imageBytesDecoded;
+		start=now();
+		int loaded=loadPngBatch(paths,batch,COUNT);
+		double batchTime=now()-start;
+		printf("loadPngBatch x%d on %d threads: %.1f ms (%.2fx)\n",COUNT,threads[run],batchTime*1000,serialTime/batchTime);
+
+		CHECK(loaded==COUNT,"%d threads: %d of %d loaded",threads[run],loaded,COUNT);
+		CHECK(imageRamAlloc-ramBefore==ramSerial,"%d threads: %d bytes counted, serial counted %d",
+			threads[run],imageRamAlloc-ramBefore,ramSerial);
+		CHECK(imageBytesDecoded-decodedBefore==decodedSerial,"%d threads: %d bytes decoded, serial decoded %d",
+			threads[run],imageBytesDecoded-decodedBefore,decodedSerial);
+		for(i=0;i<COUNT;i++) {
+			if(!batch[i]) continue;
+			CHECK(sameImage(serial[i],batch[i]),"%d threads: %s differs from loadPng",threads[run],paths[i]);
+			freeImage(batch[i]);
+		}
+	}
+	for(i=0;i<COUNT;i++) freeImage(serial[i]);
+	printf("batch: %s\n",failures ? "FAILED" : "ok");
+	return failures!=0;
+}
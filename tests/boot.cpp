@@ -0,0 +1,280 @@
+// boot - the staged boot's timeline, decoding the menu's own PNGs
+//
+// The loaders boot.cpp stages are replaced by ones that decode the same
+// romfs PNGs with the real loadPng and note which thread ran them and when.
+// The main thread then plays the menu: a frame every vblank, each decoding
+// and freeing a PNG of its own as a busy frame does, then boot::postFrame.
+// The loader runs below the main thread, so on the PSP it gets nothing until
+// main first waits for a vblank; here its loads are held until then.
+//
+// begin() must load only background frame 0 and the logo on the main thread
+// and enter the menu; the rest must come from the loader thread in the order
+// of kSteps, each reported once. The menu must take input once the text and
+// cursor are in, and the music must be attached then, on the main thread,
+// and played once. The timeline must be reported once, its first frame
+// before the loader is done and its fully loaded no earlier than the last
+// step.
+//
+// Both threads load at once, so the byte counters (imageRamAlloc and the
+// others) must come back to where they started once everything is freed.
+#include "included/boot.hpp"
+#include "included/image2.hpp"
+#include "included/audio.hpp"
+#include "included/state.hpp"
+#include "included/memory.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static constexpr unsigned int kFrameMicros = 16683;
+static constexpr int kMaxFrames = 600; // ten seconds
+
+// ------------------------------
+// The loaders
+// ------------------------------
+enum Part {
+    kFrame0, kLogo, kText, kNormalNumbers, kStar, kCopyright, kFrame1, kFrame2, kFrame3, kStatic, kPixelNumbers,
+    kNightText
+};
+
+struct Load {
+    Part part;
+    bool onMain;
+    unsigned int done; // from the origin
+};
+
+static pthread_t mainThread;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int origin = 0;
+static std::vector<Load> loads;
+static std::vector<Image*> held;
+static int missing = 0;
+static bool firstShown = false;
+static pthread_cond_t shown = PTHREAD_COND_INITIALIZER;
+
+static unsigned int now() { return sceKernelGetSystemTimeLow() - origin; }
+
+static void load(Part part, const char* const* paths, int count) {
+    const bool onMain = pthread_equal(pthread_self(), mainThread) != 0;
+    pthread_mutex_lock(&lock);
+    while (!onMain && !firstShown) pthread_cond_wait(&shown, &lock);
+    pthread_mutex_unlock(&lock);
+
+    std::vector<Image*> images;
+    for (int i = 0; i < count; ++i) {
+        Image* image = loadPng(paths[i]);
+        if (image) images.push_back(image);
+    }
+    pthread_mutex_lock(&lock);
+    missing += count - (int)images.size();
+    held.insert(held.end(), images.begin(), images.end());
+    loads.push_back({part, onMain, now()});
+    pthread_mutex_unlock(&lock);
+}
+
+static void load(Part part, const char* path) { load(part, &path, 1); }
+
+static const char* const kFrames[] = {
+    "romfs/gfx/menu/frame_1.png", "romfs/gfx/menu/frame_2.png",
+    "romfs/gfx/menu/frame_3.png", "romfs/gfx/menu/frame_4.png",
+};
+
+namespace image {
+    namespace menu {
+        void loadMenuBackgroundFrame(int frame) { load((Part)(frame ? kFrame1 + frame - 1 : kFrame0), kFrames[frame]); }
+        void loadLogo() { load(kLogo, "romfs/gfx/menu/logo.png"); }
+        void loadCopyright() { load(kCopyright, "romfs/gfx/menu/copyright.png"); }
+        void loadTextAndCursor() {
+            static const char* const kPaths[] = {
+                "romfs/gfx/menu/selection/continue.png", "romfs/gfx/menu/selection/newGame.png",
+                "romfs/gfx/menu/selection/6thNight.png", "romfs/gfx/menu/selection/customNight.png",
+                "romfs/gfx/menu/selection/arrow.png",
+            };
+            load(kText, kPaths, 5);
+        }
+    }
+    namespace global {
+        namespace n_static {
+            void loadStatic() {
+                static const char* const kPaths[] = {
+                    "romfs/gfx/menu/static/image1_480x272.png", "romfs/gfx/menu/static/image2_480x272.png",
+                    "romfs/gfx/menu/static/image3_480x272.png", "romfs/gfx/menu/static/image4_480x272.png",
+                };
+                load(kStatic, kPaths, 4);
+            }
+        }
+    }
+}
+
+namespace sprite { namespace menu { void loadStar() { load(kStar, "romfs/gfx/menu/star.png"); } } }
+
+static void loadNumbers(Part part, const char* set) {
+    char paths[10][64];
+    const char* list[10];
+    for (int i = 0; i < 10; ++i) {
+        snprintf(paths[i], sizeof(paths[i]), "romfs/gfx/global/numbers/%s/%d.png", set, i);
+        list[i] = paths[i];
+    }
+    load(part, list, 10);
+}
+
+namespace text {
+    namespace global {
+        void loadNormalNumbers() { loadNumbers(kNormalNumbers, "normal"); }
+        void loadPixelNumbers() { loadNumbers(kPixelNumbers, "pixel"); }
+        void loadNightText() { load(kNightText, "romfs/gfx/global/numbers/symbols/%.png"); }
+    }
+}
+
+// ------------------------------
+// The rest of the game
+// ------------------------------
+static int started = 0, startedAfter = -1; // loads done when the menu was entered
+static int musicLoaded = 0, musicPlayed = 0;
+static bool musicOnMain = false;
+static unsigned int musicAt = 0;
+
+namespace state {
+    Id current() { return kMenu; }
+    void startLoaded(Id first) {
+        started++;
+        CHECK(first == kMenu, "the boot entered state %d", first);
+        pthread_mutex_lock(&lock);
+        startedAfter = (int)loads.size();
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+namespace music {
+    namespace menu {
+        void loadMenuMusic() {
+            musicLoaded++;
+            musicOnMain = pthread_equal(pthread_self(), mainThread) != 0;
+            musicAt = now();
+        }
+        void playMenuMusic() { musicPlayed++; }
+    }
+}
+
+static std::vector<const char*> steps;
+static int timelines = 0;
+static unsigned int firstFrame = 0, interactiveAt = 0, loadedAt = 0;
+
+namespace memory {
+    void reportBootStep(const char* step, unsigned int) {
+        pthread_mutex_lock(&lock);
+        steps.push_back(step);
+        pthread_mutex_unlock(&lock);
+    }
+    void reportBootTimeline(unsigned int first, unsigned int interactive, unsigned int loaded) {
+        timelines++;
+        firstFrame = first;
+        interactiveAt = interactive;
+        loadedAt = loaded;
+    }
+}
+
+// ------------------------------
+// The boot
+// ------------------------------
+static const char* const kBusy[] = {
+    "romfs/gfx/menu/static/image1_480x272.png", "romfs/gfx/menu/logo.png", "romfs/gfx/menu/frame_2.png",
+};
+
+static void testBoot() {
+    const int ramBefore = imageRamAlloc, savedBefore = imageBytesSaved;
+    mainThread = pthread_self();
+    origin = sceKernelGetSystemTimeLow();
+    boot::begin(origin);
+
+    pthread_mutex_lock(&lock);
+    const int loadsAtBegin = (int)loads.size();
+    const bool firstOnMain = loadsAtBegin >= 2 && loads[0].part == kFrame0 && loads[0].onMain &&
+                             loads[1].part == kLogo && loads[1].onMain;
+    pthread_mutex_unlock(&lock);
+    CHECK(firstOnMain, "begin() did not load frame 0 and the logo first, on the main thread");
+    CHECK(started == 1 && startedAfter == 2, "the menu was entered %d times, after %d loads", started, startedAfter);
+
+    // The menu, a frame per vblank, until the timeline is in
+    int frames = 0, inputEarly = 0;
+    for (; frames < kMaxFrames && !timelines; ++frames) {
+        const unsigned int frameStart = now();
+        freeImage(loadPng(kBusy[frames % 3]));
+
+        // interactive() first: the loader records a load before counting its step
+        const bool interactive = boot::interactive();
+        pthread_mutex_lock(&lock);
+        bool textIn = false;
+        for (const Load& l : loads) textIn |= l.part == kText;
+        pthread_mutex_unlock(&lock);
+        if (interactive && !textIn) inputEarly++;
+
+        boot::postFrame();
+        if (frames == 0) {
+            CHECK(!interactive, "interactive before the loader ran");
+            pthread_mutex_lock(&lock);
+            firstShown = true;
+            pthread_cond_broadcast(&shown);
+            pthread_mutex_unlock(&lock);
+        }
+        if (interactive) CHECK(musicLoaded == 1, "frame %d: interactive with the music not attached", frames);
+
+        const unsigned int took = now() - frameStart;
+        if (took < kFrameMicros) sceKernelDelayThread(kFrameMicros - took);
+    }
+    boot::finish();
+    CHECK(timelines == 1, "the timeline was reported %d times in %d frames", timelines, frames);
+    CHECK(inputEarly == 0, "the menu took input on %d frames before its text was in", inputEarly);
+
+    // The loader's share, in the order of kSteps
+    static const Part kOrder[] = {kText, kNormalNumbers, kStar, kCopyright, kFrame1, kFrame2, kFrame3, kStatic,
+                                  kPixelNumbers};
+    static const char* const kStepNames[] = {"menu text", "night numbers", "star", "copyright", "menu frames",
+                                             "static", "office numbers"};
+    const int staged = sizeof(kOrder) / sizeof(kOrder[0]);
+    CHECK((int)loads.size() == 2 + staged, "%d loads, expected %d", (int)loads.size(), 2 + staged);
+    for (int i = 0; i < staged && 2 + i < (int)loads.size(); ++i) {
+        const Load& l = loads[2 + i];
+        CHECK(l.part == kOrder[i] && !l.onMain, "load %d is part %d on the %s thread, expected part %d on the loader",
+              2 + i, l.part, l.onMain ? "main" : "loader", kOrder[i]);
+    }
+    const int stepCount = sizeof(kStepNames) / sizeof(kStepNames[0]);
+    CHECK((int)steps.size() == stepCount, "%d steps reported, expected %d", (int)steps.size(), stepCount);
+    for (int i = 0; i < stepCount && i < (int)steps.size(); ++i) {
+        CHECK(strcmp(steps[i], kStepNames[i]) == 0, "step %d reported as '%s', expected '%s'", i, steps[i],
+              kStepNames[i]);
+    }
+    CHECK(missing == 0, "%d PNGs did not load", missing);
+
+    // The music and the timeline
+    const unsigned int textDone = loads.size() > 2 ? loads[2].done : 0;
+    const unsigned int lastDone = loads.empty() ? 0 : loads.back().done;
+    CHECK(musicLoaded == 1 && musicPlayed == 1 && musicOnMain, "the music was attached %d times, played %d, on %s",
+          musicLoaded, musicPlayed, musicOnMain ? "main" : "the loader");
+    CHECK(musicAt >= textDone, "the music was attached at %u us, before the menu text at %u us", musicAt, textDone);
+    CHECK(firstFrame <= interactiveAt && interactiveAt <= loadedAt, "timeline out of order: %u, %u, %u us",
+          firstFrame, interactiveAt, loadedAt);
+    CHECK(firstFrame < lastDone, "the first frame at %u us waited for the loader, done at %u us", firstFrame,
+          lastDone);
+    CHECK(interactiveAt >= textDone, "interactive at %u us, before the menu text at %u us", interactiveAt, textDone);
+    CHECK(loadedAt >= lastDone, "fully loaded at %u us, before the last step at %u us", loadedAt, lastDone);
+    printf("boot: first frame %u us, interactive %u us, fully loaded %u us, %d frames (host)\n", firstFrame,
+           interactiveAt, loadedAt, frames);
+
+    for (Image* image : held) freeImage(image);
+    CHECK(imageRamAlloc == ramBefore && imageBytesSaved == savedBefore,
+          "%d bytes held and %d saved after freeing everything, %d and %d before", imageRamAlloc, imageBytesSaved,
+          ramBefore, savedBefore);
+}
+
+int main() {
+    testBoot();
+    printf("boot: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,186 @@
+/* convert - convertImage16 against the per-texel loop it replaced
+ *
+ * The loop as first written tested the format and the dither on every
+ * texel; convertImage16 now runs one branch-free row kernel per format with
+ * the row's dither offsets worked out once. Both convert the same 8888
+ * buffers, the menu and office PNGs plus a synthetic one holding every
+ * channel value, to 5650, 5551 and 4444, with and without the dither. The
+ * outputs must be byte-identical, row padding included. Both are timed on
+ * the same buffers and the rates printed, not checked: they depend on the
+ * machine.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include "included/image.h"
+
+#define GU_PSM_5650 0
+#define GU_PSM_5551 1
+#define GU_PSM_4444 2
+#define GU_PSM_8888 3
+
+static int failures=0;
+
+#define CHECK(cond,...) do { if(!(cond)) { printf("FAIL %s:%d: ",__FILE__,__LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while(0)
+
+#define RUNS 8
+
+static const char *const paths[]={
+	"romfs/gfx/office/chuncks/nothing/office_1.png",
+	"romfs/gfx/office/camera/main/cam1a.png",
+	"romfs/gfx/menu/logo.png",
+	"romfs/gfx/menu/selection/arrow.png",
+	"romfs/gfx/menu/static/image2_480x272.png",
+};
+#define COUNT ((int)(sizeof(paths)/sizeof(paths[0])))
+
+static double now()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return t.tv_sec+t.tv_nsec/1e9;
+}
+
+// ------------------------------
+// The loop it replaced
+// ------------------------------
+static const unsigned char bayer4[4][4]={
+	{ 0, 8, 2,10},
+	{12, 4,14, 6},
+	{ 3,11, 1, 9},
+	{15, 7,13, 5}
+};
+
+static inline unsigned int quantise(unsigned int v,int bits,int d)
+{
+	v+=(d<<(8-bits))>>4;	// spread one output step across the 16 thresholds
+	if(v>255) v=255;
+	return v>>(8-bits);
+}
+
+static void referenceConvert(const Color *data,int textureWidth,int height,int format,int dithered,unsigned short *out)
+{
+	int rb=format==GU_PSM_4444 ? 4 : 5;
+	int gb=format==GU_PSM_5650 ? 6 : (format==GU_PSM_5551 ? 5 : 4);
+	int x,y;
+	for(y=0;y<height;y++) {
+		const Color *src=data+y*textureWidth;
+		unsigned short *dst=out+y*textureWidth;
+		const unsigned char *dither=bayer4[y&3];
+		for(x=0;x<textureWidth;x++) {
+			unsigned int c=src[x];
+			int d=dithered ? dither[x&3] : 0;
+			unsigned int r=quantise(c&0xff,rb,d);
+			unsigned int g=quantise((c>>8)&0xff,gb,d);
+			unsigned int b=quantise((c>>16)&0xff,rb,d);
+			unsigned int a=c>>24;
+			if(format==GU_PSM_5650) dst[x]=r|(g<<5)|(b<<11);
+			else if(format==GU_PSM_5551) dst[x]=r|(g<<5)|(b<<10)|((a>=128)<<15);
+			else dst[x]=r|(g<<4)|(b<<8)|((a>>4)<<12);
+		}
+	}
+}
+
+// ------------------------------
+// Images
+// ------------------------------
+// A copy of an 8888 image that convertImage16 may replace the data of; the
+// counters it moves are not looked at here
+static Image *copyImage(Image *from)
+{
+	int bytes=from->imageHeight*from->textureWidth*4;
+	Image *image=(Image *)malloc(sizeof(Image));
+	*image=*from;
+	image->data=(Color *)memalign(16,bytes);
+	memcpy(image->data,from->data,bytes);
+	return image;
+}
+
+static void dropImage(Image *image)
+{
+	free(image->data);
+	free(image);
+}
+
+// Every value in every channel, in a different order per channel
+static Image *syntheticImage()
+{
+	Image *image=(Image *)calloc(1,sizeof(Image));
+	int i;
+	strcpy(image->filename,"synthetic");
+	image->imageWidth=image->textureWidth=512;
+	image->imageHeight=image->textureHeight=256;
+	image->format=GU_PSM_8888;
+	image->data=(Color *)memalign(16,512*256*4);
+	for(i=0;i<512*256;i++) {
+		unsigned int r=i&255,g=(i*7+3)&255,b=(i*13+11)&255,a=(i>>8)*37&255;
+		image->data[i]=r|(g<<8)|(b<<16)|(a<<24);
+	}
+	return image;
+}
+
+// ------------------------------
+// Both on the same buffers
+// ------------------------------
+static double oldSeconds=0,newSeconds=0,megabytes=0;
+
+static void compare(Image *source,int format,int dithered)
+{
+	int texels=source->imageHeight*source->textureWidth;
+	unsigned short *expected=(unsigned short *)memalign(16,texels*2);
+	int run,same=1;
+	textureDither=dithered;
+	for(run=0;run<RUNS;run++) {
+		double start=now();
+		referenceConvert(source->data,source->textureWidth,source->imageHeight,format,dithered,expected);
+		oldSeconds+=now()-start;
+
+		Image *image=copyImage(source);
+		start=now();
+		convertImage16(image,format);
+		newSeconds+=now()-start;
+		megabytes+=texels*4/1e6;
+
+		if(image->format!=format || image->isSwizzled) {
+			CHECK(0,"%s to format %d: came back as format %d, swizzled %d",source->filename,format,
+				image->format,image->isSwizzled);
+			same=0;
+		} else if(memcmp(image->data,expected,texels*2)) {
+			same=0;
+		}
+		dropImage(image);
+	}
+	CHECK(same,"%s to format %d, dither %d: differs from the old loop",source->filename,format,dithered);
+	free(expected);
+}
+
+int main()
+{
+	static const int formats[]={GU_PSM_5650,GU_PSM_5551,GU_PSM_4444};
+	Image *sources[COUNT+1];
+	int i,f,dithered;
+
+	textureAutoFormat=0;	// kept at 8888, converted here
+	textureCompressed=0;
+	for(i=0;i<COUNT;i++) {
+		sources[i]=loadPng(paths[i]);
+		CHECK(sources[i] && sources[i]->format==GU_PSM_8888,"%s did not load as 8888",paths[i]);
+		if(!sources[i]) return 1;
+	}
+	sources[COUNT]=syntheticImage();
+
+	for(i=0;i<=COUNT;i++) {
+		for(f=0;f<3;f++) {
+			for(dithered=0;dithered<2;dithered++) compare(sources[i],formats[f],dithered);
+		}
+	}
+	printf("convert: %.0f MB of 8888, old loop %.0f MB/s, row kernels %.0f MB/s (host)\n",megabytes,
+		megabytes/oldSeconds,megabytes/newSeconds);
+
+	for(i=0;i<COUNT;i++) freeImage(sources[i]);
+	dropImage(sources[COUNT]);
+	printf("convert: %s\n",failures ? "FAILED" : "ok");
+	return failures!=0;
+}
@@ -0,0 +1,249 @@
+/* decode - loadPng's decoder against the one it replaced, and swizzle-on-load
+ *
+ * The decoder as first written read each row into a line buffer with
+ * png_read_row and copied it into the texture texel by texel; loadPng now
+ * hands libpng row pointers into the texture. Every PNG under romfs/gfx is
+ * decoded by both, kept at 8888, and the texels must be identical. Both are
+ * timed over the same files and the rates printed, not checked: they depend
+ * on the machine.
+ *
+ * Then swizzleOnLoad under textureAutoFormat: an image converted to 16 bits
+ * and one the format manifest pins to 8888 must both come back swizzled in
+ * the pass that wrote them, not by swizzleFast after, with the texels of a
+ * linear load that swizzleFast did swizzle. The pinned one needs a manifest
+ * of its own, so that part runs in tests/build/pinned with romfs/gfx/office
+ * linked in.
+ */
+#define _GNU_SOURCE	/* nftw, realpath */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <png.h>
+#include "included/image.h"
+
+#define GU_PSM_5650 0
+#define GU_PSM_8888 3
+
+static int failures=0;
+
+#define CHECK(cond,...) do { if(!(cond)) { printf("FAIL %s:%d: ",__FILE__,__LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while(0)
+
+#define RUNS 3
+#define MAX_PATHS 512
+
+static char *paths[MAX_PATHS];
+static int count=0;
+
+static double now()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return t.tv_sec+t.tv_nsec/1e9;
+}
+
+static int addPng(const char *path,const struct stat *st,int type,struct FTW *ftw)
+{
+	int length=strlen(path);
+	if(type==FTW_F && length>4 && strcmp(path+length-4,".png")==0 && count<MAX_PATHS) paths[count++]=strdup(path);
+	return 0;
+}
+
+static int byName(const void *a,const void *b)
+{
+	return strcmp(*(char *const *)a,*(char *const *)b);
+}
+
+// ------------------------------
+// The decoder it replaced
+// ------------------------------
+static int nextPower2(int width)
+{
+	int b=width,n;
+	for(n=0;b!=0;n++) b>>=1;
+	b=1<<n;
+	if(b==2*width) b>>=1;
+	return b;
+}
+
+// The texels at textureWidth a row, or 0; the old loop's transforms
+static Color *referenceDecode(const char *filename,int *textureWidth,int *imageHeight)
+{
+	png_structp png_ptr;
+	png_infop info_ptr;
+	png_uint_32 width,height;
+	int bit_depth,color_type,interlace_type,x,y;
+	unsigned int *line;
+	Color *data;
+	FILE *fp=fopen(filename,"rb");
+	if(!fp) return 0;
+	png_ptr=png_create_read_struct(PNG_LIBPNG_VER_STRING,NULL,NULL,NULL);
+	info_ptr=png_create_info_struct(png_ptr);
+	png_init_io(png_ptr,fp);
+	png_read_info(png_ptr,info_ptr);
+	png_get_IHDR(png_ptr,info_ptr,&width,&height,&bit_depth,&color_type,&interlace_type,NULL,NULL);
+	*textureWidth=nextPower2(width);
+	*imageHeight=height;
+	png_set_strip_16(png_ptr);
+	png_set_packing(png_ptr);
+	if(color_type==PNG_COLOR_TYPE_PALETTE) png_set_palette_to_rgb(png_ptr);
+	if(color_type==PNG_COLOR_TYPE_GRAY && bit_depth<8) png_set_expand_gray_1_2_4_to_8(png_ptr);
+	if(color_type==PNG_COLOR_TYPE_GRAY) png_set_gray_to_rgb(png_ptr);
+	if(png_get_valid(png_ptr,info_ptr,PNG_INFO_tRNS)) png_set_tRNS_to_alpha(png_ptr);
+	png_set_filler(png_ptr,0xff,PNG_FILLER_AFTER);
+	data=(Color *)memalign(16,*textureWidth*height*sizeof(Color));
+	line=(unsigned int *)malloc(width*4);
+	for(y=0;y<height;y++) {
+		png_read_row(png_ptr,(unsigned char *)line,NULL);
+		for(x=0;x<width;x++) {
+			unsigned int color=line[x];
+			data[x+y**textureWidth]=color;
+		}
+	}
+	free(line);
+	png_read_end(png_ptr,info_ptr);
+	png_destroy_read_struct(&png_ptr,&info_ptr,NULL);
+	fclose(fp);
+	return data;
+}
+
+// ------------------------------
+// Both over romfs
+// ------------------------------
+// Texels only: the row padding out to textureWidth is never written
+static int sameTexels(Image *image,const Color *data,int textureWidth,int imageHeight)
+{
+	int y;
+	if(image->format!=GU_PSM_8888 || image->isSwizzled || image->textureWidth!=textureWidth ||
+		image->imageHeight!=imageHeight) return 0;
+	for(y=0;y<imageHeight;y++) {
+		if(memcmp(image->data+y*textureWidth,data+y*textureWidth,image->imageWidth*4)) return 0;
+	}
+	return 1;
+}
+
+static void testDecoders()
+{
+	double oldSeconds=0,newSeconds=0,megabytes=0;
+	int i,run,differ=0;
+
+	textureAutoFormat=0;	// 8888, as both decoders write it
+	textureCompressed=0;
+	swizzleOnLoad=0;
+	nftw("romfs/gfx",addPng,16,FTW_PHYS);
+	qsort(paths,count,sizeof(paths[0]),byName);
+	CHECK(count>=200,"only %d PNGs under romfs/gfx",count);
+
+	for(run=0;run<RUNS;run++) {
+		for(i=0;i<count;i++) {
+			int textureWidth=0,imageHeight=0;
+			double start=now();
+			Color *expected=referenceDecode(paths[i],&textureWidth,&imageHeight);
+			oldSeconds+=now()-start;
+
+			start=now();
+			Image *image=loadPng(paths[i]);
+			newSeconds+=now()-start;
+
+			if(!expected || !image) {
+				CHECK(0,"%s did not load (old %d, new %d)",paths[i],expected!=0,image!=0);
+			} else {
+				megabytes+=image->imageWidth*image->imageHeight*4/1e6;
+				if(!sameTexels(image,expected,textureWidth,imageHeight) && differ++<5) {
+					CHECK(0,"%s differs from the old decoder",paths[i]);
+				}
+			}
+			free(expected);
+			freeImage(image);
+		}
+	}
+	CHECK(differ==0,"%d decodes differ from the old decoder",differ);
+	printf("decode: %d PNGs x %d, %.0f MB of 8888, old loop %.0f MB/s, rows into the texture %.0f MB/s (host)\n",
+		count,RUNS,megabytes,megabytes/oldSeconds,megabytes/newSeconds);
+}
+
+// ------------------------------
+// Swizzle on load
+// ------------------------------
+static const char *const kConverted="romfs/gfx/office/camera/main/cam1a.png";	// opaque: 5650
+static const char *const kPinned="romfs/gfx/office/camera/main/cam2b.png";
+
+// Block by block, 16 bytes x 8 lines, leaving out the blocks of row padding
+static int sameSwizzled(Image *a,Image *b)
+{
+	int texel=a->format==GU_PSM_8888 ? 4 : 2;
+	int rowBytes=a->textureWidth*texel,used=(a->imageWidth*texel+15)/16;
+	int blocky,blockx;
+	for(blocky=0;blocky<a->imageHeight/8;blocky++) {
+		for(blockx=0;blockx<used;blockx++) {
+			int offset=blocky*rowBytes*8+blockx*128;
+			if(memcmp((char *)a->data+offset,(char *)b->data+offset,128)) return 0;
+		}
+	}
+	return 1;
+}
+
+// path loaded with swizzleOnLoad set, against a linear load swizzled after
+static void checkSwizzled(const char *path,int format)
+{
+	Image *swizzled,*linear;
+	swizzleOnLoad=1;
+	swizzleToVRam=1;	// only swizzleFast goes to VRAM, a swizzle in the pass stays in RAM
+	swizzled=loadPng(path);
+	swizzleOnLoad=0;
+	swizzleToVRam=0;
+	linear=loadPng(path);
+	if(!swizzled || !linear) {
+		CHECK(0,"%s did not load",path);
+	} else {
+		CHECK(swizzled->format==format && swizzled->isSwizzled,"%s came back as format %d, swizzled %d",path,
+			swizzled->format,swizzled->isSwizzled);
+		CHECK(!swizzled->vram,"%s was swizzled by a second pass",path);
+		swizzleFast(linear);
+		CHECK(linear->isSwizzled && linear->format==swizzled->format && sameSwizzled(swizzled,linear),
+			"%s swizzled on load differs from a swizzle after",path);
+	}
+	freeImage(swizzled);
+	freeImage(linear);
+}
+
+static void testSwizzleOnLoad()
+{
+	char office[4096];
+	FILE *manifest;
+	if(!realpath("romfs/gfx/office",office)) {
+		CHECK(0,"no romfs/gfx/office");
+		return;
+	}
+	mkdir("tests/build/pinned",0755);
+	mkdir("tests/build/pinned/romfs",0755);
+	mkdir("tests/build/pinned/romfs/gfx",0755);
+	unlink("tests/build/pinned/romfs/gfx/office");
+	if(symlink(office,"tests/build/pinned/romfs/gfx/office") || chdir("tests/build/pinned")) {
+		CHECK(0,"can't set up tests/build/pinned");
+		return;
+	}
+	manifest=fopen("romfs/gfx/formats.txt","w");
+	fprintf(manifest,"%s 8888\n",kPinned);
+	fclose(manifest);
+
+	resetVRam();
+	textureAutoFormat=1;
+	checkSwizzled(kConverted,GU_PSM_5650);
+	checkSwizzled(kPinned,GU_PSM_8888);
+	textureAutoFormat=0;
+}
+
+int main()
+{
+	int i;
+	testDecoders();
+	testSwizzleOnLoad();
+	for(i=0;i<count;i++) free(paths[i]);
+	printf("decode: %s\n",failures ? "FAILED" : "ok");
+	return failures!=0;
+}
@@ -0,0 +1,131 @@
+// graph - the built-in movement graph against romfs/ai/map.txt
+//
+// graph.cpp keeps a copy of map.txt for when map.bin is missing. The Makefile
+// compiles map.txt with tools/mapc into tests/build/map.bin; the test loads it
+// and every character and node must match the built-in graph, and every camera
+// must pick the same image for every arrangement of positions on every night.
+// Every image either graph names must exist under romfs/gfx/office/camera/
+// with that exact case: the Memory Stick forgives a wrong case, a host does not.
+#include "included/graph.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static const char* const kMap = "tests/build/map.bin";
+static constexpr int kNights = 7;
+static constexpr int kArrangements = graph::kMaxNodes * graph::kMaxNodes * graph::kMaxNodes * graph::kMaxNodes * kNights;
+
+static void arrangement(int index, int* vars) {
+    for (int v = 0; v < graph::kVarNight; ++v) {
+        vars[v] = index % graph::kMaxNodes;
+        index /= graph::kMaxNodes;
+    }
+    vars[graph::kVarNight] = 1 + index;
+}
+
+static bool imageExists(const char* image) {
+    char path[160];
+    snprintf(path, sizeof(path), "romfs/gfx/office/camera/%s.png", image);
+    FILE* f = fopen(path, "rb");
+    if (f) fclose(f);
+    return f != nullptr;
+}
+
+// Each distinct image once, and only while it is the one picked
+static void checkImages(const char* which, const char** picked) {
+    static const char* checked[256];
+    int count = 0;
+    for (int camera = 0; camera < graph::kCameras; ++camera) {
+        for (int i = 0; i < kArrangements; ++i) {
+            const char* image = picked[camera * kArrangements + i];
+            CHECK(image, "%s: camera %d picks no image", which, camera);
+            if (!image) return;
+            bool seen = false;
+            for (int k = 0; k < count && !seen; ++k) seen = strcmp(checked[k], image) == 0;
+            if (seen) continue;
+            if (count < 256) checked[count++] = image;
+            CHECK(imageExists(image), "%s: camera %d names %s, which is not in romfs", which, camera, image);
+        }
+    }
+}
+
+static const char** pick() {
+    const char** picked = new const char*[graph::kCameras * kArrangements];
+    int vars[graph::kVarCount];
+    for (int i = 0; i < kArrangements; ++i) {
+        arrangement(i, vars);
+        for (int camera = 0; camera < graph::kCameras; ++camera) {
+            picked[camera * kArrangements + i] = graph::cameraImage(camera, vars);
+        }
+    }
+    return picked;
+}
+
+static void compareCharacters(const graph::Character* builtin, const graph::Character* file) {
+    for (int id = 0; id < graph::kCharacters; ++id) {
+        const graph::Character& a = builtin[id];
+        const graph::Character& b = file[id];
+        CHECK(strcmp(a.name, b.name) == 0, "character %d is %s built in, %s in map.txt", id, a.name, b.name);
+        CHECK(a.period == b.period && a.door == b.door && a.blockedTo == b.blockedTo && a.side == b.side &&
+              a.flags == b.flags, "%s: period, door, blocked, side or flags differ from map.txt", a.name);
+        for (int n = 0; n < graph::kMaxNodes; ++n) {
+            const graph::Node& x = a.nodes[n];
+            const graph::Node& y = b.nodes[n];
+            CHECK(x.next == y.next && x.flags == y.flags && x.detourRoll == y.detourRoll &&
+                  (x.detourRoll < 0 || x.detourTo == y.detourTo),
+                  "%s position %d: built in {%d, %d, %d, %d}, map.txt {%d, %d, %d, %d}", a.name, n,
+                  x.next, x.flags, x.detourRoll, x.detourTo, y.next, y.flags, y.detourRoll, y.detourTo);
+        }
+    }
+}
+
+int main() {
+    CHECK(!graph::loadedFromFile(), "a map was loaded before load() was called");
+    static graph::Character builtin[graph::kCharacters];
+    memcpy(builtin, graph::characters, sizeof(builtin));
+    const char** builtinPicked = pick();
+    checkImages("built in", builtinPicked);
+
+    CHECK(graph::load(kMap), "can't load %s", kMap);
+    if (!graph::loadedFromFile()) {
+        printf("graph: FAILED\n");
+        return 1;
+    }
+    compareCharacters(builtin, graph::characters);
+    const char** filePicked = pick();
+    checkImages("map.txt", filePicked);
+    int differ = 0;
+    for (int camera = 0; camera < graph::kCameras; ++camera) {
+        for (int i = 0; i < kArrangements; ++i) {
+            const char* a = builtinPicked[camera * kArrangements + i];
+            const char* b = filePicked[camera * kArrangements + i];
+            if (a && b && strcmp(a, b) != 0 && differ++ < 5) {
+                int vars[graph::kVarCount];
+                arrangement(i, vars);
+                CHECK(false, "camera %d, positions %d %d %d %d, night %d: %s built in, %s in map.txt", camera,
+                      vars[0], vars[1], vars[2], vars[3], vars[4], a, b);
+            }
+        }
+    }
+    CHECK(differ == 0, "%d camera images differ", differ);
+
+    // A damaged map leaves the built-in graph in charge
+    FILE* f = fopen("tests/build/map-short.bin", "wb");
+    if (f) {
+        fwrite("AIGR", 1, 4, f);
+        fclose(f);
+    }
+    CHECK(!graph::load("tests/build/map-short.bin"), "a truncated map loaded");
+    CHECK(!graph::loadedFromFile() && memcmp(graph::characters, builtin, sizeof(builtin)) == 0,
+          "a bad map did not put the built-in graph back");
+
+    delete[] builtinPicked;
+    delete[] filePicked;
+    printf("graph: %d arrangements x %d cameras\n", kArrangements, graph::kCameras);
+    printf("graph: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,228 @@
+// input - recorded pad streams through input::sample
+//
+// First a short session as the driver reported it, frame by frame: the menu
+// cursor held past its repeat, two buttons down on the same sample (which the
+// old exact-value switch dropped), a chord completed one button at a time and
+// buttons let go together. Every sample's held, pressed and released masks,
+// the chord and the repeats must be what was recorded.
+//
+// Then a long seeded stream against a plain model of the pad: the masks on
+// every sample, and the event ring after it, which must hold the last
+// kEventLog edges oldest first with their sample and time. The cursor repeats
+// of a single held button are also checked against the countdowns they
+// replaced (the menu's 7 and the custom night's 10, counted down once a
+// frame), whenever the countdown had run out before the press. Last, presses
+// are timed through input::presented to the vblank that shows them.
+#include "included/input.hpp"
+#include <pspctrl.h>
+
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static constexpr unsigned int kFrameMicros = 16683;
+
+static constexpr input::Repeat kMenuRepeat = {8, 8};        // main.cpp
+static constexpr input::Repeat kCustomNightRepeat = {11, 11};
+
+// ------------------------------
+// A recorded session
+// ------------------------------
+enum : unsigned int {
+    U = PSP_CTRL_UP, D = PSP_CTRL_DOWN, L = PSP_CTRL_LTRIGGER, R = PSP_CTRL_RTRIGGER,
+    X = PSP_CTRL_CROSS, O = PSP_CTRL_CIRCLE, S = PSP_CTRL_SQUARE,
+};
+
+struct Sample {
+    unsigned int buttons;
+    unsigned int pressed, released;
+    bool chordLR;       // chord(L | R)
+    bool downRepeats;   // repeated(DOWN, kMenuRepeat)
+};
+
+static const Sample kSession[] = {
+    {0,         0,     0,     false, false},
+    {D,         D,     0,     false, true},   // the press itself
+    {D,         0,     0,     false, false},
+    {D,         0,     0,     false, false},
+    {D,         0,     0,     false, false},
+    {D,         0,     0,     false, false},
+    {D,         0,     0,     false, false},
+    {D,         0,     0,     false, false},
+    {D,         0,     0,     false, false},
+    {D,         0,     0,     false, true},   // eight frames on
+    {D,         0,     0,     false, false},
+    {0,         0,     D,     false, false},
+    {X | O,     X | O, 0,     false, false},  // two at once, both seen
+    {X | O,     0,     0,     false, false},
+    {O,         0,     X,     false, false},
+    {L | O,     L,     0,     false, false},
+    {L | R | O, R,     0,     true,  false},  // the chord completes on R
+    {L | R | O, 0,     0,     false, false},
+    {L | R,     0,     O,     false, false},
+    {R,         0,     L,     false, false},
+    {L | R | D, L | D, 0,     true,  true},   // and again, with a press on the side
+    {0,         0,     L | R | D, false, false},
+    {S,         S,     0,     false, false},
+    {0,         0,     S,     false, false},
+};
+
+static void testSession() {
+    input::reset();
+    const unsigned int start = input::frame();
+    const int count = sizeof(kSession) / sizeof(kSession[0]);
+    for (int i = 0; i < count; ++i) {
+        const Sample& s = kSession[i];
+        input::sample(s.buttons, 1000000 + i * kFrameMicros);
+        CHECK(input::held() == s.buttons, "sample %d: held %x, recorded %x", i, input::held(), s.buttons);
+        CHECK(input::pressed() == s.pressed, "sample %d: pressed %x, expected %x", i, input::pressed(), s.pressed);
+        CHECK(input::released() == s.released, "sample %d: released %x, expected %x", i, input::released(), s.released);
+        CHECK(input::chord(L | R) == s.chordLR, "sample %d: chord(L|R) is %d", i, input::chord(L | R));
+        CHECK(input::repeated(D, kMenuRepeat) == s.downRepeats, "sample %d: repeated(DOWN) is %d", i,
+              input::repeated(D, kMenuRepeat));
+        CHECK(input::isPressed(X) == ((s.pressed & X) != 0) && input::isHeld(O) == ((s.buttons & O) != 0),
+              "sample %d: isPressed/isHeld disagree with the masks", i);
+    }
+    CHECK(input::frame() - start == (unsigned int)count, "%u samples counted, %d fed", input::frame() - start, count);
+
+    // The recorded edges in order, those of one sample lowest bit first
+    static const unsigned int kEdges[] = {D, D, O, X, X, L, R, O, L, D, L, D, L, R, S, S};
+    const int edges = sizeof(kEdges) / sizeof(kEdges[0]);
+    CHECK(input::eventCount() == edges, "%d events, %d edges recorded", input::eventCount(), edges);
+    for (int i = 0; i < edges && i < input::eventCount(); ++i) {
+        CHECK(input::event(i).button == kEdges[i], "event %d is %x, recorded %x", i, input::event(i).button, kEdges[i]);
+    }
+}
+
+// ------------------------------
+// A long stream against a model
+// ------------------------------
+static unsigned int seed = 46;
+
+static int roll(int n) {
+    seed = seed * 1103515245u + 12345u;
+    return (int)((seed >> 16) % (unsigned int)n);
+}
+
+static const unsigned int kButtons[] = {
+    PSP_CTRL_SELECT, PSP_CTRL_START, PSP_CTRL_UP, PSP_CTRL_RIGHT, PSP_CTRL_DOWN, PSP_CTRL_LEFT, PSP_CTRL_LTRIGGER,
+    PSP_CTRL_RTRIGGER, PSP_CTRL_TRIANGLE, PSP_CTRL_CIRCLE, PSP_CTRL_CROSS, PSP_CTRL_SQUARE, PSP_CTRL_HOME,
+};
+static constexpr int kButtonCount = sizeof(kButtons) / sizeof(kButtons[0]);
+
+static void testStream() {
+    input::reset();
+    std::vector<input::Event> edges;
+    unsigned int previous = 0, buttons = 0;
+    int mismatches = 0;
+    for (int i = 0; i < 50000; ++i) {
+        // Buttons go down and up a few at a time, now and then several on one sample
+        for (int changes = roll(8) == 0 ? 1 + roll(4) : 0; changes > 0; --changes) {
+            buttons ^= kButtons[roll(kButtonCount)];
+        }
+        const unsigned int micros = 5000000u + i * kFrameMicros + roll(2000);
+        input::sample(buttons, micros);
+        const unsigned int frame = input::frame();
+
+        const unsigned int pressed = buttons & ~previous, released = previous & ~buttons;
+        for (int bit = 0; bit < 32; ++bit) {
+            const unsigned int mask = 1u << bit;
+            if ((pressed | released) & mask) edges.push_back({micros, frame, mask, (pressed & mask) != 0});
+        }
+        if ((input::held() != buttons || input::pressed() != pressed || input::released() != released) &&
+            mismatches++ < 5) {
+            CHECK(false, "sample %d: held/pressed/released %x %x %x, model %x %x %x", i, input::held(),
+                  input::pressed(), input::released(), buttons, pressed, released);
+        }
+        previous = buttons;
+
+        // The ring: the last kEventLog edges, oldest first
+        const int expected = (int)edges.size() < input::kEventLog ? (int)edges.size() : input::kEventLog;
+        if (input::eventCount() != expected && mismatches++ < 5) {
+            CHECK(false, "sample %d: %d events kept, %d expected", i, input::eventCount(), expected);
+        }
+        for (int e = 0; e < expected && e < input::eventCount(); ++e) {
+            const input::Event& got = input::event(e);
+            const input::Event& want = edges[edges.size() - expected + e];
+            if ((got.micros != want.micros || got.frame != want.frame || got.button != want.button ||
+                 got.down != want.down) && mismatches++ < 5) {
+                CHECK(false, "sample %d, event %d: %x %s at %u/%u, expected %x %s at %u/%u", i, e, got.button,
+                      got.down ? "down" : "up", got.frame, got.micros, want.button, want.down ? "down" : "up",
+                      want.frame, want.micros);
+            }
+        }
+    }
+    CHECK(mismatches == 0, "%d differences from the model", mismatches);
+    printf("stream: 50000 samples, %d edges\n", (int)edges.size());
+}
+
+// The old cursor: act when the countdown has run out, then wait reload frames
+static void testRepeat(const char* which, const input::Repeat& repeat, int reload) {
+    input::reset();
+    int countdown = 0, compared = 0, mismatches = 0;
+    bool down = false;
+    bool fresh = true; // the countdown had run out before this press
+    for (int i = 0; i < 20000; ++i) {
+        if (roll(down ? 60 : 20) == 0) {
+            down = !down;
+            if (down) fresh = countdown <= 0;
+        }
+        input::sample(down ? (unsigned int)PSP_CTRL_DOWN : 0, i * kFrameMicros);
+
+        bool old = false;
+        if (countdown <= 0) {
+            if (down) {
+                old = true;
+                countdown = reload;
+            }
+        } else {
+            countdown -= 1;
+        }
+        if (!fresh) continue;
+        compared++;
+        if (input::repeated(PSP_CTRL_DOWN, repeat) != old && mismatches++ < 5) {
+            CHECK(false, "%s, frame %d: repeated() is %d, the countdown says %d", which, i, !old, old);
+        }
+    }
+    CHECK(mismatches == 0, "%s: %d frames differ from the countdown", which, mismatches);
+    printf("repeat: %s, %d frames compared\n", which, compared);
+}
+
+// Each press shows a set number of frames later; a frame is shown a vblank
+// after its sample, so a press that shows at once is timed at one vblank
+static void testLatency() {
+    input::reset();
+    input::resetLatency();
+    static const int kShowsAfter[] = {0, 1, 3, 0, 2, -1, 5, 1}; // -1: never shows
+    const int presses = sizeof(kShowsAfter) / sizeof(kShowsAfter[0]);
+    unsigned int visible = 0;
+    int frame = 0, timed = 0;
+    unsigned int expected[presses];
+    for (int press = 0; press < presses; ++press) {
+        for (int k = 0; k < input::kLatencyTimeout + 3; ++k, ++frame) {
+            input::sample(k == 0 ? (unsigned int)PSP_CTRL_CROSS : 0, 9000000u + frame * kFrameMicros);
+            if (k == kShowsAfter[press]) visible++;
+            input::presented(visible, 9000000u + (frame + 1) * kFrameMicros);
+        }
+        if (kShowsAfter[press] >= 0) expected[timed++] = (kShowsAfter[press] + 1) * kFrameMicros;
+    }
+    CHECK(input::latencyCount() == timed, "%d presses timed, %d showed", input::latencyCount(), timed);
+    const input::Latency measured = input::latency();
+    unsigned int slowest = 0;
+    for (int i = 0; i < timed; ++i) slowest = expected[i] > slowest ? expected[i] : slowest;
+    CHECK(measured.max == slowest, "slowest press %u us, expected %u", measured.max, slowest);
+    CHECK(measured.p50 == 2 * kFrameMicros, "median %u us, expected %u", measured.p50, 2 * kFrameMicros);
+}
+
+int main() {
+    testSession();
+    testStream();
+    testRepeat("menu", kMenuRepeat, 7);
+    testRepeat("custom night", kCustomNightRepeat, 10);
+    testLatency();
+    printf("input: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,267 @@
+// jumpscare - the reserve that decodes a character's set ahead of its attack
+//
+// The reserve's worker runs as a real thread here, so its loads and drops go
+// on alongside the main thread's own, as in the office, and all of them
+// count into imageRamAlloc:
+//   - a set warmed and left to finish is adopted whole by loadJumpscare: nine
+//     frames with the texels of loading the PNGs directly, counted warm
+//   - a set never warmed is cold: only its first frame at the trigger
+//   - a character that retreats has its set dropped, the frame being decoded
+//     with it, at forty points of the decode
+//   - seeded churn of warms and retreats while the main thread loads and
+//     frees a PNG of its own every frame
+// Whenever the worker is idle, what imageRamAlloc holds above the start must
+// be what the reserve counts; once it is emptied, nothing.
+//
+// Then the .jsq sequences, which the Makefile encodes into tests/build/jsq:
+// cold and warmed, the first frame must be in, with the texels of its PNG at
+// 16 bits, before the next vblank after the trigger, and the rest must keep
+// ahead of jumpscare.cpp's animation so it never holds a frame longer than
+// its three vblanks. The times are those reportJumpscareFrame prints on the
+// device, but from the host.
+//
+// image2.cpp is included rather than linked to look at the reserve.
+#include "../source/image2.cpp"
+
+#include <cstdio>
+#include <unistd.h>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+using namespace sprite::n_jumpscare;
+
+namespace save { int whichNight = 1; }
+namespace graph { const char* cameraImage(int, const int*) { return ""; } }
+namespace memory {
+    void trackGraphicsCamera(size_t) {}
+    void trackGraphicsJumpscare(size_t) {}
+    void untrackGraphicsCamera(size_t) {}
+    void untrackGraphicsJumpscare(size_t) {}
+    void reportJumpscareReserve(int, int, int, int) {}
+    static unsigned int slowestFrame = 0;
+    void reportJumpscareFrame(int, unsigned int micros, int) {
+        if (micros > slowestFrame) slowestFrame = micros;
+    }
+}
+
+static constexpr unsigned int kFrameMicros = 16683;
+static constexpr unsigned int kWaitMicros = 10000000;
+
+static unsigned int seed = 44;
+
+static int roll(int n) {
+    seed = seed * 1103515245u + 12345u;
+    return (int)((seed >> 16) % (unsigned int)n);
+}
+
+// ------------------------------
+// The reserve
+// ------------------------------
+static int slotOf(int which) {
+    for (int s = 0; s < kReserveSlots; ++s) {
+        if (reserve[s].which == which) return s;
+    }
+    return -1;
+}
+
+// Until which's set is all in; the worker takes slots in turn and frees
+// what it drops before its next load, so after this it has nothing in hand
+static bool waitDone(int which) {
+    const unsigned int start = sceKernelGetSystemTimeLow();
+    for (;;) {
+        lockReserve();
+        const int s = slotOf(which);
+        const bool done = s >= 0 && slotDone(reserve[s]);
+        unlockReserve();
+        if (done) return true;
+        if (s < 0 || sceKernelGetSystemTimeLow() - start > kWaitMicros) return false;
+        sceKernelDelayThread(1000);
+    }
+}
+
+static int ramBase = 0, savedBase = 0;
+
+static void checkCounted(const char* when) {
+    lockReserve();
+    const int held = reserveBytes;
+    unlockReserve();
+    CHECK(imageRamAlloc - ramBase == held, "%s: imageRamAlloc holds %d bytes over the start, the reserve %d", when,
+          imageRamAlloc - ramBase, held);
+}
+
+// Row by row: the columns past imageWidth are never written
+static bool sameTexels(Image* a, Image* b) {
+    if (!a || !b || a->format != b->format || a->imageWidth != b->imageWidth || a->imageHeight != b->imageHeight ||
+        a->textureWidth != b->textureWidth) {
+        return false;
+    }
+    const int stride = imageDataBytes(a) / a->imageHeight;
+    const int used = stride / a->textureWidth * a->imageWidth;
+    for (int y = 0; y < a->imageHeight; ++y) {
+        if (memcmp((char*)a->data + y * stride, (char*)b->data + y * stride, used) != 0) return false;
+    }
+    return true;
+}
+
+// ------------------------------
+// Cases
+// ------------------------------
+static void testWarm() {
+    warm(2);
+    CHECK(waitDone(2), "bonnie's set was not decoded");
+    checkCounted("bonnie warmed");
+
+    whichJumpscare = 2;
+    const int warmBefore = shownWarm;
+    loadJumpscare();
+    CHECK(shownWarm == warmBefore + 1 && loaded && framesLoaded == 9, "a finished set was not adopted whole: %d frames",
+          framesLoaded);
+    for (int i = 0; i < 9; ++i) {
+        char path[48];
+        snprintf(path, sizeof(path), "romfs/gfx/jumpscare/bonnie/%d.png", i);
+        Image* direct = loadPng(path);
+        CHECK(sameTexels(jumpscareAnim[i], direct), "bonnie's frame %d differs from %s", i, path);
+        freeImage(direct);
+    }
+    CHECK(slotOf(2) < 0 && reserveBytes == 0, "the adopted set is still in the reserve");
+    unloadJumpscare();
+    CHECK(imageRamAlloc == ramBase, "%d bytes left after the jumpscare", imageRamAlloc - ramBase);
+}
+
+static void testCold() {
+    whichJumpscare = 3;
+    const int coldBefore = shownCold;
+    loadJumpscare();
+    CHECK(shownCold == coldBefore + 1 && loaded && framesLoaded == 1, "a cold set loaded %d frames at the trigger",
+          framesLoaded);
+    for (int shown = 0; shown < 9 && framesLoaded < 9; ++shown) loadNextFrame(shown);
+    CHECK(framesLoaded == 9, "a cold set stopped at %d frames", framesLoaded);
+    unloadJumpscare();
+}
+
+static void testRetreat() {
+    // Gone at a different point of the decode each time, often mid-frame
+    int dropped = 0;
+    for (int round = 0; round < 40; ++round) {
+        warm(1);
+        sceKernelDelayThread(roll(round < 20 ? 3000 : 30000));
+        discard(1);
+        lockReserve();
+        const bool gone = slotOf(1) < 0 && reserveBytes == 0;
+        unlockReserve();
+        if (!gone && dropped++ < 3) CHECK(false, "round %d: freddy's set outlived his retreat", round);
+    }
+
+    warm(4);
+    CHECK(waitDone(4), "foxy's set was not decoded after freddy's were dropped");
+    checkCounted("after the retreats");
+    discard(0);
+    CHECK(imageRamAlloc == ramBase, "%d bytes left after the retreats", imageRamAlloc - ramBase);
+}
+
+static void testChurn() {
+    static const char* const kOffice[] = {
+        "romfs/gfx/office/buttons/left/left_0.png", "romfs/gfx/office/doors/left/door_3.png",
+        "romfs/gfx/office/buttons/right/right_2.png",
+    };
+    int warms = 0, retreats = 0;
+    for (int frame = 0; frame < 240; ++frame) {
+        const int which = 1 + roll(4);
+        if (roll(6) == 0) {
+            warm(which);
+            warms++;
+        } else if (roll(8) == 0) {
+            discard(roll(5) == 0 ? 0 : which);
+            retreats++;
+        }
+        freeImage(loadPng(kOffice[frame % 3]));
+        sceKernelDelayThread(roll(kFrameMicros / 4));
+    }
+    discard(0);
+    warm(2);
+    CHECK(waitDone(2), "the reserve did not settle after the churn");
+    checkCounted("after the churn");
+    CHECK(reservePeak <= 2 * 9 * 512 * 272 * 2, "the reserve peaked at %d bytes, over two 16-bit sets", reservePeak);
+    discard(0);
+    CHECK(imageRamAlloc == ramBase && imageBytesSaved == savedBase,
+          "%d bytes held and %d saved over the start after the churn", imageRamAlloc - ramBase,
+          imageBytesSaved - savedBase);
+    printf("churn: %d warms, %d retreats, reserve peak %d KB\n", warms, retreats, reservePeak / 1024);
+}
+
+// ------------------------------
+// Sequences
+// ------------------------------
+// The trigger as load::loadWithDelay makes it, then jumpscare.cpp's animation
+// one vblank at a time with loadNextFrame after each; which has a .jsq
+static void playSequence(int which, bool warmed) {
+    const char* const name = names[which];
+    whichJumpscare = which;
+    const int warmBefore = shownWarm, coldBefore = shownCold;
+    const unsigned int start = sceKernelGetSystemTimeLow();
+    loadJumpscare();
+    const unsigned int toFirst = sceKernelGetSystemTimeLow() - start;
+    CHECK(sequence && loaded && framesLoaded == 1 && jumpscareAnim[0],
+          "%s: the trigger left %d frames, sequence %d", name, framesLoaded, sequence != nullptr);
+    CHECK(warmed ? shownWarm == warmBefore + 1 : shownCold == coldBefore + 1, "%s was not counted %s", name,
+          warmed ? "warm" : "cold");
+    CHECK(toFirst < kFrameMicros, "%s: frame 0 took %u us from the trigger, past the next vblank", name, toFirst);
+    if (!jumpscareAnim[0]) return;
+
+    char path[48];
+    snprintf(path, sizeof(path), "romfs/gfx/jumpscare/%s/0.png", name);
+    textureAutoFormat = 1; // converted as jsqenc converts it
+    Image* direct = loadPng(path);
+    textureAutoFormat = 0;
+    CHECK(sameTexels(jumpscareAnim[0], direct), "%s: frame 0 of the sequence differs from %s", name, path);
+    freeImage(direct);
+
+    // Each frame is held three vblanks, a frame not in yet holding it longer;
+    // frame 1 is only decoded after frame 0 is first up, so that one vblank
+    // more is the animation's own
+    int shown = 0, counter = 3, vblanks = 0, missing = 0;
+    memory::slowestFrame = 0;
+    while (shown < 8 && vblanks < 9 * 8) {
+        if (!jumpscareAnim[shown]) missing++;
+        vblanks++;
+        if (shown + 1 < framesLoaded && --counter <= 0) {
+            shown++;
+            counter = 3;
+        }
+        loadNextFrame(shown);
+    }
+    CHECK(missing == 0, "%s: %d vblanks with nothing to show", name, missing);
+    CHECK(shown == 8 && vblanks == 1 + 3 * 8, "%s: frame %d after %d vblanks, not 8 after 25", name, shown,
+          vblanks);
+    CHECK(memory::slowestFrame < kFrameMicros, "%s: a frame took %u us to rebuild", name, memory::slowestFrame);
+    printf("%s %s: frame 0 %u us after the trigger, the slowest after it %u us (host)\n", name,
+           warmed ? "warm" : "cold", toFirst, memory::slowestFrame);
+    unloadJumpscare();
+}
+
+static void testSequences() {
+    if (chdir("tests/build/jsq")) {
+        CHECK(false, "no tests/build/jsq");
+        return;
+    }
+    playSequence(3, false);
+    warm(2);
+    CHECK(waitDone(2), "bonnie's sequence was not read ahead");
+    playSequence(2, true);
+    CHECK(reserveBytes == 0 && imageRamAlloc == ramBase, "%d bytes held after the sequences",
+          imageRamAlloc - ramBase);
+}
+
+int main() {
+    ramBase = imageRamAlloc;
+    savedBase = imageBytesSaved;
+    testWarm();
+    testCold();
+    testRetreat();
+    testChurn();
+    testSequences();
+    printf("jumpscare: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,104 @@
+// latencysim - tools/latencysim's model of the frame loop, against main.cpp
+//
+// The model mirrors kRefreshMicros, kPresentMargin and kBuildHistory from
+// source/main.cpp's LOW_LATENCY_PRESENT loop; the values written there must
+// be the ones the tool runs with.
+//
+// At a light load (2 ms to build, no jitter, no spikes) the default loop
+// never misses a vblank and shows every press one to three refreshes later;
+// LOW_LATENCY_PRESENT misses only while its build history fills, and must
+// come in at least a quarter of a refresh sooner at the median. Then at the
+// tool's default load, what the device would measure (from the driver sample
+// less half a cycle) must agree with the true press-to-screen median within
+// a millisecond in both modes. The figures are printed as the tool prints
+// them.
+//
+// The tool is included, so the harness can call its run(); LATENCYSIM_NO_MAIN
+// keeps its main() out.
+#define LATENCYSIM_NO_MAIN
+#include "../tools/latencysim.cpp"
+
+#include <cmath>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static const char* const kMain = "source/main.cpp";
+
+// ------------------------------
+// The mirrored constants
+// ------------------------------
+// The value main.cpp gives name, or -1
+static long constantIn(const char* path, const char* name) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    char line[256], pattern[64];
+    snprintf(pattern, sizeof(pattern), " %s = ", name);
+    long value = -1;
+    while (value < 0 && fgets(line, sizeof(line), f)) {
+        const char* at = strstr(line, pattern);
+        if (strncmp(line, "static constexpr ", 17) == 0 && at) value = atol(at + strlen(pattern));
+    }
+    fclose(f);
+    return value;
+}
+
+static void testConstants() {
+    const long refresh = constantIn(kMain, "kRefreshMicros");
+    const long margin = constantIn(kMain, "kPresentMargin");
+    const long history = constantIn(kMain, "kBuildHistory");
+    CHECK(refresh == (long)kRefreshMicros, "kRefreshMicros is %ld in %s, %.0f in the tool", refresh, kMain,
+          kRefreshMicros);
+    CHECK(margin == (long)kPresentMargin, "kPresentMargin is %ld in %s, %.0f in the tool", margin, kMain,
+          kPresentMargin);
+    CHECK(history == kBuildHistory, "kBuildHistory is %ld in %s, %d in the tool", history, kMain, kBuildHistory);
+}
+
+// ------------------------------
+// The model
+// ------------------------------
+static double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+static void testLightLoad() {
+    build = 2000, jitter = 0, post = 500, spikes = 0;
+    const Result normal = run(false);
+    const Result late = run(true);
+    const double shortest = *std::min_element(normal.fromPress.begin(), normal.fromPress.end());
+    const double longest = *std::max_element(normal.fromPress.begin(), normal.fromPress.end());
+    CHECK(normal.missed == 0, "the default loop missed %d vblanks at 2 ms a frame", normal.missed);
+    CHECK(shortest >= kRefreshMicros && longest <= 3 * kRefreshMicros,
+          "the default loop showed presses %.1f to %.1f ms later", shortest / 1000, longest / 1000);
+    CHECK(late.missed < kBuildHistory, "LOW_LATENCY_PRESENT missed %d vblanks at 2 ms a frame", late.missed);
+    CHECK(median(late.fromPress) + kRefreshMicros / 4 <= median(normal.fromPress),
+          "LOW_LATENCY_PRESENT's median is %.1f ms, the default's %.1f ms", median(late.fromPress) / 1000,
+          median(normal.fromPress) / 1000);
+}
+
+static void testDefaultLoad() {
+    build = 6000, jitter = 3000, post = 1500, spikes = 2;
+    printf("build %.0f us + up to %.0f, %.0f%% spikes of 8 ms, %.0f us after the swap\n", build, jitter, spikes, post);
+    for (int late = 0; late < 2; late++) {
+        const Result r = run(late != 0);
+        const char* mode = late ? "LOW_LATENCY_PRESENT" : "default";
+        printf("%s (%d frames, %d missed vblanks)\n", mode, r.frames, r.missed);
+        print("press to screen", r.fromPress);
+        print("as measured", r.fromSample);
+        CHECK((int)r.fromPress.size() == presses, "%s: %d of %d presses shown", mode, (int)r.fromPress.size(),
+              presses);
+        CHECK(std::fabs(median(r.fromSample) - median(r.fromPress)) <= 1000,
+              "%s: measured median %.1f ms, press to screen %.1f ms", mode, median(r.fromSample) / 1000,
+              median(r.fromPress) / 1000);
+    }
+}
+
+int main() {
+    testConstants();
+    testLightLoad();
+    testDefaultLoad();
+    printf("latencysim: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,305 @@
+// mixer - deferred frees against a running mix, and play() never waiting on it
+//
+// The mixer's audio callback runs on its own thread here, one 512-frame block
+// every 11.6 ms as on the PSP, while the test thread plays, restarts and
+// releases streamed and resident sounds the way the game's states do, with a
+// collect() per frame. Built with AddressSanitizer: a stream freed while a
+// voice still reads it is a use-after-free report, not a silent glitch.
+//
+// Then the stalls: restarting a streamed sound that is still playing, and
+// releasing more sounds in one frame than the pending list starts with, must
+// both return without waiting for the audio thread. A sound played twice
+// before the mixer has seen the first start must never be primed while a
+// voice may read it. Last, with the callback driven by hand, a restart must
+// come back from the top of the sound after one mix boundary and one
+// collect(), and so must a second play of a start the mixer has not seen.
+#include "included/mixer.hpp"
+#include "included/stream.hpp"
+#include "oslstub.h"
+
+#include <cstdio>
+#include <vector>
+#include <pthread.h>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static constexpr int kBlockFrames = 512;
+static constexpr unsigned int kBlockMicros = kBlockFrames * 1000000u / 44100u;
+static constexpr int kFrames = 20000; // under half a second of sound
+
+static const char* const kPath = "tests/build/mixer.wav";
+
+static void put16(std::vector<unsigned char>& v, int x) { v.push_back(x & 255); v.push_back((x >> 8) & 255); }
+static void put32(std::vector<unsigned char>& v, int x) { put16(v, x & 0xffff); put16(v, (x >> 16) & 0xffff); }
+
+// 16-bit stereo at 44.1 kHz, so the mix of one voice at full volume is the file itself
+static std::vector<short> writeWav() {
+    std::vector<short> samples;
+    unsigned int seed = 99;
+    for (int i = 0; i < kFrames * 2; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        samples.push_back((short)((int)(seed >> 16) / 4)); // headroom, nothing clips
+    }
+    std::vector<unsigned char> wav;
+    wav.insert(wav.end(), {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    put32(wav, 16);
+    put16(wav, 1);
+    put16(wav, 2);
+    put32(wav, 44100);
+    put32(wav, 44100 * 4);
+    put16(wav, 4);
+    put16(wav, 16);
+    wav.insert(wav.end(), {'d', 'a', 't', 'a'});
+    put32(wav, kFrames * 4);
+    for (short s : samples) put16(wav, s);
+    FILE* f = fopen(kPath, "wb");
+    if (!f || fwrite(wav.data(), 1, wav.size(), f) != wav.size()) {
+        printf("FAIL can't write %s\n", kPath);
+        exit(1);
+    }
+    fclose(f);
+    return samples;
+}
+
+static short block[kBlockFrames * 2];
+
+static void mix() {
+    OSL_SOUND* out = oslstubChannels[mixer::kChannel];
+    out->audioCallback(mixer::kChannel, block, kBlockFrames);
+}
+
+// The oslib audio thread: a block, then the time it takes to play
+static volatile bool audioRunning = false;
+
+static void* audioThread(void*) {
+    while (audioRunning) {
+        mix();
+        sceKernelDelayThread(kBlockMicros);
+    }
+    return nullptr;
+}
+
+static pthread_t startAudio() {
+    pthread_t thread;
+    audioRunning = true;
+    pthread_create(&thread, nullptr, audioThread, nullptr);
+    return thread;
+}
+
+static void stopAudio(pthread_t thread) {
+    audioRunning = false;
+    pthread_join(thread, nullptr);
+}
+
+static unsigned int now() {
+    return sceKernelGetSystemTimeLow();
+}
+
+// Priming through the stream's own playSound, counted. One by play() itself
+// is flagged when the sound still counts as playing: a voice may be reading
+// the buffers it refills. collect() primes behind a queued stop, which any
+// mix drains before it reads.
+static int primes = 0, primedWhilePlaying = 0;
+static bool collecting = false;
+static void (*streamPrime)(OSL_SOUND*) = nullptr;
+
+static void countPrime(OSL_SOUND* s) {
+    primes++;
+    if (!collecting && mixer::playing(s)) primedWhilePlaying++;
+    streamPrime(s);
+}
+
+static void collect() {
+    collecting = true;
+    mixer::collect();
+    collecting = false;
+}
+
+static OSL_SOUND* openCounted(int bufferFrames) {
+    OSL_SOUND* s = mixer::attach(stream::open(kPath, bufferFrames));
+    if (!s) return nullptr;
+    streamPrime = s->playSound;
+    s->playSound = countPrime;
+    primes = 0;
+    primedWhilePlaying = 0;
+    return s;
+}
+
+// A state entered and left over and over: load, play, a few frames, release
+static void testReleaseUnderMix() {
+    const int deletedBefore = oslstubDeleted;
+    int released = 0;
+    unsigned int seed = 7;
+    for (int round = 0; round < 150; ++round) {
+        OSL_SOUND* streamed = mixer::attach(stream::open(kPath, 1024));
+        OSL_SOUND* resident = mixer::attach(stream::load(kPath));
+        CHECK(streamed && resident, "round %d: open or load failed", round);
+        if (!streamed || !resident) return;
+        mixer::play(streamed, mixer::kMusic, 1, true);
+        mixer::play(resident, mixer::kSfx, 2);
+        seed = seed * 1103515245u + 12345u;
+        const int frames = (seed >> 16) % 4;
+        for (int f = 0; f < frames; ++f) {
+            sceKernelDelayThread(4000 + (seed >> 20) % 4000); // mid-block more often than not
+            mixer::collect();
+        }
+        if (round & 1) mixer::play(streamed, mixer::kMusic, 1, true); // a restart in flight
+        mixer::release(streamed);
+        mixer::release(resident);
+        released += 2;
+        mixer::collect();
+    }
+    for (int f = 0; f < 10 && mixer::pendingReleases() > 0; ++f) {
+        sceKernelDelayThread(kBlockMicros);
+        mixer::collect();
+    }
+    CHECK(mixer::pendingReleases() == 0, "%d releases still pending", mixer::pendingReleases());
+    CHECK(oslstubDeleted - deletedBefore == released, "%d of %d released sounds deleted",
+          oslstubDeleted - deletedBefore, released);
+}
+
+// Neither call may wait for the audio thread: the worst case is compared with a block
+static void testNoStalls() {
+    OSL_SOUND* music = mixer::attach(stream::open(kPath, 1024));
+    mixer::play(music, mixer::kMusic, 1, true);
+    sceKernelDelayThread(3 * kBlockMicros);
+
+    unsigned int worstRestart = 0, totalRestart = 0;
+    for (int i = 0; i < 40; ++i) {
+        const unsigned int start = now();
+        const bool queued = mixer::play(music, mixer::kMusic, 1, true);
+        const unsigned int took = now() - start;
+        CHECK(queued, "restart %d dropped", i);
+        if (took > worstRestart) worstRestart = took;
+        totalRestart += took;
+        sceKernelDelayThread(2000 + i * 397 % 9000);
+        mixer::collect();
+    }
+
+    // More releases in one frame than the pending list starts with
+    static constexpr int kBurst = 80;
+    OSL_SOUND* sounds[kBurst];
+    for (int i = 0; i < kBurst; ++i) sounds[i] = stream::load(kPath);
+    unsigned int worstRelease = 0;
+    for (int i = 0; i < kBurst; ++i) {
+        const unsigned int start = now();
+        mixer::release(sounds[i]);
+        const unsigned int took = now() - start;
+        if (took > worstRelease) worstRelease = took;
+    }
+    mixer::release(music);
+
+    printf("restart while playing: worst %u us, mean %u us; release x%d in one frame: worst %u us (a block is %u us)\n",
+           worstRestart, totalRestart / 40, kBurst, worstRelease, kBlockMicros);
+    CHECK(worstRestart < kBlockMicros / 4, "a restart waited %u us for the mixer", worstRestart);
+    CHECK(worstRelease < kBlockMicros / 4, "a release waited %u us for the mixer", worstRelease);
+    for (int f = 0; f < 10 && mixer::pendingReleases() > 0; ++f) {
+        sceKernelDelayThread(kBlockMicros);
+        mixer::collect();
+    }
+    CHECK(mixer::pendingReleases() == 0, "%d releases still pending after the burst", mixer::pendingReleases());
+}
+
+// The audio.cpp pattern, twice in quick succession, at every point of a block
+static void testPlayTwice() {
+    OSL_SOUND* music = openCounted(1024);
+    for (int i = 0; i < 200; ++i) {
+        mixer::play(music, mixer::kMusic, 1);
+        sceKernelDelayThread(i * 211 % 3000);
+        mixer::play(music, mixer::kMusic, 1);
+        sceKernelDelayThread(i * 97 % 2000);
+        collect();
+    }
+    CHECK(primedWhilePlaying == 0, "%d of %d primes while the sound was starting or playing", primedWhilePlaying,
+          primes);
+    mixer::release(music);
+    sceKernelDelayThread(2 * kBlockMicros);
+    mixer::collect();
+}
+
+static bool blockIs(const std::vector<short>& samples, int frame) {
+    for (int i = 0; i < kBlockFrames * 2; ++i) {
+        if (block[i] != samples[frame * 2 + i]) return false;
+    }
+    return true;
+}
+
+// The callback by hand: the restart lands on the first mix after the stop and a collect()
+static void testRestartFromTop(const std::vector<short>& samples) {
+    OSL_SOUND* music = mixer::attach(stream::open(kPath, 4096));
+    mixer::play(music, mixer::kMusic, 1);
+    mix();
+    CHECK(blockIs(samples, 0), "the first block is the start of the sound");
+    mix();
+    CHECK(blockIs(samples, kBlockFrames), "the second block follows on");
+
+    CHECK(mixer::play(music, mixer::kMusic, 1), "restart queued");
+    CHECK(mixer::playing(music), "still playing until the mixer sees the stop");
+    mix();
+    CHECK(!mixer::playing(music), "stopped at the next mix");
+    CHECK(blockIs(samples, kBlockFrames * 2) == false, "nothing more of the old play");
+    mixer::collect();
+    mix();
+    CHECK(mixer::playing(music), "playing again after collect");
+    CHECK(blockIs(samples, 0), "restarted from the top");
+    mix();
+    CHECK(blockIs(samples, kBlockFrames), "and carries on from there");
+
+    // No mix in flight when it is queued: the stop goes first, so the next
+    // collect() may prime at once
+    CHECK(mixer::play(music, mixer::kMusic, 1), "second restart queued");
+    mixer::collect();
+    mix();
+    CHECK(blockIs(samples, 0), "restarted from the top again");
+
+    // A stop before the restart lands cancels it
+    mixer::play(music, mixer::kMusic, 1);
+    mixer::stop(music);
+    mix();
+    mixer::collect();
+    mix();
+    CHECK(!mixer::playing(music), "a stop cancels a pending restart");
+
+    mixer::release(music);
+    mix();
+    mixer::collect();
+
+    // Played again before the mixer has seen the first start: one prime, and
+    // the second play waits for the boundary like any restart
+    music = openCounted(4096);
+    CHECK(mixer::play(music, mixer::kMusic, 1), "first play queued");
+    CHECK(mixer::playing(music), "a start the mixer has not seen yet does not count as playing");
+    CHECK(mixer::play(music, mixer::kMusic, 1), "second play queued");
+    CHECK(primes == 1, "primed %d times before the mixer saw the first start", primes);
+    mix();
+    collect();
+    CHECK(primes == 2 && primedWhilePlaying == 0, "%d primes, %d while playing", primes, primedWhilePlaying);
+    mix();
+    CHECK(blockIs(samples, 0), "the second play starts from the top");
+    mixer::release(music);
+    mix();
+    mixer::collect();
+}
+
+int main() {
+    const std::vector<short> samples = writeWav();
+    mixer::init();
+    if (!oslstubChannels[mixer::kChannel]) {
+        printf("FAIL mixer::init did not take its channel\n");
+        return 1;
+    }
+
+    pthread_t audio = startAudio();
+    testReleaseUnderMix();
+    testNoStalls();
+    testPlayTwice();
+    stopAudio(audio);
+    testRestartFromTop(samples);
+
+    printf("mixer: %d events, %d merged, %d dropped\n", (int)mixer::eventsPosted, (int)mixer::eventsMerged,
+           (int)mixer::eventsDropped);
+    printf("mixer: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
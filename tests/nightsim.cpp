@@ -0,0 +1,206 @@
+// nightsim - tools/nightsim's mirror of the office against the real sources
+//
+// nightsim plays custom nights on its own copy of onOpportunity, reachDoor and
+// foxyAttackFrame (animatronic.cpp), drainConstant and checkDrain (power.cpp)
+// and updateTime (time.cpp). Here the same nights are played twice: through
+// the tool's Night, and through the game's own functions in handleOfficeState's
+// order (runAiLoop, the watchdog, the drain, the hour), with the tool's
+// reference player's cameras, lights and doors handed to both every frame. The
+// reload worker is held (pspstubHoldThreads) and settles within the frame, as
+// the tool assumes. Every frame positions, levels, door and side-room flags,
+// the opportunity countdowns, Foxy's run, the generator, power and the hour
+// must agree, and the night must end on the same frame the same way.
+//
+// The reference player rarely dies, so every third night the doors stay open
+// whatever it sees, for the jumpscares. The other nights then go through the
+// tool's playNight, which skips the quiet frames, and must come out with the
+// same power left.
+//
+// The game's sources and the tool are both included, so the harness can reach
+// their statics; NIGHTSIM_NO_MAIN keeps the tool's main() out.
+#include "../source/animatronic.cpp"
+#include "../source/power.cpp"
+#include "../source/time.cpp"
+
+#define NIGHTSIM_NO_MAIN
+#include "../tools/nightsim.cpp"
+
+using namespace animatronic;
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static const char* const kMap = "tests/build/map.bin";
+static constexpr int kNights = 300;
+
+// ------------------------------
+// What the game's code calls
+// ------------------------------
+namespace save { int whichNight = 7; }
+namespace sfx { namespace office {
+    void playLaugh() {}
+    void playRun() {}
+    void playKnock() {}
+    void playMove() {}
+} }
+namespace sprite {
+    namespace UI { namespace office {
+        int freddyPosition = 0, bonniePosition = 0, chicaPosition = 0, foxyPosition = 0;
+        Image *powerBar[5], *usageFrame, *powerLeft, *AM, *Night;
+        void updateChangedCams() {}
+    } }
+    namespace n_jumpscare {
+        int whichJumpscare = 0;
+        void warm(int) {}
+        void discard(int) {}
+    }
+}
+namespace text { namespace global { Image *nightNumbersPixel[10], *symbols; } }
+void drawSpriteAlpha(int, int, int, int, Image*, int, int, int) {}
+namespace office { volatile bool leftOn, rightOn, leftClosed, rightClosed; }
+namespace camera { volatile bool isUsing; }
+namespace state {
+    volatile bool isFoxyAttackPaused = false;
+    static int requested = -1;
+    void request(Id id) { requested = id; }
+}
+
+// ------------------------------
+// The game's night
+// ------------------------------
+// The game's timers keep their phase from the night before, nightsim draws
+// one; the game's night starts from the tool's draw and generator
+static void startGame(const Night& n, const scheduler::Wheel& simAi) {
+    animatronic::reset();
+    setDefault();
+    for (int id = 0; id < animatronic::kCount; ++id) {
+        table.level[id] = (signed char)n.level[id];
+        table.inOtherRoom[id] = false;
+        ai.schedule(table.opportunity[id], simAi.remaining(n.opportunity[id].timer));
+    }
+    animatronic::resetFoxyAttack();
+    rngState = n.rng;
+
+    power::reset();
+    power::update::setDrainTime();
+    timegame::reset();
+    state::requested = -1;
+}
+
+// The player's hands, as office.cpp and camera.cpp leave them for the AI and the power
+static void handOver(const Night& n) {
+    animatronic::usingCams = camera::isUsing = n.usingCams;
+    office::leftOn = n.leftOn;
+    office::rightOn = n.rightOn;
+    animatronic::leftClosed = office::leftClosed = n.closed[LEFT];
+    animatronic::rightClosed = office::rightClosed = n.closed[RIGHT];
+}
+
+// handleOfficeState's update half; false once the night is over
+static bool gameFrame() {
+    runAiLoop();
+    forceAnimatronicAiReset();
+    if (sceKernelPollSema(ReloadSemaphore, 1) >= 0) { // reloadCams, done at once
+        while (sceKernelPollSema(ReloadSemaphore, 1) >= 0) { /* drain */ }
+        sPendingReloads = 0;
+        if (!jumpscaring) {
+            reloaded = true;
+            isMoving = false;
+        }
+    }
+    if (jumpscaring) return false;
+
+    power::update::drainConstant();
+    power::update::checkDrain();
+    if (state::requested == state::kPowerOut) return false;
+
+    timegame::update::updateTime();
+    return state::requested != state::kSixAm;
+}
+
+// The first field that differs, or null
+static const char* differs(const Night& n, const scheduler::Wheel& simAi, int* id) {
+    for (*id = 0; *id < CHARACTERS; ++*id) {
+        if (n.position[*id] != table.position[*id]) return "position";
+        if (n.level[*id] != table.level[*id]) return "level";
+        if (n.atDoor[*id] != table.atDoor[*id]) return "at the door";
+        if (n.inOtherRoom[*id] != table.inOtherRoom[*id]) return "in the side room";
+        if (simAi.remaining(n.opportunity[*id].timer) != ai.remaining(table.opportunity[*id])) return "countdown";
+    }
+    *id = -1;
+    if (n.rng != rngState) return "generator";
+    if (n.jumpscaring != jumpscaring) return "jumpscare";
+    if (n.foxyPaused != state::isFoxyAttackPaused) return "Foxy's pause";
+    if (n.warningTimer != warningTimer) return "Foxy's warning timer";
+    if (n.isMoving != isMoving && !n.jumpscaring) return "isMoving";
+    if (n.total != power::total || n.drainTime != power::drainTime || n.usage != power::usage) return "power";
+    if ((n.gtime != timegame::gtime && !(n.gtime == 6 && timegame::gtime == 0)) ||
+        n.framesPerUpdate != timegame::framesPerUpdate) return "hour";
+    return nullptr;
+}
+
+static unsigned int seed = 1987;
+
+static int roll(int n) {
+    seed = seed * 1103515245u + 12345u;
+    return (int)((seed >> 16) % (unsigned int)n);
+}
+
+int main() {
+    pspstubHoldThreads = 1;
+    CHECK(graph::load(kMap), "can't load %s", kMap);
+    loadMap(kMap);
+
+    scheduler::Wheel simAi, skipAi;
+    int frames = 0, won = 0, jumpscares = 0, powerOuts = 0, reported = 0;
+    for (int night = 0; night < kNights && reported < 5; ++night) {
+        // The corners of the table first, then anything
+        int levels[CHARACTERS];
+        for (int id = 0; id < CHARACTERS; ++id) {
+            levels[id] = night == 0 ? 0 : night == 1 ? 20 : night == 2 ? (id == FOXY ? 20 : 0) : roll(LEVELS);
+        }
+        const uint32_t nightSeed = mix(night);
+        const bool careless = night % 3 == 2;
+
+        static Night n;
+        startNight(n, simAi, levels, nightSeed);
+        startGame(n, simAi);
+
+        bool simOn = true, gameOn = true;
+        for (; simOn; n.frame++) {
+            player(n);
+            if (careless) n.wantClosed[LEFT] = n.wantClosed[RIGHT] = false;
+            handOver(n);
+            simOn = officeFrame(n, simAi);
+            gameOn = gameFrame();
+            frames++;
+
+            int id;
+            const char* field = differs(n, simAi, &id);
+            if (!field && simOn != gameOn) field = "end of the night";
+            if (field) {
+                CHECK(false, "night %d (levels %d %d %d %d), frame %d: %s differs (character %d)", night,
+                      levels[0], levels[1], levels[2], levels[3], n.frame, field, id);
+                reported++;
+                break;
+            }
+            if (simOn) doors(n);
+        }
+        const int left = endNight(n, simAi);
+        if (left >= 0) won++;
+        else if (n.jumpscaring) jumpscares++;
+        else powerOuts++;
+
+        if (careless) continue;
+        const int skipped = playNight(skipAi, levels, nightSeed);
+        CHECK(skipped == left, "night %d: %d power left frame by frame, %d skipping the quiet frames", night, left,
+              skipped);
+        if (skipped != left) reported++;
+    }
+
+    printf("%d nights, %d frames: %d to 6 AM, %d jumpscares, %d out of power\n", kNights, frames, won, jumpscares,
+           powerOuts);
+    printf("nightsim: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
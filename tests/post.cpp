@@ -0,0 +1,124 @@
+// post - the mixer's event queue under several producers at once
+//
+// Six threads, as many as the game has posting sounds (main, AI, camera
+// reload and friends), each hammer postFor with their own sound while a
+// consumer thread runs drainEvents the way the audio callback does. Every
+// event carries its producer's running count as the volume, so after each
+// drain a voice's volume must never go backwards (per-producer order), and at
+// the end it must be the last count that producer got accepted (nothing lost).
+// A full queue must refuse the event, never tear one: every drop is accounted
+// for by a refusal, since nothing is released here.
+//
+// mixer.cpp is included rather than linked to call postFor and drainEvents
+// directly and to look at the voices and the ring.
+#include "../source/mixer.cpp"
+#include "oslstub.h"
+
+#include <cstdio>
+#include <pthread.h>
+
+using namespace mixer;
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static constexpr int kProducers = 6;
+static constexpr int kEventsEach = 50000;
+
+struct Producer {
+    OSL_SOUND sound;
+    pthread_t thread;
+    int index;
+    int accepted, refused;
+    int lastAccepted;      // volume of the last accepted event
+    int seen;              // highest volume the consumer has seen, consumer only
+};
+
+static Producer producers[kProducers];
+static volatile int producersDone = 0;
+
+static void* produce(void* arg) {
+    Producer& p = *(Producer*)arg;
+    for (int i = 1; i <= kEventsEach; ++i) {
+        if (postFor(&p.sound, kStart, kSfx, 1, i)) {
+            p.accepted++;
+            p.lastAccepted = i;
+        } else {
+            p.refused++;
+            sceKernelDelayThread(0); // the game moves on to its next frame
+        }
+        if ((i & 255) == 0) sceKernelDelayThread(0); // let the others in, as a reschedule would
+    }
+    __sync_fetch_and_add(&producersDone, 1);
+    return nullptr;
+}
+
+static int backwards = 0, drains = 0;
+
+static void checkVoices() {
+    for (int v = 0; v < kVoices; ++v) {
+        OSL_SOUND* s = voices[v].sound;
+        if (!s) continue;
+        Producer* p = (Producer*)s; // sound is the first member
+        if (voices[v].volume < p->seen) backwards++;
+        p->seen = voices[v].volume;
+    }
+}
+
+static void* consume(void*) {
+    while (producersDone < kProducers) {
+        drainEvents();
+        checkVoices();
+        drains++;
+        sceKernelDelayThread(drains & 15 ? 0 : 500); // now and then slow enough to fill the ring
+    }
+    drainEvents();
+    checkVoices();
+    return nullptr;
+}
+
+int main() {
+    init();
+    for (int i = 0; i < kProducers; ++i) {
+        Producer& p = producers[i];
+        snprintf(p.sound.filename, sizeof(p.sound.filename), "producer%d", i);
+        p.index = i;
+        attach(&p.sound);
+    }
+    const int postedBefore = eventsPosted, droppedBefore = eventsDropped;
+    const unsigned int headBefore = queueHead;
+
+    pthread_t consumer;
+    pthread_create(&consumer, nullptr, consume, nullptr);
+    for (int i = 0; i < kProducers; ++i) pthread_create(&producers[i].thread, nullptr, produce, &producers[i]);
+    for (int i = 0; i < kProducers; ++i) pthread_join(producers[i].thread, nullptr);
+    pthread_join(consumer, nullptr);
+
+    int accepted = 0, refused = 0;
+    for (int i = 0; i < kProducers; ++i) {
+        const Producer& p = producers[i];
+        accepted += p.accepted;
+        refused += p.refused;
+        const int v = findVoice((OSL_SOUND*)&p.sound);
+        CHECK(v >= 0 || p.accepted == 0, "producer %d has no voice", i);
+        if (v >= 0) {
+            CHECK(voices[v].volume == p.lastAccepted, "producer %d: voice at %d, last accepted %d",
+                  i, voices[v].volume, p.lastAccepted);
+        }
+    }
+    printf("%d producers x %d events: %d accepted, %d refused (ring full), %d merged, %d drains\n",
+           kProducers, kEventsEach, accepted, refused, (int)eventsMerged, drains);
+    CHECK(backwards == 0, "a voice's volume went backwards %d times: events out of order", backwards);
+    CHECK(eventsPosted - postedBefore == accepted, "%d posted, %d accepted", eventsPosted - postedBefore, accepted);
+    CHECK(eventsDropped - droppedBefore == refused, "%d dropped, %d refused: torn or lost events",
+          eventsDropped - droppedBefore, refused);
+    CHECK(queueHead - headBefore == (unsigned int)accepted, "the ring took %u events, %d accepted",
+          queueHead - headBefore, accepted);
+    CHECK(queueHead == queueTail, "%u events left in the ring", queueHead - queueTail);
+    CHECK(steals == 0 && rejected == 0, "%d steals, %d rejected with a voice each", (int)steals, (int)rejected);
+    CHECK(refused > 0, "the ring never filled; the test isn't reaching the full path");
+
+    printf("post: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,25 @@
+// The host side of oslstub.h
+#include "oslstub.h"
+
+OSL_AUDIO_VOICE osl_audioVoices[OSL_NUM_AUDIO_CHANNELS];
+int osl_audioDefaultNumSamples = 512;
+OSL_SOUND *oslstubChannels[OSL_NUM_AUDIO_CHANNELS];
+volatile int oslstubDeleted = 0;
+
+int oslSoundLoopFunc(OSL_SOUND *, int) {
+    return 1;
+}
+
+void oslPlaySound(OSL_SOUND *s, int voice) {
+    if (voice < 0 || voice >= OSL_NUM_AUDIO_CHANNELS) return;
+    osl_audioVoices[voice].sound = s;
+    oslstubChannels[voice] = s;
+    if (s->playSound) s->playSound(s);
+}
+
+void oslDeleteSound(OSL_SOUND *s) {
+    if (!s) return;
+    if (s->deleteSound) s->deleteSound(s);
+    free(s);
+    __sync_fetch_and_add(&oslstubDeleted, 1);
+}
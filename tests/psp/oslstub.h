@@ -0,0 +1,16 @@
+/* oslstub - the few OSLib audio entry points the engine calls, for host tests
+ *
+ * Sounds are never played: oslPlaySound only records which sound holds which
+ * channel, so a test can drive that sound's audio callback itself, the way
+ * OSLib's audio thread would. oslDeleteSound calls the sound's deleteSound
+ * and frees it, as OSLib does, and counts the deletions.
+ */
+#ifndef OSLSTUB_H
+#define OSLSTUB_H
+
+#include "include/oslib.h"
+
+extern OSL_SOUND *oslstubChannels[OSL_NUM_AUDIO_CHANNELS];
+extern volatile int oslstubDeleted;
+
+#endif
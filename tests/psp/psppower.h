@@ -0,0 +1 @@
+#include "pspstub.h"
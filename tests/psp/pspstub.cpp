@@ -0,0 +1,340 @@
+// The host side of pspstub.h
+#include "pspstub.h"
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+int pspstubFailRename = 0;
+int pspstubHoldThreads = 0;
+
+static pthread_mutex_t tableLock = PTHREAD_MUTEX_INITIALIZER;
+
+// ==============================
+// Threads
+// ==============================
+
+static constexpr int kMaxThreads = 32;
+
+struct Thread {
+    bool used, started;
+    SceKernelThreadEntry entry;
+    SceSize argLength;
+    unsigned char args[256];
+    pthread_t handle;
+};
+static Thread threads[kMaxThreads];
+
+static void* threadMain(void* p) {
+    Thread* thread = static_cast<Thread*>(p);
+    const int status = thread->entry(thread->argLength, thread->argLength ? thread->args : nullptr);
+    return reinterpret_cast<void*>(static_cast<intptr_t>(status));
+}
+
+SceUID sceKernelCreateThread(const char*, SceKernelThreadEntry entry, int, int, SceUInt, void*) {
+    pthread_mutex_lock(&tableLock);
+    for (int i = 0; i < kMaxThreads; ++i) {
+        if (threads[i].used) continue;
+        threads[i] = Thread();
+        threads[i].used = true;
+        threads[i].entry = entry;
+        pthread_mutex_unlock(&tableLock);
+        return i + 1;
+    }
+    pthread_mutex_unlock(&tableLock);
+    return -1;
+}
+
+int sceKernelStartThread(SceUID id, SceSize length, void* args) {
+    if (id < 1 || id > kMaxThreads || !threads[id - 1].used || length > sizeof(threads[0].args)) return -1;
+    Thread* thread = &threads[id - 1];
+    thread->argLength = length;
+    for (SceSize i = 0; i < length; ++i) thread->args[i] = static_cast<unsigned char*>(args)[i];
+    if (pspstubHoldThreads) return 0;
+    if (pthread_create(&thread->handle, nullptr, threadMain, thread) != 0) return -1;
+    thread->started = true;
+    return 0;
+}
+
+int sceKernelExitThread(int status) {
+    pthread_exit(reinterpret_cast<void*>(static_cast<intptr_t>(status)));
+}
+
+int sceKernelExitDeleteThread(int status) {
+    // The slot stays taken; tests start few enough threads
+    pthread_detach(pthread_self());
+    pthread_exit(reinterpret_cast<void*>(static_cast<intptr_t>(status)));
+}
+
+int sceKernelWaitThreadEnd(SceUID id, SceUInt*) {
+    if (id < 1 || id > kMaxThreads || !threads[id - 1].started) return -1;
+    void* status = nullptr;
+    pthread_join(threads[id - 1].handle, &status);
+    threads[id - 1].started = false;
+    return static_cast<int>(reinterpret_cast<intptr_t>(status));
+}
+
+int sceKernelDeleteThread(SceUID id) {
+    if (id < 1 || id > kMaxThreads) return -1;
+    threads[id - 1].used = false;
+    return 0;
+}
+
+int sceKernelTerminateDeleteThread(SceUID id) {
+    if (id < 1 || id > kMaxThreads || !threads[id - 1].used) return -1;
+    if (threads[id - 1].started) pthread_cancel(threads[id - 1].handle);
+    threads[id - 1].used = false;
+    return 0;
+}
+
+int sceKernelChangeThreadPriority(SceUID, int) { return 0; }
+SceUID sceKernelGetThreadId(void) { return 0; }
+int sceKernelRotateThreadReadyQueue(int) { sched_yield(); return 0; }
+
+int sceKernelDelayThread(SceUInt delay) {
+    if (delay) usleep(delay);
+    else sched_yield();
+    return 0;
+}
+
+int sceKernelCreateCallback(const char*, SceKernelCallbackFunction, void*) { return 1; }
+int sceKernelRegisterExitCallback(int) { return 0; }
+int sceKernelSleepThreadCB(void) { for (;;) pause(); }
+void sceKernelExitGame(void) { _exit(0); }
+
+// ==============================
+// Semaphores
+// ==============================
+
+static constexpr int kMaxSemas = 64;
+
+struct Sema {
+    bool used;
+    int count, max;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+};
+static Sema semas[kMaxSemas];
+
+static Sema* sema(SceUID id) {
+    return id >= 1 && id <= kMaxSemas && semas[id - 1].used ? &semas[id - 1] : nullptr;
+}
+
+SceUID sceKernelCreateSema(const char*, SceUInt, int initVal, int maxVal, void*) {
+    pthread_mutex_lock(&tableLock);
+    for (int i = 0; i < kMaxSemas; ++i) {
+        if (semas[i].used) continue;
+        semas[i].used = true;
+        semas[i].count = initVal;
+        semas[i].max = maxVal;
+        pthread_mutex_init(&semas[i].mutex, nullptr);
+        pthread_cond_init(&semas[i].changed, nullptr);
+        pthread_mutex_unlock(&tableLock);
+        return i + 1;
+    }
+    pthread_mutex_unlock(&tableLock);
+    return -1;
+}
+
+int sceKernelDeleteSema(SceUID id) {
+    Sema* s = sema(id);
+    if (!s) return -1;
+    s->used = false;
+    return 0;
+}
+
+int sceKernelSignalSema(SceUID id, int signal) {
+    Sema* s = sema(id);
+    if (!s) return -1;
+    pthread_mutex_lock(&s->mutex);
+    const bool over = s->count + signal > s->max;
+    if (!over) s->count += signal;
+    pthread_cond_broadcast(&s->changed);
+    pthread_mutex_unlock(&s->mutex);
+    return over ? -1 : 0;
+}
+
+int sceKernelWaitSema(SceUID id, int signal, SceUInt* timeout) {
+    Sema* s = sema(id);
+    if (!s) return -1;
+    timespec until;
+    if (timeout) {
+        clock_gettime(CLOCK_REALTIME, &until);
+        const long long ns = until.tv_nsec + static_cast<long long>(*timeout) * 1000;
+        until.tv_sec += ns / 1000000000;
+        until.tv_nsec = ns % 1000000000;
+    }
+    pthread_mutex_lock(&s->mutex);
+    int result = 0;
+    while (s->count < signal) {
+        if (!timeout) {
+            pthread_cond_wait(&s->changed, &s->mutex);
+        } else if (pthread_cond_timedwait(&s->changed, &s->mutex, &until) == ETIMEDOUT) {
+            result = SCE_KERNEL_ERROR_WAIT_TIMEOUT;
+            break;
+        }
+    }
+    if (result == 0) s->count -= signal;
+    pthread_mutex_unlock(&s->mutex);
+    return result;
+}
+
+int sceKernelPollSema(SceUID id, int signal) {
+    Sema* s = sema(id);
+    if (!s) return -1;
+    pthread_mutex_lock(&s->mutex);
+    const bool taken = s->count >= signal;
+    if (taken) s->count -= signal;
+    pthread_mutex_unlock(&s->mutex);
+    return taken ? 0 : SCE_KERNEL_ERROR_SEMA_ZERO;
+}
+
+// ==============================
+// Time, cache and interrupts
+// ==============================
+
+SceUInt64 sceKernelGetSystemTimeWide(void) {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<SceUInt64>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+unsigned int sceKernelGetSystemTimeLow(void) {
+    return static_cast<unsigned int>(sceKernelGetSystemTimeWide());
+}
+
+void sceKernelDcacheWritebackAll(void) {}
+void sceKernelDcacheWritebackInvalidateAll(void) {}
+void sceKernelDcacheWritebackRange(const void*, unsigned int) {}
+void sceKernelDcacheWritebackInvalidateRange(const void*, unsigned int) {}
+
+static pthread_mutex_t interrupts = PTHREAD_MUTEX_INITIALIZER;
+int sceKernelCpuSuspendIntr(void) { pthread_mutex_lock(&interrupts); return 0; }
+void sceKernelCpuResumeIntr(int) { pthread_mutex_unlock(&interrupts); }
+
+// ==============================
+// Files
+// ==============================
+
+static constexpr int kMaxFiles = 256;
+static long long asyncResult[kMaxFiles];
+
+SceUID sceIoOpen(const char* file, int flags, SceMode mode) {
+    int posixFlags = (flags & PSP_O_RDWR) == PSP_O_RDONLY ? O_RDONLY
+                   : (flags & PSP_O_RDWR) == PSP_O_WRONLY ? O_WRONLY : O_RDWR;
+    if (flags & PSP_O_CREAT) posixFlags |= O_CREAT;
+    if (flags & PSP_O_TRUNC) posixFlags |= O_TRUNC;
+    const int fd = open(file, posixFlags, mode ? mode & 0777 : 0644);
+    return fd < 0 || fd >= kMaxFiles ? (fd >= 0 ? close(fd), -1 : -1) : fd;
+}
+
+SceUID sceIoOpenAsync(const char* file, int flags, SceMode mode) {
+    const SceUID fd = sceIoOpen(file, flags, mode);
+    if (fd >= 0) asyncResult[fd] = fd;
+    return fd;
+}
+
+int sceIoClose(SceUID fd) { return close(fd); }
+int sceIoCloseAsync(SceUID fd) { return close(fd); }
+int sceIoRead(SceUID fd, void* data, SceSize size) { return static_cast<int>(read(fd, data, size)); }
+int sceIoWrite(SceUID fd, const void* data, SceSize size) { return static_cast<int>(write(fd, data, size)); }
+
+int sceIoReadAsync(SceUID fd, void* data, SceSize size) {
+    if (fd < 0 || fd >= kMaxFiles) return -1;
+    asyncResult[fd] = read(fd, data, size);
+    return 0;
+}
+
+int sceIoWriteAsync(SceUID fd, const void* data, SceSize size) {
+    if (fd < 0 || fd >= kMaxFiles) return -1;
+    asyncResult[fd] = write(fd, data, size);
+    return 0;
+}
+
+int sceIoWaitAsync(SceUID fd, SceInt64* res) {
+    if (fd < 0 || fd >= kMaxFiles) return -1;
+    if (res) *res = asyncResult[fd];
+    return 0;
+}
+
+int sceIoWaitAsyncCB(SceUID fd, SceInt64* res) { return sceIoWaitAsync(fd, res); }
+int sceIoPollAsync(SceUID fd, SceInt64* res) { return sceIoWaitAsync(fd, res); }
+SceOff sceIoLseek(SceUID fd, SceOff offset, int whence) { return static_cast<SceOff>(lseek(fd, offset, whence)); }
+int sceIoLseek32(SceUID fd, int offset, int whence) { return static_cast<int>(lseek(fd, offset, whence)); }
+int sceIoRemove(const char* file) { return unlink(file); }
+int sceIoMkdir(const char* dir, SceMode mode) { return mkdir(dir, mode & 0777); }
+int sceIoChangeAsyncPriority(SceUID, int) { return 0; }
+
+int sceIoRename(const char* oldname, const char* newname) {
+    if (pspstubFailRename) return -1;
+    return rename(oldname, newname);
+}
+
+// ==============================
+// Pad, display, GU, power
+// ==============================
+
+int sceCtrlPeekBufferPositive(SceCtrlData* pad, int count) {
+    for (int i = 0; i < count; ++i) pad[i] = SceCtrlData();
+    return count;
+}
+int sceCtrlReadBufferPositive(SceCtrlData* pad, int count) { return sceCtrlPeekBufferPositive(pad, count); }
+int sceCtrlSetSamplingCycle(int) { return 0; }
+int sceCtrlGetSamplingCycle(int* cycle) { *cycle = 0; return 0; }
+int sceCtrlSetSamplingMode(int) { return 0; }
+
+int sceDisplayWaitVblankStart(void) { return 0; }
+int sceDisplayWaitVblankStartCB(void) { return 0; }
+int sceDisplayGetVcount(void) { return 0; }
+void* sceGeEdramGetAddr(void) { return nullptr; }
+unsigned int sceGeEdramGetSize(void) { return 0x200000; }
+
+void sceGuAlphaFunc(int, int, int) {}
+void sceGuBlendFunc(int, int, int, unsigned int, unsigned int) {}
+void sceGuClear(int) {}
+void sceGuClearColor(unsigned int) {}
+void sceGuDisable(int) {}
+void sceGuEnable(int) {}
+void* sceGuDispBuffer(int, int, void*, int) { return nullptr; }
+int sceGuDisplay(int) { return 0; }
+void sceGuDrawArray(int, int, int, const void*, const void*) {}
+void sceGuDrawBuffer(int, void*, int) {}
+int sceGuFinish(void) { return 0; }
+void* sceGuGetMemory(int size) {
+    // A frame's worth of vertices, reused; nothing reads them back
+    static unsigned char list[1 << 16] __attribute__((aligned(16)));
+    return size <= static_cast<int>(sizeof(list)) ? list : nullptr;
+}
+void sceGuInit(void) {}
+void sceGuOffset(unsigned int, unsigned int) {}
+void sceGuScissor(int, int, int, int) {}
+void sceGuStart(int, void*) {}
+void* sceGuSwapBuffers(void) { return nullptr; }
+int sceGuSync(int, int) { return 0; }
+void sceGuTexFilter(int, int) {}
+void sceGuTexFunc(int, int) {}
+void sceGuTexImage(int, int, int, int, const void*) {}
+void sceGuTexMode(int, int, int, int) {}
+void sceGuTexScale(float, float) {}
+void sceGuViewport(int, int, int, int) {}
+void sceGuTexFlush(void) {}
+void sceGuTexSync(void) {}
+void sceGuCopyImage(int, int, int, int, int, int, void*, int, int, int, void*) {}
+void sceGumLoadIdentity(void) {}
+void sceGumMatrixMode(int) {}
+void sceGumOrtho(float, float, float, float, float, float) {}
+
+int scePowerSetClockFrequency(int, int, int) { return 0; }
+int scePowerRegisterCallback(int, SceUID) { return 0; }
+
+int pspDebugScreenPrintf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
@@ -0,0 +1,201 @@
+/* pspstub - just enough of the PSP SDK to build the engine modules on a host
+ *
+ * Every psp*.h in this directory includes this file. Files go through POSIX,
+ * threads are pthreads, semaphores are counting semaphores with the SDK's
+ * timeout, and the clock is the monotonic clock in microseconds. The GU and
+ * display calls do nothing. See pspstub.cpp.
+ */
+#ifndef PSPSTUB_H
+#define PSPSTUB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t u8; typedef uint16_t u16; typedef uint32_t u32; typedef uint64_t u64;
+typedef int8_t s8; typedef int16_t s16; typedef int32_t s32; typedef int64_t s64;
+typedef int SceUID; typedef unsigned int SceSize; typedef int SceInt32; typedef unsigned int SceUInt32;
+typedef int64_t SceInt64; typedef uint64_t SceUInt64; typedef unsigned int SceUInt; typedef int SceOff; typedef int SceMode;
+
+/* Pad */
+typedef struct { unsigned int TimeStamp; unsigned int Buttons; unsigned char Lx, Ly; unsigned char Rsrv[6]; } SceCtrlData;
+enum {
+	PSP_CTRL_SELECT = 0x1, PSP_CTRL_START = 0x8, PSP_CTRL_UP = 0x10, PSP_CTRL_RIGHT = 0x20,
+	PSP_CTRL_DOWN = 0x40, PSP_CTRL_LEFT = 0x80, PSP_CTRL_LTRIGGER = 0x100, PSP_CTRL_RTRIGGER = 0x200,
+	PSP_CTRL_TRIANGLE = 0x1000, PSP_CTRL_CIRCLE = 0x2000, PSP_CTRL_CROSS = 0x4000, PSP_CTRL_SQUARE = 0x8000,
+	PSP_CTRL_HOME = 0x10000
+};
+enum { PSP_CTRL_MODE_DIGITAL = 0, PSP_CTRL_MODE_ANALOG = 1 };
+int sceCtrlPeekBufferPositive(SceCtrlData *pad, int count);
+int sceCtrlReadBufferPositive(SceCtrlData *pad, int count);
+int sceCtrlSetSamplingCycle(int cycle);
+int sceCtrlGetSamplingCycle(int *cycle);
+int sceCtrlSetSamplingMode(int mode);
+
+/* Display and GE */
+#define PSP_DISPLAY_SETBUF_IMMEDIATE 0
+#define PSP_DISPLAY_SETBUF_NEXTFRAME 1
+int sceDisplayWaitVblankStart(void);
+int sceDisplayWaitVblankStartCB(void);
+int sceDisplayGetVcount(void);
+void *sceGeEdramGetAddr(void);
+unsigned int sceGeEdramGetSize(void);
+
+#define GU_PSM_5650 0
+#define GU_PSM_5551 1
+#define GU_PSM_4444 2
+#define GU_PSM_8888 3
+#define GU_PSM_T4 4
+#define GU_PSM_T8 5
+#define GU_PSM_T16 6
+#define GU_PSM_T32 7
+#define GU_PSM_DXT1 8
+#define GU_PSM_DXT3 9
+#define GU_PSM_DXT5 10
+enum {
+	GU_ALPHA_TEST = 0, GU_DEPTH_TEST, GU_SCISSOR_TEST, GU_STENCIL_TEST, GU_BLEND, GU_CULL_FACE,
+	GU_DITHER, GU_FOG, GU_CLIP_PLANES, GU_TEXTURE_2D, GU_LIGHTING, GU_LIGHT0, GU_LIGHT1, GU_LIGHT2, GU_LIGHT3
+};
+#define GU_ADD 0
+#define GU_COLOR_8888 (7 << 2)
+#define GU_COLOR_BUFFER_BIT 1
+#define GU_DIRECT 0
+#define GU_GREATER 4
+#define GU_NEAREST 0
+#define GU_LINEAR 1
+#define GU_SRC_ALPHA 2
+#define GU_ONE_MINUS_SRC_ALPHA 3
+#define GU_PROJECTION 0
+#define GU_VIEW 1
+#define GU_SPRITES 6
+#define GU_SYNC_FINISH 0
+#define GU_SYNC_WHAT_DONE 0
+#define GU_SYNC_LIST 1
+#define GU_TCC_RGBA 1
+#define GU_TCC_RGB 0
+#define GU_TEXTURE_16BIT (2)
+#define GU_TFX_REPLACE 3
+#define GU_TFX_MODULATE 0
+#define GU_TRANSFORM_2D (1 << 23)
+#define GU_TRUE 1
+#define GU_FALSE 0
+#define GU_VERTEX_16BIT (2 << 7)
+#define GU_RGBA(r, g, b, a) (((a) << 24) | ((b) << 16) | ((g) << 8) | (r))
+void sceGuAlphaFunc(int func, int value, int mask);
+void sceGuBlendFunc(int op, int src, int dest, unsigned int srcfix, unsigned int destfix);
+void sceGuClear(int flags);
+void sceGuClearColor(unsigned int color);
+void sceGuDisable(int state);
+void sceGuEnable(int state);
+void *sceGuDispBuffer(int width, int height, void *dispbp, int dispbw);
+int sceGuDisplay(int state);
+void sceGuDrawArray(int prim, int vtype, int count, const void *indices, const void *vertices);
+void sceGuDrawBuffer(int psm, void *fbp, int fbw);
+int sceGuFinish(void);
+void *sceGuGetMemory(int size);
+void sceGuInit(void);
+void sceGuOffset(unsigned int x, unsigned int y);
+void sceGuScissor(int x, int y, int w, int h);
+void sceGuStart(int cid, void *list);
+void *sceGuSwapBuffers(void);
+int sceGuSync(int mode, int what);
+void sceGuTexFilter(int min, int mag);
+void sceGuTexFunc(int tfx, int tcc);
+void sceGuTexImage(int mipmap, int width, int height, int tbw, const void *tbp);
+void sceGuTexMode(int tpsm, int maxmips, int a2, int swizzle);
+void sceGuTexScale(float u, float v);
+void sceGuViewport(int cx, int cy, int width, int height);
+void sceGuTexFlush(void);
+void sceGuTexSync(void);
+void sceGuCopyImage(int psm, int sx, int sy, int width, int height, int srcw, void *src, int dx, int dy, int destw, void *dest);
+void sceGumLoadIdentity(void);
+void sceGumMatrixMode(int mode);
+void sceGumOrtho(float left, float right, float bottom, float top, float near, float far);
+
+/* Kernel: threads, semaphores, callbacks, time, cache */
+typedef int (*SceKernelCallbackFunction)(int arg1, int arg2, void *common);
+typedef int (*SceKernelThreadEntry)(SceSize args, void *argp);
+#define SCE_KERNEL_ERROR_WAIT_TIMEOUT ((int)0x800201a8)
+#define SCE_KERNEL_ERROR_SEMA_ZERO ((int)0x800201ad)
+int sceKernelCreateCallback(const char *name, SceKernelCallbackFunction func, void *arg);
+int sceKernelRegisterExitCallback(int cbid);
+int sceKernelSleepThreadCB(void);
+SceUID sceKernelCreateThread(const char *name, SceKernelThreadEntry entry, int priority, int stackSize, SceUInt attr, void *option);
+int sceKernelStartThread(SceUID thid, SceSize arglen, void *argp);
+int sceKernelExitThread(int status);
+int sceKernelExitDeleteThread(int status);
+int sceKernelWaitThreadEnd(SceUID thid, SceUInt *timeout);
+int sceKernelDeleteThread(SceUID thid);
+int sceKernelTerminateDeleteThread(SceUID thid);
+int sceKernelChangeThreadPriority(SceUID thid, int priority);
+SceUID sceKernelGetThreadId(void);
+int sceKernelRotateThreadReadyQueue(int priority);
+int sceKernelDelayThread(SceUInt delay);
+SceUID sceKernelCreateSema(const char *name, SceUInt attr, int initVal, int maxVal, void *option);
+int sceKernelDeleteSema(SceUID semaid);
+int sceKernelSignalSema(SceUID semaid, int signal);
+int sceKernelWaitSema(SceUID semaid, int signal, SceUInt *timeout);
+int sceKernelPollSema(SceUID semaid, int signal);
+SceUInt64 sceKernelGetSystemTimeWide(void);
+unsigned int sceKernelGetSystemTimeLow(void);
+void sceKernelExitGame(void);
+void sceKernelDcacheWritebackAll(void);
+void sceKernelDcacheWritebackInvalidateAll(void);
+void sceKernelDcacheWritebackRange(const void *p, unsigned int size);
+void sceKernelDcacheWritebackInvalidateRange(const void *p, unsigned int size);
+int sceKernelCpuSuspendIntr(void);
+void sceKernelCpuResumeIntr(int flags);
+#define THREAD_ATTR_USER 0x80000000
+#define THREAD_ATTR_VFPU 0x00004000
+#define PSP_MODULE_INFO(name, attr, major, minor) static int pspstubModuleInfo
+#define PSP_MAIN_THREAD_ATTR(attr) static int pspstubThreadAttr
+#define PSP_HEAP_SIZE_KB(size) static int pspstubHeapSize
+
+/* Files; the async calls complete at once and keep their result for the wait */
+#define PSP_O_RDONLY 0x0001
+#define PSP_O_WRONLY 0x0002
+#define PSP_O_RDWR 0x0003
+#define PSP_O_CREAT 0x0200
+#define PSP_O_TRUNC 0x0400
+#define PSP_SEEK_SET 0
+#define PSP_SEEK_CUR 1
+#define PSP_SEEK_END 2
+SceUID sceIoOpen(const char *file, int flags, SceMode mode);
+SceUID sceIoOpenAsync(const char *file, int flags, SceMode mode);
+int sceIoClose(SceUID fd);
+int sceIoCloseAsync(SceUID fd);
+int sceIoRead(SceUID fd, void *data, SceSize size);
+int sceIoReadAsync(SceUID fd, void *data, SceSize size);
+int sceIoWrite(SceUID fd, const void *data, SceSize size);
+int sceIoWriteAsync(SceUID fd, const void *data, SceSize size);
+int sceIoWaitAsync(SceUID fd, SceInt64 *res);
+int sceIoWaitAsyncCB(SceUID fd, SceInt64 *res);
+int sceIoPollAsync(SceUID fd, SceInt64 *res);
+SceOff sceIoLseek(SceUID fd, SceOff offset, int whence);
+int sceIoLseek32(SceUID fd, int offset, int whence);
+int sceIoRemove(const char *file);
+int sceIoMkdir(const char *dir, SceMode mode);
+int sceIoRename(const char *oldname, const char *newname);
+int sceIoChangeAsyncPriority(SceUID fd, int pri);
+
+/* Power */
+#define PSP_POWER_CB_SUSPENDING 0x00010000
+#define PSP_POWER_CB_RESUME_COMPLETE 0x00040000
+#define PSP_POWER_CB_POWER_SWITCH 0x80000000
+int scePowerSetClockFrequency(int pllfreq, int cpufreq, int busfreq);
+int scePowerRegisterCallback(int slot, SceUID cbid);
+
+int pspDebugScreenPrintf(const char *format, ...);
+
+/* Test hooks, not part of the SDK */
+extern int pspstubFailRename;	/* sceIoRename fails while set, like a pulled card */
+extern int pspstubHoldThreads;	/* sceKernelStartThread leaves threads unstarted while set; the test runs their work */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
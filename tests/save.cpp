@@ -0,0 +1,301 @@
+// save - the progress record through corruption, cut-short writes and lost renames
+//
+// First the record itself: the CRC-32 check value, every record that can be
+// stored round trips, every single-bit flip and every wrong size is turned
+// down, and so is a value out of range under a good CRC.
+//
+// Then boots against a real saves/ directory, in tests/build/save-root so the
+// tree's own saves/ is left alone. A boot forgets everything save.cpp keeps
+// in memory and calls save::file() as the game does. Nights are won through
+// saveData and flushed, then the files are damaged the ways a pulled card or
+// a flat battery damages them:
+//   - a bit flipped anywhere in save.bin: the defaults, written back whole
+//   - a stale save.tmp left beside a newer save.bin: save.bin, and save.tmp
+//     goes
+//   - a newer save.tmp cut short: save.bin
+//   - the rename lost (pspstubFailRename) after save.bin was removed: save.tmp,
+//     renamed to save.bin by the boot, so the next write cut short in
+//     save.tmp still has it to go back to
+//   - a newer save.tmp cut short and no save.bin: the defaults
+// and the old one-file-per-value saves are converted once and deleted.
+//
+// save.cpp is included rather than linked, so a boot can reset its statics.
+#include "../source/save.cpp"
+
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static const char* const kRoot = "tests/build/save-root";
+
+namespace memory { void reportSave(const char*, unsigned int) {} }
+
+// ------------------------------
+// Files
+// ------------------------------
+static int readFile(const char* path, unsigned char* out, int size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    const int bytes = (int)fread(out, 1, size, f);
+    fclose(f);
+    return bytes;
+}
+
+static void writeFile(const char* path, const void* data, int bytes) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return;
+    fwrite(data, 1, bytes, f);
+    fclose(f);
+}
+
+static bool exists(const char* path) {
+    struct stat info;
+    return stat(path, &info) == 0;
+}
+
+static void wipe() {
+    unlink(save::kSavePath);
+    unlink(save::kTempPath);
+    for (const char* path : save::kLegacyPaths) unlink(path);
+}
+
+// ------------------------------
+// The game
+// ------------------------------
+struct Progress {
+    int night, mode1, mode2, stars;
+};
+
+static Progress boot() {
+    save::flush();
+    save::stored = save::Record{0, 1, 0, 0, 0};
+    save::loadedFile = false;
+    save::loadedData = false;
+    save::whichNight = 1;
+    save::file();
+    return {save::whichNight, save::mode1Unlocked, save::mode2Unlocked, save::starAmount};
+}
+
+static bool same(const Progress& a, const Progress& b) {
+    return a.night == b.night && a.mode1 == b.mode1 && a.mode2 == b.mode2 && a.stars == b.stars;
+}
+
+static void win(int night) {
+    save::whichNight = night;
+    save::saveData();
+    save::flush();
+}
+
+// save.bin as it is on disk, checked
+static bool onDisk(const char* path, save::Record& record) {
+    unsigned char buffer[save::kRecordBytes + 1];
+    return save::decode(buffer, readFile(path, buffer, sizeof(buffer)), record);
+}
+
+static constexpr Progress kDefaults = {1, 0, 0, 0};
+
+// ------------------------------
+// The record
+// ------------------------------
+static void testRecord() {
+    CHECK(save::crc32((const unsigned char*)"123456789", 9) == 0xcbf43926, "CRC-32 check value %08x",
+          save::crc32((const unsigned char*)"123456789", 9));
+
+    unsigned char buffer[save::kRecordBytes + 1];
+    int records = 0;
+    for (int night = 1; night <= 5; ++night) {
+        for (int modes = 0; modes < 4; ++modes) {
+            for (int stars = 0; stars <= 3; ++stars) {
+                const save::Record in = {0x9e3779b9u * (unsigned int)records, (unsigned char)night,
+                                         (unsigned char)(modes & 1), (unsigned char)(modes >> 1),
+                                         (unsigned char)stars};
+                save::encode(in, buffer);
+                save::Record out = {};
+                CHECK(save::decode(buffer, save::kRecordBytes, out) && out.generation == in.generation &&
+                      out.night == in.night && out.mode1 == in.mode1 && out.mode2 == in.mode2 &&
+                      out.stars == in.stars, "night %d, modes %d, stars %d do not round trip", night, modes, stars);
+                records++;
+            }
+        }
+    }
+
+    const save::Record good = {7, 3, 1, 0, 2};
+    save::encode(good, buffer);
+    save::Record out;
+    int accepted = 0;
+    for (int bit = 0; bit < save::kRecordBytes * 8; ++bit) {
+        buffer[bit / 8] ^= 1 << (bit % 8);
+        if (save::decode(buffer, save::kRecordBytes, out) && accepted++ < 5) {
+            CHECK(false, "a record with bit %d flipped decodes", bit);
+        }
+        buffer[bit / 8] ^= 1 << (bit % 8);
+    }
+    CHECK(accepted == 0, "%d single-bit flips accepted", accepted);
+    for (int bytes = 0; bytes <= save::kRecordBytes + 1; ++bytes) {
+        if (bytes == save::kRecordBytes) continue;
+        CHECK(!save::decode(buffer, bytes, out), "a %d-byte record decodes", bytes);
+    }
+
+    // Out of range under a CRC that matches
+    static const int kField[] = {12, 12, 13, 14, 15};
+    static const unsigned char kBad[] = {0, 6, 2, 2, 4};
+    for (int i = 0; i < 5; ++i) {
+        save::encode(good, buffer);
+        buffer[kField[i]] = kBad[i];
+        save::put32(buffer + 16, save::crc32(buffer, 16));
+        CHECK(!save::decode(buffer, save::kRecordBytes, out), "byte %d = %d decodes", kField[i], kBad[i]);
+    }
+    printf("record: %d round trips, %d bit flips\n", records, save::kRecordBytes * 8);
+}
+
+// ------------------------------
+// The disk
+// ------------------------------
+static void testFirstBoot() {
+    wipe();
+    CHECK(same(boot(), kDefaults), "a first boot is not night 1");
+    save::Record record;
+    CHECK(onDisk(save::kSavePath, record) && record.night == 1, "a first boot writes no save.bin");
+
+    win(1);
+    win(2);
+    win(5);
+    const Progress won = {3, 1, 0, 1};
+    CHECK(same(boot(), won), "three wins did not come back");
+    CHECK(!exists(save::kTempPath), "save.tmp is left after a write");
+}
+
+// Progress worth losing: night 4, the 6th night unlocked, one star
+static Progress someProgress() {
+    wipe();
+    boot();
+    win(1);
+    win(2);
+    win(3);
+    win(5);
+    return {4, 1, 0, 1};
+}
+
+static void testBitFlips() {
+    int wrong = 0;
+    for (int bit = 0; bit < save::kRecordBytes * 8; ++bit) {
+        someProgress();
+        unsigned char buffer[save::kRecordBytes];
+        readFile(save::kSavePath, buffer, sizeof(buffer));
+        buffer[bit / 8] ^= 1 << (bit % 8);
+        writeFile(save::kSavePath, buffer, sizeof(buffer));
+
+        const Progress got = boot();
+        save::Record record;
+        if ((!same(got, kDefaults) || !onDisk(save::kSavePath, record)) && wrong++ < 5) {
+            CHECK(false, "bit %d flipped in save.bin: night %d, stars %d, save.bin %s", bit, got.night, got.stars,
+                  onDisk(save::kSavePath, record) ? "good" : "still bad");
+        }
+    }
+    CHECK(wrong == 0, "%d bit flips not recovered", wrong);
+}
+
+static void testStaleTemp() {
+    // The temp of the write before last, as if its remove had failed
+    const Progress progress = someProgress();
+    save::Record record;
+    CHECK(onDisk(save::kSavePath, record), "no save.bin");
+    save::Record older = record;
+    older.generation--;
+    older.night--;
+    unsigned char buffer[save::kRecordBytes];
+    save::encode(older, buffer);
+    writeFile(save::kTempPath, buffer, sizeof(buffer));
+    CHECK(same(boot(), progress), "a stale save.tmp was taken over save.bin");
+    CHECK(!exists(save::kTempPath), "the stale save.tmp was left after the boot");
+}
+
+static void testTruncatedTemp() {
+    const Progress progress = someProgress();
+    save::Record record;
+    onDisk(save::kSavePath, record);
+    record.generation++;
+    record.night = 5;
+    unsigned char buffer[save::kRecordBytes];
+    save::encode(record, buffer);
+    for (int bytes = 0; bytes < save::kRecordBytes; ++bytes) {
+        writeFile(save::kTempPath, buffer, bytes);
+        const Progress got = boot();
+        CHECK(same(got, progress), "a newer save.tmp cut to %d bytes gave night %d", bytes, got.night);
+    }
+
+    // Cut short with save.bin already gone: nothing to go back to
+    unlink(save::kSavePath);
+    writeFile(save::kTempPath, buffer, save::kRecordBytes / 2);
+    CHECK(same(boot(), kDefaults), "a lone cut-short save.tmp did not give the defaults");
+    CHECK(onDisk(save::kSavePath, record) && record.night == 1, "the defaults were not written back");
+}
+
+static void testLostRename() {
+    someProgress();
+    pspstubFailRename = 1;
+    win(4);
+    pspstubFailRename = 0;
+    CHECK(!exists(save::kSavePath) && exists(save::kTempPath), "a failed rename left save.bin %s, save.tmp %s",
+          exists(save::kSavePath) ? "there" : "gone", exists(save::kTempPath) ? "there" : "gone");
+
+    const Progress won = {5, 1, 0, 1};
+    CHECK(same(boot(), won), "the record in save.tmp was lost with the rename");
+    save::Record record;
+    CHECK(onDisk(save::kSavePath, record) && !exists(save::kTempPath), "the boot did not put save.bin back");
+
+    // The next write cut short in save.tmp: save.bin is there to go back to
+    unsigned char buffer[save::kRecordBytes];
+    save::encode(record, buffer);
+    writeFile(save::kTempPath, buffer, save::kRecordBytes / 2);
+    CHECK(same(boot(), won), "a write cut short after the boot took the progress with it");
+    win(5);
+    CHECK(onDisk(save::kSavePath, record) && !exists(save::kTempPath), "the next write did not go through");
+    CHECK(same(boot(), won), "progress differs after the rename went through");
+
+    // Every write lost the same way, one after another
+    pspstubFailRename = 1;
+    win(6);
+    win(7);
+    pspstubFailRename = 0;
+    const Progress all = {5, 1, 1, 3};
+    CHECK(same(boot(), all), "two lost renames in a row lost progress");
+    CHECK(onDisk(save::kSavePath, record) && !exists(save::kTempPath), "the boot did not put save.bin back");
+}
+
+static void testLegacy() {
+    wipe();
+    writeFile(save::kLegacyPaths[0], save::kLegacyNights[2], (int)strlen(save::kLegacyNights[2]));
+    writeFile(save::kLegacyPaths[1], save::kLegacyModes[1], (int)strlen(save::kLegacyModes[1]));
+    writeFile(save::kLegacyPaths[3], "garbage\n", 8);
+    const Progress converted = {3, 1, 0, 0};
+    CHECK(same(boot(), converted), "the old saves were not converted");
+    for (const char* path : save::kLegacyPaths) CHECK(!exists(path), "%s was left after the conversion", path);
+    CHECK(same(boot(), converted), "the converted record did not come back");
+}
+
+int main() {
+    testRecord();
+
+    mkdir("tests/build", 0777);
+    mkdir(kRoot, 0777);
+    if (chdir(kRoot) != 0) {
+        printf("save: can't enter %s\nsave: FAILED\n", kRoot);
+        return 1;
+    }
+    mkdir("saves", 0777);
+    testFirstBoot();
+    testBitFlips();
+    testStaleTemp();
+    testTruncatedTemp();
+    testLostRename();
+    testLegacy();
+    wipe();
+
+    printf("save: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
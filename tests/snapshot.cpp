@@ -0,0 +1,342 @@
+// snapshot - quick resume: round trips, seeded continuation and bad files
+//
+// A night is played through the real office, camera, AI, power and clock
+// code (handleOfficeState without the drawing), with the pad a function of the
+// frame number and jumpscares waved off so the night runs on. The reload
+// worker is held (pspstubHoldThreads) and its job done within the frame.
+//
+// Frame 4000 is captured: restore() on it and capture() again must give the
+// same bytes, and the HOME path (request and postFrame) writes resume.bin.
+// Every frame after it is hashed through capture() up to frame 30000, along
+// with the state requests made. The test then runs itself again, a fresh
+// process that boots through snapshot::resume(), plays the same frames and
+// must come to the same hash and requests.
+//
+// Then resume.bin is damaged, each time for a fresh process:
+//   - a byte flipped under the CRC: no resume, the menu as usual
+//   - a byte added to or taken from the body, framed with a good CRC: the
+//     office, on the snapshot's night from the start, the call not cut
+// and resume.bin must be gone after each boot, good or bad.
+//
+// animatronic.cpp, power.cpp and time.cpp are included rather than linked,
+// so the harness can do the reload worker's bookkeeping and see a fresh night.
+#include "../source/animatronic.cpp"
+#include "../source/power.cpp"
+#include "../source/time.cpp"
+#include "included/snapshot.hpp"
+#include "included/office.hpp"
+#include "included/camera.hpp"
+#include "included/save.hpp"
+
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace animatronic;
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static const char* const kRoot = "tests/build/snapshot-root";
+static const char* const kResumePath = "saves/resume.bin";
+static const char* const kMap = "../map.bin"; // from kRoot
+
+static constexpr int kNight = 6;
+static constexpr int kLevel = 15;
+static constexpr int kCapture = 4000;
+static constexpr int kFrames = 30000;
+
+// ------------------------------
+// What the modules call
+// ------------------------------
+static int requests = 0;
+static int resumeBytes = 0;
+static bool callStarted = false;
+
+namespace state {
+    volatile bool isFoxyAttackPaused = false;
+    static Id currentId = kNone;
+    Id current() { return currentId; }
+    void request(Id) { requests++; }
+    void start(Id first) {
+        if (currentId != kNone) return;
+        currentId = first;
+        office::enter();
+    }
+}
+namespace ambience { namespace office {
+    OSL_SOUND *ambience, *fan;
+    void playAmbience() {}
+    void playFanSound() {}
+} }
+namespace call {
+    bool stopped = false;
+    void playPhoneCalls() { callStarted = true; }
+    void unloadPhoneCalls() { stopped = true; }
+}
+namespace mixer { void stop(OSL_SOUND*) {} }
+namespace sfx { namespace office {
+    void playCamClose() {} void playCamOpen() {} void playDoor() {} void playKnock() {} void playLaugh() {}
+    void playLightOff() {} void playLightOn() {} void playMove() {} void playRun() {} void playScare() {}
+    void playSwitch() {}
+} }
+namespace image { namespace global { namespace n_static { Image* staticFrames[4]; } } }
+namespace officeImage { Image *office1Sprites[5], *office2Sprites[5]; }
+namespace text { namespace global { Image *nightNumbersPixel[10], *symbols; } }
+namespace sprite {
+    namespace office { Image *buttonsLeft[4], *buttonsRight[4], *doorLeft[7], *doorRight[7]; }
+    namespace n_jumpscare {
+        int whichJumpscare = 0;
+        void warm(int) {}
+        void discard(int) {}
+    }
+    namespace UI { namespace office {
+        Image *AM, *Night, *camBorder, *camButtons[11], *camFlip[4], *camMap, *camNames[11], *cams[11];
+        Image *powerBar[5], *powerLeft, *recording, *reticle, *usageFrame;
+        bool loaded = true;
+        int freddyPosition = 0, bonniePosition = 0, chicaPosition = 0, foxyPosition = 0;
+        void updateChangedCams() {}
+    } }
+}
+void drawSpriteAlpha(int, int, int, int, Image*, int, int, int) {}
+extern "C" Image* loadPng(const char*) { return nullptr; }
+namespace memory {
+    void reportResume(int bytes, unsigned int) { resumeBytes = bytes; }
+    void reportSnapshot(int) {}
+    void reportSave(const char*, unsigned int) {}
+}
+
+// ------------------------------
+// The night
+// ------------------------------
+static unsigned int mixBits(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+// handleOfficeState without the drawing; the pad is a function of the frame
+static void officeFrame(unsigned int frame) {
+    const unsigned int r = mixBits(frame * 2654435761u + 17);
+    office::main::moveOffice();
+    office::lights::lights();
+    office::buttons::setButtonFrame();
+    runAiLoop();
+    forceAnimatronicAiReset();
+    if (sceKernelPollSema(ReloadSemaphore, 1) >= 0) { // reloadCams, done at once
+        while (sceKernelPollSema(ReloadSemaphore, 1) >= 0) { /* drain */ }
+        sPendingReloads = 0;
+        reloaded = true;
+        isMoving = false;
+    }
+    power::update::drainConstant();
+    power::update::checkDrain();
+    timegame::update::updateTime();
+    if (office::closingLeft) office::doors::closeLeft(); else if (office::openingLeft) office::doors::openLeft();
+    if (office::closingRight) office::doors::closeRight(); else if (office::openingRight) office::doors::openRight();
+    if (camera::opening) camera::animation::openCams(); else if (camera::closing) camera::animation::closeCams();
+    if (!camera::isUsing) {
+        const int swing = (frame / 40) % 3;
+        office::scroll = swing == 0 ? office::kStill : swing == 1 ? office::kScrollLeft : office::kScrollRight;
+        office::lightHeld = (frame / 25) % 4 == 1;
+        if (r % 97 == 0) office::doors::doors();
+    }
+    if (r % 151 == 0) camera::animation::camera();
+    if (r % 13 == 1) camera::system::down();
+    if (r % 17 == 2) camera::system::up();
+    jumpscaring = false; // the night goes on past an attack
+}
+
+static unsigned long long hashFrame(unsigned long long hash) {
+    unsigned char buffer[snapshot::kMaxBytes];
+    const int bytes = snapshot::capture(buffer, sizeof(buffer));
+    for (int i = 0; i < bytes; ++i) hash = (hash ^ buffer[i]) * 0x100000001b3ull;
+    return (hash ^ (unsigned int)requests) * 0x100000001b3ull;
+}
+
+static constexpr unsigned long long kHashStart = 0xcbf29ce484222325ull;
+
+// ------------------------------
+// Files
+// ------------------------------
+static int readFile(const char* path, unsigned char* out, int size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    const int bytes = (int)fread(out, 1, size, f);
+    fclose(f);
+    return bytes;
+}
+
+static void writeFile(const char* path, const unsigned char* data, int bytes) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return;
+    fwrite(data, 1, bytes, f);
+    fclose(f);
+}
+
+static bool exists(const char* path) {
+    struct stat info;
+    return stat(path, &info) == 0;
+}
+
+// The snapshot with its body one byte longer or shorter, size and CRC made good
+static int reframe(const unsigned char* in, int bytes, int change, unsigned char* out) {
+    const int body = bytes - 4;
+    memcpy(out, in, body);
+    if (change > 0) out[body] = 0;
+    const int framed = body + change + 4;
+    out[6] = framed & 0xff;
+    out[7] = (framed >> 8) & 0xff;
+    const unsigned int crc = save::crc32(out, framed - 4);
+    for (int i = 0; i < 4; ++i) out[framed - 4 + i] = (crc >> (8 * i)) & 0xff;
+    return framed;
+}
+
+// ------------------------------
+// A fresh process
+// ------------------------------
+static char self[PATH_MAX];
+
+static int runFresh(const char* mode, const char* arg) {
+    fflush(stdout);
+    const pid_t child = fork();
+    if (child == 0) {
+        execl(self, self, mode, arg, (char*)nullptr);
+        _exit(127);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+static int finish(const char* name) {
+    printf("%s: %s\n", name, failures ? "FAILED" : "ok");
+    return failures != 0;
+}
+
+// Boots from resume.bin and plays on; the hash and requests must be the recorded ones
+static int resumed(const char* expected) {
+    CHECK(snapshot::resume(), "resume.bin did not resume");
+    CHECK(!exists(kResumePath), "resume.bin is left after resuming");
+    CHECK(state::current() == state::kOffice && save::whichNight == kNight, "resumed into state %d, night %d",
+          state::current(), save::whichNight);
+    unsigned long long hash = kHashStart;
+    for (int frame = kCapture; frame < kFrames; ++frame) {
+        officeFrame(frame);
+        hash = hashFrame(hash);
+    }
+    char got[64];
+    snprintf(got, sizeof(got), "%016llx/%d", hash, requests);
+    CHECK(strcmp(got, expected) == 0, "resumed night ends at %s, recorded %s", got, expected);
+    printf("resumed: %d bytes, frames %d to %d\n", resumeBytes, kCapture, kFrames);
+    return finish("snapshot (resumed)");
+}
+
+// Boots from a resume.bin whose body does not read back
+static int badBody(const char* how) {
+    CHECK(snapshot::resume(), "%s: no resume from a good frame", how);
+    CHECK(!exists(kResumePath), "%s: resume.bin is left", how);
+    CHECK(state::current() == state::kOffice && save::whichNight == kNight, "%s: state %d, night %d", how,
+          state::current(), save::whichNight);
+    for (int id = 0; id < kCount; ++id) {
+        CHECK(table.position[id] == 0 && !table.atDoor[id] && !table.inOtherRoom[id],
+              "%s: character %d at %d, not at the start", how, id, table.position[id]);
+    }
+    CHECK(power::total == 99 && timegame::gtime == 0, "%s: power %d, hour %d, not a fresh night", how, power::total,
+          timegame::gtime);
+    CHECK(!office::leftClosed && !office::rightClosed && !camera::isUsing && camera::whichCamera == 0,
+          "%s: doors or camera carried over", how);
+    CHECK(callStarted && !call::stopped, "%s: the call was cut", how);
+    CHECK(resumeBytes == 0, "%s: reported as resumed", how);
+    return finish("snapshot (bad body)");
+}
+
+static int badCrc() {
+    CHECK(!snapshot::resume(), "a snapshot with a bad CRC resumed");
+    CHECK(!exists(kResumePath), "a bad resume.bin is left");
+    CHECK(state::current() == state::kNone, "a bad snapshot entered state %d", state::current());
+    return finish("snapshot (bad CRC)");
+}
+
+static void playFromBoot(unsigned char* captured, int* capturedBytes, char* expected, int size) {
+    save::whichNight = kNight;
+    state::start(state::kOffice);
+    for (int id = 0; id < kCount; ++id) table.level[id] = kLevel;
+
+    unsigned long long hash = kHashStart;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        officeFrame(frame);
+        if (frame == kCapture - 1) {
+            // The phone call is over by now; a resume must not play it again
+            call::stopped = true;
+            *capturedBytes = snapshot::capture(captured, snapshot::kMaxBytes);
+            unsigned char again[snapshot::kMaxBytes];
+            CHECK(*capturedBytes > 0 && snapshot::restore(captured, *capturedBytes), "frame %d does not restore",
+                  kCapture);
+            CHECK(snapshot::capture(again, sizeof(again)) == *capturedBytes &&
+                  memcmp(again, captured, *capturedBytes) == 0, "capture, restore, capture differs");
+            CHECK(snapshot::night(captured, *capturedBytes) == kNight, "the snapshot is not of night %d", kNight);
+
+            snapshot::request(true, 0);
+            snapshot::postFrame();
+            unsigned char written[snapshot::kMaxBytes + 1];
+            CHECK(readFile(kResumePath, written, sizeof(written)) == *capturedBytes &&
+                  memcmp(written, captured, *capturedBytes) == 0, "resume.bin is not the frame captured");
+            requests = 0;
+        }
+        if (frame >= kCapture) hash = hashFrame(hash);
+    }
+    snprintf(expected, size, "%016llx/%d", hash, requests);
+}
+
+int main(int argc, char** argv) {
+    if (argc == 1) {
+        if (!realpath(argv[0], self)) {
+            printf("snapshot: can't find %s\nsnapshot: FAILED\n", argv[0]);
+            return 1;
+        }
+        mkdir("tests/build", 0777);
+        mkdir(kRoot, 0777);
+        if (chdir(kRoot) != 0) {
+            printf("snapshot: can't enter %s\nsnapshot: FAILED\n", kRoot);
+            return 1;
+        }
+        mkdir("saves", 0777);
+        unlink(kResumePath);
+    }
+    pspstubHoldThreads = 1;
+    CHECK(graph::load(kMap), "can't load %s", kMap);
+
+    if (argc == 3 && strcmp(argv[1], "resume") == 0) return resumed(argv[2]);
+    if (argc == 3 && strcmp(argv[1], "bad-body") == 0) return badBody(argv[2]);
+    if (argc == 2 && strcmp(argv[1], "bad-crc") == 0) return badCrc();
+
+    unsigned char captured[snapshot::kMaxBytes];
+    int bytes = 0;
+    char expected[64];
+    playFromBoot(captured, &bytes, expected, sizeof(expected));
+    printf("recorded: %d-byte snapshot at frame %d, %s through frame %d\n", bytes, kCapture, expected, kFrames);
+    CHECK(runFresh("resume", expected) == 0, "the resumed process failed");
+
+    unsigned char damaged[snapshot::kMaxBytes + 1];
+    memcpy(damaged, captured, bytes);
+    damaged[bytes / 2] ^= 0x10;
+    writeFile(kResumePath, damaged, bytes);
+    CHECK(runFresh("bad-crc", nullptr) == 0, "a bad CRC was not turned down");
+
+    writeFile(kResumePath, damaged, reframe(captured, bytes, 1, damaged));
+    CHECK(runFresh("bad-body", "longer") == 0, "a longer body did not start the night over");
+    writeFile(kResumePath, damaged, reframe(captured, bytes, -1, damaged));
+    CHECK(runFresh("bad-body", "shorter") == 0, "a shorter body did not start the night over");
+
+    unlink(kResumePath);
+    return finish("snapshot");
+}
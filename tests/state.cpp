@@ -0,0 +1,386 @@
+// state - every legal transition, for leaks and redundant decodes
+//
+// state.cpp is built against loaders that only keep count: each load and
+// unload pair shares a record of whether it is resident, how often it decoded
+// and how many bytes it holds (in imageRamAlloc, which the retention ceiling
+// reads). The harness first loads and unloads each asset group once through
+// state.cpp's own table to learn which loaders belong to which group.
+//
+// Then, for every move in the transition table, it goes from the menu to the
+// move's source by the shortest route, takes the move, and comes back to the
+// menu. After every switch, and again once the frees it spread over the
+// following frames are done, a state's manifest must be resident, nothing
+// outside its manifest and what it retains may be, and every loader must agree
+// with the state's idea of what is resident. A load of something resident is
+// a redundant decode, unless it is a refreshed group the state marked stale;
+// an unload of something not resident is a double free. Every move the table
+// does not list is requested from each state and must be refused.
+//
+// Last, two nights won back to back: with room to spare the second night must
+// decode nothing the first left behind, only the refreshed cameras and the
+// per-night phone call. Nights 1 to 5 are then won once freeing everything
+// between nights and once retaining; retaining must decode exactly four
+// nights' worth of the groups it holds less. With loaders four times the size
+// retention must give way, and still nothing may leak.
+#include "../source/state.cpp"
+
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+// ------------------------------
+// Counting loaders
+// ------------------------------
+struct Loader {
+    const char* name;
+    int group = -1;        // learned from state.cpp's table
+    bool resident = false;
+    int decodes = 0;
+    int bytes = 0;
+    explicit Loader(const char* name);
+};
+
+static std::vector<Loader*>& loaders() {
+    static std::vector<Loader*> all;
+    return all;
+}
+
+Loader::Loader(const char* loaderName) : name(loaderName) { loaders().push_back(this); }
+
+static int learning = -1;  // the group being loaded to learn its loaders
+static int scale = 1;      // loader sizes, times this
+static int redundant = 0, doubleFrees = 0;
+
+static void countLoad(Loader& l) {
+    if (learning >= 0) l.group = learning;
+    const bool refresh = l.group >= 0 && (state::stale & state::bit(static_cast<state::Asset>(l.group)));
+    if (l.resident && !refresh && redundant++ < 5) {
+        CHECK(false, "%s decoded again while resident (in %s)", l.name, state::name(state::currentState));
+    }
+    if (!l.resident) {
+        // Anything from 64 KB to 1.5 MB, the same for a loader every time
+        unsigned int h = 2166136261u;
+        for (const char* c = l.name; *c; ++c) h = (h ^ (unsigned char)*c) * 16777619u;
+        l.bytes = (int)(64 * 1024 * (1 + h % 24)) * scale;
+        imageRamAlloc += l.bytes;
+    }
+    imageBytesDecoded += l.bytes;
+    l.resident = true;
+    l.decodes++;
+}
+
+static void countUnload(Loader& l) {
+    if (!l.resident && doubleFrees++ < 5) {
+        CHECK(false, "%s unloaded while not resident (in %s)", l.name, state::name(state::currentState));
+    }
+    if (l.resident) imageRamAlloc -= l.bytes;
+    l.resident = false;
+}
+
+#define LOADER(load, unload) \
+    static Loader load##Loader(#load); \
+    void load() { ::countLoad(load##Loader); } \
+    void unload() { ::countUnload(load##Loader); }
+
+int imageRamAlloc = 0;
+int imageBytesDecoded = 0;
+
+namespace image {
+    namespace menu {
+        LOADER(loadMenuBackground, unloadMenuBackground)
+        LOADER(loadLogo, unloadLogo)
+        LOADER(loadCopyright, unloadCopyright)
+        LOADER(loadTextAndCursor, unloadTextAndCursor)
+    }
+    namespace n_newspaper { LOADER(loadNewsPaper, unloadNewsPaper) }
+    namespace n_noPower { LOADER(loadNoPower, unloadNoPower) }
+    namespace n_ending { LOADER(loadEnding, unloadEnding) }
+}
+namespace sprite {
+    namespace menu { LOADER(loadStar, unloadStar) }
+    namespace nightinfo { LOADER(loadNightInfoSprite, unloadNightInfoSprite) }
+    namespace UI {
+        namespace customnight {
+            LOADER(loadIcons, unloadIcons)
+            LOADER(loadReticle, unloadReticle)
+            LOADER(loadInstructions, unloadInstructions)
+            LOADER(loadTitle, unloadTitle)
+            LOADER(loadArrows, unloadArrows)
+            LOADER(loadText, unloadText)
+            LOADER(loadNames, unloadNames)
+            LOADER(loadActions, unloadActions)
+            LOADER(loadGoldenFreddy, unloadGoldenFreddy)
+        }
+        namespace office {
+            LOADER(loadCamFlip, unloadCamFlip)
+            LOADER(loadPowerInfo, unloadPowerInfo)
+            LOADER(loadTimeInfo, unloadTimeInfo)
+            LOADER(loadAllCams, unloadCams)
+            LOADER(loadCamUi, unloadCamUi)
+        }
+    }
+    namespace office {
+        LOADER(loadButtons, unloadButtons)
+        LOADER(loadDoors, unloadDoors)
+    }
+    namespace n_jumpscare { LOADER(loadJumpscare, unloadJumpscare) }
+}
+namespace officeImage {
+    LOADER(loadOffice1Sprites, unloadOffice1Sprites)
+    LOADER(loadOffice2Sprites, unloadOffice2Sprites)
+}
+namespace customnight { LOADER(loadTable, unloadTable) }
+namespace music {
+    namespace menu { LOADER(loadMenuMusic, unloadMenuMusic) }
+    namespace n_ending { LOADER(loadEndingSong, unloadEndingSong) }
+}
+namespace ambience { namespace office {
+    LOADER(loadAmbience, unloadAmbience)
+    LOADER(loadFanSound, unloadFanSound)
+} }
+namespace sfx {
+    namespace office { LOADER(loadSfx, unloadSfx) }
+    namespace preload { LOADER(preloadCriticalAudio, unloadCriticalAudio) }
+    namespace sixam { LOADER(loadSixAm, unloadSixAm) }
+    namespace jumpscare {
+        LOADER(loadJumpscareSound, unloadJumpscareSound)
+        LOADER(loadDeadSound, unloadDeadSound)
+    }
+}
+namespace call { LOADER(loadPhoneCalls, unloadPhoneCalls) }
+namespace text { namespace preload {
+    LOADER(preloadCameraAssets, unloadCameraAssets)
+    LOADER(preloadJumpscareAssets, unloadJumpscareAssets)
+} }
+
+// ------------------------------
+// The rest of what state.cpp calls
+// ------------------------------
+namespace audio { size_t residentBytes() { return 0; } } // the loaders count in imageRamAlloc
+namespace memory {
+    void reportTextureSavings(const char*) {}
+    void reportAudioResident(const char*, size_t) {}
+    void reportTransition(const char*, const char*, unsigned int, unsigned int) {}
+    void reportRelease(const char*, unsigned int) {}
+}
+namespace mixer { void report(const char*) {} }
+namespace menu { void enter() {} }
+namespace office { void enter() {} void exit() {} }
+namespace sixam { void enter() {} }
+namespace powerout { void enter() {} }
+namespace ending { void enter() {} }
+namespace dead { void enter() {} }
+namespace jumpscare { namespace load { void loadWithDelay() {} } }
+
+using namespace state;
+
+// ------------------------------
+// Checks
+// ------------------------------
+static int learnGroups() {
+    int unowned = 0;
+    for (int asset = 0; asset < kAssetCount; ++asset) {
+        learning = asset;
+        kAssets[asset].load();
+        learning = -1;
+        kAssets[asset].unload();
+    }
+    for (Loader* l : loaders()) {
+        CHECK(l->group >= 0, "%s belongs to no asset group", l->name);
+        CHECK(!l->resident, "%s is resident after its group's unload", l->name);
+        if (l->group < 0) unowned++;
+        l->decodes = 0;
+    }
+    for (int asset = 0; asset < kAssetCount; ++asset) {
+        bool any = false;
+        for (Loader* l : loaders()) any = any || l->group == asset;
+        CHECK(any, "asset group %s loads nothing here; a loader is missing from the harness", kAssets[asset].name);
+    }
+    CHECK(imageRamAlloc == 0, "%d bytes left after learning the groups", imageRamAlloc);
+    return unowned;
+}
+
+// What is resident agrees with the loaders and with the current state
+static void checkResident(const char* when) {
+    const State& s = kStates[currentState];
+    CHECK((resident & s.manifest) == s.manifest && !(stale & s.manifest), "%s %s: manifest %x, resident %x, stale %x",
+          when, name(currentState), s.manifest, resident, stale);
+    CHECK(!(resident & ~(s.manifest | s.retain | releasing)), "%s %s: %x resident beyond its manifest and retained groups",
+          when, name(currentState), resident & ~(s.manifest | s.retain | releasing));
+    CHECK(!(stale & ~kRefreshed), "%s %s: %x marked stale but not refreshed", when, name(currentState),
+          stale & ~kRefreshed);
+    for (Loader* l : loaders()) {
+        const bool inResident = (resident & bit(static_cast<Asset>(l->group))) != 0;
+        CHECK(l->resident == inResident, "%s %s: %s is %sresident, its group %s", when, name(currentState), l->name,
+              l->resident ? "" : "not ", inResident ? "is" : "is not");
+    }
+}
+
+static void settle() {
+    for (int frame = 0; frame < kAssetCount && releasing; ++frame) postFrame(0);
+    CHECK(!releasing, "%x still to free after %d frames", releasing, kAssetCount);
+}
+
+static int moves = 0;
+
+static void move(Id next) {
+    const Id from = currentState;
+    if (from == kNightinfo) {
+        // The screen preloads the office a little per frame; sometimes it has
+        // all of it, sometimes part, sometimes none
+        for (int step = 0; step < moves % 3 * 8 && !preloadStep(kOffice); ++step) postFrame(0);
+        checkResident("preloading in");
+    }
+    request(next);
+    postFrame(0);
+    moves++;
+    CHECK(currentState == next, "%s -> %s was not taken", name(from), name(next));
+    checkResident("entering");
+    settle();
+    checkResident("settled in");
+}
+
+// Shortest moves from one state to another
+static std::vector<Id> route(Id from, Id to) {
+    Id previous[kCount];
+    bool seen[kCount] = {};
+    std::vector<Id> queue{from};
+    seen[from] = true;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        for (int next = 0; next < kCount; ++next) {
+            if (!seen[next] && (kTransitions[queue[i]] & state::to(static_cast<Id>(next)))) {
+                seen[next] = true;
+                previous[next] = queue[i];
+                queue.push_back(static_cast<Id>(next));
+            }
+        }
+    }
+    std::vector<Id> path;
+    if (!seen[to]) return path;
+    for (Id at = to; at != from; at = previous[at]) path.insert(path.begin(), at);
+    return path;
+}
+
+static void walk(Id to) {
+    const std::vector<Id> path = route(currentState, to);
+    CHECK(!path.empty() || currentState == to, "no way from %s to %s", name(currentState), name(to));
+    for (Id next : path) move(next);
+}
+
+static void refuseAll() {
+    const Id here = currentState;
+    for (int next = 0; next < kCount; ++next) {
+        if (kTransitions[here] & state::to(static_cast<Id>(next))) continue;
+        request(static_cast<Id>(next));
+        postFrame(0);
+        CHECK(currentState == here, "%s -> %s is not in the table but was taken", name(here), name((Id)next));
+    }
+}
+
+static void checkOnlyMenu() {
+    settle();
+    CHECK(currentState == kMenu && resident == kStates[kMenu].manifest, "back at the menu with %x resident", resident);
+    int bytes = 0;
+    for (Loader* l : loaders()) {
+        if (l->resident) bytes += l->bytes;
+    }
+    CHECK(bytes == imageRamAlloc, "%d bytes counted, %d by the loaders", imageRamAlloc, bytes);
+}
+
+// Two nights won in a row; returns the decodes of the second
+static std::vector<int> nights() {
+    walk(kNightinfo);
+    walk(kOffice);
+    move(kSixAm);
+    std::vector<int> before;
+    for (Loader* l : loaders()) before.push_back(l->decodes);
+    move(kNightinfo);
+    move(kOffice);
+    std::vector<int> second;
+    for (size_t i = 0; i < loaders().size(); ++i) second.push_back(loaders()[i]->decodes - before[i]);
+    walk(kMenu);
+    checkOnlyMenu();
+    return second;
+}
+
+// Nights 1 to 5 won back to back; the bytes the four night-to-night moves decode
+static int fourNights(bool retain) {
+    retention = retain;
+    walk(kNightinfo);
+    walk(kOffice);
+    const int decoded = imageBytesDecoded;
+    for (int night = 2; night <= 5; ++night) {
+        move(kSixAm);
+        move(kNightinfo);
+        move(kOffice);
+    }
+    const int bytes = imageBytesDecoded - decoded;
+    walk(kMenu);
+    checkOnlyMenu();
+    retention = true;
+    return bytes;
+}
+
+int main() {
+    const int unowned = learnGroups();
+    if (unowned) {
+        printf("state: FAILED\n");
+        return 1;
+    }
+
+    start(kMenu);
+    checkResident("starting in");
+
+    int taken = 0;
+    for (int from = 0; from < kCount; ++from) {
+        for (int to = 0; to < kCount; ++to) {
+            if (!(kTransitions[from] & state::to(static_cast<Id>(to)))) continue;
+            walk(static_cast<Id>(from));
+            refuseAll();
+            move(static_cast<Id>(to));
+            taken++;
+            walk(kMenu);
+            checkOnlyMenu();
+        }
+    }
+
+    // Retention with room to spare: only the refreshed and per-night groups decode again
+    const std::vector<int> roomy = nights();
+    int roomyDecodes = 0;
+    for (size_t i = 0; i < loaders().size(); ++i) {
+        const Loader& l = *loaders()[i];
+        const Manifest mask = bit(static_cast<Asset>(l.group));
+        roomyDecodes += roomy[i];
+        const bool expected = !(kNextNight & mask) || (kRefreshed & mask);
+        if (kOfficeManifest & mask) {
+            CHECK(roomy[i] == (expected ? 1 : 0), "%s decoded %d times for the second night", l.name, roomy[i]);
+        }
+    }
+
+    // Four nights on, freeing everything between them and retaining
+    const int reloaded = fourNights(false);
+    const int retained = fourNights(true);
+    int kept = 0; // a night's bytes that retention spares
+    for (Loader* l : loaders()) {
+        const Manifest mask = bit(static_cast<Asset>(l->group));
+        if ((kOfficeManifest & kNextNight & mask) && !(kRefreshed & mask)) kept += l->bytes;
+    }
+    CHECK(reloaded - retained == 4 * kept, "retaining decoded %d KB over four nights, reloading %d KB, %d KB apart "
+          "where the held groups make %d KB a night", retained / 1024, reloaded / 1024, (reloaded - retained) / 1024,
+          kept / 1024);
+
+    // And without: retention must give way, and still nothing may leak or decode twice
+    scale = 4;
+    const std::vector<int> tight = nights();
+    int again = 0;
+    for (size_t i = 0; i < loaders().size(); ++i) again += tight[i];
+
+    printf("%d moves over %d transitions; a second night decodes %d loaders with room, %d when tight\n", moves, taken,
+           roomyDecodes, again);
+    printf("nights 1 to 5: %d KB decoded reloading, %d KB retaining\n", reloaded / 1024, retained / 1024);
+    printf("state: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
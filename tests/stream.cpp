@@ -0,0 +1,191 @@
+// stream - the WAV streamer against the samples it was given, bit for bit
+//
+// WAVs are written into tests/build in every layout the game ships (8 and 16
+// bit, mono and stereo, 11/22/44 kHz), with lengths that end mid-chunk and
+// an odd-sized chunk before the data. Each is played through stream::open on
+// the real decode thread and through stream::load, and the 44.1 kHz stereo
+// output must be exactly the source samples, widened and repeated. Looping
+// sounds must wrap without a gap. Built with -fsanitize=alignment: 16-bit
+// frames are read out of byte buffers and the Allegrex faults on a
+// misaligned halfword load, where x86 would not notice.
+//
+// stream.cpp is included rather than linked so the test can wait for the
+// decode thread to fill a buffer before reading it, instead of racing it.
+#include "../source/stream.cpp"
+#include "oslstub.h"
+
+#include <cstdio>
+#include <vector>
+
+using stream::Stream;
+using stream::underruns;
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+struct Layout {
+    const char* name;
+    int channels, bits, rate, frames;
+};
+
+static const Layout layouts[] = {
+    {"s16-stereo-44k", 2, 16, 44100, 10007},
+    {"s16-mono-22k",   1, 16, 22050, 9001},  // the menu music and the six am chimes
+    {"s16-mono-11k",   1, 16, 11025, 3001},
+    {"u8-stereo-11k",  2,  8, 11025, 4099},  // the phone calls
+    {"u8-mono-22k",    1,  8, 22050, 777},
+};
+
+static void put16(std::vector<unsigned char>& v, int x) { v.push_back(x & 255); v.push_back((x >> 8) & 255); }
+static void put32(std::vector<unsigned char>& v, int x) { put16(v, x & 0xffff); put16(v, (x >> 16) & 0xffff); }
+static void putTag(std::vector<unsigned char>& v, const char* tag) { v.insert(v.end(), tag, tag + 4); }
+
+// Writes the WAV and returns what the game should hear: stereo s16 at 44.1 kHz
+static std::vector<short> writeWav(const Layout& l, const char* path) {
+    std::vector<unsigned char> data;
+    std::vector<short> expected;
+    unsigned int seed = 12345u + l.frames;
+    for (int i = 0; i < l.frames; ++i) {
+        int sample[2];
+        for (int c = 0; c < l.channels; ++c) {
+            seed = seed * 1103515245u + 12345u;
+            if (l.bits == 16) {
+                sample[c] = (short)(seed >> 16);
+                put16(data, sample[c]);
+            } else {
+                const int u = (seed >> 16) & 255;
+                data.push_back((unsigned char)u);
+                sample[c] = (u - 128) << 8;
+            }
+        }
+        if (l.channels == 1) sample[1] = sample[0];
+        for (int k = 0; k < 44100 / l.rate; ++k) {
+            expected.push_back((short)sample[0]);
+            expected.push_back((short)sample[1]);
+        }
+    }
+
+    std::vector<unsigned char> wav;
+    putTag(wav, "RIFF");
+    put32(wav, 0);
+    putTag(wav, "WAVE");
+    putTag(wav, "fmt ");
+    put32(wav, 16);
+    put16(wav, 1);
+    put16(wav, l.channels);
+    put32(wav, l.rate);
+    put32(wav, l.rate * l.channels * l.bits / 8);
+    put16(wav, l.channels * l.bits / 8);
+    put16(wav, l.bits);
+    putTag(wav, "LIST"); // odd length, padded, as some editors write it
+    put32(wav, 5);
+    wav.insert(wav.end(), {'I', 'N', 'F', 'O', '!', 0});
+    putTag(wav, "data");
+    put32(wav, (int)data.size());
+    wav.insert(wav.end(), data.begin(), data.end());
+    if (data.size() & 1) wav.push_back(0);
+
+    FILE* f = fopen(path, "wb");
+    if (!f || fwrite(wav.data(), 1, wav.size(), f) != wav.size()) {
+        printf("FAIL can't write %s\n", path);
+        exit(1);
+    }
+    fclose(f);
+    return expected;
+}
+
+// Streamed sounds: never read a buffer the decode thread hasn't finished
+static void waitFilled(OSL_SOUND* s) {
+    Stream* st = (Stream*)s->data;
+    if (st->memory) return;
+    for (int tries = 0; tries < 2000 && st->filled[st->playBuffer] == 0 && !st->eof; ++tries) {
+        sceKernelDelayThread(1000);
+    }
+}
+
+// Plays the sound to the end (or for frames, when it loops) in mixer-sized blocks
+static std::vector<short> play(OSL_SOUND* s, int frames) {
+    static constexpr int kBlock = 512;
+    std::vector<short> out;
+    short block[kBlock * 2];
+    s->playSound(s);
+    while ((int)out.size() / 2 < frames) {
+        waitFilled(s);
+        const int before = underruns;
+        const int more = stream::read(s, block, kBlock);
+        if (more == 0) break;
+        if (underruns != before) {
+            printf("FAIL %s: underrun with the buffer filled\n", s->filename);
+            failures++;
+            break;
+        }
+        out.insert(out.end(), block, block + kBlock * 2);
+    }
+    return out;
+}
+
+// Output is padded with silence to a whole block past the end
+static void compare(const char* what, const std::vector<short>& got, const std::vector<short>& want) {
+    CHECK(got.size() >= want.size() && got.size() < want.size() + 512 * 2,
+          "%s: %d frames out, expected %d", what, (int)got.size() / 2, (int)want.size() / 2);
+    const size_t n = got.size() < want.size() ? got.size() : want.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (got[i] != want[i]) {
+            CHECK(false, "%s: frame %d channel %d is %d, expected %d", what, (int)(i / 2), (int)(i & 1), got[i], want[i]);
+            return;
+        }
+    }
+    for (size_t i = n; i < got.size(); ++i) {
+        if (got[i] != 0) {
+            CHECK(false, "%s: frame %d past the end is %d, not silence", what, (int)(i / 2), got[i]);
+            return;
+        }
+    }
+}
+
+static void testLayout(const Layout& l) {
+    char path[64], what[96];
+    snprintf(path, sizeof(path), "tests/build/%s.wav", l.name);
+    const std::vector<short> expected = writeWav(l, path);
+    const int frames = (int)expected.size() / 2;
+
+    // Small buffers so the decode thread has to refill them many times over
+    OSL_SOUND* streamed = stream::open(path, 1024);
+    OSL_SOUND* resident = stream::load(path);
+    CHECK(streamed && resident, "%s: open or load failed", l.name);
+    if (!streamed || !resident) return;
+
+    snprintf(what, sizeof(what), "%s streamed", l.name);
+    compare(what, play(streamed, frames), expected);
+    snprintf(what, sizeof(what), "%s resident", l.name);
+    compare(what, play(resident, frames), expected);
+
+    // Two and a half times round: the wrap must carry straight on
+    std::vector<short> looped;
+    for (int pass = 0; pass < 3; ++pass) looped.insert(looped.end(), expected.begin(), expected.end());
+    looped.resize(expected.size() * 5 / 2);
+    looped.resize(looped.size() / 2 * 2);
+    streamed->endCallback = oslSoundLoopFunc;
+    resident->endCallback = oslSoundLoopFunc;
+    std::vector<short> got = play(streamed, frames * 5 / 2);
+    got.resize(looped.size());
+    snprintf(what, sizeof(what), "%s streamed loop", l.name);
+    compare(what, got, looped);
+    got = play(resident, frames * 5 / 2);
+    got.resize(looped.size());
+    snprintf(what, sizeof(what), "%s resident loop", l.name);
+    compare(what, got, looped);
+
+    streamed->deleteSound(streamed);
+    resident->deleteSound(resident);
+    free(streamed);
+    free(resident);
+}
+
+int main() {
+    for (const Layout& l : layouts) testLayout(l);
+    CHECK(underruns == 0, "%d underruns", (int)underruns);
+    printf("stream: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
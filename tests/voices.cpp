@@ -0,0 +1,269 @@
+// voices - voice stealing, a scripted mix against its checksum, and the kernel's time
+//
+// First every voice is filled with sounds of mixed priorities, then more are
+// played: each must take the voice of the lowest priority, the oldest of those
+// when several tie, and be refused when everything playing outranks it.
+// Restarting a sound that holds a voice keeps that voice.
+//
+// Then a fixed script of plays, stops, pauses, pans, category volumes and a
+// steal is run through the audio callback block by block, the way oslib's
+// audio thread calls it, and the output is written to tests/build/script.wav.
+// Its samples must hash to kScriptHash; if a change to the mixer means to
+// alter the output, listen to the file and update the hash.
+//
+// Last, mixBlock is timed with every voice busy, half of them panned so both
+// the unity and the gain paths run, against the 11.6 ms a block lasts.
+//
+// mixer.cpp is included rather than linked to look at the voices and to call
+// drainEvents and mixBlock directly.
+#include "../source/mixer.cpp"
+#include "oslstub.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace mixer;
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static constexpr unsigned long long kScriptHash = 0xef2ffae5e743a6daull;
+static constexpr int kSounds = kVoices + 4;
+static constexpr int kSoundFrames = 16384;
+static constexpr unsigned int kBlockMicros = kBlockFrames * 1000000u / 44100u;
+
+static const char* const kScriptPath = "tests/build/script.wav";
+
+// ------------------------------
+// Sounds
+// ------------------------------
+static void put16(std::vector<unsigned char>& v, int x) { v.push_back(x & 255); v.push_back((x >> 8) & 255); }
+static void put32(std::vector<unsigned char>& v, int x) { put16(v, x & 0xffff); put16(v, (x >> 16) & 0xffff); }
+
+static void wavHeader(std::vector<unsigned char>& wav, int frames) {
+    wav.insert(wav.end(), {'R', 'I', 'F', 'F'});
+    put32(wav, 36 + frames * 4);
+    wav.insert(wav.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    put32(wav, 16);
+    put16(wav, 1);
+    put16(wav, 2);
+    put32(wav, 44100);
+    put32(wav, 44100 * 4);
+    put16(wav, 4);
+    put16(wav, 16);
+    wav.insert(wav.end(), {'d', 'a', 't', 'a'});
+    put32(wav, frames * 4);
+}
+
+static bool writeFile(const char* path, const std::vector<unsigned char>& data) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    const bool written = fwrite(data.data(), 1, data.size(), f) == data.size();
+    fclose(f);
+    return written;
+}
+
+// A triangle wave of its own pitch per sound, the right channel a little
+// quieter, so a wrong voice or gain shows in the hash
+static OSL_SOUND* makeSound(int index) {
+    char path[64];
+    snprintf(path, sizeof(path), "tests/build/voice%d.wav", index);
+    std::vector<unsigned char> wav;
+    wavHeader(wav, kSoundFrames);
+    const int period = 40 + index * 14;
+    for (int i = 0; i < kSoundFrames; ++i) {
+        const int phase = i % period;
+        const int level = (phase < period / 2 ? phase : period - phase) * 12000 / (period / 2) - 6000;
+        put16(wav, level);
+        put16(wav, level * 3 / 4);
+    }
+    if (!writeFile(path, wav)) {
+        printf("FAIL can't write %s\n", path);
+        exit(1);
+    }
+    return attach(stream::load(path));
+}
+
+static OSL_SOUND* sounds[kSounds];
+
+static void stopAll() {
+    for (OSL_SOUND* s : sounds) stop(s);
+    drainEvents();
+}
+
+// ------------------------------
+// Stealing
+// ------------------------------
+static void testStealing() {
+    // Priorities by start order; voices 1, 3 and 6 are the low ones
+    static const int kPriority[kVoices] = {2, 1, 3, 1, 2, 3, 1, 2};
+    for (int i = 0; i < kVoices; ++i) play(sounds[i], kSfx, kPriority[i]);
+    drainEvents();
+    for (int i = 0; i < kVoices; ++i) CHECK(playing(sounds[i]), "sound %d has no voice with some free", i);
+    const int stealsBefore = steals, rejectedBefore = rejected;
+
+    struct Step {
+        int sound, priority;
+        int takes;   // whose voice it must get, -1 refused
+        const char* why;
+    };
+    static const Step kSteps[] = {
+        {8, 2, 1, "the oldest of the lowest"},
+        {9, 2, 3, "the next oldest of the lowest"},
+        {10, 0, -1, "outranked by everyone"},
+        {10, 1, 6, "an equal priority, the last of them"},
+        {11, 2, 10, "the lowest, although the newest"},
+        {1, 1, -1, "outranked again"},
+        {0, 9, 0, "its own voice, nothing stolen"},
+        {1, 2, 4, "now the oldest of the 2s"},
+    };
+    int expectedSteals = 0, expectedRejected = 0;
+    for (const Step& step : kSteps) {
+        const int target = step.takes >= 0 ? findVoice(sounds[step.takes]) : -1;
+        const bool restart = playing(sounds[step.sound]);
+        const int own = findVoice(sounds[step.sound]);
+        play(sounds[step.sound], kSfx, step.priority);
+        drainEvents();
+        if (step.takes < 0) {
+            expectedRejected++;
+            CHECK(!playing(sounds[step.sound]), "sound %d at priority %d got a voice (%s)", step.sound,
+                  step.priority, step.why);
+        } else if (restart) {
+            CHECK(findVoice(sounds[step.sound]) == own, "sound %d moved voice on a restart", step.sound);
+        } else {
+            expectedSteals++;
+            CHECK(target >= 0 && voices[target].sound == sounds[step.sound] && !playing(sounds[step.takes]),
+                  "sound %d at priority %d did not take sound %d's voice (%s)", step.sound, step.priority,
+                  step.takes, step.why);
+        }
+    }
+    CHECK(steals - stealsBefore == expectedSteals, "%d steals, expected %d", steals - stealsBefore, expectedSteals);
+    CHECK(rejected - rejectedBefore == expectedRejected, "%d refused, expected %d", rejected - rejectedBefore,
+          expectedRejected);
+    stopAll();
+}
+
+// ------------------------------
+// The script
+// ------------------------------
+enum Action { kScriptPlay, kScriptLoop, kScriptStop, kScriptPause, kScriptResume, kScriptCategory };
+
+struct Cue {
+    int block;
+    Action action;
+    int sound;      // or the category for kScriptCategory
+    int priority, volume, pan;
+};
+
+static const Cue kScript[] = {
+    {0,  kScriptLoop,     0, 1, kVolumeMax, 0},
+    {0,  kScriptPlay,     1, 2, kVolumeMax / 2, -kVolumeMax},   // hard left
+    {3,  kScriptPlay,     2, 2, kVolumeMax, kVolumeMax / 2},    // half right
+    {5,  kScriptPause,    0, 0, 0, 0},
+    {8,  kScriptResume,   0, 0, 0, 0},
+    {9,  kScriptCategory, kSfx, 0, kVolumeMax / 4, 0},
+    {12, kScriptPlay,     3, 1, kVolumeMax / 3, 0},
+    {12, kScriptPlay,     3, 3, kVolumeMax, 0},                 // twice in a block: one voice, louder wins
+    {14, kScriptStop,     1, 0, 0, 0},
+    {16, kScriptCategory, kSfx, 0, kVolumeMax, 0},
+    {18, kScriptPlay,     4, 1, kVolumeMax, 0},
+    {18, kScriptPlay,     5, 1, kVolumeMax, kVolumeMax},
+    {18, kScriptPlay,     6, 1, kVolumeMax, -kVolumeMax / 3},
+    {18, kScriptPlay,     7, 1, kVolumeMax, 0},
+    {18, kScriptPlay,     8, 1, kVolumeMax, 0},
+    {19, kScriptPlay,     9, 2, kVolumeMax, 0},                 // every voice busy: steals sound 0's loop
+    {24, kScriptPlay,     2, 2, kVolumeMax, 0},                 // a restart from the top
+    {30, kScriptStop,     9, 0, 0, 0},
+};
+static constexpr int kScriptBlocks = 64; // past the end of the one-shots
+
+static unsigned long long hashSamples(const short* samples, int count, unsigned long long hash) {
+    for (int i = 0; i < count; ++i) {
+        hash = (hash ^ (unsigned short)samples[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static void testScript() {
+    OSL_SOUND* out = oslstubChannels[kChannel];
+    std::vector<short> rendered(kScriptBlocks * kBlockFrames * 2);
+    const int count = sizeof(kScript) / sizeof(kScript[0]);
+    int next = 0;
+    for (int block = 0; block < kScriptBlocks; ++block) {
+        for (; next < count && kScript[next].block == block; ++next) {
+            const Cue& cue = kScript[next];
+            OSL_SOUND* s = sounds[cue.sound];
+            switch (cue.action) {
+                case kScriptPlay:     play(s, kSfx, cue.priority, false, cue.volume, cue.pan); break;
+                case kScriptLoop:     play(s, kAmbience, cue.priority, true, cue.volume, cue.pan); break;
+                case kScriptStop:     stop(s); break;
+                case kScriptPause:    pause(s, true); break;
+                case kScriptResume:   pause(s, false); break;
+                case kScriptCategory: setCategoryVolume((Category)cue.sound, cue.volume); break;
+            }
+        }
+        const int mergedBefore = eventsMerged;
+        out->audioCallback(kChannel, &rendered[block * kBlockFrames * 2], kBlockFrames);
+        if (block == 12) CHECK(eventsMerged - mergedBefore == 1, "block 12: the double play was not merged");
+        if (block == 19) CHECK(!playing(sounds[0]) && playing(sounds[9]), "block 19: the loop's voice was not stolen");
+    }
+    setCategoryVolume(kSfx, kVolumeMax);
+    stopAll();
+
+    std::vector<unsigned char> wav;
+    wavHeader(wav, kScriptBlocks * kBlockFrames);
+    for (short sample : rendered) put16(wav, sample);
+    CHECK(writeFile(kScriptPath, wav), "can't write %s", kScriptPath);
+
+    const unsigned long long hash = hashSamples(rendered.data(), (int)rendered.size(), 0xcbf29ce484222325ull);
+    int silent = 0;
+    for (short sample : rendered) silent += sample == 0;
+    printf("script: %d blocks to %s, hash %016llx\n", kScriptBlocks, kScriptPath, hash);
+    CHECK(silent < (int)rendered.size() / 4, "the script rendered %d silent samples of %d", silent,
+          (int)rendered.size());
+    CHECK(hash == kScriptHash, "the script's mix differs from the recorded one (%016llx)", kScriptHash);
+}
+
+// ------------------------------
+// The kernel's time
+// ------------------------------
+static void benchMix() {
+    for (int i = 0; i < kVoices; ++i) {
+        play(sounds[i], kAmbience, 1, true, i & 1 ? kVolumeMax : kVolumeMax * 3 / 4, i & 1 ? 0 : kVolumeMax / 3);
+    }
+    drainEvents();
+    static short out[kBlockFrames * 2];
+    static constexpr int kBlocks = 4000;
+    mixBlock(out, kBlockFrames); // warm
+    const unsigned int start = sceKernelGetSystemTimeLow();
+    for (int i = 0; i < kBlocks; ++i) mixBlock(out, kBlockFrames);
+    const unsigned int took = sceKernelGetSystemTimeLow() - start;
+    const double perBlock = (double)took / kBlocks;
+    printf("mixBlock: %d voices x %d frames in %.1f us, %.2f%% of a %u us block (host)\n", kVoices, kBlockFrames,
+           perBlock, 100.0 * perBlock / kBlockMicros, kBlockMicros);
+    CHECK(perBlock < kBlockMicros, "a block takes longer to mix than to play");
+    stopAll();
+}
+
+int main() {
+    init();
+    if (!oslstubChannels[kChannel]) {
+        printf("FAIL mixer::init did not take its channel\n");
+        return 1;
+    }
+    for (int i = 0; i < kSounds; ++i) {
+        sounds[i] = makeSound(i);
+        if (!sounds[i]) {
+            printf("FAIL can't load sound %d\nvoices: FAILED\n", i);
+            return 1;
+        }
+    }
+
+    testStealing();
+    testScript();
+    benchMix();
+
+    printf("voices: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,185 @@
+/* vram - the VRAM allocator and residency manager under the camera-switch sequence
+ *
+ * First allocVRam/freeVRam on their own: best fit, merging on free, and a
+ * request bigger than the biggest hole failing cleanly. Then the office and
+ * camera textures are loaded from romfs through the host image.c and a night
+ * is replayed frame by frame through vramTouch/vramEndFrame, drawing what
+ * office.cpp and camera.cpp draw: the office with its doors and buttons, the
+ * monitor going up, the cameras in the order a player checks them, the static
+ * over each, back down to the office. After every frame the free list must
+ * account for all of VRAM. The camera view's hot set (feed, border and four
+ * static frames at 272KB each) is more than the 1.5MB there is, so a new feed
+ * only gets in once the previous one has gone cold; it must then fit, however
+ * the holes have been cut up. Freeing every image must leave one hole again.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "included/image.h"
+
+#define CAPACITY (0x200000-0x88000)
+#define FULL_SCREEN (512*272*2)	// a 480x272 texture at 16 bits
+#define COLD_FRAMES 30	// VRAM_COLD_FRAMES in image.c
+#define SETTLE_FRAMES (COLD_FRAMES+4)	// then a promotion or two, one per frame
+#define MAX_FRAGMENTATION 66	// percent of the free space not in the biggest hole
+
+static int failures=0;
+
+#define CHECK(cond,...) do { if(!(cond)) { printf("FAIL %s:%d: ",__FILE__,__LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while(0)
+
+static int fragmentation()
+{
+	return availableVRam ? 100-(int)((long long)biggestVRam*100/availableVRam) : 0;
+}
+
+static void testAllocator()
+{
+	resetVRam();
+	CHECK(availableVRam==CAPACITY && biggestVRam==CAPACITY,"fresh VRAM is one hole of %d, got %d in %d",CAPACITY,biggestVRam,availableVRam);
+
+	unsigned char *a=allocVRam(FULL_SCREEN);
+	unsigned char *b=allocVRam(1000);	// rounded up to 1008
+	unsigned char *c=allocVRam(FULL_SCREEN);
+	CHECK(a && b && c,"three allocations fit");
+	CHECK(b==a+FULL_SCREEN && c==b+1008,"allocations are packed and 16-byte aligned");
+
+	freeVRam(b,1000);
+	unsigned char *d=allocVRam(512);
+	CHECK(d==b,"best fit takes the small hole, not the big one");
+	freeVRam(d,512);
+
+	freeVRam(a,FULL_SCREEN);
+	unsigned char *e=allocVRam(FULL_SCREEN+1008);
+	CHECK(e==a,"a and b merge into one hole, which best fit picks over the tail");
+	freeVRam(e,FULL_SCREEN+1008);
+	CHECK(allocVRam(CAPACITY)==0,"a request bigger than the biggest hole fails");
+	freeVRam(c,FULL_SCREEN);
+	CHECK(availableVRam==CAPACITY && biggestVRam==CAPACITY,"everything merges back, got %d in %d",biggestVRam,availableVRam);
+}
+
+static const char *const camNames[11]={"cam1a","cam1b","cam1c","cam2a","cam2b","cam3","cam4a","cam4b","cam5","cam6","cam7"};
+// The order a player flips through them: the stage, the halls, the doors
+static const int camOrder[]={0,1,2,3,4,6,7,0,5,8,9,10,1,3,6,0,2,4,7};
+
+static Image *office1,*office2,*doorLeft,*doorRight,*buttonLeft,*buttonRight;
+static Image *cams[11],*statics[4],*border,*map,*recording;
+
+static Image *load(const char *path)
+{
+	Image *image=loadPng(path);
+	if(!image) {
+		printf("FAIL can't load %s\n",path);
+		exit(1);
+	}
+	return image;
+}
+
+static int residentBytes()
+{
+	Image *all[]={office1,office2,doorLeft,doorRight,buttonLeft,buttonRight,border,map,recording,
+		cams[0],cams[1],cams[2],cams[3],cams[4],cams[5],cams[6],cams[7],cams[8],cams[9],cams[10],
+		statics[0],statics[1],statics[2],statics[3]};
+	int bytes=0;
+	unsigned i;
+	for(i=0;i<sizeof(all)/sizeof(all[0]);i++) {
+		if(all[i]->vramData) bytes+=(imageDataBytes(all[i])+15)&~15;
+	}
+	return bytes;
+}
+
+static int frame=0;
+
+static void endFrame()
+{
+	vramEndFrame();
+	frame++;
+	CHECK(availableVRam+residentBytes()==CAPACITY,"frame %d: %d free + %d resident is not all of VRAM",
+		frame,availableVRam,residentBytes());
+}
+
+static void drawOffice(int frames)
+{
+	int i;
+	for(i=0;i<frames;i++) {
+		vramTouch(office1);
+		vramTouch(office2);
+		vramTouch(buttonLeft);
+		vramTouch(buttonRight);
+		vramTouch(doorLeft);
+		vramTouch(doorRight);
+		endFrame();
+	}
+}
+
+static void drawCamera(Image *feed,int frames)
+{
+	int i;
+	for(i=0;i<frames;i++) {
+		vramTouch(feed);
+		vramTouch(statics[(frame/4)&3]);	// animateStatic: a new frame every 4
+		vramTouch(border);
+		vramTouch(map);
+		vramTouch(recording);
+		endFrame();
+	}
+}
+
+static void testCameraSequence()
+{
+	int i,round,worst=0,smallest=CAPACITY;
+	char path[256];
+
+	office1=load("romfs/gfx/office/chuncks/nothing/office_1.png");
+	office2=load("romfs/gfx/office/chuncks/nothing/office_2.png");
+	doorLeft=load("romfs/gfx/office/doors/left/door_1.png");
+	doorRight=load("romfs/gfx/office/doors/right/door_1.png");
+	buttonLeft=load("romfs/gfx/office/buttons/left/left_0.png");
+	buttonRight=load("romfs/gfx/office/buttons/right/right_0.png");
+	for(i=0;i<11;i++) {
+		snprintf(path,sizeof(path),"romfs/gfx/office/camera/main/%s.png",camNames[i]);
+		cams[i]=load(path);
+	}
+	for(i=0;i<4;i++) {
+		snprintf(path,sizeof(path),"romfs/gfx/menu/static/image%d_480x272.png",i+1);
+		statics[i]=load(path);
+	}
+	border=load("romfs/gfx/office/ui/camera_border.png");
+	map=load("romfs/gfx/office/ui/camera-map.png");
+	recording=load("romfs/gfx/office/ui/recording.png");
+
+	resetVRam();
+	for(round=0;round<3;round++) {
+		drawOffice(120);
+		CHECK(office1->vramData && office2->vramData,"round %d: the office is resident after two seconds on it",round);
+		for(i=0;i<(int)(sizeof(camOrder)/sizeof(camOrder[0]));i++) {
+			Image *feed=cams[camOrder[i]];
+			drawCamera(feed,SETTLE_FRAMES);
+			CHECK(feed->vramData!=0,"round %d: %s not resident %d frames after switching to it (%d free, biggest %d)",
+				round,camNames[camOrder[i]],SETTLE_FRAMES,availableVRam,biggestVRam);
+			drawCamera(feed,60-SETTLE_FRAMES);	// a second per camera
+			if(fragmentation()>worst) worst=fragmentation();
+			if(biggestVRam<smallest) smallest=biggestVRam;
+		}
+	}
+	drawOffice(120);
+	CHECK(office1->vramData && office2->vramData,"the office is resident again after the cameras");
+
+	printf("camera sequence: %d frames, hit rate %d%%, worst fragmentation %d%%, smallest biggest hole %d KB\n",
+		frame,vramHits*100/(vramHits+vramMisses),worst,smallest/1024);
+	CHECK(worst<=MAX_FRAGMENTATION,"fragmentation reached %d%%",worst);
+	CHECK(vramHits*100/(vramHits+vramMisses)>=75,"hit rate below 75%%");
+
+	Image *all[]={office1,office2,doorLeft,doorRight,buttonLeft,buttonRight,border,map,recording,
+		statics[0],statics[1],statics[2],statics[3]};
+	for(i=0;i<(int)(sizeof(all)/sizeof(all[0]));i++) freeImage(all[i]);
+	for(i=0;i<11;i++) freeImage(cams[i]);
+	CHECK(availableVRam==CAPACITY && biggestVRam==CAPACITY,"freeing every image leaves one hole of %d, got %d in %d",
+		CAPACITY,biggestVRam,availableVRam);
+}
+
+int main()
+{
+	testAllocator();
+	testCameraSequence();
+	printf("vram: %s\n",failures ? "FAILED" : "ok");
+	return failures!=0;
+}
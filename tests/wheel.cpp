@@ -0,0 +1,291 @@
+// wheel - the timer wheel against the per-frame countdowns it replaced
+//
+// First the office as the game drives it: Freddy, Bonnie, Chica and Foxy on
+// the AI clock (which stops during Foxy's attack, and skips Foxy on night 1),
+// and the stuck-state watchdog on the office clock (which holds off while a
+// jumpscare plays). The old code counted each delay down once per frame; the
+// same frames are replayed through the old countdowns and through the wheel,
+// and the fire sequences and every per-frame countdown value must match.
+//
+// Then a fuzz of the wheel's own contract: random timers with delays longer
+// than the wheel (extra laps), scheduled, cancelled, suspended and resumed at
+// random, against a plain countdown per timer, with skip() jumping to the
+// next tick that fires.
+#include "included/scheduler.hpp"
+
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static unsigned int seed = 2024;
+
+static int roll(int n) {
+    seed = seed * 1103515245u + 12345u;
+    return (int)((seed >> 16) % (unsigned int)n);
+}
+
+struct Fire {
+    int frame, who;
+    bool operator!=(const Fire& o) const { return frame != o.frame || who != o.who; }
+};
+
+// ------------------------------
+// The office
+// ------------------------------
+static constexpr int kCharacters = 4;
+static constexpr int kPeriods[kCharacters] = {650, 389, 432, 460}; // Freddy, Bonnie, Chica, Foxy
+static constexpr int kForceResetDelay = 450;
+static constexpr int kWatchdog = kCharacters;
+
+// The old code, as it was: int delays counted down in runAiLoop and forceAnimatronicAiReset
+struct Countdowns {
+    int delay[kCharacters];
+    int waitBeforeForceReset;
+    std::vector<Fire> fires;
+
+    Countdowns() : waitBeforeForceReset(kForceResetDelay) {
+        for (int i = 0; i < kCharacters; ++i) delay[i] = kPeriods[i];
+    }
+
+    void wait(int who, int frame) {
+        if (delay[who] > 0) {
+            --delay[who];
+        } else {
+            fires.push_back({frame, who});
+            delay[who] = kPeriods[who];
+        }
+    }
+
+    void frame(int frame, int night, bool paused, bool jumpscaring) {
+        if (!paused) {
+            wait(0, frame);
+            wait(1, frame);
+            wait(2, frame);
+            if (night > 1) wait(3, frame);
+        }
+        if (waitBeforeForceReset <= 0 && !jumpscaring) {
+            fires.push_back({frame, kWatchdog});
+            waitBeforeForceReset = kForceResetDelay;
+        } else {
+            waitBeforeForceReset -= 1;
+        }
+    }
+
+    void reset() { waitBeforeForceReset = kForceResetDelay; }
+};
+
+// The new code: the same timers on scheduler::Wheel, as animatronic.cpp arms them
+struct Wheels {
+    scheduler::Wheel ai, housekeeping;
+    scheduler::Timer opportunity[kCharacters];
+    scheduler::Timer forceReset;
+    std::vector<Fire> fires;
+    int frameNow = 0;
+    bool jumpscaring = false;
+
+    static Wheels* current;
+
+    static void onOpportunity(scheduler::Timer* timer) {
+        current->fires.push_back({current->frameNow, timer->order});
+    }
+
+    static void onForceReset(scheduler::Timer* timer) {
+        if (current->jumpscaring) {
+            current->housekeeping.schedule(*timer, 0);
+            return;
+        }
+        current->fires.push_back({current->frameNow, kWatchdog});
+    }
+
+    Wheels() {
+        current = this;
+        for (int i = 0; i < kCharacters; ++i) {
+            opportunity[i] = scheduler::Timer();
+            opportunity[i].fire = onOpportunity;
+            opportunity[i].period = kPeriods[i];
+            opportunity[i].order = i;
+            ai.schedule(opportunity[i], kPeriods[i]);
+        }
+        forceReset = scheduler::Timer();
+        forceReset.fire = onForceReset;
+        forceReset.period = kForceResetDelay;
+        housekeeping.schedule(forceReset, kForceResetDelay);
+    }
+
+    void frame(int frame, int night, bool paused, bool scaring) {
+        frameNow = frame;
+        jumpscaring = scaring;
+        if (night > 1) ai.resume(opportunity[3]);
+        else ai.suspend(opportunity[3]);
+        if (!paused) ai.advance();
+        housekeeping.advance();
+    }
+
+    void reset() { housekeeping.schedule(forceReset, kForceResetDelay); }
+};
+
+Wheels* Wheels::current = nullptr;
+
+static void testOffice() {
+    Countdowns old;
+    Wheels wheel;
+    int frame = 0, mismatches = 0;
+
+    // Nights in the order a player might take them, with deaths and retries
+    static const int nights[] = {1, 1, 2, 2, 2, 3, 1, 4, 5, 5, 6, 7, 2};
+    for (int night : nights) {
+        old.reset();
+        wheel.reset();
+        const int length = 2000 + roll(20000);
+        int pausedFor = 0, scaringFor = 0;
+        for (int f = 0; f < length; ++f, ++frame) {
+            if (pausedFor == 0 && night > 1 && roll(900) == 0) pausedFor = 30 + roll(200); // Foxy's attack
+            if (scaringFor == 0 && roll(1500) == 0) scaringFor = 20 + roll(90);
+            const bool paused = pausedFor > 0, scaring = scaringFor > 0;
+            if (pausedFor) pausedFor--;
+            if (scaringFor) scaringFor--;
+
+            old.frame(frame, night, paused, scaring);
+            wheel.frame(frame, night, paused, scaring);
+
+            for (int i = 0; i < kCharacters; ++i) {
+                if (wheel.ai.remaining(wheel.opportunity[i]) != old.delay[i] && mismatches++ < 5) {
+                    CHECK(false, "frame %d night %d: timer %d has %d left, countdown at %d", frame, night, i,
+                          wheel.ai.remaining(wheel.opportunity[i]), old.delay[i]);
+                }
+            }
+        }
+    }
+
+    CHECK(mismatches == 0, "%d countdown values differ", mismatches);
+    CHECK(old.fires.size() == wheel.fires.size(), "%d fires on the countdowns, %d on the wheel",
+          (int)old.fires.size(), (int)wheel.fires.size());
+    const size_t n = old.fires.size() < wheel.fires.size() ? old.fires.size() : wheel.fires.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (old.fires[i] != wheel.fires[i]) {
+            CHECK(false, "fire %d: countdowns have %d on frame %d, the wheel %d on frame %d", (int)i,
+                  old.fires[i].who, old.fires[i].frame, wheel.fires[i].who, wheel.fires[i].frame);
+            break;
+        }
+    }
+    printf("office: %d frames, %d fires\n", frame, (int)old.fires.size());
+}
+
+// ------------------------------
+// The contract
+// ------------------------------
+static constexpr int kTimers = 24;
+
+struct Model {
+    bool active, suspended;
+    int delay, period;
+};
+
+static std::vector<Fire> fuzzFires;
+static int fuzzTick = 0;
+
+static void onFuzz(scheduler::Timer* timer) {
+    fuzzFires.push_back({fuzzTick, timer->order});
+}
+
+static void testContract() {
+    scheduler::Wheel wheel;
+    scheduler::Timer timers[kTimers];
+    Model model[kTimers];
+    std::vector<Fire> modelFires;
+    for (int i = 0; i < kTimers; ++i) {
+        timers[i] = scheduler::Timer();
+        timers[i].fire = onFuzz;
+        timers[i].order = i;
+        model[i] = Model();
+    }
+
+    int mismatches = 0, skipped = 0;
+    for (int step = 0; step < 200000; ++step) {
+        // A few operations between ticks
+        for (int ops = roll(3); ops > 0; --ops) {
+            const int i = roll(kTimers);
+            switch (roll(4)) {
+                case 0: {
+                    const int delay = roll(4) == 0 ? roll(5000) : roll(64);
+                    timers[i].period = roll(3) == 0 ? 0 : 1 + roll(3000);
+                    wheel.schedule(timers[i], delay);
+                    model[i] = {true, false, delay, timers[i].period};
+                    break;
+                }
+                case 1:
+                    wheel.cancel(timers[i]);
+                    model[i].active = model[i].suspended = false;
+                    break;
+                case 2:
+                    wheel.suspend(timers[i]);
+                    if (model[i].active) model[i].suspended = true;
+                    break;
+                case 3:
+                    wheel.resume(timers[i]);
+                    model[i].suspended = false;
+                    break;
+            }
+        }
+
+        // Now and then jump to the tick before the next one that fires
+        if (roll(50) == 0) {
+            int next = 1 << 30;
+            for (int i = 0; i < kTimers; ++i) {
+                if (model[i].active && !model[i].suspended && model[i].delay < next) next = model[i].delay;
+            }
+            if (next < (1 << 30) && next > 0) {
+                wheel.skip(next);
+                fuzzTick += next;
+                skipped += next;
+                for (int i = 0; i < kTimers; ++i) {
+                    if (model[i].active && !model[i].suspended) model[i].delay -= next;
+                }
+            }
+        }
+
+        ++fuzzTick;
+        wheel.advance();
+        for (int i = 0; i < kTimers; ++i) {
+            Model& m = model[i];
+            if (!m.active || m.suspended) continue;
+            if (m.delay > 0) {
+                --m.delay;
+            } else {
+                modelFires.push_back({fuzzTick, i});
+                if (m.period > 0) m.delay = m.period;
+                else m.active = false;
+            }
+        }
+
+        for (int i = 0; i < kTimers; ++i) {
+            const int want = model[i].active ? model[i].delay : -1;
+            if (wheel.remaining(timers[i]) != want && mismatches++ < 5) {
+                CHECK(false, "tick %d: timer %d has %d left, expected %d", fuzzTick, i, wheel.remaining(timers[i]), want);
+            }
+        }
+    }
+
+    CHECK(mismatches == 0, "%d remaining() values differ", mismatches);
+    CHECK(modelFires.size() == fuzzFires.size(), "%d fires expected, the wheel fired %d",
+          (int)modelFires.size(), (int)fuzzFires.size());
+    const size_t n = modelFires.size() < fuzzFires.size() ? modelFires.size() : fuzzFires.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (modelFires[i] != fuzzFires[i]) {
+            CHECK(false, "fire %d: expected %d on tick %d, the wheel fired %d on tick %d", (int)i,
+                  modelFires[i].who, modelFires[i].frame, fuzzFires[i].who, fuzzFires[i].frame);
+            break;
+        }
+    }
+    printf("contract: %d ticks (%d skipped), %d fires\n", fuzzTick, skipped, (int)fuzzFires.size());
+}
+
+int main() {
+    testOffice();
+    testContract();
+    printf("wheel: %s\n", failures ? "FAILED" : "ok");
+    return failures != 0;
+}
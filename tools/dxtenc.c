@@ -0,0 +1,380 @@
+/* dxtenc - host-side DXT encoder for full-screen photographic textures
+ *
+ * Writes a .dxt file next to every input .png, in the block layout the PSP GE
+ * samples directly (GU_PSM_DXT1 for opaque images, GU_PSM_DXT5 otherwise).
+ * loadPng picks the .dxt up automatically and falls back to the PNG when it
+ * is missing, so assets can be converted one at a time.
+ *
+ * Every encoded file is decoded again and compared with the source PNG; files
+ * below the PSNR gate are reported and not written.
+ *
+ *   cc -O2 -o dxtenc tools/dxtenc.c -lpng -lpthread -lm
+ *   ./dxtenc [-j threads] [-min-psnr dB] romfs/gfx/jumpscare/freddy/[0-8].png
+ */
+#include <math.h>
+#include <png.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GU_PSM_DXT1 (8)
+#define GU_PSM_DXT5 (10)
+
+typedef struct {
+	unsigned int width, height;	/* image size */
+	unsigned int texWidth;		/* power of two, what the GE is told */
+	unsigned char *rgba;		/* texWidth * height * 4, padding replicated */
+	int hasAlpha;
+} Source;
+
+static double minPsnr = 30.0;
+static char **files;
+static int fileCount;
+static int nextFile = 0;
+static int failures = 0;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int nextPower2(unsigned int v)
+{
+	unsigned int p = 1;
+	while (p < v) p <<= 1;
+	return p;
+}
+
+static int readPng(const char *path, Source *src)
+{
+	png_image img;
+	memset(&img, 0, sizeof(img));
+	img.version = PNG_IMAGE_VERSION;
+	if (!png_image_begin_read_from_file(&img, path)) return 0;
+	img.format = PNG_FORMAT_RGBA;
+
+	src->width = img.width;
+	src->height = img.height;
+	src->texWidth = nextPower2(img.width);
+	src->rgba = malloc(src->texWidth * img.height * 4);
+	if (!src->rgba || !png_image_finish_read(&img, NULL, src->rgba, src->texWidth * 4, NULL)) {
+		free(src->rgba);
+		png_image_free(&img);
+		return 0;
+	}
+
+	/* Replicate the last column into the padding so edge blocks stay clean */
+	unsigned int x, y;
+	src->hasAlpha = 0;
+	for (y = 0; y < src->height; y++) {
+		unsigned char *row = src->rgba + y * src->texWidth * 4;
+		for (x = 0; x < src->width; x++) {
+			if (row[x * 4 + 3] != 255) src->hasAlpha = 1;
+		}
+		for (x = src->width; x < src->texWidth; x++) {
+			memcpy(row + x * 4, row + (src->width - 1) * 4, 4);
+		}
+	}
+	return 1;
+}
+
+static unsigned short pack565(const int *c)
+{
+	return (unsigned short)(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+}
+
+static void unpack565(unsigned short v, int *c)
+{
+	c[0] = ((v >> 11) & 31) * 255 / 31;
+	c[1] = ((v >> 5) & 63) * 255 / 63;
+	c[2] = (v & 31) * 255 / 31;
+}
+
+/* Fetch a 4x4 block, clamping at the bottom edge */
+static void fetchBlock(const Source *src, unsigned int bx, unsigned int by, unsigned char block[16][4])
+{
+	int i;
+	for (i = 0; i < 16; i++) {
+		unsigned int x = bx * 4 + (i & 3);
+		unsigned int y = by * 4 + (i >> 2);
+		if (y >= src->height) y = src->height - 1;
+		memcpy(block[i], src->rgba + (y * src->texWidth + x) * 4, 4);
+	}
+}
+
+static int colorDistance(const int *a, const unsigned char *b)
+{
+	int dr = a[0] - b[0], dg = a[1] - b[1], db = a[2] - b[2];
+	return dr * dr * 3 + dg * dg * 4 + db * db * 2;
+}
+
+/* Four-colour DXT1 block: endpoints from the bounding box along the main
+ * diagonal, then a couple of least-squares refinements. Output is in PSP
+ * order: the 32-bit index word first, then the two colours. */
+static void encodeColorBlock(unsigned char block[16][4], unsigned char *out)
+{
+	int lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+	int i, c, iter;
+	for (i = 0; i < 16; i++) {
+		for (c = 0; c < 3; c++) {
+			if (block[i][c] < lo[c]) lo[c] = block[i][c];
+			if (block[i][c] > hi[c]) hi[c] = block[i][c];
+		}
+	}
+
+	unsigned short c0 = 0, c1 = 0;
+	unsigned int indices = 0;
+	for (iter = 0; iter < 3; iter++) {
+		c0 = pack565(hi);
+		c1 = pack565(lo);
+		if (c0 < c1) { unsigned short t = c0; c0 = c1; c1 = t; }
+		if (c0 == c1) {
+			/* Flat block: any c0 > c1 pair keeps us in four-colour mode */
+			if (c0 > 0) c1 = c0 - 1;
+			else c0 = 1;
+		}
+
+		int palette[4][3];
+		unpack565(c0, palette[0]);
+		unpack565(c1, palette[1]);
+		for (c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		indices = 0;
+		int sel[16];
+		for (i = 0; i < 16; i++) {
+			int best = 0, bestDist = colorDistance(palette[0], block[i]), k;
+			for (k = 1; k < 4; k++) {
+				int d = colorDistance(palette[k], block[i]);
+				if (d < bestDist) { best = k; bestDist = d; }
+			}
+			sel[i] = best;
+			indices |= (unsigned int)best << (i * 2);
+		}
+
+		/* Least-squares endpoints for the chosen weights */
+		static const float weight[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+		float aa = 0, bb = 0, ab = 0, ax[3] = {0, 0, 0}, bx[3] = {0, 0, 0};
+		for (i = 0; i < 16; i++) {
+			float a = weight[sel[i]], b = 1.0f - a;
+			aa += a * a; bb += b * b; ab += a * b;
+			for (c = 0; c < 3; c++) {
+				ax[c] += a * block[i][c];
+				bx[c] += b * block[i][c];
+			}
+		}
+		float det = aa * bb - ab * ab;
+		if (fabsf(det) < 1e-6f) break;
+		for (c = 0; c < 3; c++) {
+			float e0 = (ax[c] * bb - bx[c] * ab) / det;
+			float e1 = (bx[c] * aa - ax[c] * ab) / det;
+			hi[c] = e0 < 0 ? 0 : (e0 > 255 ? 255 : (int)(e0 + 0.5f));
+			lo[c] = e1 < 0 ? 0 : (e1 > 255 ? 255 : (int)(e1 + 0.5f));
+		}
+	}
+
+	out[0] = indices;
+	out[1] = indices >> 8;
+	out[2] = indices >> 16;
+	out[3] = indices >> 24;
+	out[4] = c0;
+	out[5] = c0 >> 8;
+	out[6] = c1;
+	out[7] = c1 >> 8;
+}
+
+/* DXT5 alpha: 8-value ramp between the block min and max. PSP order is the
+ * 48 bits of 3-bit indices first, then alpha0 and alpha1. */
+static void encodeAlphaBlock(unsigned char block[16][4], unsigned char *out)
+{
+	int a0 = 0, a1 = 255, i, k;
+	for (i = 0; i < 16; i++) {
+		if (block[i][3] > a0) a0 = block[i][3];
+		if (block[i][3] < a1) a1 = block[i][3];
+	}
+	if (a0 == a1) {
+		if (a0 < 255) a0++;
+		else a1--;
+	}
+
+	int ramp[8];
+	ramp[0] = a0;
+	ramp[1] = a1;
+	for (k = 1; k < 7; k++) ramp[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+
+	unsigned long long bits = 0;
+	for (i = 0; i < 16; i++) {
+		int best = 0, bestDist = 256;
+		for (k = 0; k < 8; k++) {
+			int d = abs(ramp[k] - block[i][3]);
+			if (d < bestDist) { best = k; bestDist = d; }
+		}
+		bits |= (unsigned long long)best << (i * 3);
+	}
+	for (i = 0; i < 6; i++) out[i] = bits >> (i * 8);
+	out[6] = a0;
+	out[7] = a1;
+}
+
+static void decodeBlock(const unsigned char *in, int format, unsigned char block[16][4])
+{
+	const unsigned char *color = in;
+	const unsigned char *alpha = format == GU_PSM_DXT5 ? in + 8 : NULL;
+	unsigned int indices = color[0] | color[1] << 8 | color[2] << 16 | (unsigned int)color[3] << 24;
+	unsigned short c0 = color[4] | color[5] << 8, c1 = color[6] | color[7] << 8;
+	int palette[4][3], i, c;
+	unpack565(c0, palette[0]);
+	unpack565(c1, palette[1]);
+	for (c = 0; c < 3; c++) {
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	int ramp[8];
+	unsigned long long bits = 0;
+	if (alpha) {
+		int k;
+		ramp[0] = alpha[6];
+		ramp[1] = alpha[7];
+		for (k = 1; k < 7; k++) ramp[k + 1] = ((7 - k) * ramp[0] + k * ramp[1]) / 7;
+		for (i = 0; i < 6; i++) bits |= (unsigned long long)alpha[i] << (i * 8);
+	}
+
+	for (i = 0; i < 16; i++) {
+		int *p = palette[(indices >> (i * 2)) & 3];
+		block[i][0] = p[0];
+		block[i][1] = p[1];
+		block[i][2] = p[2];
+		block[i][3] = alpha ? ramp[(bits >> (i * 3)) & 7] : 255;
+	}
+}
+
+static void writeLe16(FILE *fp, unsigned int v)
+{
+	fputc(v & 0xff, fp);
+	fputc((v >> 8) & 0xff, fp);
+}
+
+static void writeLe32(FILE *fp, unsigned int v)
+{
+	writeLe16(fp, v & 0xffff);
+	writeLe16(fp, v >> 16);
+}
+
+static int encodeFile(const char *path)
+{
+	Source src;
+	if (!readPng(path, &src)) {
+		fprintf(stderr, "%s: can't read\n", path);
+		return 0;
+	}
+
+	int format = src.hasAlpha ? GU_PSM_DXT5 : GU_PSM_DXT1;
+	int blockBytes = format == GU_PSM_DXT5 ? 16 : 8;
+	unsigned int blocksX = src.texWidth / 4, blocksY = (src.height + 3) / 4;
+	size_t dataBytes = (size_t)blocksX * blocksY * blockBytes;
+	unsigned char *data = malloc(dataBytes);
+	if (!data) {
+		free(src.rgba);
+		return 0;
+	}
+
+	/* Encode, decode again and measure the error over the visible image */
+	double squared = 0;
+	unsigned int bx, by;
+	for (by = 0; by < blocksY; by++) {
+		for (bx = 0; bx < blocksX; bx++) {
+			unsigned char block[16][4], decoded[16][4];
+			unsigned char *out = data + (by * blocksX + bx) * blockBytes;
+			fetchBlock(&src, bx, by, block);
+			encodeColorBlock(block, out);
+			if (format == GU_PSM_DXT5) encodeAlphaBlock(block, out + 8);
+			decodeBlock(out, format, decoded);
+
+			int i, c;
+			for (i = 0; i < 16; i++) {
+				if (bx * 4 + (i & 3) >= src.width || by * 4 + (i >> 2) >= src.height) continue;
+				for (c = 0; c < 4; c++) {
+					int d = block[i][c] - decoded[i][c];
+					squared += d * d;
+				}
+			}
+		}
+	}
+	double mse = squared / ((double)src.width * src.height * (src.hasAlpha ? 4 : 3));
+	double psnr = mse > 0 ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0;
+
+	char outPath[1024];
+	snprintf(outPath, sizeof(outPath), "%s", path);
+	char *ext = strrchr(outPath, '.');
+	if (ext) strcpy(ext, ".dxt");
+
+	int ok = psnr >= minPsnr;
+	if (ok) {
+		FILE *fp = fopen(outPath, "wb");
+		if (fp) {
+			fwrite("PDXT", 1, 4, fp);
+			writeLe16(fp, src.width);
+			writeLe16(fp, src.height);
+			writeLe16(fp, src.texWidth);
+			writeLe16(fp, nextPower2(src.height));
+			writeLe32(fp, format);
+			writeLe32(fp, dataBytes);
+			fwrite(data, 1, dataBytes, fp);
+			fclose(fp);
+		} else {
+			ok = 0;
+		}
+	}
+
+	pthread_mutex_lock(&lock);
+	printf("%-60s DXT%d %6.2f dB %s\n", path, format == GU_PSM_DXT5 ? 5 : 1, psnr,
+	       ok ? "" : "(kept as PNG)");
+	pthread_mutex_unlock(&lock);
+
+	free(data);
+	free(src.rgba);
+	return ok;
+}
+
+static void *worker(void *arg)
+{
+	(void)arg;
+	for (;;) {
+		pthread_mutex_lock(&lock);
+		int i = nextFile++;
+		pthread_mutex_unlock(&lock);
+		if (i >= fileCount) break;
+		if (!encodeFile(files[i])) {
+			pthread_mutex_lock(&lock);
+			failures++;
+			pthread_mutex_unlock(&lock);
+		}
+	}
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	int threads = 4, i;
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-min-psnr") == 0 && i + 1 < argc) minPsnr = atof(argv[++i]);
+		else break;
+	}
+	files = argv + i;
+	fileCount = argc - i;
+	if (fileCount <= 0) {
+		fprintf(stderr, "usage: %s [-j threads] [-min-psnr dB] file.png...\n", argv[0]);
+		return 1;
+	}
+	if (threads < 1) threads = 1;
+	if (threads > fileCount) threads = fileCount;
+
+	pthread_t *pool = malloc(sizeof(pthread_t) * threads);
+	for (i = 0; i < threads; i++) pthread_create(&pool[i], NULL, worker, NULL);
+	for (i = 0; i < threads; i++) pthread_join(pool[i], NULL);
+	free(pool);
+
+	printf("%d of %d files encoded\n", fileCount - failures, fileCount);
+	return failures ? 2 : 0;
+}
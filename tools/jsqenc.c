@@ -0,0 +1,383 @@
+/* jsqenc - encodes a jumpscare's frames as a keyframe plus changed tiles
+ *
+ * Reads <dir>/0.png, 1.png, ... and writes <dir>.jsq, which n_jumpscare plays
+ * through two frame buffers instead of holding every frame (see
+ * loadSequence in source/image.c). Pixels are converted to 16 bits exactly
+ * as loadPng would (same format choice, same ordered dither), so the
+ * sequence looks like the PNG path. Frame 0 stores every tile; later frames
+ * only the 16x16 tiles that differ from the frame before, each run-length
+ * coded.
+ *
+ * The file is decoded again, both straight through and the way the game
+ * plays it (two buffers taking turns), and must match the converted frames
+ * pixel for pixel or it is not written.
+ *
+ *   cc -O2 -o jsqenc tools/jsqenc.c -lpng
+ *   ./jsqenc [-format 5650|5551|4444] [-no-dither] romfs/gfx/jumpscare/freddy
+ *
+ * Layout (little-endian): "JSQ1", width, height, texture width, format, frame
+ * count and tile size as u16; frame count + 1 u32 file offsets; per frame a
+ * bitmap of changed tiles (row-major, bit t&7 of byte t>>3) and the changed
+ * tiles in order. A tile is its pixels in row order as runs: a control byte
+ * below 128 is followed by control+1 literal pixels, otherwise by one pixel
+ * repeated control-126 times. Must match source/image.c.
+ */
+#include <png.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GU_PSM_5650 (0)
+#define GU_PSM_5551 (1)
+#define GU_PSM_4444 (2)
+
+#define MAX_FRAMES 32
+#define TILE 16
+
+static int width, height, texWidth, frameCount;
+static unsigned short *frames[MAX_FRAMES]; /* texWidth * height each, padding 0 */
+static int dither = 1;
+
+static const unsigned char bayer4[4][4] = {
+	{ 0, 8, 2, 10},
+	{12, 4, 14, 6},
+	{ 3, 11, 1, 9},
+	{15, 7, 13, 5}
+};
+
+static unsigned int quantise(unsigned int v, int bits, int d)
+{
+	v += (d << (8 - bits)) >> 4;
+	if (v > 255) v = 255;
+	return v >> (8 - bits);
+}
+
+static unsigned char *readPng(const char *path, int *w, int *h)
+{
+	png_image img;
+	unsigned char *rgba;
+	memset(&img, 0, sizeof(img));
+	img.version = PNG_IMAGE_VERSION;
+	if (!png_image_begin_read_from_file(&img, path)) return NULL;
+	img.format = PNG_FORMAT_RGBA;
+	*w = img.width;
+	*h = img.height;
+	rgba = malloc(img.width * img.height * 4);
+	if (!rgba || !png_image_finish_read(&img, NULL, rgba, img.width * 4, NULL)) {
+		free(rgba);
+		png_image_free(&img);
+		return NULL;
+	}
+	return rgba;
+}
+
+/* Same histogram as chooseImageFormat, over the whole sequence */
+static int chooseFormat(unsigned char **rgba)
+{
+	int clear = 0, partial = 0, f, i;
+	for (f = 0; f < frameCount; f++) {
+		for (i = 0; i < width * height; i++) {
+			int a = rgba[f][i * 4 + 3];
+			if (a < 8) clear++;
+			else if (a < 248) partial++;
+		}
+	}
+	if (partial == 0 && clear == 0) return GU_PSM_5650;
+	if (partial == 0) return GU_PSM_5551;
+	return GU_PSM_4444;
+}
+
+/* convertImage16 for the visible pixels */
+static unsigned short *convert(const unsigned char *rgba, int format)
+{
+	unsigned short *out = calloc(texWidth * height, 2);
+	int rb = format == GU_PSM_4444 ? 4 : 5;
+	int gb = format == GU_PSM_5650 ? 6 : (format == GU_PSM_5551 ? 5 : 4);
+	int x, y;
+	for (y = 0; y < height; y++) {
+		for (x = 0; x < width; x++) {
+			const unsigned char *c = rgba + (y * width + x) * 4;
+			int d = dither ? bayer4[y & 3][x & 3] : 0;
+			unsigned int r = quantise(c[0], rb, d);
+			unsigned int g = quantise(c[1], gb, d);
+			unsigned int b = quantise(c[2], rb, d);
+			unsigned int a = c[3];
+			unsigned short *dst = out + y * texWidth + x;
+			if (format == GU_PSM_5650) *dst = r | (g << 5) | (b << 11);
+			else if (format == GU_PSM_5551) *dst = r | (g << 5) | (b << 10) | ((a >= 128) << 15);
+			else *dst = r | (g << 4) | (b << 8) | ((a >> 4) << 12);
+		}
+	}
+	return out;
+}
+
+/* Growable output */
+static unsigned char *out;
+static int outBytes, outCapacity;
+
+static void put(const void *data, int bytes)
+{
+	if (outBytes + bytes > outCapacity) {
+		outCapacity = (outBytes + bytes) * 2;
+		out = realloc(out, outCapacity);
+		if (!out) {
+			fprintf(stderr, "out of memory\n");
+			exit(2);
+		}
+	}
+	memcpy(out + outBytes, data, bytes);
+	outBytes += bytes;
+}
+
+static void put8(int v)
+{
+	unsigned char b = v;
+	put(&b, 1);
+}
+
+static void put16(unsigned int v)
+{
+	put8(v & 0xff);
+	put8(v >> 8);
+}
+
+static void set32(int at, unsigned int v)
+{
+	out[at] = v;
+	out[at + 1] = v >> 8;
+	out[at + 2] = v >> 16;
+	out[at + 3] = v >> 24;
+}
+
+static unsigned int get16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static unsigned int get32(const unsigned char *p)
+{
+	return get16(p) | (get16(p + 2) << 16);
+}
+
+static void encodeTile(const unsigned short *frame, int x0, int y0, int w, int h)
+{
+	unsigned short pixels[TILE * TILE];
+	int n = 0, i, x, y;
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < w; x++) pixels[n++] = frame[(y0 + y) * texWidth + x0 + x];
+	}
+	i = 0;
+	while (i < n) {
+		int run = 1;
+		while (i + run < n && run < 129 && pixels[i + run] == pixels[i]) run++;
+		if (run >= 2) {
+			put8(run + 126);
+			put16(pixels[i]);
+			i += run;
+			continue;
+		}
+		/* Literals up to the next run of two or more */
+		int start = i, count = 0;
+		while (i < n && count < 128 && !(i + 1 < n && pixels[i + 1] == pixels[i])) {
+			i++;
+			count++;
+		}
+		if (count == 0) continue;
+		put8(count - 1);
+		for (x = 0; x < count; x++) put16(pixels[start + x]);
+	}
+}
+
+static int tileChanged(const unsigned short *a, const unsigned short *b, int x0, int y0, int w, int h)
+{
+	int y;
+	for (y = 0; y < h; y++) {
+		if (memcmp(a + (y0 + y) * texWidth + x0, b + (y0 + y) * texWidth + x0, w * 2)) return 1;
+	}
+	return 0;
+}
+
+/* The decoder from source/image.c (applySequenceFrame) */
+static int apply(const unsigned char *file, int frame, unsigned short *dst)
+{
+	const unsigned char *at = file + get32(file + 16 + frame * 4);
+	const unsigned char *end = file + get32(file + 16 + (frame + 1) * 4);
+	int tilesX = (width + TILE - 1) / TILE, tilesY = (height + TILE - 1) / TILE;
+	const unsigned char *bitmap = at;
+	int t;
+	at += (tilesX * tilesY + 7) / 8;
+	if (at > end) return 0;
+	for (t = 0; t < tilesX * tilesY; t++) {
+		if (!(bitmap[t >> 3] & (1 << (t & 7)))) continue;
+		int x0 = (t % tilesX) * TILE, y0 = (t / tilesX) * TILE;
+		int w = width - x0 < TILE ? width - x0 : TILE, h = height - y0 < TILE ? height - y0 : TILE;
+		int left = w * h, x = 0;
+		unsigned short *row = dst + y0 * texWidth + x0;
+		while (left > 0) {
+			if (at >= end) return 0;
+			int control = *at++;
+			int count = control < 128 ? control + 1 : control - 126;
+			int literal = control < 128;
+			if (count > left || at + (literal ? count * 2 : 2) > end) return 0;
+			unsigned short value = get16(at);
+			left -= count;
+			while (count--) {
+				if (literal) {
+					value = get16(at);
+					at += 2;
+				}
+				row[x] = value;
+				if (++x == w) {
+					x = 0;
+					row += texWidth;
+				}
+			}
+			if (!literal) at += 2;
+		}
+	}
+	return at == end;
+}
+
+static int sameVisible(const unsigned short *a, const unsigned short *b)
+{
+	int y;
+	for (y = 0; y < height; y++) {
+		if (memcmp(a + y * texWidth, b + y * texWidth, width * 2)) return 0;
+	}
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	int format = -1, i, f;
+	unsigned char *rgba[MAX_FRAMES];
+	const char *dir;
+	char path[1024];
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-format") == 0 && i + 1 < argc) {
+			int bits = atoi(argv[++i]);
+			format = bits == 5650 ? GU_PSM_5650 : bits == 5551 ? GU_PSM_5551 : bits == 4444 ? GU_PSM_4444 : -2;
+		} else if (strcmp(argv[i], "-no-dither") == 0) {
+			dither = 0;
+		} else {
+			break;
+		}
+	}
+	if (i != argc - 1 || format == -2) {
+		fprintf(stderr, "usage: %s [-format 5650|5551|4444] [-no-dither] frames-directory\n", argv[0]);
+		return 1;
+	}
+	dir = argv[i];
+
+	for (frameCount = 0; frameCount < MAX_FRAMES; frameCount++) {
+		int w = 0, h = 0;
+		snprintf(path, sizeof(path), "%s/%d.png", dir, frameCount);
+		rgba[frameCount] = readPng(path, &w, &h);
+		if (!rgba[frameCount]) break;
+		if (frameCount == 0) {
+			width = w;
+			height = h;
+		} else if (w != width || h != height) {
+			fprintf(stderr, "%s: %dx%d, frame 0 is %dx%d\n", path, w, h, width, height);
+			return 2;
+		}
+	}
+	if (frameCount == 0) {
+		fprintf(stderr, "%s/0.png: can't read\n", dir);
+		return 2;
+	}
+	for (texWidth = 1; texWidth < width; texWidth <<= 1) {}
+	if (format < 0) format = chooseFormat(rgba);
+	for (f = 0; f < frameCount; f++) {
+		frames[f] = convert(rgba[f], format);
+		free(rgba[f]);
+	}
+
+	/* Header, offsets filled in as frames are written */
+	put("JSQ1", 4);
+	put16(width);
+	put16(height);
+	put16(texWidth);
+	put16(format);
+	put16(frameCount);
+	put16(TILE);
+	int offsets = outBytes;
+	for (f = 0; f <= frameCount; f++) put("\0\0\0\0", 4);
+
+	int tilesX = (width + TILE - 1) / TILE, tilesY = (height + TILE - 1) / TILE;
+	int bitmapBytes = (tilesX * tilesY + 7) / 8;
+	int changed[MAX_FRAMES];
+	for (f = 0; f < frameCount; f++) {
+		int t, bitmap;
+		set32(offsets + f * 4, outBytes);
+		bitmap = outBytes;
+		for (t = 0; t < bitmapBytes; t++) put8(0);
+		changed[f] = 0;
+		for (t = 0; t < tilesX * tilesY; t++) {
+			int x0 = (t % tilesX) * TILE, y0 = (t / tilesX) * TILE;
+			int w = width - x0 < TILE ? width - x0 : TILE, h = height - y0 < TILE ? height - y0 : TILE;
+			if (f > 0 && !tileChanged(frames[f], frames[f - 1], x0, y0, w, h)) continue;
+			out[bitmap + (t >> 3)] |= 1 << (t & 7);
+			encodeTile(frames[f], x0, y0, w, h);
+			changed[f]++;
+		}
+	}
+	set32(offsets + frameCount * 4, outBytes);
+
+	/* Straight through, timing each frame */
+	int frameBytes = texWidth * height * 2;
+	unsigned short *straight = calloc(frameBytes, 1);
+	int ok = 1;
+	printf("%s: %dx%d, format %s, %d frames of %d tiles\n", dir, width, height,
+	       format == GU_PSM_5650 ? "5650" : format == GU_PSM_5551 ? "5551" : "4444", frameCount, tilesX * tilesY);
+	for (f = 0; f < frameCount; f++) {
+		clock_t start = clock();
+		int decoded = apply(out, f, straight);
+		double micros = (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC;
+		int same = decoded && sameVisible(straight, frames[f]);
+		printf("  frame %d: %3d tiles changed, %7d bytes, decode %6.0f us host%s\n", f, changed[f],
+		       get32(out + offsets + (f + 1) * 4) - get32(out + offsets + f * 4), micros, same ? "" : "  MISMATCH");
+		ok &= same;
+	}
+
+	/* The game's order: frame n goes into buffer n&1, which holds n-2 */
+	unsigned short *buffers[2] = {calloc(frameBytes, 1), calloc(frameBytes, 1)};
+	int holds[2] = {-1, -1};
+	for (f = 0; f < frameCount && ok; f++) {
+		int b = f & 1, from = holds[b], n;
+		if (from < 0 && holds[b ^ 1] >= 0) {
+			memcpy(buffers[b], buffers[b ^ 1], frameBytes);
+			from = holds[b ^ 1];
+		}
+		for (n = from + 1; n <= f && ok; n++) ok = apply(out, n, buffers[b]);
+		holds[b] = f;
+		if (ok && !sameVisible(buffers[b], frames[f])) {
+			printf("  frame %d: MISMATCH through two buffers\n", f);
+			ok = 0;
+		}
+	}
+
+	printf("  resident: %d KB file + %d KB for two buffers, instead of %d KB at 16 bits (%d KB at 8888)\n",
+	       outBytes / 1024, 2 * frameBytes / 1024, frameCount * frameBytes / 1024, frameCount * frameBytes * 2 / 1024);
+	if (!ok) {
+		fprintf(stderr, "%s: round trip failed, not written\n", dir);
+		return 2;
+	}
+
+	snprintf(path, sizeof(path), "%s", dir);
+	{
+		size_t n = strlen(path);
+		while (n > 1 && path[n - 1] == '/') path[--n] = 0;
+	}
+	strncat(path, ".jsq", sizeof(path) - strlen(path) - 1);
+	FILE *fp = fopen(path, "wb");
+	if (!fp || fwrite(out, 1, outBytes, fp) != (size_t)outBytes) {
+		perror(path);
+		return 2;
+	}
+	fclose(fp);
+	printf("  wrote %s\n", path);
+	return 0;
+}
@@ -0,0 +1,159 @@
+/* latencysim - press-to-screen latency of the frame loop, both present modes
+ *
+ *   c++ -O2 -std=c++14 -o latencysim tools/latencysim.cpp
+ *   ./latencysim [-b build-us] [-j jitter-us] [-p post-us] [-s spike-percent] [-n presses]
+ *
+ * Replays main()'s loop on a 59.94 Hz clock: poll the pad, build and sync the
+ * list (b plus up to j microseconds, and s percent of frames 8 ms more), wait
+ * for vblank, swap, then the post-swap work (p). The swap only queues the
+ * buffer (PSP_DISPLAY_SETBUF_NEXTFRAME), so a frame is on screen one vblank
+ * after its swap. The pad driver samples once per vblank in the default mode
+ * and every 5555 us in LOW_LATENCY_PRESENT, which also sleeps before polling
+ * like waitForLateStart. Presses land at random times; each is timed from the
+ * press, and from the driver sample that saw it less half a driver cycle
+ * (what input::presented measures on the device), to the vblank that shows
+ * the first frame built after it was seen.
+ *
+ * Only the model has been run. The device figures, from building with
+ * INPUT_LATENCY 1 in each mode, have not been taken, so how close the two
+ * come is not known.
+ *
+ * Mirrors kRefreshMicros, kPresentMargin and kBuildHistory in source/main.cpp;
+ * change them together. tests/latencysim checks they agree and runs the model
+ * at a light and the default load; LATENCYSIM_NO_MAIN leaves main() out for
+ * it.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+static const double kRefreshMicros = 16683;
+static const double kPresentMargin = 1000;
+static const int kBuildHistory = 32;
+static const double kFastSampling = 5555;
+
+static double build = 6000, jitter = 3000, post = 1500, spikes = 2;
+static int presses = 20000;
+
+static uint32_t rng = 1;
+
+static uint32_t next()
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+static double uniform(double range)
+{
+	return range * (next() & 0xffffff) / 16777216.0;
+}
+
+struct Result {
+	std::vector<double> fromPress, fromSample;
+	int frames, missed;
+};
+
+static Result run(bool late)
+{
+	Result r = {{}, {}, 0, 0};
+	double history[kBuildHistory] = {0};
+	int historyNext = 0;
+
+	/* Presses one to forty frames apart */
+	std::vector<double> at(presses);
+	double t = kRefreshMicros;
+	for (int i = 0; i < presses; i++) {
+		t += kRefreshMicros + uniform(39 * kRefreshMicros);
+		at[i] = t;
+	}
+
+	rng = 1;
+	int seen = 0;
+	double vblank = 0;
+	while (seen < presses) {
+		double start = vblank + post;
+		if (late) {
+			/* Second slowest, as waitForLateStart */
+			double slowest = 0, second = 0;
+			for (double h : history) {
+				if (h > slowest) {
+					second = slowest;
+					slowest = h;
+				} else if (h > second) {
+					second = h;
+				}
+			}
+			if (second + kPresentMargin < kRefreshMicros) {
+				start = std::max(start, vblank + kRefreshMicros - second - kPresentMargin);
+			}
+		}
+
+		/* The newest driver sample at the time of the poll */
+		const double cycle = late ? kFastSampling : kRefreshMicros;
+		const double sample = (double)(long long)(start / cycle) * cycle;
+
+		double took = build + uniform(jitter);
+		if (uniform(100) < spikes) took += 8000;
+		history[historyNext++ % kBuildHistory] = took;
+
+		const double done = start + took;
+		double swap = vblank + kRefreshMicros;
+		while (swap < done) swap += kRefreshMicros;
+		if (swap - vblank > kRefreshMicros * 1.5) r.missed++;
+
+		const double shown = swap + kRefreshMicros;
+		for (; seen < presses && at[seen] <= sample; seen++) {
+			r.fromPress.push_back(shown - at[seen]);
+			/* The driver sample that first saw the press */
+			double first = (double)(long long)(at[seen] / cycle) * cycle;
+			if (first < at[seen]) first += cycle;
+			r.fromSample.push_back(shown - first + cycle / 2);
+		}
+		vblank = swap;
+		r.frames++;
+	}
+	return r;
+}
+
+static void print(const char *what, std::vector<double> v)
+{
+	std::sort(v.begin(), v.end());
+	printf("  %-18s median %5.1f ms, p90 %5.1f ms, max %5.1f ms\n", what,
+	       v[v.size() / 2] / 1000, v[v.size() * 9 / 10] / 1000, v.back() / 1000);
+}
+
+#ifndef LATENCYSIM_NO_MAIN
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-b build-us] [-j jitter-us] [-p post-us] [-s spike-percent] [-n presses]\n", name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	for (int arg = 1; arg < argc; arg++) {
+		if (arg + 1 >= argc) usage(argv[0]);
+		if (strcmp(argv[arg], "-b") == 0) build = atof(argv[++arg]);
+		else if (strcmp(argv[arg], "-j") == 0) jitter = atof(argv[++arg]);
+		else if (strcmp(argv[arg], "-p") == 0) post = atof(argv[++arg]);
+		else if (strcmp(argv[arg], "-s") == 0) spikes = atof(argv[++arg]);
+		else if (strcmp(argv[arg], "-n") == 0) presses = atoi(argv[++arg]);
+		else usage(argv[0]);
+	}
+	if (presses < 1 || build < 0 || jitter < 0) usage(argv[0]);
+
+	printf("build %.0f us + up to %.0f, %.0f%% spikes of 8 ms, %.0f us after the swap\n", build, jitter, spikes, post);
+	for (int late = 0; late < 2; late++) {
+		const Result r = run(late != 0);
+		printf("%s (%d frames, %d missed vblanks)\n", late ? "LOW_LATENCY_PRESENT" : "default", r.frames, r.missed);
+		print("press to screen", r.fromPress);
+		print("as measured", r.fromSample);
+	}
+	return 0;
+}
+#endif
@@ -0,0 +1,300 @@
+/* mapc - compiles the readable movement graph into the table the game loads
+ *
+ *   cc -O2 -o mapc tools/mapc.c
+ *   ./mapc romfs/ai/map.txt romfs/ai/map.bin
+ *
+ * Source format, one statement per line, '#' starts a comment:
+ *
+ *   character <name>            freddy, bonnie, chica or foxy
+ *     period <frames>           frames between movement opportunities
+ *     door <left|right> <pos>   which door it attacks and from which position
+ *     blocked <pos>             where a closed door sends it back to
+ *     flags <flag>...           laughs needscams forgetsroom runs
+ *     <pos> [-> <next>] [door] [side] [return <pos>] [watched] [pushed] [detour <roll> <pos>]
+ *
+ *   camera <index>
+ *     [<var> <op> <value>]... : <image>
+ *
+ * Positions a character does not list behave as its door. Camera variables are
+ * the four names plus night, ops are == != < >; the first rule of a camera whose
+ * clauses all hold picks the image (a path under romfs/gfx/office/camera/).
+ *
+ * Layout (little-endian): "AIGR", version, character count, rule count, string
+ * bytes; then per character a 12-byte name, period (u16), door, blocked, side,
+ * flags, 2 pad bytes and 16 nodes of {next, flags, detour roll, detour target};
+ * then 16-byte rules {camera, clause count, image offset (u16), 4 x {var, op,
+ * value}}; then the NUL-terminated image names. Must match source/graph.cpp.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_NODES 16
+#define CHARACTERS 4
+#define CAMERAS 11
+#define MAX_RULES 96
+#define MAX_CLAUSES 4
+#define MAX_STRING_BYTES 2048
+
+enum { DOOR = 1, SIDE = 2, RETURN = 4, WATCHED = 8, PUSHED = 16 };
+
+static const char *names[CHARACTERS] = {"freddy", "bonnie", "chica", "foxy"};
+static const char *characterFlags[] = {"laughs", "needscams", "forgetsroom", "runs"};
+static const char *vars[] = {"freddy", "bonnie", "chica", "foxy", "night"};
+static const char *ops[] = {"==", "!=", "<", ">"};
+
+typedef struct {
+	int defined;
+	int period, door, blocked, side, flags;
+	int listed[MAX_NODES];
+	signed char next[MAX_NODES], detourRoll[MAX_NODES], detourTo[MAX_NODES];
+	unsigned char nodeFlags[MAX_NODES];
+} Character;
+
+typedef struct {
+	int camera, clauses, image;
+	unsigned char clause[MAX_CLAUSES][3];
+} Rule;
+
+static Character characters[CHARACTERS];
+static Rule rules[MAX_RULES];
+static int ruleCount;
+static char strings[MAX_STRING_BYTES];
+static int stringBytes;
+
+static const char *path;
+static int line;
+
+static void fail(const char *what, const char *token)
+{
+	fprintf(stderr, "%s:%d: %s%s%s\n", path, line, what, token ? ": " : "", token ? token : "");
+	exit(2);
+}
+
+static int lookup(const char **table, int count, const char *token)
+{
+	int i;
+	for (i = 0; i < count; i++) {
+		if (strcmp(table[i], token) == 0) return i;
+	}
+	return -1;
+}
+
+static int number(const char *token, int low, int high)
+{
+	char *end;
+	long value;
+	if (!token) fail("missing number", NULL);
+	value = strtol(token, &end, 10);
+	if (*end || value < low || value > high) fail("bad number", token);
+	return (int)value;
+}
+
+static int intern(const char *image)
+{
+	int at = 0;
+	while (at < stringBytes) {
+		if (strcmp(strings + at, image) == 0) return at;
+		at += strlen(strings + at) + 1;
+	}
+	if (stringBytes + (int)strlen(image) + 1 > MAX_STRING_BYTES) fail("too many image names", NULL);
+	strcpy(strings + stringBytes, image);
+	stringBytes += strlen(image) + 1;
+	return at;
+}
+
+static void node(Character *c, char *first)
+{
+	int position = number(first, 0, MAX_NODES - 1);
+	char *token;
+	if (c->listed[position]) fail("position listed twice", first);
+	c->listed[position] = 1;
+	c->next[position] = position;
+	c->detourRoll[position] = -1;
+	while ((token = strtok(NULL, " \t")) != NULL) {
+		if (strcmp(token, "->") == 0) {
+			c->next[position] = number(strtok(NULL, " \t"), 0, MAX_NODES - 1);
+		} else if (strcmp(token, "door") == 0) {
+			c->nodeFlags[position] |= DOOR;
+		} else if (strcmp(token, "side") == 0) {
+			c->nodeFlags[position] |= SIDE;
+		} else if (strcmp(token, "return") == 0) {
+			c->nodeFlags[position] |= RETURN;
+			c->next[position] = number(strtok(NULL, " \t"), 0, MAX_NODES - 1);
+		} else if (strcmp(token, "watched") == 0) {
+			c->nodeFlags[position] |= WATCHED;
+		} else if (strcmp(token, "pushed") == 0) {
+			c->nodeFlags[position] |= PUSHED;
+		} else if (strcmp(token, "detour") == 0) {
+			c->detourRoll[position] = number(strtok(NULL, " \t"), 0, 19);
+			c->detourTo[position] = number(strtok(NULL, " \t"), 0, MAX_NODES - 1);
+		} else {
+			fail("unknown node keyword", token);
+		}
+	}
+}
+
+static void rule(int camera, char *text)
+{
+	char *colon = strchr(text, ':'), *token, *image;
+	Rule *r;
+	if (!colon) fail("camera rule without ': image'", NULL);
+	if (ruleCount == MAX_RULES) fail("too many camera rules", NULL);
+	*colon = 0;
+	image = strtok(colon + 1, " \t");
+	if (!image || strtok(NULL, " \t")) fail("expected one image name after ':'", NULL);
+	r = &rules[ruleCount++];
+	memset(r, 0, sizeof(*r));
+	r->camera = camera;
+	r->image = intern(image);
+	for (token = strtok(text, " \t"); token; token = strtok(NULL, " \t")) {
+		int var = lookup(vars, 5, token), op;
+		if (var < 0) fail("unknown variable", token);
+		if (r->clauses == MAX_CLAUSES) fail("too many clauses", NULL);
+		token = strtok(NULL, " \t");
+		op = token ? lookup(ops, 4, token) : -1;
+		if (op < 0) fail("bad operator", token);
+		r->clause[r->clauses][0] = var;
+		r->clause[r->clauses][1] = op;
+		r->clause[r->clauses][2] = (unsigned char)number(strtok(NULL, " \t"), -128, 127);
+		r->clauses++;
+	}
+}
+
+static void putLe16(unsigned char *p, unsigned int v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+static void putLe32(unsigned char *p, unsigned int v)
+{
+	putLe16(p, v);
+	putLe16(p + 2, v >> 16);
+}
+
+int main(int argc, char **argv)
+{
+	char text[512];
+	Character *current = NULL;
+	int camera = -1, i, n;
+	FILE *fp;
+
+	if (argc != 3) {
+		fprintf(stderr, "usage: %s map.txt map.bin\n", argv[0]);
+		return 1;
+	}
+	path = argv[1];
+	fp = fopen(path, "r");
+	if (!fp) {
+		perror(path);
+		return 2;
+	}
+	while (fgets(text, sizeof(text), fp)) {
+		char *hash = strchr(text, '#'), *token;
+		line++;
+		if (hash) *hash = 0;
+		text[strcspn(text, "\r\n")] = 0;
+
+		if (camera >= 0 && strchr(text, ':')) {
+			rule(camera, text);
+			continue;
+		}
+		token = strtok(text, " \t");
+		if (!token) continue;
+
+		if (strcmp(token, "character") == 0) {
+			token = strtok(NULL, " \t");
+			i = token ? lookup(names, CHARACTERS, token) : -1;
+			if (i < 0) fail("unknown character", token);
+			current = &characters[i];
+			if (current->defined) fail("character defined twice", token);
+			current->defined = 1;
+			current->door = -1;
+			camera = -1;
+		} else if (strcmp(token, "camera") == 0) {
+			n = number(strtok(NULL, " \t"), 0, CAMERAS - 1);
+			if (n <= camera) fail("cameras must come in order", NULL);
+			camera = n;
+			current = NULL;
+		} else if (!current) {
+			fail("statement outside a character", token);
+		} else if (strcmp(token, "period") == 0) {
+			current->period = number(strtok(NULL, " \t"), 1, 65535);
+		} else if (strcmp(token, "door") == 0) {
+			token = strtok(NULL, " \t");
+			if (!token || (strcmp(token, "left") != 0 && strcmp(token, "right") != 0)) fail("door must be left or right", token);
+			current->side = strcmp(token, "right") == 0;
+			current->door = number(strtok(NULL, " \t"), 0, MAX_NODES - 1);
+		} else if (strcmp(token, "blocked") == 0) {
+			current->blocked = number(strtok(NULL, " \t"), 0, MAX_NODES - 1);
+		} else if (strcmp(token, "flags") == 0) {
+			while ((token = strtok(NULL, " \t")) != NULL) {
+				i = lookup(characterFlags, 4, token);
+				if (i < 0) fail("unknown flag", token);
+				current->flags |= 1 << i;
+			}
+		} else {
+			node(current, token);
+		}
+	}
+	fclose(fp);
+
+	line = 0;
+	for (i = 0; i < CHARACTERS; i++) {
+		Character *c = &characters[i];
+		if (!c->defined) fail("missing character", names[i]);
+		if (!c->period || c->door < 0) fail("character needs a period and a door", names[i]);
+		for (n = 0; n < MAX_NODES; n++) {
+			if (c->listed[n]) continue;
+			if (n < c->door) fail("position before the door not listed for", names[i]);
+			c->next[n] = c->door;
+			c->nodeFlags[n] = DOOR;
+			c->detourRoll[n] = -1;
+		}
+	}
+	if (!ruleCount) fail("no camera rules", NULL);
+
+	{
+		int headerBytes = 20, characterBytes = 20 + MAX_NODES * 4, ruleBytes = 16;
+		int total = headerBytes + CHARACTERS * characterBytes + ruleCount * ruleBytes + stringBytes;
+		unsigned char *out = calloc(1, total), *at = out + headerBytes;
+		memcpy(out, "AIGR", 4);
+		putLe32(out + 4, 1);
+		putLe32(out + 8, CHARACTERS);
+		putLe32(out + 12, ruleCount);
+		putLe32(out + 16, stringBytes);
+		for (i = 0; i < CHARACTERS; i++, at += characterBytes) {
+			Character *c = &characters[i];
+			strcpy((char *)at, names[i]);
+			putLe16(at + 12, c->period);
+			at[14] = c->door;
+			at[15] = c->blocked;
+			at[16] = c->side;
+			at[17] = c->flags;
+			for (n = 0; n < MAX_NODES; n++) {
+				at[20 + n * 4] = c->next[n];
+				at[21 + n * 4] = c->nodeFlags[n];
+				at[22 + n * 4] = c->detourRoll[n];
+				at[23 + n * 4] = c->detourTo[n];
+			}
+		}
+		for (i = 0; i < ruleCount; i++, at += ruleBytes) {
+			at[0] = rules[i].camera;
+			at[1] = rules[i].clauses;
+			putLe16(at + 2, rules[i].image);
+			memcpy(at + 4, rules[i].clause, sizeof(rules[i].clause));
+		}
+		memcpy(at, strings, stringBytes);
+
+		fp = fopen(argv[2], "wb");
+		if (!fp || fwrite(out, 1, total, fp) != (size_t)total) {
+			perror(argv[2]);
+			return 2;
+		}
+		fclose(fp);
+		printf("%s: %d characters, %d camera rules, %d bytes\n", argv[2], CHARACTERS, ruleCount, total);
+		free(out);
+	}
+	return 0;
+}
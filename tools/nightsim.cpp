@@ -0,0 +1,606 @@
+/* nightsim - estimates how survivable every custom night is
+ *
+ *   c++ -O2 -std=c++14 -pthread -o nightsim tools/nightsim.cpp source/scheduler.cpp
+ *   ./nightsim [-n nights] [-j threads] [-s seed] romfs/ai/map.bin romfs/ai/difficulty.bin
+ *   ./nightsim [-n nights] -c freddy,bonnie,chica,foxy romfs/ai/map.bin
+ *
+ * Plays every combination of custom night levels (0..20 each) the given
+ * number of times with a fixed reference player, on the same movement graph
+ * the game loads and the game's own timer wheel. -c plays one combination and
+ * prints its figures instead of writing the table. `make difficulty` rebuilds
+ * the committed romfs/ai/difficulty.bin.
+ *
+ * The engine keeps its AI, power and clock in globals behind the PSP headers,
+ * so one night here is a struct mirroring source/animatronic.cpp (onOpportunity,
+ * reachDoor, foxyAttackFrame), source/power.cpp (drainConstant, checkDrain) and
+ * source/time.cpp (updateTime) frame for frame, in the order handleOfficeState
+ * calls them. The reload worker is taken to settle at the end of every frame,
+ * which leaves the stuck-state watchdog nothing to do. tests/nightsim plays
+ * the same nights through the real sources and fails on the first frame the
+ * two part; NIGHTSIM_NO_MAIN leaves the table writing out
+ * for it.
+ *
+ * Reference player: every 300 frames flip the cameras up for a second and
+ * down, then hold the left light and the right light for 20 frames each. A
+ * door is closed while the last look showed someone at it (the lights show
+ * the hall, the cameras show whoever only attacks on them) and opened once it
+ * is clear. Foxy's run is answered by closing the left door 20 frames after
+ * it starts. Power running out counts as a loss.
+ *
+ * Layout (little-endian): "CNDT", version, levels per character (21), nights
+ * per combination; then one entry per combination, Freddy's level slowest and
+ * Foxy's fastest, of {survival percent, mean power left at 6 AM of the nights
+ * survived}. Must match source/customnight.cpp.
+ */
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "../source/included/scheduler.hpp"
+
+#define CHARACTERS 4
+#define MAX_NODES 16
+#define LEVELS 21
+#define COMBINATIONS (LEVELS * LEVELS * LEVELS * LEVELS)
+
+enum { FREDDY, BONNIE, CHICA, FOXY };
+enum { DOOR = 1, SIDE = 2, RETURN = 4, WATCHED = 8, PUSHED = 16 };
+enum { LAUGHS = 1, NEEDS_CAMS = 2, FORGETS_ROOM = 4, RUNS = 8 };
+enum { LEFT, RIGHT };
+
+/* Reference player timings, in frames */
+enum {
+	ROUND = 300,
+	FLIP = 8,           /* camera flip animation, each way */
+	WATCH = 60,
+	LIGHT = 20,
+	REACT = 20,         /* hearing Foxy run to pressing the door */
+	DOOR_FRAMES = 7,    /* press to closed (or open) */
+	HOUR_FRAMES = 5100,
+	NIGHT7_DRAIN = 420,
+};
+
+struct Node {
+	signed char next, flags, detourRoll, detourTo;
+};
+
+struct Character {
+	int period, door, blockedTo, side, flags;
+	Node nodes[MAX_NODES];
+};
+
+static Character characters[CHARACTERS];
+
+struct Night;
+
+struct Opportunity {
+	scheduler::Timer timer; /* first, so the wheel's pointer is ours */
+	Night *night;
+	int id;
+};
+
+struct Night {
+	uint32_t rng;
+	int position[CHARACTERS], level[CHARACTERS];
+	bool atDoor[CHARACTERS], inOtherRoom[CHARACTERS], seenAtDoor[CHARACTERS];
+	bool isMoving, usingCams, leftOn, rightOn, jumpscaring;
+
+	int warningTimer;
+	bool foxyAttackStarted, knockPlayed, foxyPaused;
+
+	int total, drainTime, usage;
+	int gtime, framesPerUpdate;
+
+	int frame;
+	bool closed[2], wantClosed[2];
+	int doorTimer[2];
+
+	Opportunity opportunity[CHARACTERS];
+};
+
+/* ------------------------------------------------------------------ */
+/* Mirrors source/animatronic.cpp                                      */
+/* ------------------------------------------------------------------ */
+
+static int randN(Night &n, int range)
+{
+	n.rng ^= n.rng << 13;
+	n.rng ^= n.rng >> 17;
+	n.rng ^= n.rng << 5;
+	return (int)(((uint64_t)n.rng * (uint32_t)range) >> 32);
+}
+
+static const Node &nodeAt(int id, int position)
+{
+	return characters[id].nodes[position < 0 ? 0 : (position >= MAX_NODES ? MAX_NODES - 1 : position)];
+}
+
+static void resetFoxyAttack(Night &n)
+{
+	n.warningTimer = 0;
+	n.foxyAttackStarted = false;
+	n.knockPlayed = false;
+	n.foxyPaused = false;
+}
+
+static void blockAttack(Night &n, int id)
+{
+	n.atDoor[id] = false;
+	n.position[id] = characters[id].blockedTo;
+	if (characters[id].flags & RUNS) resetFoxyAttack(n);
+}
+
+static void reachDoor(Night &n, int id)
+{
+	const Character &c = characters[id];
+	bool closed;
+	if (c.flags & RUNS) {
+		if (!n.atDoor[id]) {
+			n.atDoor[id] = true;
+			n.warningTimer = 0;
+			n.foxyAttackStarted = false;
+			n.knockPlayed = false;
+			n.foxyPaused = true;
+		}
+		return;
+	}
+	n.atDoor[id] = true;
+	closed = n.closed[c.side];
+	if (!n.jumpscaring && !closed && (n.usingCams || !(c.flags & NEEDS_CAMS))) {
+		n.jumpscaring = true;
+	} else if (!n.jumpscaring && closed) {
+		blockAttack(n, id);
+	}
+}
+
+static void onOpportunity(scheduler::Timer *timer)
+{
+	Opportunity *o = reinterpret_cast<Opportunity *>(timer);
+	Night &n = *o->night;
+	const int id = o->id;
+	const Character &c = characters[id];
+	int roll, level;
+	bool moves;
+
+	if (c.flags & FORGETS_ROOM) n.inOtherRoom[id] = false;
+
+	roll = randN(n, 20);
+	level = n.level[id];
+	const Node &node = nodeAt(id, n.position[id]);
+
+	if (c.flags & RUNS) {
+		moves = roll <= level || ((node.flags & PUSHED) && !n.isMoving);
+	} else {
+		moves = roll < level || (node.flags & PUSHED);
+	}
+	if (!moves || n.atDoor[id]) return;
+
+	if (node.flags & RETURN) {
+		if (n.inOtherRoom[id]) {
+			n.position[id] = node.next;
+			n.inOtherRoom[id] = false;
+		}
+	} else if (roll == node.detourRoll) {
+		n.position[id] = node.detourTo;
+		n.inOtherRoom[id] = true;
+		n.isMoving = true;
+	} else if (node.flags & DOOR) {
+		reachDoor(n, id);
+	} else if (!n.isMoving && (!n.usingCams || (node.flags & WATCHED))) {
+		n.position[id] = node.next;
+	}
+}
+
+static void foxyAttackFrame(Night &n)
+{
+	if (n.atDoor[FOXY] && !n.jumpscaring) {
+		n.foxyAttackStarted = true;
+		n.warningTimer++;
+		if (n.warningTimer >= 60) {
+			if (!n.closed[LEFT]) {
+				n.foxyPaused = false;
+				n.jumpscaring = true;
+			} else {
+				n.knockPlayed = true;
+				if (n.warningTimer >= 90) blockAttack(n, FOXY);
+			}
+		}
+	}
+}
+
+/* ------------------------------------------------------------------ */
+/* Mirrors source/power.cpp and source/time.cpp                        */
+/* ------------------------------------------------------------------ */
+
+static void drainConstant(Night &n)
+{
+	static const int divisors[5] = {0, 2, 4, 6, 8};
+	const int divisor = divisors[n.usage];
+	if (divisor && (n.drainTime == 600 || n.drainTime == 540 || n.drainTime == 480 || n.drainTime == 420)) {
+		n.drainTime /= divisor;
+	}
+	if (n.drainTime <= 0) {
+		n.total -= 1;
+		n.drainTime = NIGHT7_DRAIN;
+	} else {
+		n.drainTime -= 1;
+	}
+}
+
+static void checkDrain(Night &n)
+{
+	n.usage = (n.leftOn ? 1 : 0) + (n.rightOn ? 1 : 0) + (n.closed[LEFT] ? 1 : 0) + (n.closed[RIGHT] ? 1 : 0) +
+		(n.usingCams ? 1 : 0);
+	if (n.usage > 4) n.usage = 4;
+}
+
+/* Returns true at 6 AM */
+static bool updateTime(Night &n)
+{
+	if (n.framesPerUpdate > 0) {
+		n.framesPerUpdate -= 1;
+		return false;
+	}
+	n.gtime += 1;
+	n.framesPerUpdate = HOUR_FRAMES;
+	switch (n.gtime) {
+	case 2:
+		n.level[BONNIE] += 1;
+		break;
+	case 3: case 4: case 5:
+		n.level[BONNIE] += 1;
+		n.level[CHICA] += 1;
+		break;
+	case 6:
+		return true;
+	}
+	return false;
+}
+
+/* ------------------------------------------------------------------ */
+/* Reference player                                                    */
+/* ------------------------------------------------------------------ */
+
+static void look(Night &n, int side, bool cams)
+{
+	int id;
+	for (id = 0; id < CHARACTERS; id++) {
+		const Character &c = characters[id];
+		if (c.flags & RUNS) continue;
+		if (cams ? (c.flags & NEEDS_CAMS) : (c.side == side && !(c.flags & NEEDS_CAMS))) {
+			n.seenAtDoor[id] = n.position[id] == c.door;
+		}
+	}
+	if (cams) return;
+	n.wantClosed[side] = false;
+	for (id = 0; id < CHARACTERS; id++) {
+		if (n.seenAtDoor[id] && characters[id].side == side) n.wantClosed[side] = true;
+	}
+}
+
+static void player(Night &n)
+{
+	const int t = n.frame % ROUND;
+	const int lightsAt = FLIP + WATCH + FLIP;
+
+	n.usingCams = t >= FLIP && t < lightsAt;
+	if (t == lightsAt) look(n, 0, true);
+	n.leftOn = t >= lightsAt && t < lightsAt + LIGHT;
+	n.rightOn = t >= lightsAt + LIGHT && t < lightsAt + 2 * LIGHT;
+	if (t == lightsAt + LIGHT - 1) look(n, LEFT, false);
+	if (t == lightsAt + 2 * LIGHT - 1) look(n, RIGHT, false);
+
+	if (n.atDoor[FOXY] && n.warningTimer >= REACT) n.wantClosed[LEFT] = true;
+}
+
+static void doors(Night &n)
+{
+	int side;
+	for (side = 0; side < 2; side++) {
+		if (n.wantClosed[side] == n.closed[side]) {
+			n.doorTimer[side] = DOOR_FRAMES;
+		} else if (--n.doorTimer[side] <= 0) {
+			n.closed[side] = n.wantClosed[side];
+			n.doorTimer[side] = DOOR_FRAMES;
+		}
+	}
+}
+
+/* ------------------------------------------------------------------ */
+/* One night                                                           */
+/* ------------------------------------------------------------------ */
+
+/* Frames of the round on which the reference player does something new; the
+ * last one is the next round's camera flip */
+static const int playerChanges[] = {
+	FLIP, FLIP + WATCH + FLIP, FLIP + WATCH + FLIP + LIGHT - 1, FLIP + WATCH + FLIP + LIGHT,
+	FLIP + WATCH + FLIP + 2 * LIGHT - 1, FLIP + WATCH + FLIP + 2 * LIGHT, ROUND + FLIP,
+};
+
+/* Frames from here on that only count down: the player keeps doing the same
+ * thing, the doors are still, Foxy is not running, and no opportunity, drain
+ * step or hour is due. Stepping them one by one gives the same night. */
+static int quietFrames(const Night &n, const scheduler::Wheel &ai)
+{
+	const int t = n.frame % ROUND;
+	int quiet = 0, i, left;
+
+	for (i = 0; !quiet; i++) {
+		if (playerChanges[i] == t) return 0;
+		if (playerChanges[i] > t) quiet = playerChanges[i] - t;
+	}
+	if (n.atDoor[FOXY] || n.wantClosed[LEFT] != n.closed[LEFT] || n.wantClosed[RIGHT] != n.closed[RIGHT]) return 0;
+	if (n.usage != (n.leftOn ? 1 : 0) + (n.rightOn ? 1 : 0) + (n.closed[LEFT] ? 1 : 0) + (n.closed[RIGHT] ? 1 : 0) +
+		(n.usingCams ? 1 : 0)) return 0;
+	if (n.drainTime >= NIGHT7_DRAIN) return 0;
+
+	if (n.drainTime < quiet) quiet = n.drainTime;
+	if (n.framesPerUpdate < quiet) quiet = n.framesPerUpdate;
+	for (i = 0; i < CHARACTERS; i++) {
+		left = ai.remaining(n.opportunity[i].timer);
+		if (left < quiet) quiet = left;
+	}
+	return quiet > 1 ? quiet : 0;
+}
+
+static uint32_t mix(uint64_t x)
+{
+	x += 0x9E3779B97F4A7C15ull;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+	x ^= x >> 31;
+	return (uint32_t)x ? (uint32_t)x : 1;
+}
+
+static void startNight(Night &n, scheduler::Wheel &ai, const int *levels, uint32_t seed)
+{
+	int id;
+
+	memset(&n, 0, sizeof(n));
+	n.rng = seed;
+	n.total = 99;
+	n.drainTime = NIGHT7_DRAIN;
+	n.framesPerUpdate = HOUR_FRAMES;
+	n.doorTimer[LEFT] = n.doorTimer[RIGHT] = DOOR_FRAMES;
+	for (id = 0; id < CHARACTERS; id++) {
+		Opportunity &o = n.opportunity[id];
+		n.level[id] = levels[id];
+		o.night = &n;
+		o.id = id;
+		o.timer.fire = onOpportunity;
+		o.timer.period = characters[id].period;
+		o.timer.order = id;
+	}
+	/* The game's timers keep their phase from whatever was played before */
+	for (id = 0; id < CHARACTERS; id++) {
+		ai.schedule(n.opportunity[id].timer, randN(n, characters[id].period));
+	}
+}
+
+/* The part of handleOfficeState mirrored above, after the player's input and
+ * before the doors move; returns false once the night is over */
+static bool officeFrame(Night &n, scheduler::Wheel &ai)
+{
+	foxyAttackFrame(n);
+	if (!n.foxyPaused) ai.advance();
+	if (n.jumpscaring) return false;
+	n.isMoving = false;
+
+	drainConstant(n);
+	checkDrain(n);
+	if (n.total <= 0) return false;
+
+	return !updateTime(n);
+}
+
+static int endNight(Night &n, scheduler::Wheel &ai)
+{
+	int id;
+
+	for (id = 0; id < CHARACTERS; id++) ai.cancel(n.opportunity[id].timer);
+	return n.jumpscaring || n.total <= 0 ? -1 : n.total;
+}
+
+/* Returns the power left at 6 AM, or -1 for a loss */
+static int playNight(scheduler::Wheel &ai, const int *levels, uint32_t seed)
+{
+	Night n;
+
+	startNight(n, ai, levels, seed);
+	for (;; n.frame++) {
+		const int quiet = quietFrames(n, ai);
+		if (quiet) {
+			ai.skip(quiet);
+			n.drainTime -= quiet;
+			n.framesPerUpdate -= quiet;
+			n.frame += quiet - 1;
+			continue;
+		}
+
+		player(n);
+		if (!officeFrame(n, ai)) break;
+		doors(n);
+	}
+	return endNight(n, ai);
+}
+
+#ifndef NIGHTSIM_NO_MAIN
+struct Estimate {
+	unsigned char survival, power;
+};
+
+static Estimate estimate(scheduler::Wheel &ai, int combination, int nights, uint32_t seed)
+{
+	int levels[CHARACTERS], i, rest = combination, won = 0;
+	long power = 0;
+	Estimate e;
+
+	for (i = CHARACTERS - 1; i >= 0; i--) {
+		levels[i] = rest % LEVELS;
+		rest /= LEVELS;
+	}
+	for (i = 0; i < nights; i++) {
+		const int left = playNight(ai, levels, mix(((uint64_t)seed << 40) ^ ((uint64_t)combination << 20) ^ (uint64_t)i));
+		if (left >= 0) {
+			won++;
+			power += left;
+		}
+	}
+	e.survival = (unsigned char)((won * 100 + nights / 2) / nights);
+	e.power = (unsigned char)(won ? (power + won / 2) / won : 0);
+	return e;
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* map.bin, as written by tools/mapc                                   */
+/* ------------------------------------------------------------------ */
+
+static int le16(const unsigned char *p)
+{
+	return p[0] | p[1] << 8;
+}
+
+static int le32(const unsigned char *p)
+{
+	return le16(p) | le16(p + 2) << 16;
+}
+
+static void loadMap(const char *path)
+{
+	unsigned char data[20 + CHARACTERS * (20 + MAX_NODES * 4)];
+	const unsigned char *at = data + 20;
+	FILE *fp = fopen(path, "rb");
+	int i, n;
+
+	if (!fp) {
+		perror(path);
+		exit(2);
+	}
+	if (fread(data, 1, sizeof(data), fp) != sizeof(data) || memcmp(data, "AIGR", 4) != 0 || le32(data + 4) != 1 ||
+		le32(data + 8) != CHARACTERS) {
+		fprintf(stderr, "%s: not a movement graph from tools/mapc\n", path);
+		exit(2);
+	}
+	fclose(fp);
+	for (i = 0; i < CHARACTERS; i++, at += 20 + MAX_NODES * 4) {
+		Character &c = characters[i];
+		c.period = le16(at + 12);
+		c.door = (signed char)at[14];
+		c.blockedTo = (signed char)at[15];
+		c.side = at[16];
+		c.flags = at[17];
+		for (n = 0; n < MAX_NODES; n++) {
+			c.nodes[n].next = (signed char)at[20 + n * 4];
+			c.nodes[n].flags = (signed char)at[21 + n * 4];
+			c.nodes[n].detourRoll = (signed char)at[22 + n * 4];
+			c.nodes[n].detourTo = (signed char)at[23 + n * 4];
+		}
+	}
+	if (!(characters[FOXY].flags & RUNS)) {
+		fprintf(stderr, "%s: the engine expects Foxy to be the runner\n", path);
+		exit(2);
+	}
+}
+
+#ifndef NIGHTSIM_NO_MAIN
+/* ------------------------------------------------------------------ */
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-n nights] [-j threads] [-s seed] map.bin difficulty.bin\n"
+		"       %s [-n nights] -c freddy,bonnie,chica,foxy map.bin\n", name, name);
+	exit(1);
+}
+
+static void putLe32(unsigned char *p, unsigned int v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+int main(int argc, char **argv)
+{
+	int nights = 1000, threads = (int)std::thread::hardware_concurrency(), arg = 1;
+	int one = -1, i;
+	uint32_t seed = 1;
+
+	for (; arg < argc && argv[arg][0] == '-'; arg++) {
+		if (arg + 1 >= argc) usage(argv[0]);
+		if (strcmp(argv[arg], "-n") == 0) {
+			nights = atoi(argv[++arg]);
+		} else if (strcmp(argv[arg], "-j") == 0) {
+			threads = atoi(argv[++arg]);
+		} else if (strcmp(argv[arg], "-s") == 0) {
+			seed = (uint32_t)strtoul(argv[++arg], NULL, 0);
+		} else if (strcmp(argv[arg], "-c") == 0) {
+			int l[CHARACTERS];
+			if (sscanf(argv[++arg], "%d,%d,%d,%d", &l[0], &l[1], &l[2], &l[3]) != 4) usage(argv[0]);
+			for (one = 0, i = 0; i < CHARACTERS; i++) {
+				if (l[i] < 0 || l[i] >= LEVELS) usage(argv[0]);
+				one = one * LEVELS + l[i];
+			}
+		} else {
+			usage(argv[0]);
+		}
+	}
+	if (nights < 1 || threads < 1 || argc - arg != (one >= 0 ? 1 : 2)) usage(argv[0]);
+	loadMap(argv[arg]);
+
+	if (one >= 0) {
+		scheduler::Wheel ai;
+		const Estimate e = estimate(ai, one, nights, seed);
+		printf("survival %d%%, power left %d%%\n", e.survival, e.power);
+		return 0;
+	}
+
+	{
+		std::vector<Estimate> table(COMBINATIONS);
+		std::vector<std::thread> pool;
+		std::atomic<int> nextBatch(0);
+		const int batch = 64;
+		const auto start = std::chrono::steady_clock::now();
+		unsigned char header[16];
+		double seconds, perSecond;
+		FILE *fp;
+
+		for (i = 0; i < threads; i++) {
+			pool.emplace_back([&]() {
+				scheduler::Wheel ai;
+				int first;
+				while ((first = nextBatch.fetch_add(batch)) < COMBINATIONS) {
+					const int last = first + batch < COMBINATIONS ? first + batch : COMBINATIONS;
+					for (int c = first; c < last; c++) table[c] = estimate(ai, c, nights, seed);
+				}
+			});
+		}
+		for (auto &worker : pool) worker.join();
+
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		perSecond = (double)COMBINATIONS * nights / seconds;
+		printf("%d combinations x %d nights in %.1f s: %.0f nights/s, %.0f per thread (%d threads)\n",
+			COMBINATIONS, nights, seconds, perSecond, perSecond / threads, threads);
+
+		memcpy(header, "CNDT", 4);
+		putLe32(header + 4, 1);
+		putLe32(header + 8, LEVELS);
+		putLe32(header + 12, nights);
+		fp = fopen(argv[arg + 1], "wb");
+		if (!fp || fwrite(header, 1, sizeof(header), fp) != sizeof(header) ||
+			fwrite(table.data(), sizeof(Estimate), COMBINATIONS, fp) != COMBINATIONS) {
+			perror(argv[arg + 1]);
+			return 2;
+		}
+		fclose(fp);
+		printf("%s: %d bytes\n", argv[arg + 1], (int)(sizeof(header) + COMBINATIONS * sizeof(Estimate)));
+	}
+	return 0;
+}
+#endif
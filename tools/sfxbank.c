@@ -0,0 +1,174 @@
+/* sfxbank - packs a set of sounds into one bank file for the stream engine
+ *
+ * Layout (little-endian): "SBNK", version, entry count, then one 32-byte entry
+ * per sound - 16-byte name (file name without extension), data offset, data
+ * bytes, sample rate, codec (0 PCM, 1 VAG ADPCM), channels, bits, pad - then the
+ * sample data, each entry aligned to 16 bytes. A .vag written by tools/vagenc
+ * next to a WAV is packed instead of the WAV's PCM.
+ *
+ *   cc -O2 -o sfxbank tools/sfxbank.c
+ *   ./sfxbank romfs/sfx/office/office.bank romfs/sfx/office/[a-z]*.wav
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SOUNDS 64
+#define ENTRY_BYTES 32
+#define HEADER_BYTES 12
+
+typedef struct {
+	char name[16];
+	unsigned char *data;
+	unsigned int bytes, rate;
+	int codec, channels, bits;
+} Sound;
+
+static unsigned int le16(const unsigned char *p) { return p[0] | (p[1] << 8); }
+static unsigned int le32(const unsigned char *p) { return le16(p) | (le16(p + 2) << 16); }
+static unsigned int be32(const unsigned char *p) { return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+
+static void putLe32(unsigned char *p, unsigned int v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static unsigned char *readFile(const char *path, long *size)
+{
+	FILE *fp = fopen(path, "rb");
+	if (!fp) return NULL;
+	fseek(fp, 0, SEEK_END);
+	*size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	unsigned char *file = malloc(*size);
+	if (file && fread(file, 1, *size, fp) != (size_t)*size) {
+		free(file);
+		file = NULL;
+	}
+	fclose(fp);
+	return file;
+}
+
+static int loadVag(const char *path, Sound *sound)
+{
+	long size;
+	unsigned char *file = readFile(path, &size);
+	if (!file) return 0;
+	if (size < 48 || memcmp(file, "VAGp", 4) != 0 || be32(file + 12) > (unsigned int)size - 48) {
+		fprintf(stderr, "%s: bad vag header\n", path);
+		free(file);
+		return 0;
+	}
+	sound->codec = 1;
+	sound->channels = file[0x1e] ? file[0x1e] : 1;
+	sound->bits = 16;
+	sound->rate = be32(file + 16);
+	sound->bytes = be32(file + 12);
+	sound->data = malloc(sound->bytes);
+	memcpy(sound->data, file + 48, sound->bytes);
+	free(file);
+	return 1;
+}
+
+static int loadWav(const char *path, Sound *sound)
+{
+	long size, pos = 12;
+	unsigned char *file = readFile(path, &size);
+	if (!file) return 0;
+	sound->channels = 0;
+	while (pos + 8 <= size) {
+		unsigned int length = le32(file + pos + 4);
+		if (memcmp(file + pos, "fmt ", 4) == 0) {
+			if (le16(file + pos + 8) != 1) break;
+			sound->channels = le16(file + pos + 10);
+			sound->rate = le32(file + pos + 12);
+			sound->bits = le16(file + pos + 22);
+		} else if (memcmp(file + pos, "data", 4) == 0 && sound->channels) {
+			if (length > size - pos - 8) length = size - pos - 8;
+			sound->codec = 0;
+			sound->bytes = length - length % (sound->channels * sound->bits / 8);
+			sound->data = malloc(sound->bytes);
+			memcpy(sound->data, file + pos + 8, sound->bytes);
+			free(file);
+			return 1;
+		}
+		pos += 8 + length + (length & 1);
+	}
+	fprintf(stderr, "%s: not a PCM wav\n", path);
+	free(file);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	Sound sounds[MAX_SOUNDS];
+	int count = 0, i;
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s out.bank file.wav...\n", argv[0]);
+		return 1;
+	}
+	if (argc - 2 > MAX_SOUNDS) {
+		fprintf(stderr, "at most %d sounds per bank\n", MAX_SOUNDS);
+		return 1;
+	}
+
+	for (i = 2; i < argc; i++) {
+		Sound *sound = &sounds[count];
+		char path[1024];
+		memset(sound, 0, sizeof(*sound));
+		const char *base = strrchr(argv[i], '/');
+		base = base ? base + 1 : argv[i];
+		snprintf(sound->name, sizeof(sound->name), "%s", base);
+		char *dot = strrchr(sound->name, '.');
+		if (dot) *dot = 0;
+
+		snprintf(path, sizeof(path), "%s", argv[i]);
+		dot = strrchr(path, '.');
+		if (dot) strcpy(dot, ".vag");
+		if (!(dot && loadVag(path, sound)) && !loadWav(argv[i], sound)) return 2;
+		count++;
+	}
+
+	unsigned int offset = HEADER_BYTES + count * ENTRY_BYTES;
+	unsigned char *index = calloc(1, offset);
+	memcpy(index, "SBNK", 4);
+	putLe32(index + 4, 1);
+	putLe32(index + 8, count);
+	for (i = 0; i < count; i++) {
+		unsigned char *entry = index + HEADER_BYTES + i * ENTRY_BYTES;
+		offset = (offset + 15) & ~15u;
+		memcpy(entry, sounds[i].name, 16);
+		putLe32(entry + 16, offset);
+		putLe32(entry + 20, sounds[i].bytes);
+		putLe32(entry + 24, sounds[i].rate);
+		entry[28] = sounds[i].codec;
+		entry[29] = sounds[i].channels;
+		entry[30] = sounds[i].bits;
+		offset += sounds[i].bytes;
+	}
+
+	FILE *fp = fopen(argv[1], "wb");
+	if (!fp) {
+		perror(argv[1]);
+		return 2;
+	}
+	static const unsigned char zero[16];
+	long written = HEADER_BYTES + count * ENTRY_BYTES;
+	fwrite(index, 1, written, fp);
+	for (i = 0; i < count; i++) {
+		const unsigned char *entry = index + HEADER_BYTES + i * ENTRY_BYTES;
+		fwrite(zero, 1, le32(entry + 16) - written, fp);
+		fwrite(sounds[i].data, 1, sounds[i].bytes, fp);
+		written = le32(entry + 16) + sounds[i].bytes;
+		printf("%-16s %s %d ch %5u Hz %8u bytes\n", sounds[i].name, sounds[i].codec ? "vag" : "pcm",
+		       sounds[i].channels, sounds[i].rate, sounds[i].bytes);
+		free(sounds[i].data);
+	}
+	fclose(fp);
+	printf("%s: %d sounds, %ld bytes\n", argv[1], count, written);
+	free(index);
+	return 0;
+}
@@ -0,0 +1,241 @@
+/* vagenc - host-side WAV to PSP VAG-style ADPCM converter
+ *
+ * Writes a .vag next to every input .wav. The stream engine (source/stream.cpp)
+ * prefers the .vag and falls back to the WAV when it is missing.
+ *
+ * Format: the usual 48-byte big-endian "VAGp" header (data size at 0x0c, sample
+ * rate at 0x10) with the channel count in byte 0x1e. Data is 16-byte frames of
+ * 28 4-bit samples; stereo files interleave one frame per channel.
+ *
+ * Each file is decoded again and its SNR against the source is printed, along
+ * with the decoder throughput.
+ *
+ *   cc -O2 -o vagenc tools/vagenc.c -lm
+ *   ./vagenc romfs/ambience/office/call/call2.wav ...
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const int filters[5][2] = {
+	{0, 0}, {60, 0}, {115, -52}, {98, -55}, {122, -60}
+};
+
+typedef struct {
+	int channels, rate, frames;
+	short *pcm;	/* interleaved s16 */
+} Wav;
+
+static unsigned int le16(const unsigned char *p) { return p[0] | (p[1] << 8); }
+static unsigned int le32(const unsigned char *p) { return le16(p) | (le16(p + 2) << 16); }
+
+static int readWav(const char *path, Wav *wav)
+{
+	FILE *fp = fopen(path, "rb");
+	if (!fp) return 0;
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	unsigned char *file = malloc(size);
+	if (!file || fread(file, 1, size, fp) != (size_t)size) {
+		fclose(fp);
+		free(file);
+		return 0;
+	}
+	fclose(fp);
+
+	int bits = 0, ok = 0;
+	long pos = 12;
+	wav->channels = 0;
+	while (pos + 8 <= size) {
+		unsigned int length = le32(file + pos + 4);
+		if (memcmp(file + pos, "fmt ", 4) == 0) {
+			if (le16(file + pos + 8) != 1) break;
+			wav->channels = le16(file + pos + 10);
+			wav->rate = le32(file + pos + 12);
+			bits = le16(file + pos + 22);
+		} else if (memcmp(file + pos, "data", 4) == 0 && wav->channels && (bits == 8 || bits == 16)) {
+			if (length > size - pos - 8) length = size - pos - 8;
+			int frameBytes = wav->channels * bits / 8;
+			wav->frames = length / frameBytes;
+			wav->pcm = malloc(sizeof(short) * wav->frames * wav->channels);
+			int i;
+			for (i = 0; i < wav->frames * wav->channels; i++) {
+				const unsigned char *s = file + pos + 8 + i * bits / 8;
+				wav->pcm[i] = bits == 16 ? (short)le16(s) : (short)((s[0] - 128) << 8);
+			}
+			ok = 1;
+			break;
+		}
+		pos += 8 + length + (length & 1);
+	}
+	free(file);
+	return ok;
+}
+
+static int clamp16(int v)
+{
+	return v < -32768 ? -32768 : (v > 32767 ? 32767 : v);
+}
+
+/* Picks the filter/shift pair with the least error for one 28-sample frame */
+static void encodeFrame(const int *in, int *hist1, int *hist2, unsigned char *out, int last)
+{
+	double bestError = -1;
+	int bestFilter = 0, bestShift = 0, f, shift, i;
+	unsigned char bestNibbles[28];
+	int bestH1 = 0, bestH2 = 0;
+
+	for (f = 0; f < 5; f++) {
+		for (shift = 0; shift <= 12; shift++) {
+			int h1 = *hist1, h2 = *hist2;
+			double error = 0;
+			unsigned char nibbles[28];
+			for (i = 0; i < 28; i++) {
+				int predicted = (h1 * filters[f][0] + h2 * filters[f][1] + 32) >> 6;
+				int residual = in[i] - predicted;
+				/* sample = (n << 12) >> shift, so n = residual / 2^(12 - shift) */
+				double scaled = residual / (double)(1 << (12 - shift));
+				int n = (int)floor(scaled + 0.5);
+				if (n < -8) n = -8;
+				if (n > 7) n = 7;
+				int decoded = clamp16(((n << 12) >> shift) + predicted);
+				error += (double)(decoded - in[i]) * (decoded - in[i]);
+				nibbles[i] = n & 15;
+				h2 = h1;
+				h1 = decoded;
+			}
+			if (bestError < 0 || error < bestError) {
+				bestError = error;
+				bestFilter = f;
+				bestShift = shift;
+				memcpy(bestNibbles, nibbles, 28);
+				bestH1 = h1;
+				bestH2 = h2;
+			}
+		}
+	}
+
+	out[0] = (bestFilter << 4) | bestShift;
+	out[1] = last ? 1 : 0;
+	for (i = 0; i < 14; i++) out[2 + i] = bestNibbles[i * 2] | (bestNibbles[i * 2 + 1] << 4);
+	*hist1 = bestH1;
+	*hist2 = bestH2;
+}
+
+/* Same decoder as the game's, kept in sync with source/stream.cpp */
+static void decodeFrame(const unsigned char *in, int *hist1, int *hist2, short *out, int stride)
+{
+	int f = in[0] >> 4, shift = in[0] & 15, i;
+	if (f > 4) f = 0;
+	for (i = 0; i < 28; i++) {
+		int n = (in[2 + i / 2] >> ((i & 1) * 4)) & 15;
+		int sample = (short)(n << 12) >> shift;
+		sample = clamp16(sample + ((*hist1 * filters[f][0] + *hist2 * filters[f][1] + 32) >> 6));
+		*hist2 = *hist1;
+		*hist1 = sample;
+		out[i * stride] = (short)sample;
+	}
+}
+
+static void writeBe32(unsigned char *p, unsigned int v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+static int convert(const char *path)
+{
+	Wav wav = {0, 0, 0, NULL};
+	if (!readWav(path, &wav)) {
+		fprintf(stderr, "%s: not a PCM wav\n", path);
+		return 0;
+	}
+
+	int blocks = (wav.frames + 27) / 28, ch, b, i;
+	size_t dataBytes = (size_t)blocks * 16 * wav.channels;
+	unsigned char *data = calloc(1, dataBytes);
+	int hist1[2] = {0, 0}, hist2[2] = {0, 0};
+	for (b = 0; b < blocks; b++) {
+		for (ch = 0; ch < wav.channels; ch++) {
+			int in[28];
+			for (i = 0; i < 28; i++) {
+				int frame = b * 28 + i;
+				in[i] = frame < wav.frames ? wav.pcm[frame * wav.channels + ch] : 0;
+			}
+			encodeFrame(in, &hist1[ch], &hist2[ch], data + (b * wav.channels + ch) * 16, b == blocks - 1);
+		}
+	}
+
+	/* Decode again: SNR against the source, and decoder speed */
+	short *decoded = malloc(sizeof(short) * blocks * 28 * wav.channels);
+	int runs = 0;
+	clock_t start = clock();
+	do {
+		hist1[0] = hist1[1] = hist2[0] = hist2[1] = 0;
+		for (b = 0; b < blocks; b++) {
+			for (ch = 0; ch < wav.channels; ch++) {
+				decodeFrame(data + (b * wav.channels + ch) * 16, &hist1[ch], &hist2[ch],
+				            decoded + b * 28 * wav.channels + ch, wav.channels);
+			}
+		}
+		runs++;
+	} while (clock() - start < CLOCKS_PER_SEC / 10);
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	double samplesPerSecond = (double)runs * blocks * 28 * wav.channels / seconds;
+
+	double signal = 0, noise = 0;
+	for (i = 0; i < wav.frames * wav.channels; i++) {
+		double d = decoded[i] - wav.pcm[i];
+		signal += (double)wav.pcm[i] * wav.pcm[i];
+		noise += d * d;
+	}
+	double snr = noise > 0 ? 10.0 * log10(signal / noise) : 99.0;
+
+	char outPath[1024];
+	snprintf(outPath, sizeof(outPath), "%s", path);
+	char *ext = strrchr(outPath, '.');
+	if (ext) strcpy(ext, ".vag");
+
+	unsigned char header[48];
+	memset(header, 0, sizeof(header));
+	memcpy(header, "VAGp", 4);
+	writeBe32(header + 4, 0x20);
+	writeBe32(header + 12, dataBytes);
+	writeBe32(header + 16, wav.rate);
+	header[0x1e] = wav.channels;
+	const char *name = strrchr(path, '/');
+	strncpy((char *)header + 32, name ? name + 1 : path, 15);
+
+	FILE *fp = fopen(outPath, "wb");
+	int ok = fp != NULL;
+	if (fp) {
+		fwrite(header, 1, 48, fp);
+		fwrite(data, 1, dataBytes, fp);
+		fclose(fp);
+	}
+	printf("%-50s %d ch %5d Hz %8d s16 bytes -> %8zu  SNR %5.1f dB  %6.1f Msamples/s\n", path, wav.channels, wav.rate,
+	       wav.frames * wav.channels * 2, dataBytes + 48, snr, samplesPerSecond / 1e6);
+
+	free(decoded);
+	free(data);
+	free(wav.pcm);
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	int i, failures = 0;
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s file.wav...\n", argv[0]);
+		return 1;
+	}
+	for (i = 1; i < argc; i++) {
+		if (!convert(argv[i])) failures++;
+	}
+	return failures ? 2 : 0;
+}